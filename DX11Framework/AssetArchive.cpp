@@ -0,0 +1,399 @@
+#include "AssetArchive.h"
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <algorithm>
+#include <ctype.h>
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#include "Hash.h"
+#include "JobSystem.h"
+
+static const size_t LZ_MIN_MATCH = 4;
+static const size_t LZ_MAX_OFFSET = 65535;
+static const uint32_t LZ_HASH_BITS = 16;
+static const uint32_t LZ_NO_POSITION = ~0u;
+
+static uint32_t Read32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static void WriteLength(std::vector<uint8_t>& output, size_t length)
+{
+    for (; length >= 255; length -= 255) output.push_back(255);
+    output.push_back((uint8_t)length);
+}
+
+static bool ReadLength(const uint8_t* data, size_t dataSize, size_t& position, size_t limit, size_t& length)
+{
+    uint8_t byte;
+    do
+    {
+        if (position >= dataSize || length > limit) return false;
+        byte = data[position++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+//literals then, unless it is the last sequence, a match of length at offset back
+static void WriteSequence(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalCount, size_t offset, size_t length)
+{
+    size_t matchCode = length ? length - LZ_MIN_MATCH : 0;
+    output.push_back((uint8_t)((std::min(literalCount, (size_t)15) << 4) | std::min(matchCode, (size_t)15)));
+    if (literalCount >= 15) WriteLength(output, literalCount - 15);
+    output.insert(output.end(), literals, literals + literalCount);
+    if (!length) return;
+
+    output.push_back((uint8_t)offset);
+    output.push_back((uint8_t)(offset >> 8));
+    if (matchCode >= 15) WriteLength(output, matchCode - 15);
+}
+
+void AssetLZ::Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& output)
+{
+    output.clear();
+    output.reserve(size / 2 + 16);
+
+    //Last place each 4 byte run was seen, greedy and one candidate deep, which is plenty for meshes and scenes
+    std::vector<uint32_t> table((size_t)1 << LZ_HASH_BITS, LZ_NO_POSITION);
+
+    size_t literalStart = 0;
+    size_t position = 0;
+    while (size >= LZ_MIN_MATCH && position <= size - LZ_MIN_MATCH)
+    {
+        uint32_t sequence = Read32(data + position);
+        uint32_t& slot = table[(sequence * 2654435761u) >> (32 - LZ_HASH_BITS)];
+        size_t candidate = slot;
+        slot = (uint32_t)position;
+
+        if (candidate == LZ_NO_POSITION || position - candidate > LZ_MAX_OFFSET || Read32(data + candidate) != sequence)
+        {
+            position++;
+            continue;
+        }
+
+        size_t length = LZ_MIN_MATCH;
+        while (position + length < size && data[candidate + length] == data[position + length]) length++;
+
+        WriteSequence(output, data + literalStart, position - literalStart, position - candidate, length);
+        position += length;
+        literalStart = position;
+    }
+
+    WriteSequence(output, data + literalStart, size - literalStart, 0, 0);
+}
+
+bool AssetLZ::Decompress(const uint8_t* data, size_t dataSize, uint8_t* output, size_t size)
+{
+    //Every stream ends with a sequence of just literals, even none, so one cut off after a match is caught too
+    size_t in = 0;
+    size_t out = 0;
+    bool ended = false;
+    while (in < dataSize)
+    {
+        uint8_t token = data[in++];
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !ReadLength(data, dataSize, in, size, literals)) return false;
+        if (literals > dataSize - in || literals > size - out) return false;
+        memcpy(output + out, data + in, literals);
+        in += literals;
+        out += literals;
+        if (in == dataSize)
+        {
+            ended = true;
+            break;
+        }
+
+        if (dataSize - in < 2) return false;
+        size_t offset = data[in] | ((size_t)data[in + 1] << 8);
+        in += 2;
+
+        size_t length = token & 15;
+        if (length == 15 && !ReadLength(data, dataSize, in, size, length)) return false;
+        length += LZ_MIN_MATCH;
+        if (offset == 0 || offset > out || length > size - out) return false;
+
+        //Byte by byte, a match can overlap what it is copying
+        for (size_t i = 0; i < length; i++, out++) output[out] = output[out - offset];
+    }
+    return ended && out == size;
+}
+
+bool AssetArchive::Open(const char* filename)
+{
+    Close();
+    if (!_file.Open(filename)) return false;
+
+    _data = _file.GetData();
+    _size = _file.GetSize();
+
+    //Everything is checked against the file size before use, a truncated or stale archive is a failed open not a crash
+    const AssetArchiveHeader* header = (const AssetArchiveHeader*)_data;
+    size_t entriesStart = sizeof(AssetArchiveHeader);
+    if (_size < entriesStart || header->Magic != ASSET_ARCHIVE_MAGIC || header->Version != ASSET_ARCHIVE_VERSION ||
+        header->Alignment == 0 || (header->Alignment & (header->Alignment - 1)) != 0 || header->StringTableSize == 0)
+    {
+        Close();
+        return false;
+    }
+
+    size_t stringsStart = entriesStart + (size_t)header->EntryCount * sizeof(AssetArchiveEntry);
+    if (header->EntryCount > (_size - entriesStart) / sizeof(AssetArchiveEntry) || header->StringTableSize > _size - stringsStart ||
+        _data[stringsStart + header->StringTableSize - 1] != 0)
+    {
+        Close();
+        return false;
+    }
+
+    const AssetArchiveEntry* entries = (const AssetArchiveEntry*)(_data + entriesStart);
+    for (uint32_t i = 0; i < header->EntryCount; i++)
+    {
+        const AssetArchiveEntry& entry = entries[i];
+        //No LZ sequence inflates to more than 255 bytes a stored byte, a bigger size is damage not data. Data starts on
+        //the alignment past the table of contents, as the writer lays it out
+        bool stored = entry.Compression == ASSET_COMPRESSION_NONE && entry.StoredSize == entry.Size;
+        bool compressed = entry.Compression == ASSET_COMPRESSION_LZ && entry.Size / 255 <= entry.StoredSize;
+        if ((!stored && !compressed) || entry.Format > ASSET_FORMAT_MESH || (entry.Offset & (header->Alignment - 1)) != 0 ||
+            entry.Offset < stringsStart + header->StringTableSize ||
+            entry.Offset > _size || entry.StoredSize > _size - entry.Offset || entry.Path >= header->StringTableSize ||
+            entry.Size > SIZE_MAX || (i > 0 && entries[i - 1].PathHash > entry.PathHash))
+        {
+            Close();
+            return false;
+        }
+    }
+
+    _header = header;
+    _entries = entries;
+    _strings = (const char*)(_data + stringsStart);
+    return true;
+}
+
+void AssetArchive::Close()
+{
+    _file.Close();
+    _data = nullptr;
+    _size = 0;
+    _header = nullptr;
+    _entries = nullptr;
+    _strings = nullptr;
+}
+
+std::string AssetArchive::NormalizePath(const std::string& path)
+{
+    std::string normalized = path;
+    for (char& c : normalized)
+    {
+        c = c == '/' ? '\\' : (char)tolower((unsigned char)c);
+    }
+    return normalized;
+}
+
+const AssetArchiveEntry* AssetArchive::Find(const std::string& path) const
+{
+    if (!_header) return nullptr;
+
+    std::string normalized = NormalizePath(path);
+    uint64_t hash = HashString(normalized);
+
+    //Different paths can share a hash, so every entry with it is checked by name
+    const AssetArchiveEntry* end = _entries + _header->EntryCount;
+    const AssetArchiveEntry* entry = std::lower_bound(_entries, end, hash, [](const AssetArchiveEntry& a, uint64_t b) { return a.PathHash < b; });
+    for (; entry != end && entry->PathHash == hash; entry++)
+    {
+        if (normalized == GetPath(*entry)) return entry;
+    }
+    return nullptr;
+}
+
+bool AssetFile::Open(const AssetArchive* archive, const std::string& path)
+{
+    Close();
+
+    const AssetArchiveEntry* entry = archive ? archive->Find(path) : nullptr;
+    if (!entry)
+    {
+        if (!_file.Open(path.c_str())) return false;
+        _data = _file.GetData();
+        _size = _file.GetSize();
+        return true;
+    }
+
+    _archived = true;
+    _format = (AssetFormat)entry->Format;
+    _contentHash = entry->ContentHash;
+    _hashed = true;
+
+    const uint8_t* stored = archive->GetStoredData(*entry);
+    if (entry->Compression == ASSET_COMPRESSION_NONE)
+    {
+        _data = stored;
+        _size = (size_t)entry->Size;
+        return true;
+    }
+
+    _inflated.resize((size_t)entry->Size);
+    if (!AssetLZ::Decompress(stored, (size_t)entry->StoredSize, _inflated.data(), _inflated.size()))
+    {
+        Close();
+        return false;
+    }
+    _data = _inflated.data();
+    _size = _inflated.size();
+    return true;
+}
+
+void AssetFile::Close()
+{
+    _file.Close();
+    std::vector<uint8_t>().swap(_inflated);
+    _data = nullptr;
+    _size = 0;
+    _contentHash = 0;
+    _hashed = false;
+    _archived = false;
+    _format = ASSET_FORMAT_RAW;
+}
+
+uint64_t AssetFile::GetContentHash()
+{
+    if (!_hashed)
+    {
+        _contentHash = HashBytes(_data, _size);
+        _hashed = true;
+    }
+    return _contentHash;
+}
+
+static uint64_t RoundUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool AssetArchiveWriter::Write(const std::string& filename, const std::vector<AssetArchiveInput>& inputs, uint32_t alignment, float minSavings,
+    JobSystem* jobSystem, AssetArchiveStats* stats)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return false;
+
+    std::vector<std::string> paths(inputs.size());
+    std::vector<uint32_t> order(inputs.size());
+    for (uint32_t i = 0; i < (uint32_t)inputs.size(); i++)
+    {
+        paths[i] = AssetArchive::NormalizePath(inputs[i].Path);
+        order[i] = i;
+    }
+
+    //Table order, by hash and then path so the same inputs always make the same file
+    std::vector<uint64_t> hashes(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) hashes[i] = HashString(paths[i]);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+    {
+        return hashes[a] != hashes[b] ? hashes[a] < hashes[b] : paths[a] < paths[b];
+    });
+    for (size_t i = 1; i < order.size(); i++)
+    {
+        if (paths[order[i]] == paths[order[i - 1]]) return false;
+    }
+
+    //Each entry is compressed on its own, so they can all go at once
+    std::vector<std::vector<uint8_t>> compressed(inputs.size());
+    auto compress = [&](uint32_t first, uint32_t end)
+    {
+        for (uint32_t i = first; i < end; i++)
+        {
+            const AssetArchiveInput& input = inputs[i];
+            if (!input.Compress || input.Data.empty() || input.Data.size() > 0xFFFFFFFFull) continue;
+
+            AssetLZ::Compress(input.Data.data(), input.Data.size(), compressed[i]);
+            if (compressed[i].size() > input.Data.size() * (1.0 - minSavings)) std::vector<uint8_t>().swap(compressed[i]);
+        }
+    };
+    if (jobSystem && !inputs.empty()) jobSystem->ParallelFor((uint32_t)inputs.size(), 1, compress);
+    else compress(0, (uint32_t)inputs.size());
+
+    std::string strings;
+    std::vector<AssetArchiveEntry> entries(inputs.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        uint32_t input = order[i];
+        AssetArchiveEntry& entry = entries[i];
+        entry = AssetArchiveEntry();
+        entry.PathHash = hashes[input];
+        entry.ContentHash = HashBytes(inputs[input].Data.data(), inputs[input].Data.size());
+        entry.Size = inputs[input].Data.size();
+        entry.Compression = compressed[input].empty() ? ASSET_COMPRESSION_NONE : ASSET_COMPRESSION_LZ;
+        entry.StoredSize = compressed[input].empty() ? entry.Size : compressed[input].size();
+        entry.Format = (uint16_t)inputs[input].Format;
+        entry.Path = (uint32_t)strings.size();
+        strings.append(paths[input]);
+        strings.push_back('\0');
+    }
+    if (strings.empty()) strings.push_back('\0');
+
+    //Data goes in input order, each entry on its own aligned start
+    std::vector<uint32_t> entryOf(inputs.size());
+    for (uint32_t i = 0; i < (uint32_t)order.size(); i++) entryOf[order[i]] = i;
+
+    uint64_t tableSize = sizeof(AssetArchiveHeader) + entries.size() * sizeof(AssetArchiveEntry) + strings.size();
+    uint64_t position = RoundUp(tableSize, alignment);
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        AssetArchiveEntry& entry = entries[entryOf[i]];
+        entry.Offset = position;
+        position = RoundUp(position + entry.StoredSize, alignment);
+    }
+
+    AssetArchiveHeader header = {};
+    header.Magic = ASSET_ARCHIVE_MAGIC;
+    header.Version = ASSET_ARCHIVE_VERSION;
+    header.EntryCount = (uint32_t)entries.size();
+    header.Alignment = alignment;
+    header.StringTableSize = (uint32_t)strings.size();
+
+    std::string temporaryFilename = filename + ".tmp";
+    {
+        std::ofstream output(temporaryFilename, std::ios::binary | std::ios::trunc);
+        if (!output.good()) return false;
+
+        std::vector<char> padding(alignment, 0);
+        auto pad = [&]() { output.write(padding.data(), RoundUp((uint64_t)output.tellp(), alignment) - (uint64_t)output.tellp()); };
+
+        output.write((const char*)&header, sizeof(header));
+        output.write((const char*)entries.data(), entries.size() * sizeof(AssetArchiveEntry));
+        output.write(strings.data(), strings.size());
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            pad();
+            const std::vector<uint8_t>& data = compressed[i].empty() ? inputs[i].Data : compressed[i];
+            output.write((const char*)data.data(), data.size());
+        }
+        if (!output.good()) return false;
+    }
+
+    if (stats)
+    {
+        *stats = AssetArchiveStats();
+        stats->Entries = entries.size();
+        stats->FileSize = tableSize;
+        for (const AssetArchiveEntry& entry : entries)
+        {
+            if (entry.Compression != ASSET_COMPRESSION_NONE) stats->Compressed++;
+            stats->Bytes += entry.Size;
+            stats->StoredBytes += entry.StoredSize;
+            stats->FileSize = std::max(stats->FileSize, entry.Offset + entry.StoredSize);
+        }
+    }
+
+#ifdef _WIN32
+    return MoveFileExA(temporaryFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    //rename replaces the destination atomically on POSIX already
+    return rename(temporaryFilename.c_str(), filename.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+class JobSystem;
+
+//Archive layout: header, entry table sorted by path hash, string table of the paths, then every entry's data
+//starting on a multiple of Alignment. The table of contents all sits at the front, so opening an archive reads
+//a page or two, and a 4K alignment lets each entry be read uncached or mapped on its own pages
+const uint32_t ASSET_ARCHIVE_MAGIC = 0x4B505341; //"ASPK"
+const uint32_t ASSET_ARCHIVE_VERSION = 1;
+
+enum AssetCompression
+{
+	ASSET_COMPRESSION_NONE = 0, //Read straight out of the mapping
+	ASSET_COMPRESSION_LZ = 1    //See AssetLZ, inflated into a buffer of the reader's own
+};
+
+//What the bytes are once inflated
+enum AssetFormat
+{
+	ASSET_FORMAT_RAW = 0, //The file exactly as it was on disk
+	ASSET_FORMAT_MESH = 1 //An OBJ already turned into OBJLoader's binary layout
+};
+
+struct AssetArchiveHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t EntryCount;
+	uint32_t Alignment;
+	uint32_t StringTableSize;
+	uint32_t Reserved[3];
+};
+
+struct AssetArchiveEntry
+{
+	uint64_t PathHash;    //HashString of the normalised path
+	uint64_t ContentHash; //HashBytes of the inflated bytes, so sharing by content doesn't have to read them
+	uint64_t Offset;      //From the start of the archive
+	uint64_t StoredSize;  //Bytes in the archive
+	uint64_t Size;        //Bytes once inflated, the same as StoredSize when stored as is
+	uint32_t Path;        //Offset of the normalised path in the string table
+	uint16_t Compression;
+	uint16_t Format;
+};
+
+//Small LZ77 coder so archives need nothing outside the repo. Each sequence is a token (literal count in the high
+//nibble, match length - 4 in the low, 15 meaning more bytes follow), the literals, then a 2 byte offset back into
+//what has been written; the last sequence is just literals. Inflating is a bounds checked copy loop
+namespace AssetLZ
+{
+	void Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+
+	//False unless data inflates to exactly size bytes
+	bool Decompress(const uint8_t* data, size_t dataSize, uint8_t* output, size_t size);
+};
+
+//Read only view of an archive through one mapping. Everything in the table is checked on Open, so lookups and
+//reads can trust it, and being read only it is safe to use from any number of loading jobs at once
+class AssetArchive
+{
+private:
+	MappedFile _file;
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+	const AssetArchiveHeader* _header = nullptr;
+	const AssetArchiveEntry* _entries = nullptr;
+	const char* _strings = nullptr;
+
+public:
+	AssetArchive() = default;
+
+	AssetArchive(const AssetArchive&) = delete;
+	AssetArchive& operator=(const AssetArchive&) = delete;
+
+	bool Open(const char* filename); //UTF-8
+	void Close();
+	bool IsOpen() const { return _header != nullptr; }
+
+	//Lower case with back slashes, the same as AssetCache keys paths by
+	static std::string NormalizePath(const std::string& path);
+
+	//Binary search on the path's hash, nullptr when the archive isn't open or doesn't have it
+	const AssetArchiveEntry* Find(const std::string& path) const;
+
+	uint32_t GetEntryCount() const { return _header ? _header->EntryCount : 0; }
+	const AssetArchiveEntry& GetEntry(uint32_t index) const { return _entries[index]; }
+	const char* GetPath(const AssetArchiveEntry& entry) const { return _strings + entry.Path; }
+	const uint8_t* GetStoredData(const AssetArchiveEntry& entry) const { return _data + entry.Offset; }
+	size_t GetSize() const { return _size; }
+};
+
+//Bytes of one asset, from the archive when there is one and it has the path, otherwise mapped from the loose file.
+//Entries stored as they are point straight into the archive's mapping, so the archive has to outlive every AssetFile
+//opened from it. Compressed ones are inflated into a buffer the AssetFile owns
+class AssetFile
+{
+private:
+	MappedFile _file;
+	std::vector<uint8_t> _inflated;
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+	uint64_t _contentHash = 0;
+	bool _hashed = false;
+	bool _archived = false;
+	AssetFormat _format = ASSET_FORMAT_RAW;
+
+public:
+	AssetFile() = default;
+	~AssetFile() { Close(); }
+
+	AssetFile(const AssetFile&) = delete;
+	AssetFile& operator=(const AssetFile&) = delete;
+
+	//archive can be nullptr or closed, path is UTF-8
+	bool Open(const AssetArchive* archive, const std::string& path);
+	void Close();
+
+	bool IsOpen() const { return _data != nullptr; }
+	bool IsArchived() const { return _archived; }
+	AssetFormat GetFormat() const { return _format; }
+	const uint8_t* GetData() const { return _data; }
+	size_t GetSize() const { return _size; }
+
+	//Taken from the archive's table when it came from there, hashed on first use otherwise
+	uint64_t GetContentHash();
+};
+
+//One file going into an archive. Entries are laid out in the order they are given, so giving them in the order
+//they get loaded keeps reads going forwards through the file
+struct AssetArchiveInput
+{
+	std::string Path;
+	std::vector<uint8_t> Data;
+	AssetFormat Format = ASSET_FORMAT_RAW;
+	bool Compress = false; //Only kept compressed when that saves at least minSavings of it
+};
+
+struct AssetArchiveStats
+{
+	size_t Entries = 0;
+	size_t Compressed = 0;
+	uint64_t Bytes = 0;       //Inflated
+	uint64_t StoredBytes = 0; //In the archive
+	uint64_t FileSize = 0;
+};
+
+namespace AssetArchiveWriter
+{
+	//Writes to the side and moves it over filename, so a reader never sees half an archive. alignment is a power of two,
+	//compression is shared out over jobSystem when there is one. False on duplicate paths or if it couldn't be written
+	bool Write(const std::string& filename, const std::vector<AssetArchiveInput>& inputs, uint32_t alignment, float minSavings,
+		JobSystem* jobSystem, AssetArchiveStats* stats = nullptr);
+};
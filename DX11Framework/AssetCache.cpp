@@ -0,0 +1,273 @@
+#include "AssetCache.h"
+#include "AssetArchive.h"
+#include "Hash.h"
+
+std::string AssetCache::NormalizePath(const std::string& path)
+{
+    //Archives key their tables the same way, so a path finds its packed copy whichever it is given as
+    return AssetArchive::NormalizePath(path);
+}
+
+std::string AssetCache::MakeKey(AssetType type, const std::string& path)
+{
+    //A file could in theory be loaded as both, so the type is part of the key
+    return NormalizePath(path) + (type == ASSET_MESH ? "|mesh" : "|texture");
+}
+
+uint64_t AssetCache::MakeContentKey(AssetType type, uint64_t contentHash)
+{
+    return HashBytes(&type, sizeof(type), contentHash);
+}
+
+AssetHandle AssetCache::Acquire(AssetType type, const std::string& path, bool* created)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::string key = MakeKey(type, path);
+    auto found = _pathLookup.find(key);
+    if (found != _pathLookup.end())
+    {
+        _entries.Get(found->second)->RefCount++;
+        if (created) *created = false;
+        return found->second;
+    }
+
+    Entry entry;
+    entry.Key = key;
+    entry.Type = type;
+    entry.RefCount = 1;
+
+    AssetHandle handle = _entries.Create(entry);
+    _pathLookup[key] = handle;
+
+    if (created) *created = true;
+    return handle;
+}
+
+void AssetCache::AddRef(AssetHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry* entry = _entries.Get(handle);
+    if (entry) entry->RefCount++;
+}
+
+void AssetCache::Release(AssetHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    ReleaseEntry(handle);
+}
+
+void AssetCache::ReleaseEntry(AssetHandle handle)
+{
+    Entry* entry = _entries.Get(handle);
+    if (!entry || --entry->RefCount > 0) return;
+
+    //Invalidate may already have handed the path to a newer entry
+    auto path = _pathLookup.find(entry->Key);
+    if (path != _pathLookup.end() && path->second == handle)
+    {
+        _pathLookup.erase(path);
+    }
+
+    auto content = _contentLookup.find(MakeContentKey(entry->Type, entry->ContentHash));
+    if (content != _contentLookup.end() && content->second == handle)
+    {
+        _contentLookup.erase(content);
+    }
+
+    AssetHandle sharedWith = entry->SharedWith;
+    if (!sharedWith.IsValid())
+    {
+        if (entry->Mesh.VertexBuffer)entry->Mesh.VertexBuffer->Release();
+        if (entry->Mesh.IndexBuffer)entry->Mesh.IndexBuffer->Release();
+        if (entry->Texture)entry->Texture->Release();
+    }
+
+    //Any handle still out there for this entry is stale from here on
+    _entries.Destroy(handle);
+
+    //Doesn't own anything, just lets go of the entry it was borrowing from
+    if (sharedWith.IsValid())
+    {
+        ReleaseEntry(sharedWith);
+    }
+}
+
+void AssetCache::Invalidate(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const AssetType types[] = { ASSET_MESH, ASSET_TEXTURE };
+    for (AssetType type : types)
+    {
+        auto found = _pathLookup.find(MakeKey(type, path));
+        if (found == _pathLookup.end()) continue;
+
+        //Nor should anything new share the old bytes by content, they are out of date
+        Entry* entry = _entries.Get(found->second);
+        auto content = _contentLookup.find(MakeContentKey(entry->Type, entry->ContentHash));
+        if (content != _contentLookup.end() && content->second == found->second)
+        {
+            _contentLookup.erase(content);
+        }
+
+        _pathLookup.erase(found);
+    }
+}
+
+bool AssetCache::ShareByContent(AssetHandle handle, uint64_t contentHash)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry* entry = _entries.Get(handle);
+    if (!entry) return false;
+    entry->ContentHash = contentHash;
+
+    //Only entries that have finished loading are shared, two copies loading at once both just load
+    auto found = _contentLookup.find(MakeContentKey(entry->Type, contentHash));
+    if (found == _contentLookup.end() || found->second == handle) return false;
+
+    Entry* original = _entries.Get(found->second);
+    if (!original) return false;
+
+    original->RefCount++;
+    entry->SharedWith = found->second;
+    entry->State = ASSET_LOADED;
+    return true;
+}
+
+void AssetCache::SetLoaded(AssetHandle handle, const MeshData& mesh, ID3D11ShaderResourceView* texture)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry* entry = _entries.Get(handle);
+    if (!entry)
+    {
+        //Everyone let go while it was loading, so nothing will ever free these if we don't
+        if (mesh.VertexBuffer)mesh.VertexBuffer->Release();
+        if (mesh.IndexBuffer)mesh.IndexBuffer->Release();
+        if (texture)texture->Release();
+        return;
+    }
+
+    entry->Mesh = mesh;
+    entry->Texture = texture;
+    entry->State = ASSET_LOADED;
+
+    uint64_t contentKey = MakeContentKey(entry->Type, entry->ContentHash);
+    if (entry->ContentHash && _contentLookup.find(contentKey) == _contentLookup.end())
+    {
+        _contentLookup[contentKey] = handle;
+    }
+}
+
+void AssetCache::SetFailed(AssetHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry* entry = _entries.Get(handle);
+    if (entry) entry->State = ASSET_FAILED;
+}
+
+const AssetCache::Entry* AssetCache::Resolve(AssetHandle handle)
+{
+    const Entry* entry = _entries.Get(handle);
+    if (entry && entry->SharedWith.IsValid())
+    {
+        return _entries.Get(entry->SharedWith);
+    }
+    return entry;
+}
+
+AssetState AssetCache::GetState(AssetHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const Entry* entry = _entries.Get(handle);
+    return entry ? entry->State : ASSET_FAILED;
+}
+
+std::string AssetCache::GetPath(AssetHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const Entry* entry = _entries.Get(handle);
+    if (!entry) return std::string();
+
+    //Key is the normalised path plus the type suffix
+    return entry->Key.substr(0, entry->Key.rfind('|'));
+}
+
+MeshData AssetCache::GetMesh(AssetHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const Entry* entry = Resolve(handle);
+    return entry ? entry->Mesh : MeshData();
+}
+
+ID3D11ShaderResourceView* AssetCache::GetTexture(AssetHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const Entry* entry = Resolve(handle);
+    return entry ? entry->Texture : nullptr;
+}
+
+AssetHandle AssetCache::GetOwner(AssetHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const Entry* entry = _entries.Get(handle);
+    if (!entry) return AssetHandle();
+    return entry->SharedWith.IsValid() ? entry->SharedWith : handle;
+}
+
+bool AssetCache::ReplaceTexture(AssetHandle handle, ID3D11ShaderResourceView* texture, ID3D11ShaderResourceView** previous)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry* entry = _entries.Get(handle);
+    if (entry && entry->SharedWith.IsValid()) entry = _entries.Get(entry->SharedWith);
+    if (!entry || entry->State != ASSET_LOADED || !entry->Texture) return false;
+
+    *previous = entry->Texture;
+    entry->Texture = texture;
+    return true;
+}
+
+size_t AssetCache::GetLiveCount()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.GetCount();
+}
+
+size_t AssetCache::GetResidentCount()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    size_t resident = 0;
+    for (const Entry& entry : _entries)
+    {
+        if (entry.State == ASSET_LOADED && !entry.SharedWith.IsValid()) resident++;
+    }
+    return resident;
+}
+
+void AssetCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (Entry& entry : _entries)
+    {
+        if (entry.SharedWith.IsValid()) continue;
+        if (entry.Mesh.VertexBuffer)entry.Mesh.VertexBuffer->Release();
+        if (entry.Mesh.IndexBuffer)entry.Mesh.IndexBuffer->Release();
+        if (entry.Texture)entry.Texture->Release();
+    }
+
+    _entries.Clear();
+    _pathLookup.clear();
+    _contentLookup.clear();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <d3d11_4.h>
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Structures.h"
+#include "HandlePool.h"
+
+enum AssetType
+{
+	ASSET_MESH,
+	ASSET_TEXTURE
+};
+
+enum AssetState
+{
+	ASSET_PENDING,
+	ASSET_LOADED,
+	ASSET_FAILED
+};
+
+//Default handle means no asset, and a handle to an entry that has since been freed is caught as stale
+typedef PoolHandle AssetHandle;
+
+//Central registry of loaded meshes and textures. Entries are found by normalised path, and files whose bytes
+//hash the same share one set of GPU resources. Every Acquire/AddRef needs a matching Release, and the GPU
+//resources go when the last one does. Safe to call from loading jobs as well as the main thread
+class AssetCache
+{
+private:
+	struct Entry
+	{
+		std::string Key;
+		AssetType Type;
+		AssetState State = ASSET_PENDING;
+		int RefCount = 0;
+		uint64_t ContentHash = 0;
+		AssetHandle SharedWith; //Entry with the same content whose resources this one uses
+		MeshData Mesh = {};
+		ID3D11ShaderResourceView* Texture = nullptr;
+	};
+
+	std::mutex _mutex;
+	HandlePool<Entry> _entries;
+	std::unordered_map<std::string, AssetHandle> _pathLookup;
+	std::unordered_map<uint64_t, AssetHandle> _contentLookup;
+
+	static std::string MakeKey(AssetType type, const std::string& path);
+	static uint64_t MakeContentKey(AssetType type, uint64_t contentHash);
+	const Entry* Resolve(AssetHandle handle);
+	void ReleaseEntry(AssetHandle handle);
+
+public:
+	AssetCache() = default;
+	~AssetCache() { Clear(); }
+
+	AssetCache(const AssetCache&) = delete;
+	AssetCache& operator=(const AssetCache&) = delete;
+
+	//Lower case with back slashes, so the same file spelt differently in JSON is still one entry
+	static std::string NormalizePath(const std::string& path);
+
+	//Bumps the count on the entry for this path, or makes a new pending one and sets created so the caller loads it
+	AssetHandle Acquire(AssetType type, const std::string& path, bool* created = nullptr);
+	void AddRef(AssetHandle handle);
+	void Release(AssetHandle handle);
+
+	//The file at path has changed on disk. Whoever holds its entries keeps them, but the next Acquire of the
+	//path makes a new entry so the new version gets loaded
+	void Invalidate(const std::string& path);
+
+	//Called by a loading job once it has the file's bytes. If an already loaded entry has the same content
+	//this entry shares its resources and true comes back so the job can skip decoding and uploading
+	bool ShareByContent(AssetHandle handle, uint64_t contentHash);
+	void SetLoaded(AssetHandle handle, const MeshData& mesh, ID3D11ShaderResourceView* texture);
+	void SetFailed(AssetHandle handle);
+
+	//Stale or default handles report failed and give back empty resources
+	AssetState GetState(AssetHandle handle);
+	std::string GetPath(AssetHandle handle);
+	MeshData GetMesh(AssetHandle handle);
+	ID3D11ShaderResourceView* GetTexture(AssetHandle handle);
+
+	//The entry whose GPU resources handle uses, itself unless it shares another's by content
+	AssetHandle GetOwner(AssetHandle handle);
+
+	//Swaps a loaded texture for another copy of it, such as one with more or fewer mips. The cache owns texture from
+	//then on and the caller owns what comes back in previous. False for a stale handle, which leaves texture with the caller
+	bool ReplaceTexture(AssetHandle handle, ID3D11ShaderResourceView* texture, ID3D11ShaderResourceView** previous);
+
+	//Live entries are paths still referenced, resident ones are those holding their own GPU resources
+	size_t GetLiveCount();
+	size_t GetResidentCount();
+
+	void Clear();
+};
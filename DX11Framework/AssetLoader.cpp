@@ -0,0 +1,167 @@
+#include "AssetLoader.h"
+#include "OBJLoader.h"
+#include "DDSTextureLoader.h"
+
+void AssetLoader::Initialise(ID3D11Device* device, JobSystem* jobSystem, AssetCache* cache)
+{
+    _device = device;
+    _jobSystem = jobSystem;
+    _cache = cache;
+}
+
+AssetHandle AssetLoader::Request(const std::string& path, AssetUse use, PoolHandle object)
+{
+    AssetType type = use == ASSET_USE_MESH ? ASSET_MESH : ASSET_TEXTURE;
+
+    bool created = false;
+    AssetHandle handle = _cache->Acquire(type, path, &created);
+
+    auto found = _loads.find(handle.Index);
+    if (found == _loads.end())
+    {
+        Load* load = new Load();
+        load->Handle = handle;
+        load->Type = type;
+        load->Path = path;
+        found = _loads.emplace(handle.Index, std::unique_ptr<Load>(load)).first;
+
+        //Keeps the entry alive until the result has been collected, even if every user lets go first
+        _cache->AddRef(handle);
+
+        if (created)
+        {
+            _unstarted.push_back(load);
+        }
+        else
+        {
+            //Cache already had it from an earlier load, nothing to do but hand it out
+            load->Started = true;
+            std::lock_guard<std::mutex> lock(_finishedMutex);
+            _finished.push_back(load);
+        }
+    }
+
+    found->second->Users.push_back({ object, use });
+    return handle;
+}
+
+void AssetLoader::Start()
+{
+    for (Load* load : _unstarted)
+    {
+        load->Started = true;
+        _jobSystem->Run([this, load]() { LoadAsset(load); }, &_pending);
+    }
+    _unstarted.clear();
+}
+
+void AssetLoader::LoadAsset(Load* load)
+{
+    AssetFile file;
+    if (!file.Open(_archive, load->Path))
+    {
+        _cache->SetFailed(load->Handle);
+    }
+    else if (!_cache->ShareByContent(load->Handle, file.GetContentHash()))
+    {
+        //Device creation calls are free threaded so the GPU copy is made here as well, only the swap into the scene waits for the main thread
+        if (load->Type == ASSET_MESH)
+        {
+            //Packed meshes are already in the binary layout, loose ones go through the OBJ and its binary
+            MeshData mesh;
+            if (file.GetFormat() == ASSET_FORMAT_MESH)
+            {
+                mesh = OBJLoader::LoadBinary(file.GetData(), file.GetSize(), _device);
+            }
+            else
+            {
+                file.Close();
+                mesh = OBJLoader::Load((char*)load->Path.c_str(), _device);
+            }
+
+            if (mesh.VertexBuffer && mesh.IndexBuffer)
+            {
+                _cache->SetLoaded(load->Handle, mesh, nullptr);
+            }
+            else
+            {
+                _cache->SetFailed(load->Handle);
+            }
+        }
+        else
+        {
+            ID3D11ShaderResourceView* texture = nullptr;
+            if (SUCCEEDED(DirectX::CreateDDSTextureFromMemory(_device, file.GetData(), file.GetSize(), nullptr, &texture, _textureMaxSize)))
+            {
+                _cache->SetLoaded(load->Handle, MeshData(), texture);
+            }
+            else
+            {
+                _cache->SetFailed(load->Handle);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_finishedMutex);
+    _finished.push_back(load);
+}
+
+void AssetLoader::CollectFinished(std::vector<LoadedAsset>& finished)
+{
+    finished.clear();
+
+    std::vector<Load*> ready;
+    {
+        std::lock_guard<std::mutex> lock(_finishedMutex);
+        ready.swap(_finished);
+    }
+
+    for (Load* load : ready)
+    {
+        LoadedAsset loaded;
+        loaded.Handle = load->Handle;
+        loaded.Succeeded = _cache->GetState(load->Handle) == ASSET_LOADED;
+        loaded.Mesh = _cache->GetMesh(load->Handle);
+        loaded.Texture = _cache->GetTexture(load->Handle);
+        loaded.Users.swap(load->Users);
+        finished.push_back(std::move(loaded));
+
+        //Users hold their own references from Request, this was only keeping it alive until now. The job is done
+        //with the load once it is on the finished list, so it can go, and a later Request starts a fresh one
+        AssetHandle handle = load->Handle;
+        _loads.erase(handle.Index);
+        _cache->Release(handle);
+    }
+}
+
+void AssetLoader::Wait()
+{
+    if (_jobSystem)
+    {
+        _jobSystem->Wait(&_pending);
+    }
+}
+
+bool AssetLoader::IsIdle()
+{
+    //Jobs add to the finished list before their counter drops, so checking in this order can't miss one
+    if (!_pending.IsDone()) return false;
+
+    std::lock_guard<std::mutex> lock(_finishedMutex);
+    return _finished.empty();
+}
+
+void AssetLoader::Release()
+{
+    Wait();
+
+    //Every load not yet collected still holds the loader's reference, whether it finished or was never started
+    for (auto& load : _loads)
+    {
+        _cache->Release(load.second->Handle);
+    }
+
+    _loads.clear();
+    _unstarted.clear();
+    _finished.clear();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <d3d11_4.h>
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Structures.h"
+#include "AssetArchive.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+
+//What an object wants a loaded asset for, the same file can be wanted for more than one thing
+enum AssetUse
+{
+	ASSET_USE_MESH,
+	ASSET_USE_TEXTURE,
+	ASSET_USE_NORMAL_MAP
+};
+
+struct AssetUser
+{
+	PoolHandle Object;
+	AssetUse Use;
+};
+
+//An asset that has finished loading, handed back to the main thread with everything that was waiting on it
+struct LoadedAsset
+{
+	AssetHandle Handle;
+	bool Succeeded;
+	MeshData Mesh;
+	ID3D11ShaderResourceView* Texture;
+	std::vector<AssetUser> Users; //Everyone who asked for it since its load started, each handed out once
+};
+
+//Loads OBJ meshes and DDS textures into an AssetCache on the job system. Anything the cache already has, by path
+//or by content, isn't loaded again, and finished assets queue up for the main thread to swap in over placeholders
+class AssetLoader
+{
+private:
+	struct Load
+	{
+		AssetHandle Handle;
+		AssetType Type;
+		std::string Path;
+		bool Started = false;
+		std::vector<AssetUser> Users; //Only touched on the main thread
+	};
+
+	ID3D11Device* _device = nullptr;
+	JobSystem* _jobSystem = nullptr;
+	AssetCache* _cache = nullptr;
+	const AssetArchive* _archive = nullptr;
+	size_t _textureMaxSize = 0;
+
+	//Loads still in flight or waiting to be collected, by cache index. Each holds a reference on its entry so the
+	//index can't be reused while it is here, and it goes once collected, so this only grows with outstanding work
+	std::unordered_map<uint32_t, std::unique_ptr<Load>> _loads;
+	std::vector<Load*> _unstarted;
+
+	std::mutex _finishedMutex;
+	std::vector<Load*> _finished;
+	JobCounter _pending;
+
+	void LoadAsset(Load* load);
+
+public:
+	AssetLoader() = default;
+	~AssetLoader() { Release(); }
+
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	void Initialise(ID3D11Device* device, JobSystem* jobSystem, AssetCache* cache);
+
+	//Textures loaded from here on leave out mips larger than maxSize, 0 loads them whole. Streaming sets it to its
+	//tail size so only the tail goes up at first
+	void SetTextureMaxSize(size_t maxSize) { _textureMaxSize = maxSize; }
+
+	//Paths the archive has are read from it from here on, anything else from loose files. It has to stay open until Release
+	void SetArchive(const AssetArchive* archive) { _archive = archive; }
+
+	//Returns a reference on the asset that the caller gives back to the cache once it stops using it.
+	//Nothing loads until Start, so every object gets a chance to ask for the same path first. Asking for
+	//something already loaded doesn't load it again, it comes back from the next CollectFinished
+	AssetHandle Request(const std::string& path, AssetUse use, PoolHandle object);
+
+	//Starts everything requested since the last Start, cheap enough to call after every request
+	void Start();
+
+	//Loads are forgotten once collected, so each user comes back exactly once
+	void CollectFinished(std::vector<LoadedAsset>& finished);
+	void Wait();
+
+	//True once every load has finished and been collected
+	bool IsIdle();
+
+	void Release();
+};
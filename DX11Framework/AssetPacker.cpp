@@ -0,0 +1,120 @@
+#include "AssetPacker.h"
+#include <windows.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+#include "FileUtilities.h"
+#include "SceneFile.h"
+
+#include "JSON\json.hpp"
+using json = nlohmann::json;
+
+bool AssetPacker::LoadSettings(const char* filename, AssetPackSettings& settings)
+{
+    std::ifstream fileOpen(filename);
+    if (!fileOpen.good()) return false;
+
+    json jFile = json::parse(fileOpen, nullptr, false);
+    if (jFile.is_discarded()) return false;
+
+    settings.OutputPath = jFile.value("Output", settings.OutputPath);
+    settings.Alignment = jFile.value("Alignment", settings.Alignment);
+    settings.MinSavings = jFile.value("MinSavings", settings.MinSavings);
+
+    if (jFile.contains("Scenes")) settings.Scenes = jFile["Scenes"].get<std::vector<std::string>>();
+    if (jFile.contains("Directories")) settings.Directories = jFile["Directories"].get<std::vector<std::string>>();
+    if (jFile.contains("Extensions")) settings.Extensions = jFile["Extensions"].get<std::vector<std::string>>();
+    if (jFile.contains("Compress")) settings.Compress = jFile["Compress"].get<std::vector<std::string>>();
+
+    return !settings.OutputPath.empty() && settings.Alignment > 0 && (settings.Alignment & (settings.Alignment - 1)) == 0;
+}
+
+bool AssetPacker::FindInputs(AssetPackSettings& settings)
+{
+    settings.Inputs.clear();
+
+    //Whatever spelling a path first turns up with is the one kept, the archive keys them normalised anyway
+    std::unordered_set<std::string> added;
+    auto add = [&](const std::string& path)
+    {
+        if (!path.empty() && added.insert(AssetArchive::NormalizePath(path)).second) settings.Inputs.push_back(path);
+    };
+
+    //Scene first and then its assets as its objects name them, which is the order a load asks for them in
+    bool succeeded = true;
+    for (const std::string& scenePath : settings.Scenes)
+    {
+        SceneFile scene;
+        if (!scene.LoadJson(scenePath))
+        {
+            succeeded = false;
+            continue;
+        }
+
+        add(SceneCompiler::GetBinaryPath(scenePath));
+        for (const SceneObjectDesc& desc : scene.GetObjects())
+        {
+            add(desc.MeshPath);
+            if (desc.TexturePath) add(desc.TexturePath);
+            if (desc.NormalPath) add(desc.NormalPath);
+        }
+    }
+
+    std::vector<std::string> files;
+    for (const std::string& directory : settings.Directories)
+    {
+        FindFiles(directory, settings.Extensions, files);
+    }
+    std::sort(files.begin(), files.end());
+    for (const std::string& file : files) add(file);
+
+    return succeeded;
+}
+
+bool AssetPacker::Run(const AssetPackSettings& settings, JobSystem* jobSystem, AssetArchiveStats* stats)
+{
+    bool succeeded = true;
+    for (const std::string& scenePath : settings.Scenes)
+    {
+        std::string binaryPath = SceneCompiler::GetBinaryPath(scenePath);
+        if (!SceneCompiler::IsUpToDate(scenePath, binaryPath) && !SceneCompiler::Compile(scenePath, binaryPath)) succeeded = false;
+    }
+
+    std::vector<AssetArchiveInput> inputs;
+    inputs.reserve(settings.Inputs.size());
+    for (const std::string& path : settings.Inputs)
+    {
+        AssetArchiveInput input;
+        input.Path = path;
+        input.Compress = EndsWithAny(path, settings.Compress);
+
+        //OBJs go in as the binary OBJLoader::Load writes next to them, stored under the OBJ's path. One older than its
+        //OBJ is left out, so the OBJ is parsed again and the next pack picks up the new binary
+        std::string sourcePath = path;
+        bool read = true;
+        if (EndsWith(path, ".obj"))
+        {
+            input.Format = ASSET_FORMAT_MESH;
+            sourcePath = path + "Binary";
+            read = SceneCompiler::IsUpToDate(path, sourcePath);
+        }
+
+        std::ifstream file(sourcePath, std::ios::binary);
+        read = read && file.good();
+        if (read) input.Data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        //Left out rather than packed empty, so the loose file is still tried when it turns up
+        if (!read)
+        {
+            succeeded = false;
+            continue;
+        }
+        inputs.push_back(std::move(input));
+    }
+
+    size_t folder = settings.OutputPath.find_last_of("\\/");
+    if (folder != std::string::npos) CreateDirectories(settings.OutputPath.substr(0, folder));
+
+    return AssetArchiveWriter::Write(settings.OutputPath, inputs, settings.Alignment, settings.MinSavings, jobSystem, stats) && succeeded;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "AssetArchive.h"
+
+class JobSystem;
+
+//What to pack, read from JSON/archiveSettings.json
+struct AssetPackSettings
+{
+	std::string OutputPath = "Assets.pak";
+	std::vector<std::string> Scenes;                             //Compiled and packed with every asset they name, in the order they name them
+	std::vector<std::string> Directories;                        //Anything else under these with one of Extensions goes in after
+	std::vector<std::string> Extensions = { ".obj", ".dds" };
+	std::vector<std::string> Compress = { ".obj", ".scene" };    //DDS stays stored so textures load and stream straight out of the mapping
+	uint32_t Alignment = 4096;                                   //Sector sized, so every entry can be read uncached on its own
+	float MinSavings = 0.1f;                                     //Fraction compression has to save for an entry to be kept compressed
+	std::vector<std::string> Inputs;                             //Filled by FindInputs
+};
+
+//Packs the scene and the loose files it loads into one AssetArchive. OBJs go in as their .objBinary so loading one is
+//just making its buffers. Run with -pack-assets and point "AssetArchive" in JSON/settings.json at the output
+namespace AssetPacker
+{
+	bool LoadSettings(const char* filename, AssetPackSettings& settings);
+
+	//Each scene's compiled path then its assets, then the directories' files sorted, each path once. False if a scene couldn't be read
+	bool FindInputs(AssetPackSettings& settings);
+
+	//Compiles the scenes, reads every input and writes the archive. False if anything couldn't be read or
+	//written, the archive still has everything else in it then
+	bool Run(const AssetPackSettings& settings, JobSystem* jobSystem, AssetArchiveStats* stats = nullptr);
+};
@@ -0,0 +1,529 @@
+#include "BCDecoder.h"
+#include "BCFormat.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <string.h>
+#include <emmintrin.h>
+
+//Writes the block's four rows of pixels pitch bytes apart
+typedef void(*BlockDecoder)(const uint8_t* block, uint8_t* pixels, size_t pitch);
+
+//Reads fields of up to 8 bits from a 128 bit block, least significant bit first
+struct BlockBits
+{
+    uint64_t Low;
+    uint64_t High;
+    uint32_t Position = 0;
+
+    BlockBits(const uint8_t* block)
+    {
+        memcpy(&Low, block, 8);
+        memcpy(&High, block + 8, 8);
+    }
+
+    uint32_t Read(uint32_t count)
+    {
+        uint32_t value;
+        if (Position >= 64) value = (uint32_t)(High >> (Position - 64));
+        else if (Position + count <= 64) value = (uint32_t)(Low >> Position);
+        else value = (uint32_t)((Low >> Position) | (High << (64 - Position)));
+
+        Position += count;
+        return value & ((1u << count) - 1);
+    }
+};
+
+//Blocks are worked on a row of four RGBA8 pixels per SSE2 register. Palettes are interpolated a lane per channel and
+//indices are spread into lanes with multiplies, as SSE2 has no per lane shifts and no byte shuffle to look them up
+
+//Each 32 bit lane of indices (0 to 3) replaced by that entry of the palette
+static inline __m128i SelectColours(__m128i indices, const __m128i palette[4])
+{
+    __m128i row = _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_setzero_si128()), palette[0]);
+    row = _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_set1_epi32(1)), palette[1]));
+    row = _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_set1_epi32(2)), palette[2]));
+    return _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_set1_epi32(3)), palette[3]));
+}
+
+//The same palette as BuildColourPalette, both in between colours worked out at once in 16 bit lanes.
+//x / 3 is (x * 43691) >> 17 for everything the sums can reach
+static void BuildColourPaletteVector(uint16_t colour0, uint16_t colour1, bool allowTransparent, __m128i palette[4])
+{
+    uint8_t endpoints[8];
+    Expand565(colour0, endpoints);
+    Expand565(colour1, endpoints + 4);
+
+    __m128i wide = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)endpoints), _mm_setzero_si128());
+    __m128i first = _mm_unpacklo_epi64(wide, wide);
+    __m128i second = _mm_unpackhi_epi64(wide, wide);
+
+    //2a + b + 1 in the low half and a + 2b + 1 in the high half for thirds, or halfway then transparent black. Both
+    //are worked out so random blocks don't cost a mispredicted branch each
+    __m128i sum = _mm_add_epi16(_mm_add_epi16(first, second), _mm_add_epi16(wide, _mm_set1_epi16(1)));
+    __m128i thirds = _mm_srli_epi16(_mm_mulhi_epu16(sum, _mm_set1_epi16((short)43691)), 1);
+    __m128i halfway = _mm_move_epi64(_mm_avg_epu16(first, second));
+    __m128i useThirds = _mm_set1_epi32(colour0 > colour1 || !allowTransparent ? -1 : 0);
+    __m128i between = _mm_or_si128(_mm_and_si128(useThirds, thirds), _mm_andnot_si128(useThirds, halfway));
+
+    __m128i colours = _mm_packus_epi16(wide, between);
+    palette[0] = _mm_shuffle_epi32(colours, _MM_SHUFFLE(0, 0, 0, 0));
+    palette[1] = _mm_shuffle_epi32(colours, _MM_SHUFFLE(1, 1, 1, 1));
+    palette[2] = _mm_shuffle_epi32(colours, _MM_SHUFFLE(2, 2, 2, 2));
+    palette[3] = _mm_shuffle_epi32(colours, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+static void DecodeColourBlock(const uint8_t* block, __m128i rows[4], bool allowTransparent)
+{
+    __m128i palette[4];
+    BuildColourPaletteVector((uint16_t)(block[0] | (block[1] << 8)), (uint16_t)(block[2] | (block[3] << 8)), allowTransparent, palette);
+
+    //A row's indices are one byte, multiplied up so each lane's index sits at bit 6. The products fit in the low
+    //16 bits of each lane
+    const __m128i shifts = _mm_setr_epi32(64, 16, 4, 1);
+    for (int y = 0; y < 4; y++)
+    {
+        __m128i indices = _mm_srli_epi32(_mm_mullo_epi16(_mm_set1_epi32(block[4 + y]), shifts), 6);
+        rows[y] = SelectColours(_mm_and_si128(indices, _mm_set1_epi32(3)), palette);
+    }
+}
+
+//Sixteen 3 bit indices to a 16 bit lane each. Every four indices are 12 bits, shifted by multiplying so the wanted
+//index lands in bits 9 to 11, with the bits above it falling off the top of the lane
+static inline void UnpackSingleChannelIndices(const uint8_t* block, __m128i& low, __m128i& high)
+{
+    //The whole block then the endpoints shifted off, a 6 byte copy stalls on reading it back
+    uint64_t indices = 0;
+    memcpy(&indices, block, 8);
+    indices >>= 16;
+
+    const __m128i shifts = _mm_setr_epi16(512, 64, 8, 1, 512, 64, 8, 1);
+    low = _mm_unpacklo_epi64(_mm_set1_epi16((short)(indices & 0xfff)), _mm_set1_epi16((short)((indices >> 12) & 0xfff)));
+    high = _mm_unpacklo_epi64(_mm_set1_epi16((short)((indices >> 24) & 0xfff)), _mm_set1_epi16((short)((indices >> 36) & 0xfff)));
+    low = _mm_and_si128(_mm_srli_epi16(_mm_mullo_epi16(low, shifts), 9), _mm_set1_epi16(7));
+    high = _mm_and_si128(_mm_srli_epi16(_mm_mullo_epi16(high, shifts), 9), _mm_set1_epi16(7));
+}
+
+//Each pixel's value straight from its index rather than through a palette: index 0 is the first endpoint, 1 the
+//second and the rest step from one to the other. Rounds the same as BuildSingleChannelPalette for unsigned values.
+//Both modes go through the same instructions so random blocks don't cost a mispredicted branch each
+static inline __m128i InterpolateSingleChannel(__m128i indices, __m128i value0, __m128i value1, __m128i steps,
+    __m128i divisor, __m128i sixValues)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i isSecond = _mm_cmpeq_epi16(indices, one);
+    __m128i weight = _mm_max_epi16(_mm_sub_epi16(indices, one), _mm_setzero_si128());
+    weight = _mm_or_si128(_mm_andnot_si128(isSecond, weight), _mm_and_si128(isSecond, steps));
+
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(steps, weight), value0), _mm_mullo_epi16(weight, value1));
+    sum = _mm_add_epi16(sum, _mm_srli_epi16(steps, 1));
+    __m128i values = _mm_srli_epi16(_mm_mulhi_epu16(sum, divisor), 2);
+
+    //Six values then the two extremes
+    __m128i isZero = _mm_and_si128(sixValues, _mm_cmpeq_epi16(indices, _mm_set1_epi16(6)));
+    __m128i isMax = _mm_and_si128(sixValues, _mm_cmpeq_epi16(indices, _mm_set1_epi16(7)));
+    values = _mm_andnot_si128(_mm_or_si128(isZero, isMax), values);
+    return _mm_or_si128(values, _mm_and_si128(isMax, _mm_set1_epi16(255)));
+}
+
+//SNORM rounds away from zero on both sides, so it keeps to the shared palette
+static __m128i DecodeSignedSingleChannelBlock(const uint8_t* block)
+{
+    int value0 = std::max((int)(int8_t)block[0], -127);
+    int value1 = std::max((int)(int8_t)block[1], -127);
+
+    int palette[8];
+    BuildSingleChannelPalette(value0, value1, true, palette);
+
+    //[-127, 127] to [0, 255] so signed data can be looked at
+    uint8_t output[8];
+    for (int i = 0; i < 8; i++)
+    {
+        output[i] = (uint8_t)(((palette[i] + 127) * 255 + 127) / 254);
+    }
+
+    uint8_t values[16];
+    uint64_t indices = 0;
+    memcpy(&indices, block, 8);
+    indices >>= 16;
+    for (int i = 0; i < 16; i++, indices >>= 3)
+    {
+        values[i] = output[indices & 7];
+    }
+    return _mm_loadu_si128((const __m128i*)values);
+}
+
+//BC3 alpha, BC4 and each half of BC5 share this, one byte per pixel
+static inline __m128i DecodeSingleChannelBlock(const uint8_t* block, bool isSigned)
+{
+    if (isSigned) return DecodeSignedSingleChannelBlock(block);
+
+    __m128i low;
+    __m128i high;
+    UnpackSingleChannelIndices(block, low, high);
+
+    //x / 7 is (x * 37450) >> 18 and x / 5 is (x * 52429) >> 18 for every sum a block can make
+    __m128i value0 = _mm_set1_epi16(block[0]);
+    __m128i value1 = _mm_set1_epi16(block[1]);
+    __m128i sixValues = _mm_cmpgt_epi16(_mm_add_epi16(value1, _mm_set1_epi16(1)), value0);
+    __m128i steps = _mm_sub_epi16(_mm_set1_epi16(7), _mm_and_si128(sixValues, _mm_set1_epi16(2)));
+    __m128i divisor = _mm_add_epi16(_mm_set1_epi16((short)37450), _mm_and_si128(sixValues, _mm_set1_epi16(52429 - 37450)));
+    return _mm_packus_epi16(InterpolateSingleChannel(low, value0, value1, steps, divisor, sixValues),
+        InterpolateSingleChannel(high, value0, value1, steps, divisor, sixValues));
+}
+
+//One byte per pixel moved into a channel of each pixel, the other channels zero
+static inline void SpreadChannel(__m128i values, int channel, __m128i rows[4])
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i shift = _mm_cvtsi32_si128(channel * 8);
+    __m128i low = _mm_unpacklo_epi8(values, zero);
+    __m128i high = _mm_unpackhi_epi8(values, zero);
+    rows[0] = _mm_sll_epi32(_mm_unpacklo_epi16(low, zero), shift);
+    rows[1] = _mm_sll_epi32(_mm_unpackhi_epi16(low, zero), shift);
+    rows[2] = _mm_sll_epi32(_mm_unpacklo_epi16(high, zero), shift);
+    rows[3] = _mm_sll_epi32(_mm_unpackhi_epi16(high, zero), shift);
+}
+
+static inline void StoreRows(const __m128i rows[4], uint8_t* pixels, size_t pitch)
+{
+    for (int y = 0; y < 4; y++) _mm_storeu_si128((__m128i*)(pixels + y * pitch), rows[y]);
+}
+
+//Colour rows with their alpha replaced by one byte per pixel
+static inline void StoreWithAlpha(__m128i rows[4], __m128i alpha, uint8_t* pixels, size_t pitch)
+{
+    __m128i alphaRows[4];
+    SpreadChannel(alpha, 3, alphaRows);
+
+    const __m128i colourMask = _mm_set1_epi32(0x00ffffff);
+    for (int y = 0; y < 4; y++) rows[y] = _mm_or_si128(_mm_and_si128(rows[y], colourMask), alphaRows[y]);
+    StoreRows(rows, pixels, pitch);
+}
+
+static void DecodeBC1(const uint8_t* block, uint8_t* pixels, size_t pitch)
+{
+    __m128i rows[4];
+    DecodeColourBlock(block, rows, true);
+    StoreRows(rows, pixels, pitch);
+}
+
+static void DecodeBC2(const uint8_t* block, uint8_t* pixels, size_t pitch)
+{
+    __m128i rows[4];
+    DecodeColourBlock(block + 8, rows, false);
+
+    //Sixteen 4 bit alphas to bytes, then times 17 to widen them
+    __m128i packed = _mm_loadl_epi64((const __m128i*)block);
+    __m128i mask = _mm_set1_epi8(15);
+    __m128i alpha = _mm_unpacklo_epi8(_mm_and_si128(packed, mask), _mm_and_si128(_mm_srli_epi16(packed, 4), mask));
+    alpha = _mm_or_si128(alpha, _mm_slli_epi16(alpha, 4));
+    StoreWithAlpha(rows, alpha, pixels, pitch);
+}
+
+static void DecodeBC3(const uint8_t* block, uint8_t* pixels, size_t pitch)
+{
+    __m128i rows[4];
+    DecodeColourBlock(block + 8, rows, false);
+    StoreWithAlpha(rows, DecodeSingleChannelBlock(block, false), pixels, pitch);
+}
+
+//BC4 and BC5 only fill red and green, the rest is what a sampler returns for the missing channels
+static inline void DecodeRedGreen(const uint8_t* red, const uint8_t* green, bool isSigned, uint8_t* pixels, size_t pitch)
+{
+    __m128i rows[4];
+    SpreadChannel(DecodeSingleChannelBlock(red, isSigned), 0, rows);
+
+    __m128i greenRows[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+    if (green) SpreadChannel(DecodeSingleChannelBlock(green, isSigned), 1, greenRows);
+
+    const __m128i opaque = _mm_set1_epi32((int)0xff000000);
+    for (int y = 0; y < 4; y++) rows[y] = _mm_or_si128(_mm_or_si128(rows[y], greenRows[y]), opaque);
+    StoreRows(rows, pixels, pitch);
+}
+
+static void DecodeBC4(const uint8_t* block, uint8_t* pixels, size_t pitch)
+{
+    DecodeRedGreen(block, nullptr, false, pixels, pitch);
+}
+
+static void DecodeBC4Signed(const uint8_t* block, uint8_t* pixels, size_t pitch)
+{
+    DecodeRedGreen(block, nullptr, true, pixels, pitch);
+}
+
+static void DecodeBC5(const uint8_t* block, uint8_t* pixels, size_t pitch)
+{
+    DecodeRedGreen(block, block + 8, false, pixels, pitch);
+}
+
+static void DecodeBC5Signed(const uint8_t* block, uint8_t* pixels, size_t pitch)
+{
+    DecodeRedGreen(block, block + 8, true, pixels, pitch);
+}
+
+//Swaps alpha with the colour channel the BC7 rotation names, in each pixel of 16 bit lanes
+static inline __m128i RotateChannels(__m128i pixels, uint32_t rotation)
+{
+    switch (rotation)
+    {
+    case 1: return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(0, 2, 1, 3)), _MM_SHUFFLE(0, 2, 1, 3));
+    case 2: return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(1, 2, 3, 0)), _MM_SHUFFLE(1, 2, 3, 0));
+    case 3: return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(2, 3, 1, 0)), _MM_SHUFFLE(2, 3, 1, 0));
+    default: return pixels;
+    }
+}
+
+static void DecodeBC7(const uint8_t* block, uint8_t* pixels, size_t pitch)
+{
+    //The mode is the position of the lowest set bit, a zero first byte is reserved and decodes to transparent black
+    uint32_t mode = 0;
+    while (mode < 8 && !(block[0] & (1 << mode))) mode++;
+    if (mode == 8)
+    {
+        for (int y = 0; y < 4; y++) memset(pixels + y * pitch, 0, 16);
+        return;
+    }
+
+    const BC7Mode& info = BC7_MODES[mode];
+    BlockBits bits(block);
+    bits.Read(mode + 1);
+
+    uint32_t partition = bits.Read(info.PartitionBits);
+    uint32_t rotation = bits.Read(info.RotationBits);
+    uint32_t indexSelection = bits.Read(info.IndexSelectionBits);
+
+    //All the reds for every endpoint, then all the greens and so on
+    uint32_t endpoints[6][4];
+    uint32_t endpointCount = info.Subsets * 2u;
+    for (uint32_t channel = 0; channel < 3; channel++)
+    {
+        for (uint32_t i = 0; i < endpointCount; i++) endpoints[i][channel] = bits.Read(info.ColourBits);
+    }
+    for (uint32_t i = 0; i < endpointCount; i++) endpoints[i][3] = bits.Read(info.AlphaBits);
+
+    uint32_t colourBits = info.ColourBits;
+    uint32_t alphaBits = info.AlphaBits;
+    if (info.EndpointPBits || info.SharedPBits)
+    {
+        uint32_t pBits[6];
+        if (info.EndpointPBits)
+        {
+            for (uint32_t i = 0; i < endpointCount; i++) pBits[i] = bits.Read(1);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < endpointCount; i += 2) pBits[i] = pBits[i + 1] = bits.Read(1);
+        }
+
+        for (uint32_t i = 0; i < endpointCount; i++)
+        {
+            for (uint32_t channel = 0; channel < 4; channel++) endpoints[i][channel] = (endpoints[i][channel] << 1) | pBits[i];
+        }
+        colourBits++;
+        if (alphaBits) alphaBits++;
+    }
+
+    //Widened endpoints as 16 bit RGBA, ready to load a pixel's pair into half a register
+    uint16_t widened[6][4];
+    for (uint32_t i = 0; i < endpointCount; i++)
+    {
+        for (uint32_t channel = 0; channel < 3; channel++) widened[i][channel] = (uint16_t)ExpandBits(endpoints[i][channel], colourBits);
+        widened[i][3] = (uint16_t)(alphaBits ? ExpandBits(endpoints[i][3], alphaBits) : 255);
+    }
+
+    uint8_t subsets[16];
+    uint32_t anchors[3];
+    for (uint32_t i = 0; i < 16; i++) subsets[i] = (uint8_t)GetBC7Subset(info.Subsets, partition, i);
+    for (uint32_t subset = 0; subset < info.Subsets; subset++) anchors[subset] = GetBC7Anchor(info.Subsets, partition, subset);
+
+    //Anchor pixels drop the top bit of their index, which is always 0. Index widths change from pixel to pixel so
+    //reading them stays scalar
+    uint32_t indices[16];
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        indices[i] = bits.Read(info.IndexBits - (i == anchors[subsets[i]] ? 1 : 0));
+    }
+
+    uint32_t secondaryIndices[16];
+    if (info.SecondaryIndexBits)
+    {
+        for (uint32_t i = 0; i < 16; i++) secondaryIndices[i] = bits.Read(info.SecondaryIndexBits - (i == 0 ? 1 : 0));
+    }
+
+    //Modes 4 and 5 interpolate colour and alpha separately, mode 4 can swap which index set drives which
+    const uint32_t* colourIndices = indices;
+    const uint32_t* alphaIndices = info.SecondaryIndexBits ? secondaryIndices : indices;
+    const uint8_t* colourWeights = GetWeights(info.IndexBits);
+    const uint8_t* alphaWeights = GetWeights(info.SecondaryIndexBits ? info.SecondaryIndexBits : info.IndexBits);
+    if (indexSelection)
+    {
+        std::swap(colourIndices, alphaIndices);
+        std::swap(colourWeights, alphaWeights);
+    }
+
+    //Colour and alpha weight interleaved for each pixel
+    uint16_t weights[32];
+    for (int i = 0; i < 16; i++)
+    {
+        weights[i * 2] = colourWeights[colourIndices[i]];
+        weights[i * 2 + 1] = alphaWeights[alphaIndices[i]];
+    }
+
+    //Two pixels a register, RGBA each in 16 bit lanes, the same sum as Interpolate
+    const __m128i sixtyFour = _mm_set1_epi16(64);
+    const __m128i half = _mm_set1_epi16(32);
+    for (int i = 0; i < 16; i += 4)
+    {
+        __m128i interpolated[2];
+        for (int pair = 0; pair < 2; pair++)
+        {
+            int first = i + pair * 2;
+            __m128i endpoint0 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)widened[subsets[first] * 2]), _mm_loadl_epi64((const __m128i*)widened[subsets[first + 1] * 2]));
+            __m128i endpoint1 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)widened[subsets[first] * 2 + 1]), _mm_loadl_epi64((const __m128i*)widened[subsets[first + 1] * 2 + 1]));
+
+            //(colour, alpha) for both pixels, spread to (colour, colour, colour, alpha) for each
+            __m128i weight = _mm_loadl_epi64((const __m128i*)(weights + first * 2));
+            weight = _mm_unpacklo_epi32(weight, weight);
+            weight = _mm_shufflehi_epi16(_mm_shufflelo_epi16(weight, _MM_SHUFFLE(1, 0, 0, 0)), _MM_SHUFFLE(1, 0, 0, 0));
+
+            __m128i sum = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(sixtyFour, weight), endpoint0), _mm_mullo_epi16(weight, endpoint1));
+            interpolated[pair] = RotateChannels(_mm_srli_epi16(_mm_add_epi16(sum, half), 6), rotation);
+        }
+        _mm_storeu_si128((__m128i*)(pixels + (i / 4) * pitch), _mm_packus_epi16(interpolated[0], interpolated[1]));
+    }
+}
+
+static BlockDecoder GetBlockDecoder(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_BC1_TYPELESS:
+    case DDS_FORMAT_BC1_UNORM:
+    case DDS_FORMAT_BC1_UNORM_SRGB:
+        return DecodeBC1;
+
+    case DDS_FORMAT_BC2_TYPELESS:
+    case DDS_FORMAT_BC2_UNORM:
+    case DDS_FORMAT_BC2_UNORM_SRGB:
+        return DecodeBC2;
+
+    case DDS_FORMAT_BC3_TYPELESS:
+    case DDS_FORMAT_BC3_UNORM:
+    case DDS_FORMAT_BC3_UNORM_SRGB:
+        return DecodeBC3;
+
+    case DDS_FORMAT_BC4_TYPELESS:
+    case DDS_FORMAT_BC4_UNORM:
+        return DecodeBC4;
+
+    case DDS_FORMAT_BC4_SNORM:
+        return DecodeBC4Signed;
+
+    case DDS_FORMAT_BC5_TYPELESS:
+    case DDS_FORMAT_BC5_UNORM:
+        return DecodeBC5;
+
+    case DDS_FORMAT_BC5_SNORM:
+        return DecodeBC5Signed;
+
+    case DDS_FORMAT_BC7_TYPELESS:
+    case DDS_FORMAT_BC7_UNORM:
+    case DDS_FORMAT_BC7_UNORM_SRGB:
+        return DecodeBC7;
+
+    default:
+        return nullptr;
+    }
+}
+
+bool BCDecoder::IsSupported(DDSFormat format)
+{
+    return GetBlockDecoder(format) != nullptr;
+}
+
+size_t BCDecoder::GetBlockSize(DDSFormat format)
+{
+    return DDSParser::BitsPerPixel(format) * 2;
+}
+
+void BCDecoder::DecodeBlock(DDSFormat format, const uint8_t* block, uint8_t* pixels)
+{
+    BlockDecoder decoder = GetBlockDecoder(format);
+    if (decoder) decoder(block, pixels, 16);
+    else memset(pixels, 0, 64);
+}
+
+bool BCDecoder::Decode(DDSFormat format, const uint8_t* data, size_t size, size_t rowPitch, uint32_t width, uint32_t height,
+    uint8_t* output, size_t outputPitch, JobSystem* jobSystem)
+{
+    BlockDecoder decoder = GetBlockDecoder(format);
+    if (!decoder || !data || !output || width == 0 || height == 0) return false;
+
+    uint32_t blocksWide = (width + 3) / 4;
+    uint32_t blocksHigh = (height + 3) / 4;
+    size_t blockSize = GetBlockSize(format);
+    if (rowPitch < blocksWide * blockSize || outputPitch < (size_t)width * 4) return false;
+    if ((blocksHigh - 1) * rowPitch + blocksWide * blockSize > size) return false;
+
+    auto decodeRows = [=](uint32_t start, uint32_t end)
+    {
+        uint8_t pixels[64];
+        for (uint32_t blockY = start; blockY < end; blockY++)
+        {
+            const uint8_t* block = data + blockY * rowPitch;
+            uint8_t* row = output + (size_t)blockY * 4 * outputPitch;
+            uint32_t rows = std::min(4u, height - blockY * 4);
+
+            for (uint32_t blockX = 0; blockX < blocksWide; blockX++, block += blockSize)
+            {
+                //Whole blocks go straight to the output, only those cut by the edge of the image go through a copy
+                uint32_t columns = std::min(4u, width - blockX * 4);
+                if (columns == 4 && rows == 4)
+                {
+                    decoder(block, row + blockX * 16, outputPitch);
+                    continue;
+                }
+
+                decoder(block, pixels, 16);
+                for (uint32_t y = 0; y < rows; y++)
+                {
+                    memcpy(row + y * outputPitch + blockX * 16, pixels + y * 16, columns * 4);
+                }
+            }
+        }
+    };
+
+    //Batches of about 4096 blocks, whole rows each so no two jobs write the same pixels
+    if (jobSystem && jobSystem->IsRunning() && blocksHigh > 1)
+    {
+        jobSystem->ParallelFor(blocksHigh, std::max(4096u / blocksWide, 1u), decodeRows);
+    }
+    else
+    {
+        decodeRows(0, blocksHigh);
+    }
+
+    return true;
+}
+
+bool BCDecoder::DecodeSubresource(const uint8_t* fileData, const DDSTextureDesc& desc, const DDSSubresource& subresource,
+    std::vector<uint8_t>& output, JobSystem* jobSystem)
+{
+    if (!IsSupported(desc.Format) || subresource.SlicePitch == 0) return false;
+
+    size_t slices = subresource.Size / subresource.SlicePitch;
+    size_t sliceBytes = (size_t)subresource.Width * subresource.Height * 4;
+    output.resize(sliceBytes * slices);
+
+    for (size_t slice = 0; slice < slices; slice++)
+    {
+        const uint8_t* data = fileData + subresource.Offset + slice * subresource.SlicePitch;
+        if (!Decode(desc.Format, data, subresource.SlicePitch, subresource.RowPitch, subresource.Width, subresource.Height,
+            output.data() + slice * sliceBytes, (size_t)subresource.Width * 4, jobSystem))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "DDSParser.h"
+
+class JobSystem;
+
+//Decodes block compressed data to RGBA8 on the CPU, so compressed textures can be looked at without a device for
+//thumbnails, image diffs and a headless renderer. Channels come out the way a sampler would return them, so BC4 is
+//(R, 0, 0, 255) and BC5 is (R, G, 0, 255). SNORM values are mapped from [-1, 1] to [0, 255]
+namespace BCDecoder
+{
+	//BC1 to BC5 and BC7 in every variant, BC6H is HDR and has no RGBA8 form
+	bool IsSupported(DDSFormat format);
+
+	//8 bytes for BC1 and BC4, 16 for the rest
+	size_t GetBlockSize(DDSFormat format);
+
+	//One 4x4 block to 16 pixels, a row of 4 at a time
+	void DecodeBlock(DDSFormat format, const uint8_t* block, uint8_t* pixels);
+
+	//width x height pixels of blocks rowPitch apart, written as RGBA8 rows outputPitch apart. Blocks hanging over the
+	//right and bottom edges are clipped. Rows of blocks are shared out over jobSystem when there is one
+	bool Decode(DDSFormat format, const uint8_t* data, size_t size, size_t rowPitch, uint32_t width, uint32_t height,
+		uint8_t* output, size_t outputPitch, JobSystem* jobSystem = nullptr);
+
+	//One subresource of a parsed file into a tightly packed image. Volume slices are stacked one above the next
+	bool DecodeSubresource(const uint8_t* fileData, const DDSTextureDesc& desc, const DDSSubresource& subresource,
+		std::vector<uint8_t>& output, JobSystem* jobSystem = nullptr);
+};
@@ -0,0 +1,660 @@
+#include "BCEncoder.h"
+#include "BCFormat.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+typedef void(*BlockEncoder)(const uint8_t* pixels, BCQuality quality, uint8_t* block);
+
+//Writes fields into a 128 bit block, least significant bit first
+struct BlockWriter
+{
+    uint8_t* Block;
+    uint32_t Position = 0;
+
+    BlockWriter(uint8_t* block) : Block(block) { memset(block, 0, 16); }
+
+    void Write(uint32_t value, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++, Position++)
+        {
+            Block[Position >> 3] |= (uint8_t)(((value >> i) & 1) << (Position & 7));
+        }
+    }
+};
+
+//One BC7 subset's endpoints as they are written, without p bits, and the index chosen for each of its pixels
+struct BC7Subset
+{
+    uint32_t Stored[2][4];
+    uint32_t PBits[2];
+    uint8_t Indices[16];
+    float Error;
+};
+
+static int GetRefineCount(BCQuality quality)
+{
+    return quality == BC_QUALITY_HIGH ? 2 : quality == BC_QUALITY_NORMAL ? 1 : 0;
+}
+
+static float Clamp255(float value)
+{
+    return std::min(std::max(value, 0.0f), 255.0f);
+}
+
+//The line the palette is spread along. Fast quality takes the corners of the bounding box, the others the extent of
+//the points along their principal axis, which follows colours that change together in opposite directions too
+static void FitLine(const float (*points)[4], int count, int channels, BCQuality quality, float* start, float* end)
+{
+    float mean[4] = {};
+    float low[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+    float high[4] = {};
+    for (int i = 0; i < count; i++)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            mean[c] += points[i][c];
+            low[c] = std::min(low[c], points[i][c]);
+            high[c] = std::max(high[c], points[i][c]);
+        }
+    }
+    for (int c = 0; c < channels; c++) mean[c] /= count;
+
+    if (quality == BC_QUALITY_FAST)
+    {
+        memcpy(start, low, sizeof(low));
+        memcpy(end, high, sizeof(high));
+        return;
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < count; i++)
+    {
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++) covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+        }
+    }
+
+    //Power iteration from the bounding box diagonal, a few steps is plenty for 16 points
+    float axis[4] = {};
+    for (int c = 0; c < channels; c++) axis[c] = high[c] - low[c];
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {};
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++) next[a] += covariance[a][b] * axis[b];
+        }
+
+        float largest = 0.0f;
+        for (int c = 0; c < channels; c++) largest = std::max(largest, fabsf(next[c]));
+        if (largest < 1e-6f) break;
+        for (int c = 0; c < channels; c++) axis[c] = next[c] / largest;
+    }
+
+    float length = 0.0f;
+    for (int c = 0; c < channels; c++) length += axis[c] * axis[c];
+    if (length < 1e-12f)
+    {
+        //Every point is the same
+        memcpy(start, mean, sizeof(mean));
+        memcpy(end, mean, sizeof(mean));
+        return;
+    }
+    length = sqrtf(length);
+    for (int c = 0; c < channels; c++) axis[c] /= length;
+
+    float minimum = FLT_MAX;
+    float maximum = -FLT_MAX;
+    for (int i = 0; i < count; i++)
+    {
+        float distance = 0.0f;
+        for (int c = 0; c < channels; c++) distance += (points[i][c] - mean[c]) * axis[c];
+        minimum = std::min(minimum, distance);
+        maximum = std::max(maximum, distance);
+    }
+
+    for (int c = 0; c < channels; c++)
+    {
+        start[c] = Clamp255(mean[c] + axis[c] * minimum);
+        end[c] = Clamp255(mean[c] + axis[c] * maximum);
+    }
+}
+
+//Least squares endpoints for the points given how far along the line each was put, 0 at start and 1 at end
+static bool RefineLine(const float (*points)[4], const float* weights, int count, int channels, float* start, float* end)
+{
+    float a = 0.0f;
+    float b = 0.0f;
+    float c = 0.0f;
+    float x[4] = {};
+    float y[4] = {};
+    for (int i = 0; i < count; i++)
+    {
+        float w = weights[i];
+        float v = 1.0f - w;
+        a += v * v;
+        b += v * w;
+        c += w * w;
+        for (int channel = 0; channel < channels; channel++)
+        {
+            x[channel] += v * points[i][channel];
+            y[channel] += w * points[i][channel];
+        }
+    }
+
+    //Every point on the same index leaves nothing to solve for
+    float determinant = a * c - b * b;
+    if (fabsf(determinant) < 1e-6f) return false;
+
+    for (int channel = 0; channel < channels; channel++)
+    {
+        start[channel] = Clamp255((c * x[channel] - b * y[channel]) / determinant);
+        end[channel] = Clamp255((a * y[channel] - b * x[channel]) / determinant);
+    }
+    return true;
+}
+
+static uint16_t To565(const float* colour)
+{
+    uint32_t r = (uint32_t)(colour[0] * 31.0f / 255.0f + 0.5f);
+    uint32_t g = (uint32_t)(colour[1] * 63.0f / 255.0f + 0.5f);
+    uint32_t b = (uint32_t)(colour[2] * 31.0f / 255.0f + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+//BC1 blocks with any alpha under 128 put those pixels on transparent black and fit the rest with three colours
+static void EncodeColourBlock(const uint8_t* pixels, BCQuality quality, bool allowTransparent, uint8_t* block)
+{
+    bool transparent = false;
+    for (int i = 0; allowTransparent && i < 16; i++) transparent |= pixels[i * 4 + 3] < 128;
+
+    float points[16][4];
+    int count = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (transparent && pixels[i * 4 + 3] < 128) continue;
+        for (int c = 0; c < 4; c++) points[count][c] = pixels[i * 4 + c];
+        count++;
+    }
+
+    if (count == 0)
+    {
+        memset(block, 0, 4);
+        memset(block + 4, 0xff, 4);
+        return;
+    }
+
+    float start[4];
+    float end[4];
+    FitLine(points, count, 3, quality, start, end);
+
+    float bestError = FLT_MAX;
+    int refineCount = GetRefineCount(quality);
+    for (int pass = 0; pass <= refineCount; pass++)
+    {
+        //Four colours need colour0 to be bigger and three need it smaller, swapping the endpoints doesn't change the colours
+        uint16_t colour0 = To565(start);
+        uint16_t colour1 = To565(end);
+        if (transparent ? colour0 > colour1 : colour0 < colour1) std::swap(colour0, colour1);
+
+        uint8_t palette[4][4];
+        BuildColourPalette(colour0, colour1, allowTransparent, palette);
+        bool threeColours = allowTransparent && colour0 <= colour1;
+        const float paletteWeights[4] = { 0.0f, 1.0f, threeColours ? 0.5f : 1.0f / 3.0f, 2.0f / 3.0f };
+
+        uint32_t indices = 0;
+        float error = 0.0f;
+        float weights[16];
+        int point = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            uint32_t index = 3;
+            if (!transparent || pixels[i * 4 + 3] >= 128)
+            {
+                float bestDistance = FLT_MAX;
+                for (uint32_t candidate = 0; candidate < (threeColours ? 3u : 4u); candidate++)
+                {
+                    float distance = 0.0f;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        float difference = (float)palette[candidate][c] - pixels[i * 4 + c];
+                        distance += difference * difference;
+                    }
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        index = candidate;
+                    }
+                }
+                error += bestDistance;
+                weights[point++] = paletteWeights[index];
+            }
+            indices |= index << (i * 2);
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            block[0] = (uint8_t)colour0;
+            block[1] = (uint8_t)(colour0 >> 8);
+            block[2] = (uint8_t)colour1;
+            block[3] = (uint8_t)(colour1 >> 8);
+            memcpy(block + 4, &indices, 4);
+        }
+
+        //The weights run from colour0 to colour1, so the refined line starts at whichever endpoint ended up first
+        if (pass == refineCount || bestError == 0.0f) break;
+        if (!RefineLine(points, weights, count, 3, start, end)) break;
+    }
+}
+
+static float EncodeSingleChannelPalette(const uint8_t* pixels, int channel, int value0, int value1, uint8_t* block)
+{
+    int palette[8];
+    BuildSingleChannelPalette(value0, value1, false, palette);
+
+    uint64_t indices = 0;
+    float error = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        int value = pixels[i * 4 + channel];
+        int bestDistance = INT32_MAX;
+        uint64_t bestIndex = 0;
+        for (int index = 0; index < 8; index++)
+        {
+            int distance = abs(palette[index] - value);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                bestIndex = index;
+            }
+        }
+        error += (float)(bestDistance * bestDistance);
+        indices |= bestIndex << (i * 3);
+    }
+
+    block[0] = (uint8_t)value0;
+    block[1] = (uint8_t)value1;
+    memcpy(block + 2, &indices, 6);
+    return error;
+}
+
+static void EncodeSingleChannelBlock(const uint8_t* pixels, int channel, BCQuality quality, uint8_t* block)
+{
+    int low = 255;
+    int high = 0;
+    int innerLow = 255;
+    int innerHigh = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        int value = pixels[i * 4 + channel];
+        low = std::min(low, value);
+        high = std::max(high, value);
+        if (value != 0 && value != 255)
+        {
+            innerLow = std::min(innerLow, value);
+            innerHigh = std::max(innerHigh, value);
+        }
+    }
+
+    //Eight values need the first endpoint bigger. Equal endpoints drop to the six value palette, but every pixel is
+    //on index 0 then anyway
+    float error = EncodeSingleChannelPalette(pixels, channel, high, low, block);
+    if (quality != BC_QUALITY_HIGH || error == 0.0f) return;
+
+    //Six values plus exact 0 and 255, better when a block has both extremes and detail in between
+    if (innerLow > innerHigh) innerLow = innerHigh = 0;
+    uint8_t candidate[8];
+    if (EncodeSingleChannelPalette(pixels, channel, innerLow, innerHigh, candidate) < error) memcpy(block, candidate, 8);
+}
+
+//The stored value whose widened form is closest to an 8 bit target, with the p bit given when the mode has them
+static uint32_t QuantiseBC7(float value, uint32_t bits, bool hasPBit, uint32_t pBit, uint32_t& stored)
+{
+    uint32_t total = bits + (hasPBit ? 1 : 0);
+    int maximum = (1 << bits) - 1;
+    float scaled = value * ((1 << total) - 1) / 255.0f;
+    int guess = hasPBit ? (int)floorf((scaled - pBit) * 0.5f + 0.5f) : (int)floorf(scaled + 0.5f);
+    guess = std::min(std::max(guess, 0), maximum);
+
+    uint32_t bestWidened = 0;
+    float bestError = FLT_MAX;
+    for (int candidate = std::max(guess - 1, 0); candidate <= std::min(guess + 1, maximum); candidate++)
+    {
+        uint32_t full = hasPBit ? ((uint32_t)candidate << 1) | pBit : (uint32_t)candidate;
+        uint32_t widened = ExpandBits(full, total);
+        float error = fabsf((float)widened - value);
+        if (error < bestError)
+        {
+            bestError = error;
+            bestWidened = widened;
+            stored = (uint32_t)candidate;
+        }
+    }
+    return bestWidened;
+}
+
+//Shared p bits have to suit both endpoints, otherwise each endpoint picks its own
+static void QuantiseBC7Endpoints(const BC7Mode& info, const float* start, const float* end, BC7Subset& subset, uint32_t endpoints[2][4])
+{
+    const float* targets[2] = { start, end };
+    bool hasPBits = info.EndpointPBits || info.SharedPBits;
+    float bestError[2] = { FLT_MAX, FLT_MAX };
+
+    for (uint32_t pBit = 0; pBit < (hasPBits ? 2u : 1u); pBit++)
+    {
+        uint32_t stored[2][4];
+        uint32_t widened[2][4];
+        float errors[2] = {};
+        for (int e = 0; e < 2; e++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                if (c == 3 && !info.AlphaBits)
+                {
+                    stored[e][c] = 0;
+                    widened[e][c] = 255;
+                    continue;
+                }
+
+                widened[e][c] = QuantiseBC7(targets[e][c], c == 3 ? info.AlphaBits : info.ColourBits, hasPBits, pBit, stored[e][c]);
+                float difference = widened[e][c] - targets[e][c];
+                errors[e] += difference * difference;
+            }
+        }
+
+        for (int e = 0; e < 2; e++)
+        {
+            bool better = info.SharedPBits ? errors[0] + errors[1] < bestError[0] : errors[e] < bestError[e];
+            if (!better) continue;
+
+            memcpy(subset.Stored[e], stored[e], sizeof(stored[e]));
+            memcpy(endpoints[e], widened[e], sizeof(widened[e]));
+            subset.PBits[e] = pBit;
+            if (!info.SharedPBits) bestError[e] = errors[e];
+        }
+        if (info.SharedPBits) bestError[0] = std::min(bestError[0], errors[0] + errors[1]);
+    }
+}
+
+static void EncodeBC7Subset(const BC7Mode& info, const uint8_t* pixels, const uint8_t* subsets, uint32_t subset, BCQuality quality, BC7Subset& result)
+{
+    int channels = info.AlphaBits ? 4 : 3;
+    float points[16][4];
+    int pixelIndices[16];
+    int count = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (subsets[i] != subset) continue;
+        for (int c = 0; c < 4; c++) points[count][c] = pixels[i * 4 + c];
+        pixelIndices[count++] = i;
+    }
+
+    float start[4];
+    float end[4];
+    FitLine(points, count, channels, quality, start, end);
+    if (channels == 3) start[3] = end[3] = 255.0f;
+
+    const uint8_t* weights = GetWeights(info.IndexBits);
+    uint32_t indexCount = 1u << info.IndexBits;
+    int refineCount = GetRefineCount(quality);
+    result.Error = FLT_MAX;
+
+    for (int pass = 0; pass <= refineCount; pass++)
+    {
+        BC7Subset candidate;
+        uint32_t endpoints[2][4];
+        QuantiseBC7Endpoints(info, start, end, candidate, endpoints);
+
+        float error = 0.0f;
+        float lineWeights[16];
+        for (int point = 0; point < count; point++)
+        {
+            float bestDistance = FLT_MAX;
+            uint32_t bestIndex = 0;
+            for (uint32_t index = 0; index < indexCount; index++)
+            {
+                float distance = 0.0f;
+                for (int c = 0; c < channels; c++)
+                {
+                    float difference = (float)Interpolate(endpoints[0][c], endpoints[1][c], weights[index]) - points[point][c];
+                    distance += difference * difference;
+                }
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+
+            candidate.Indices[pixelIndices[point]] = (uint8_t)bestIndex;
+            lineWeights[point] = weights[bestIndex] / 64.0f;
+            error += bestDistance;
+        }
+
+        candidate.Error = error;
+        if (error < result.Error) result = candidate;
+
+        if (pass == refineCount || error == 0.0f || !RefineLine(points, lineWeights, count, channels, start, end)) break;
+    }
+}
+
+static float EncodeBC7Mode(const uint8_t* pixels, uint32_t mode, uint32_t partition, BCQuality quality, uint8_t* block)
+{
+    const BC7Mode& info = BC7_MODES[mode];
+
+    uint8_t subsets[16];
+    for (uint32_t i = 0; i < 16; i++) subsets[i] = (uint8_t)GetBC7Subset(info.Subsets, partition, i);
+
+    BC7Subset results[3];
+    float error = 0.0f;
+    for (uint32_t subset = 0; subset < info.Subsets; subset++)
+    {
+        EncodeBC7Subset(info, pixels, subsets, subset, quality, results[subset]);
+        error += results[subset].Error;
+    }
+
+    uint8_t indices[16];
+    for (int i = 0; i < 16; i++) indices[i] = results[subsets[i]].Indices[i];
+
+    //Anchor indices are stored without their top bit, so when it would be set the endpoints swap and the subset's
+    //indices flip, which gives exactly the same colours
+    uint32_t anchors[3];
+    uint32_t indexCount = 1u << info.IndexBits;
+    for (uint32_t subset = 0; subset < info.Subsets; subset++)
+    {
+        anchors[subset] = GetBC7Anchor(info.Subsets, partition, subset);
+        if (indices[anchors[subset]] < indexCount / 2) continue;
+
+        std::swap(results[subset].Stored[0], results[subset].Stored[1]);
+        std::swap(results[subset].PBits[0], results[subset].PBits[1]);
+        for (int i = 0; i < 16; i++)
+        {
+            if (subsets[i] == subset) indices[i] = (uint8_t)(indexCount - 1 - indices[i]);
+        }
+    }
+
+    BlockWriter writer(block);
+    writer.Write(1u << mode, mode + 1);
+    writer.Write(partition, info.PartitionBits);
+    writer.Write(0, info.RotationBits);
+    writer.Write(0, info.IndexSelectionBits);
+    for (int c = 0; c < 3; c++)
+    {
+        for (uint32_t subset = 0; subset < info.Subsets; subset++)
+        {
+            writer.Write(results[subset].Stored[0][c], info.ColourBits);
+            writer.Write(results[subset].Stored[1][c], info.ColourBits);
+        }
+    }
+    for (uint32_t subset = 0; subset < info.Subsets && info.AlphaBits; subset++)
+    {
+        writer.Write(results[subset].Stored[0][3], info.AlphaBits);
+        writer.Write(results[subset].Stored[1][3], info.AlphaBits);
+    }
+    for (uint32_t subset = 0; subset < info.Subsets; subset++)
+    {
+        if (info.EndpointPBits)
+        {
+            writer.Write(results[subset].PBits[0], 1);
+            writer.Write(results[subset].PBits[1], 1);
+        }
+        else if (info.SharedPBits)
+        {
+            writer.Write(results[subset].PBits[0], 1);
+        }
+    }
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        writer.Write(indices[i], info.IndexBits - (i == anchors[subsets[i]] ? 1 : 0));
+    }
+
+    return error;
+}
+
+static void EncodeBC1(const uint8_t* pixels, BCQuality quality, uint8_t* block)
+{
+    EncodeColourBlock(pixels, quality, true, block);
+}
+
+static void EncodeBC3(const uint8_t* pixels, BCQuality quality, uint8_t* block)
+{
+    EncodeSingleChannelBlock(pixels, 3, quality, block);
+    EncodeColourBlock(pixels, quality, false, block + 8);
+}
+
+static void EncodeBC4(const uint8_t* pixels, BCQuality quality, uint8_t* block)
+{
+    EncodeSingleChannelBlock(pixels, 0, quality, block);
+}
+
+static void EncodeBC5(const uint8_t* pixels, BCQuality quality, uint8_t* block)
+{
+    EncodeSingleChannelBlock(pixels, 0, quality, block);
+    EncodeSingleChannelBlock(pixels, 1, quality, block + 8);
+}
+
+//Mode 6 is one subset with alpha and 4 bit indices, good for most blocks. Opaque blocks at high quality also try
+//mode 1, two subsets, picking a partition by fitting all 64 once and refining the few best
+static void EncodeBC7(const uint8_t* pixels, BCQuality quality, uint8_t* block)
+{
+    float error = EncodeBC7Mode(pixels, 6, 0, quality, block);
+    if (quality != BC_QUALITY_HIGH || error == 0.0f) return;
+
+    for (int i = 0; i < 16; i++)
+    {
+        if (pixels[i * 4 + 3] != 255) return;
+    }
+
+    const int CANDIDATES = 4;
+    std::pair<float, uint32_t> partitions[64];
+    uint8_t candidate[16];
+    for (uint32_t partition = 0; partition < 64; partition++)
+    {
+        partitions[partition] = std::make_pair(EncodeBC7Mode(pixels, 1, partition, BC_QUALITY_NORMAL, candidate), partition);
+    }
+    std::partial_sort(partitions, partitions + CANDIDATES, partitions + 64);
+
+    for (int i = 0; i < CANDIDATES; i++)
+    {
+        float candidateError = EncodeBC7Mode(pixels, 1, partitions[i].second, quality, candidate);
+        if (candidateError < error)
+        {
+            error = candidateError;
+            memcpy(block, candidate, 16);
+        }
+    }
+}
+
+static BlockEncoder GetBlockEncoder(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_BC1_TYPELESS:
+    case DDS_FORMAT_BC1_UNORM:
+    case DDS_FORMAT_BC1_UNORM_SRGB:
+        return EncodeBC1;
+
+    case DDS_FORMAT_BC3_TYPELESS:
+    case DDS_FORMAT_BC3_UNORM:
+    case DDS_FORMAT_BC3_UNORM_SRGB:
+        return EncodeBC3;
+
+    case DDS_FORMAT_BC4_TYPELESS:
+    case DDS_FORMAT_BC4_UNORM:
+        return EncodeBC4;
+
+    case DDS_FORMAT_BC5_TYPELESS:
+    case DDS_FORMAT_BC5_UNORM:
+        return EncodeBC5;
+
+    case DDS_FORMAT_BC7_TYPELESS:
+    case DDS_FORMAT_BC7_UNORM:
+    case DDS_FORMAT_BC7_UNORM_SRGB:
+        return EncodeBC7;
+
+    default:
+        return nullptr;
+    }
+}
+
+bool BCEncoder::IsSupported(DDSFormat format)
+{
+    return GetBlockEncoder(format) != nullptr;
+}
+
+void BCEncoder::EncodeBlock(DDSFormat format, const uint8_t* pixels, BCQuality quality, uint8_t* block)
+{
+    BlockEncoder encoder = GetBlockEncoder(format);
+    if (encoder) encoder(pixels, quality, block);
+}
+
+bool BCEncoder::Encode(DDSFormat format, const uint8_t* pixels, size_t inputPitch, uint32_t width, uint32_t height,
+    uint8_t* output, size_t rowPitch, BCQuality quality, JobSystem* jobSystem)
+{
+    BlockEncoder encoder = GetBlockEncoder(format);
+    if (!encoder || !pixels || !output || width == 0 || height == 0) return false;
+
+    uint32_t blocksWide = (width + 3) / 4;
+    uint32_t blocksHigh = (height + 3) / 4;
+    size_t blockSize = DDSParser::BitsPerPixel(format) * 2;
+    if (rowPitch < blocksWide * blockSize || inputPitch < (size_t)width * 4) return false;
+
+    auto encodeRows = [=](uint32_t start, uint32_t end)
+    {
+        uint8_t block[64];
+        for (uint32_t blockY = start; blockY < end; blockY++)
+        {
+            uint8_t* row = output + blockY * rowPitch;
+            for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+            {
+                for (uint32_t y = 0; y < 4; y++)
+                {
+                    const uint8_t* source = pixels + std::min(blockY * 4 + y, height - 1) * inputPitch;
+                    for (uint32_t x = 0; x < 4; x++)
+                    {
+                        memcpy(block + (y * 4 + x) * 4, source + std::min(blockX * 4 + x, width - 1) * 4, 4);
+                    }
+                }
+
+                encoder(block, quality, row + blockX * blockSize);
+            }
+        }
+    };
+
+    //A block costs far more to encode than to decode, so a row of blocks per job is already plenty
+    if (jobSystem && jobSystem->IsRunning() && blocksHigh > 1)
+    {
+        jobSystem->ParallelFor(blocksHigh, 1, encodeRows);
+    }
+    else
+    {
+        encodeRows(0, blocksHigh);
+    }
+
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "DDSParser.h"
+
+class JobSystem;
+
+//How hard each block is searched, slower levels only ever lower the error
+enum BCQuality
+{
+	BC_QUALITY_FAST,   //Endpoints from the bounding box, BC7 mode 6 only
+	BC_QUALITY_NORMAL, //Endpoints along the principal axis then refined once by least squares
+	BC_QUALITY_HIGH    //Refined twice, BC4 tries both palettes and opaque BC7 blocks also try mode 1's 64 partitions
+};
+
+//Compresses RGBA8 to BC1, BC3, BC4, BC5 and BC7 off line. BC4 takes red and BC5 red and green. BC1 blocks with any
+//alpha under 128 use the three colour palette with transparent black, everything else is treated as opaque
+namespace BCEncoder
+{
+	bool IsSupported(DDSFormat format);
+
+	//16 pixels, a row of 4 at a time
+	void EncodeBlock(DDSFormat format, const uint8_t* pixels, BCQuality quality, uint8_t* block);
+
+	//width x height RGBA8 pixels inputPitch apart to blocks rowPitch apart. Blocks hanging over the right and bottom
+	//edges repeat the last row and column. Rows of blocks are shared out over jobSystem when there is one
+	bool Encode(DDSFormat format, const uint8_t* pixels, size_t inputPitch, uint32_t width, uint32_t height,
+		uint8_t* output, size_t rowPitch, BCQuality quality, JobSystem* jobSystem = nullptr);
+};
@@ -0,0 +1,1457 @@
+#include "Benchmark.h"
+#include <psapi.h>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <codecvt>
+#include <locale>
+#include "OBJLoader.h"
+#include "DDSTextureLoader.h"
+#include "BCDecoder.h"
+#include "MipGenerator.h"
+#include "TexturePacker.h"
+#include "AssetPacker.h"
+#include "FileUtilities.h"
+#include "TextureStreaming.h"
+#include "ObjectStore.h"
+#include "SceneFile.h"
+#include "MappedFile.h"
+#include "ShaderPermutation.h"
+
+#include "JSON\json.hpp"
+using json = nlohmann::json;
+
+static const char* sectionNames[TIMER_COUNT] = { "Update", "Culling", "Sorting", "Submission", "Present" };
+
+static XMFLOAT3 ReadFloat3(const json& desc, const char* key, XMFLOAT3 fallback)
+{
+    if (!desc.contains(key)) return fallback;
+
+    const json& value = desc[key];
+    if (!value.is_array() || value.size() != 3) return fallback;
+    return XMFLOAT3(value[0], value[1], value[2]);
+}
+
+bool Benchmark::LoadSettings(const char* filename)
+{
+    std::ifstream fileOpen(filename);
+    if (!fileOpen.good()) return false;
+
+    json jFile = json::parse(fileOpen, nullptr, false);
+    if (jFile.is_discarded()) return false;
+
+    _scenePath = jFile.value("Scene", _scenePath);
+    _goldenDirectory = jFile.value("GoldenDirectory", _goldenDirectory);
+    _outputDirectory = jFile.value("OutputDirectory", _outputDirectory);
+    _frameCount = jFile.value("Frames", _frameCount);
+    _frameTime = jFile.value("FrameTime", _frameTime);
+    _pixelTolerance = jFile.value("PixelTolerance", _pixelTolerance);
+    _maxFailingFraction = jFile.value("MaxFailingFraction", _maxFailingFraction);
+    _loadScenePath = jFile.value("LoadScene", _loadScenePath);
+    _loadSceneObjects = jFile.value("LoadSceneObjects", _loadSceneObjects);
+    _sceneFileScenePath = jFile.value("SceneFileScene", _sceneFileScenePath);
+    _sceneFileObjects = jFile.value("SceneFileObjects", _sceneFileObjects);
+    _transformObjects = jFile.value("TransformObjects", _transformObjects);
+    _sceneGraphObjects = jFile.value("SceneGraphObjects", _sceneGraphObjects);
+    _sceneGraphDepth = jFile.value("SceneGraphDepth", _sceneGraphDepth);
+    _sceneGraphWidth = jFile.value("SceneGraphWidth", _sceneGraphWidth);
+    _textureDirectory = jFile.value("TextureDirectory", _textureDirectory);
+    _textureLoadRepeats = jFile.value("TextureLoadRepeats", _textureLoadRepeats);
+    _textureDecodeSize = jFile.value("TextureDecodeSize", _textureDecodeSize);
+    _textureDecodeRepeats = jFile.value("TextureDecodeRepeats", _textureDecodeRepeats);
+    _streamingTextures = jFile.value("StreamingTextures", _streamingTextures);
+    _streamingObjects = jFile.value("StreamingObjects", _streamingObjects);
+    _streamingBudgetFraction = jFile.value("StreamingBudgetFraction", _streamingBudgetFraction);
+    _streamingLatency = jFile.value("StreamingLatency", _streamingLatency);
+    _texturePackInputs = jFile.value("TexturePackInputs", _texturePackInputs);
+    _assetArchiveSettings = jFile.value("AssetArchiveSettings", _assetArchiveSettings);
+    _assetArchiveRepeats = jFile.value("AssetArchiveRepeats", _assetArchiveRepeats);
+    _scalingFrames = jFile.value("ScalingFrames", _scalingFrames);
+    _scalingTolerance = jFile.value("ScalingTolerance", _scalingTolerance);
+
+    //Same settings the -generate-scene mode reads, only the object count and output get changed per step
+    _scalingScene.OutputPath = "JSON/scalingBenchmark.json";
+    StressScene::LoadSettings(jFile.value("ScalingSceneSettings", std::string("JSON/stressSettings.json")).c_str(), _scalingScene);
+    _scalingScene.OutputPath = jFile.value("ScalingScene", std::string("JSON/scalingBenchmark.json"));
+
+    if (jFile.contains("ScalingCounts"))
+    {
+        _scalingCounts = jFile["ScalingCounts"].get<std::vector<int>>();
+    }
+
+    if (jFile.contains("CaptureFrames"))
+    {
+        _captureFrames = jFile["CaptureFrames"].get<std::vector<int>>();
+    }
+
+    for (const json& keyDesc : jFile["CameraPath"])
+    {
+        CameraPathKey key;
+        key.Time = keyDesc.value("Time", 0.0f);
+        key.Eye = ReadFloat3(keyDesc, "Eye", XMFLOAT3(0, 0, -6.0f));
+        key.Direction = ReadFloat3(keyDesc, "Direction", XMFLOAT3(0, 0, 1));
+        _cameraPath.push_back(key);
+    }
+
+    std::sort(_cameraPath.begin(), _cameraPath.end(), [](const CameraPathKey& a, const CameraPathKey& b) { return a.Time < b.Time; });
+
+    _timings.reserve(_frameCount);
+
+    return _frameCount > 0;
+}
+
+static void LerpKey(const CameraPathKey& a, const CameraPathKey& b, float t, XMFLOAT3& eye, XMFLOAT3& direction)
+{
+    XMStoreFloat3(&eye, XMVectorLerp(XMLoadFloat3(&a.Eye), XMLoadFloat3(&b.Eye), t));
+    XMStoreFloat3(&direction, XMVector3Normalize(XMVectorLerp(XMLoadFloat3(&a.Direction), XMLoadFloat3(&b.Direction), t)));
+}
+
+void Benchmark::SampleCameraPath(float time, XMFLOAT3& eye, XMFLOAT3& direction)
+{
+    if (_cameraPath.empty())
+    {
+        eye = XMFLOAT3(0, 0, -6.0f);
+        direction = XMFLOAT3(0, 0, 1);
+        return;
+    }
+
+    if (time <= _cameraPath.front().Time)
+    {
+        eye = _cameraPath.front().Eye;
+        direction = _cameraPath.front().Direction;
+        return;
+    }
+
+    for (size_t i = 1; i < _cameraPath.size(); i++)
+    {
+        const CameraPathKey& next = _cameraPath[i];
+        if (time <= next.Time)
+        {
+            const CameraPathKey& previous = _cameraPath[i - 1];
+            float span = next.Time - previous.Time;
+            float t = span > 0.0f ? (time - previous.Time) / span : 1.0f;
+            LerpKey(previous, next, t, eye, direction);
+            return;
+        }
+    }
+
+    eye = _cameraPath.back().Eye;
+    direction = _cameraPath.back().Direction;
+}
+
+bool Benchmark::ShouldCapture(int frame)
+{
+    return std::find(_captureFrames.begin(), _captureFrames.end(), frame) != _captureFrames.end();
+}
+
+void Benchmark::RunJobSystemBenchmarks(JobSystem& jobSystem)
+{
+    //Empty jobs, so this is purely the cost of allocating, queueing, stealing and counting a job
+    const int spawnCount = 100000;
+    JobCounter counter;
+    double start = GetTimeMilliseconds();
+    for (int i = 0; i < spawnCount; i++)
+    {
+        jobSystem.Run([]() {}, &counter);
+    }
+    jobSystem.Wait(&counter);
+    RecordStartup("Job spawn and run (us per job)", (float)((GetTimeMilliseconds() - start) * 1000.0 / spawnCount));
+
+    //Same arithmetic loop serially and through ParallelFor to see how it scales with the worker count
+    const uint32_t itemCount = 1 << 22;
+    std::vector<float> items(itemCount, 2.0f);
+
+    start = GetTimeMilliseconds();
+    for (uint32_t i = 0; i < itemCount; i++)
+    {
+        items[i] = sqrtf(items[i] * items[i] + 1.0f);
+    }
+    float serialTime = (float)(GetTimeMilliseconds() - start);
+
+    start = GetTimeMilliseconds();
+    jobSystem.ParallelFor(itemCount, 16384, [&items](uint32_t first, uint32_t end)
+    {
+        for (uint32_t i = first; i < end; i++)
+        {
+            items[i] = sqrtf(items[i] * items[i] + 1.0f);
+        }
+    });
+    float parallelTime = (float)(GetTimeMilliseconds() - start);
+
+    RecordStartup("ParallelFor workers", (float)jobSystem.GetWorkerCount() + 1);
+    RecordStartup("Serial loop over 4M items (ms)", serialTime);
+    RecordStartup("ParallelFor over 4M items (ms)", parallelTime);
+    RecordStartup("ParallelFor speed up", parallelTime > 0.0f ? serialTime / parallelTime : 0.0f);
+}
+
+//Nothing is placed in a scene here, so the loads are requested for no object in particular
+static void RequestSceneAssets(AssetLoader& loader, const json& objects)
+{
+    for (const json& objectDesc : objects)
+    {
+        loader.Request(objectDesc.value("MeshLocation", std::string()), ASSET_USE_MESH, PoolHandle());
+        if (objectDesc.value("HasTexture", 0) == 1)
+        {
+            loader.Request(objectDesc.value("TextureLocation", std::string()), ASSET_USE_TEXTURE, PoolHandle());
+        }
+    }
+}
+
+bool Benchmark::GenerateLoadScene(const std::string& filename, int objectCount)
+{
+    std::ifstream templateFile(_scenePath);
+    if (!templateFile.good()) return false;
+
+    json templateScene = json::parse(templateFile, nullptr, false);
+    if (templateScene.is_discarded() || !templateScene.contains("Gameobjects") || templateScene["Gameobjects"].empty()) return false;
+
+    //Cycles through the template's objects on a grid, so there are many objects but only a few distinct files
+    const json& templates = templateScene["Gameobjects"];
+    json objects = json::array();
+    int side = (int)ceilf(sqrtf((float)objectCount));
+    for (int i = 0; i < objectCount; i++)
+    {
+        json objectDesc = templates[i % templates.size()];
+        objectDesc["StartPosX"] = (float)(i % side) * 10.0f;
+        objectDesc["StartPosY"] = 0.0f;
+        objectDesc["StartPosZ"] = (float)(i / side) * 10.0f;
+        objects.push_back(objectDesc);
+    }
+
+    json scene;
+    scene["Gameobjects"] = objects;
+    scene["version"] = templateScene.value("version", std::string("1.1"));
+
+    std::ofstream output(filename);
+    if (!output.good()) return false;
+    output << scene.dump(2);
+    return output.good();
+}
+
+void Benchmark::RunSceneLoadBenchmarks(ID3D11Device* device, JobSystem& jobSystem)
+{
+    if (_loadSceneObjects <= 0 || !GenerateLoadScene(_loadScenePath, _loadSceneObjects)) return;
+
+    std::ifstream sceneFile(_loadScenePath);
+    json scene = json::parse(sceneFile, nullptr, false);
+    if (scene.is_discarded()) return;
+    const json& objects = scene["Gameobjects"];
+
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+
+    //Untimed pass first so both timed loads see warm file caches and the OBJ binary caches already written
+    {
+        AssetCache warmUpCache;
+        AssetLoader warmUp;
+        warmUp.Initialise(device, &jobSystem, &warmUpCache);
+        RequestSceneAssets(warmUp, objects);
+        warmUp.Start();
+        warmUp.Release();
+    }
+
+    //What InitRunTimeData used to do, every object loads its own mesh and texture in turn
+    double start = GetTimeMilliseconds();
+    std::vector<IUnknown*> serialResources;
+    for (const json& objectDesc : objects)
+    {
+        std::string meshPath = objectDesc.value("MeshLocation", std::string());
+        MeshData mesh = OBJLoader::Load((char*)meshPath.c_str(), device);
+        serialResources.push_back(mesh.VertexBuffer);
+        serialResources.push_back(mesh.IndexBuffer);
+
+        if (objectDesc.value("HasTexture", 0) == 1)
+        {
+            ID3D11ShaderResourceView* texture = nullptr;
+            std::wstring texturePath = converter.from_bytes(objectDesc.value("TextureLocation", std::string()));
+            CreateDDSTextureFromFile(device, texturePath.c_str(), nullptr, &texture);
+            serialResources.push_back(texture);
+        }
+    }
+    float serialTime = (float)(GetTimeMilliseconds() - start);
+
+    for (IUnknown* resource : serialResources)
+    {
+        if (resource)resource->Release();
+    }
+
+    start = GetTimeMilliseconds();
+    AssetCache cache;
+    AssetLoader loader;
+    loader.Initialise(device, &jobSystem, &cache);
+    RequestSceneAssets(loader, objects);
+    loader.Start();
+    loader.Wait();
+    float parallelTime = (float)(GetTimeMilliseconds() - start);
+
+    RecordStartup("Load scene objects", (float)objects.size());
+    RecordStartup("Load scene unique paths", (float)cache.GetLiveCount());
+    RecordStartup("Load scene resident assets", (float)cache.GetResidentCount());
+    RecordStartup("Load scene serial (ms)", serialTime);
+    RecordStartup("Load scene parallel (ms)", parallelTime);
+    RecordStartup("Load scene speed up", parallelTime > 0.0f ? serialTime / parallelTime : 0.0f);
+
+    loader.Release();
+}
+
+void Benchmark::RunSceneFileBenchmarks()
+{
+    if (_sceneFileObjects <= 0 || !GenerateLoadScene(_sceneFileScenePath, _sceneFileObjects)) return;
+
+    std::string binaryPath = SceneCompiler::GetBinaryPath(_sceneFileScenePath);
+
+    //Untimed read first so both timed loads start with the JSON in the file cache
+    SceneFile scene;
+    scene.LoadJson(_sceneFileScenePath);
+
+    double start = GetTimeMilliseconds();
+    bool jsonLoaded = scene.LoadJson(_sceneFileScenePath);
+    float jsonTime = (float)(GetTimeMilliseconds() - start);
+    size_t jsonObjects = scene.GetObjects().size();
+    scene.Clear();
+
+    start = GetTimeMilliseconds();
+    bool compiled = SceneCompiler::Compile(_sceneFileScenePath, binaryPath);
+    float compileTime = (float)(GetTimeMilliseconds() - start);
+
+    start = GetTimeMilliseconds();
+    bool binaryLoaded = compiled && scene.LoadBinary(binaryPath);
+    float binaryTime = (float)(GetTimeMilliseconds() - start);
+    size_t binaryObjects = scene.GetObjects().size();
+    scene.Clear();
+
+    if (!jsonLoaded || !binaryLoaded || jsonObjects != binaryObjects)
+    {
+        OutputDebugStringA("Scene file benchmark: the JSON and compiled scenes didn't both load the same objects\n");
+        return;
+    }
+
+    WIN32_FILE_ATTRIBUTE_DATA jsonInfo;
+    WIN32_FILE_ATTRIBUTE_DATA binaryInfo;
+    GetFileAttributesExA(_sceneFileScenePath.c_str(), GetFileExInfoStandard, &jsonInfo);
+    GetFileAttributesExA(binaryPath.c_str(), GetFileExInfoStandard, &binaryInfo);
+
+    RecordStartup("Scene file objects", (float)jsonObjects);
+    RecordStartup("Scene file JSON size (KB)", jsonInfo.nFileSizeLow / 1024.0f);
+    RecordStartup("Scene file binary size (KB)", binaryInfo.nFileSizeLow / 1024.0f);
+    RecordStartup("Scene file JSON load (ms)", jsonTime);
+    RecordStartup("Scene file compile (ms)", compileTime);
+    RecordStartup("Scene file binary load (ms)", binaryTime);
+    RecordStartup("Scene file binary speed up", binaryTime > 0.0f ? jsonTime / binaryTime : 0.0f);
+}
+
+//Committed private memory of the whole process, the benchmarks look at how much it grows by
+static size_t GetPrivateBytes()
+{
+    PROCESS_MEMORY_COUNTERS_EX counters = {};
+    GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters));
+    return counters.PrivateUsage;
+}
+
+//Resident pages, mapped file pages included, so it shows what a texture's source data costs while it is held
+static size_t GetWorkingSet()
+{
+    PROCESS_MEMORY_COUNTERS counters = {};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.WorkingSetSize;
+}
+
+void Benchmark::RunTextureLoadBenchmarks(ID3D11Device* device)
+{
+    std::vector<std::string> textures;
+    WIN32_FIND_DATAA findData;
+    HANDLE find = FindFirstFileA((_textureDirectory + "\\*.dds").c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE) return;
+    do
+    {
+        textures.push_back(_textureDirectory + "\\" + findData.cFileName);
+    } while (FindNextFileA(find, &findData));
+    FindClose(find);
+
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+    std::vector<std::wstring> widePaths;
+    for (const std::string& texture : textures) widePaths.push_back(converter.from_bytes(texture));
+
+    //Untimed pass first so both timed loads read from the file cache rather than the disk
+    for (const std::wstring& path : widePaths)
+    {
+        ID3D11ShaderResourceView* texture = nullptr;
+        if (SUCCEEDED(CreateDDSTextureFromFile(device, path.c_str(), nullptr, &texture))) texture->Release();
+    }
+
+    //What LoadTextureDataFromFile used to do, the whole file read into a heap copy before the texture is made
+    size_t copyMemory = 0;
+    size_t copyResident = 0;
+    double start = GetTimeMilliseconds();
+    for (int repeat = 0; repeat < _textureLoadRepeats; repeat++)
+    {
+        for (const std::string& path : textures)
+        {
+            size_t baseline = GetPrivateBytes();
+            size_t residentBaseline = GetWorkingSet();
+
+            std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+            if (!file.good()) continue;
+            std::vector<uint8_t> data((size_t)file.tellg());
+            file.seekg(0);
+            file.read((char*)data.data(), data.size());
+
+            copyMemory = std::max(copyMemory, GetPrivateBytes() - std::min(baseline, GetPrivateBytes()));
+            copyResident = std::max(copyResident, GetWorkingSet() - std::min(residentBaseline, GetWorkingSet()));
+
+            ID3D11ShaderResourceView* texture = nullptr;
+            if (SUCCEEDED(CreateDDSTextureFromMemory(device, data.data(), data.size(), nullptr, &texture))) texture->Release();
+        }
+    }
+    float copyTime = (float)(GetTimeMilliseconds() - start);
+
+    start = GetTimeMilliseconds();
+    for (int repeat = 0; repeat < _textureLoadRepeats; repeat++)
+    {
+        for (const std::wstring& path : widePaths)
+        {
+            ID3D11ShaderResourceView* texture = nullptr;
+            if (SUCCEEDED(CreateDDSTextureFromFile(device, path.c_str(), nullptr, &texture))) texture->Release();
+        }
+    }
+    float mappedTime = (float)(GetTimeMilliseconds() - start);
+
+    //The mapped load can't be sampled from inside, so the same mapping is made and every page touched here instead
+    size_t mappedMemory = 0;
+    size_t mappedResident = 0;
+    for (const std::wstring& path : widePaths)
+    {
+        size_t baseline = GetPrivateBytes();
+        size_t residentBaseline = GetWorkingSet();
+
+        MappedFile file;
+        if (!file.Open(path.c_str())) continue;
+
+        volatile uint8_t touched = 0;
+        for (size_t i = 0; i < file.GetSize(); i += 4096) touched += file.GetData()[i];
+
+        mappedMemory = std::max(mappedMemory, GetPrivateBytes() - std::min(baseline, GetPrivateBytes()));
+        mappedResident = std::max(mappedResident, GetWorkingSet() - std::min(residentBaseline, GetWorkingSet()));
+    }
+
+    RecordStartup("Texture load files", (float)textures.size());
+    RecordStartup("Texture load copy (ms)", copyTime);
+    RecordStartup("Texture load mapped (ms)", mappedTime);
+    RecordStartup("Texture load copy peak private (KB)", copyMemory / 1024.0f);
+    RecordStartup("Texture load mapped peak private (KB)", mappedMemory / 1024.0f);
+    RecordStartup("Texture load copy peak resident (KB)", copyResident / 1024.0f);
+    RecordStartup("Texture load mapped peak resident (KB)", mappedResident / 1024.0f);
+}
+
+void Benchmark::RunTextureDecodeBenchmarks(JobSystem& jobSystem)
+{
+    if (_textureDecodeSize <= 0 || _textureDecodeRepeats <= 0) return;
+
+    std::vector<uint8_t> pixels;
+    auto measure = [&](const std::string& name, DDSFormat format, const uint8_t* data, size_t size, size_t rowPitch, uint32_t width, uint32_t height)
+    {
+        pixels.resize((size_t)width * height * 4);
+        float megapixels = (float)width * height * _textureDecodeRepeats / 1000000.0f;
+
+        double start = GetTimeMilliseconds();
+        for (int repeat = 0; repeat < _textureDecodeRepeats; repeat++)
+        {
+            BCDecoder::Decode(format, data, size, rowPitch, width, height, pixels.data(), (size_t)width * 4);
+        }
+        float serialTime = (float)(GetTimeMilliseconds() - start);
+
+        start = GetTimeMilliseconds();
+        for (int repeat = 0; repeat < _textureDecodeRepeats; repeat++)
+        {
+            BCDecoder::Decode(format, data, size, rowPitch, width, height, pixels.data(), (size_t)width * 4, &jobSystem);
+        }
+        float parallelTime = (float)(GetTimeMilliseconds() - start);
+
+        RecordStartup((name + " decode (MP/s)").c_str(), serialTime > 0.0f ? megapixels * 1000.0f / serialTime : 0.0f);
+        RecordStartup((name + " decode ParallelFor (MP/s)").c_str(), parallelTime > 0.0f ? megapixels * 1000.0f / parallelTime : 0.0f);
+    };
+
+    //The shipped textures aren't compressed, so each format gets a square of made up blocks. Any bits are a valid
+    //block in every format but BC7, where the mode bits are set so all eight modes are decoded equally often
+    const DDSFormat formats[] = { DDS_FORMAT_BC1_UNORM, DDS_FORMAT_BC3_UNORM, DDS_FORMAT_BC4_UNORM, DDS_FORMAT_BC5_UNORM, DDS_FORMAT_BC7_UNORM };
+    const char* formatNames[] = { "BC1", "BC3", "BC4", "BC5", "BC7" };
+    uint32_t size = (uint32_t)_textureDecodeSize;
+    for (int i = 0; i < 5; i++)
+    {
+        size_t blockSize = BCDecoder::GetBlockSize(formats[i]);
+        size_t rowPitch = (size + 3) / 4 * blockSize;
+        std::vector<uint8_t> blocks(rowPitch * ((size + 3) / 4));
+
+        uint32_t random = 1;
+        for (size_t b = 0; b < blocks.size(); b++)
+        {
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+            blocks[b] = (uint8_t)random;
+        }
+
+        if (formats[i] == DDS_FORMAT_BC7_UNORM)
+        {
+            for (size_t b = 0; b < blocks.size(); b += 16)
+            {
+                uint32_t mode = (uint32_t)(b / 16) % 8;
+                blocks[b] = (uint8_t)((blocks[b] & ~((2u << mode) - 1)) | (1u << mode));
+            }
+        }
+
+        measure(std::string("Texture ") + formatNames[i], formats[i], blocks.data(), blocks.size(), rowPitch, size, size);
+    }
+
+    WIN32_FIND_DATAA findData;
+    HANDLE find = FindFirstFileA((_textureDirectory + "\\*.dds").c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE) return;
+    do
+    {
+        MappedFile file;
+        if (!file.Open((_textureDirectory + "\\" + findData.cFileName).c_str())) continue;
+
+        DDSTextureDesc desc;
+        DDSLayout layout;
+        if (DDSParser::Parse(file.GetData(), file.GetSize(), desc) != DDS_OK || !BCDecoder::IsSupported(desc.Format)) continue;
+        if (DDSParser::GetLayout(desc, 0, layout) != DDS_OK) continue;
+
+        const DDSSubresource& mip = layout.Subresources[0];
+        measure(std::string("Texture ") + findData.cFileName, desc.Format, file.GetData() + mip.Offset, mip.SlicePitch, mip.RowPitch, mip.Width, mip.Height);
+    } while (FindNextFileA(find, &findData));
+    FindClose(find);
+}
+
+void Benchmark::RunMipGenerationBenchmarks(JobSystem& jobSystem)
+{
+    if (_textureDecodeSize <= 0 || _textureDecodeRepeats <= 0) return;
+
+    //Noise rather than a flat colour so nothing about the image is cheaper than a real texture
+    uint32_t size = (uint32_t)_textureDecodeSize;
+    std::vector<uint8_t> pixels((size_t)size * size * 4);
+    uint32_t random = 1;
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        pixels[i] = (uint8_t)random;
+    }
+
+    std::vector<std::vector<uint8_t>> mips;
+    uint32_t mipCount = MipGenerator::GetMipCount(size, size);
+    float megapixels = (float)size * size * _textureDecodeRepeats / 1000000.0f;
+
+    const MipFilter filters[] = { MIP_FILTER_BOX, MIP_FILTER_KAISER, MIP_FILTER_LANCZOS };
+    for (MipFilter filter : filters)
+    {
+        for (int srgb = 0; srgb < 2; srgb++)
+        {
+            MipSettings settings;
+            settings.Filter = filter;
+            settings.SRGB = srgb == 1;
+            std::string name = std::string("Mip chain ") + MipGenerator::GetFilterName(filter) + (settings.SRGB ? " sRGB" : "");
+
+            for (int parallel = 0; parallel < 2; parallel++)
+            {
+                double start = GetTimeMilliseconds();
+                for (int repeat = 0; repeat < _textureDecodeRepeats; repeat++)
+                {
+                    MipGenerator::Generate(pixels.data(), (size_t)size * 4, size, size, mipCount, settings, mips, parallel ? &jobSystem : nullptr);
+                }
+                float time = (float)(GetTimeMilliseconds() - start);
+
+                RecordStartup((name + (parallel ? " ParallelFor (MP/s)" : " (MP/s)")).c_str(), time > 0.0f ? megapixels * 1000.0f / time : 0.0f);
+            }
+        }
+    }
+}
+
+void Benchmark::RunTextureStreamingBenchmarks()
+{
+    if (_streamingTextures <= 0 || _streamingObjects <= 0 || _frameCount <= 0) return;
+
+    //BC7 is a byte a pixel, down to one 4x4 block
+    std::vector<std::vector<size_t>> mipBytes(_streamingTextures);
+    std::vector<uint32_t> sizes(_streamingTextures);
+    size_t fullBytes = 0;
+    for (int t = 0; t < _streamingTextures; t++)
+    {
+        sizes[t] = 256u << (t % 4);
+        for (uint32_t mip = 0; mip < MipGenerator::GetMipCount(sizes[t], sizes[t]); mip++)
+        {
+            size_t bytes = 0;
+            DDSParser::GetSurfaceInfo(std::max(sizes[t] >> mip, 1u), std::max(sizes[t] >> mip, 1u), DDS_FORMAT_BC7_UNORM, &bytes, nullptr, nullptr);
+            mipBytes[t].push_back(bytes);
+            fullBytes += bytes;
+        }
+    }
+
+    //Two units apart on the ground the path flies over, a few sizes so the same texture is wanted at different mips
+    int side = (int)ceilf(sqrtf((float)_streamingObjects));
+    std::vector<XMFLOAT4> bounds(_streamingObjects);
+    for (int i = 0; i < _streamingObjects; i++)
+    {
+        bounds[i] = XMFLOAT4((i % side - side * 0.5f) * 2.0f, 0.0f, (i / side - side * 0.5f) * 2.0f, 0.5f + (i % 3) * 0.25f);
+    }
+
+    //The framework's cameras are 90 degrees high, at 720 lines
+    const float projectionScale = 720.0f * 0.5f / tanf(XM_PIDIV4);
+
+    //The second run gets a fraction of the most the first had resident, so its budget always has to leave something out
+    size_t peakResident = 0;
+    for (int run = 0; run < 2; run++)
+    {
+        TextureStreamingSettings settings;
+        settings.BudgetBytes = run == 0 ? fullBytes : (size_t)(peakResident * (double)_streamingBudgetFraction);
+
+        TextureStreamingPolicy policy;
+        policy.Initialise(settings);
+        for (int t = 0; t < _streamingTextures; t++)
+        {
+            policy.Add(sizes[t], sizes[t], mipBytes[t], TextureStreamingPolicy::GetTailMip(sizes[t], sizes[t], (uint32_t)mipBytes[t].size(), settings.TailSize));
+        }
+        size_t limit = std::max(settings.BudgetBytes, policy.GetResidentBytes());
+
+        //Streams finish in the order they started, each _streamingLatency frames later
+        std::vector<std::pair<int, uint32_t>> inFlight;
+        std::vector<TextureStreamRequest> requests;
+        size_t peakCommitted = 0;
+        int framesOverBudget = 0;
+        double missingMips = 0.0;
+        size_t visibleUses = 0;
+        float finalMissing = 0.0f;
+        double policyTime = 0.0;
+
+        //After the path ends the camera holds still until every stream is done, or it is clear they never will be
+        int frame = 0;
+        int settleFrames = 0;
+        for (; frame < _frameCount || (settleFrames < 1000 && (!inFlight.empty() || !requests.empty())); frame++)
+        {
+            if (frame >= _frameCount) settleFrames++;
+
+            XMFLOAT3 eye;
+            XMFLOAT3 direction;
+            SampleCameraPath(std::min(frame, _frameCount - 1) * _frameTime, eye, direction);
+
+            policy.ReleaseRetired((uint64_t)std::max(frame - 1, 0));
+            size_t done = 0;
+            while (done < inFlight.size() && inFlight[done].first <= frame) policy.Complete(inFlight[done++].second, true, frame);
+            inFlight.erase(inFlight.begin(), inFlight.begin() + done);
+
+            double start = GetTimeMilliseconds();
+            policy.BeginFrame();
+            for (int i = 0; i < _streamingObjects; i++)
+            {
+                float pixels = TextureStreamingPolicy::GetProjectedPixels(bounds[i], eye, direction, projectionScale);
+                if (pixels > 0.0f) policy.AddUse(i % _streamingTextures, pixels);
+            }
+            policy.ChooseTargets();
+            policy.GetRequests(requests);
+            policyTime += GetTimeMilliseconds() - start;
+
+            for (const TextureStreamRequest& request : requests) inFlight.push_back(std::make_pair(frame + _streamingLatency, request.Texture));
+
+            peakCommitted = std::max(peakCommitted, policy.GetCommittedBytes());
+            peakResident = std::max(peakResident, policy.GetResidentBytes());
+            if (policy.GetResidentBytes() > limit) framesOverBudget++;
+
+            //How many mips short of what it wants each visible texture is
+            float frameMissing = 0.0f;
+            for (int t = 0; t < _streamingTextures; t++)
+            {
+                const StreamedTexture& texture = policy.Get(t);
+                if (texture.ProjectedPixels <= 0.0f) continue;
+                frameMissing += std::max(texture.ResidentMip - std::min(texture.DesiredMip, (float)texture.TailMip), 0.0f);
+                visibleUses++;
+            }
+            missingMips += frameMissing;
+            finalMissing = frameMissing;
+        }
+
+        bool settled = inFlight.empty() && requests.empty();
+        for (int t = 0; t < _streamingTextures; t++) settled = settled && policy.Get(t).ResidentMip == policy.Get(t).TargetMip;
+
+        if (framesOverBudget > 0 || !settled || (run == 0 && finalMissing > 0.0f))
+        {
+            OutputDebugStringA(run == 0 ? "Texture streaming failed its checks with the full budget\n" : "Texture streaming failed its checks with the reduced budget\n");
+            _failedStreamingChecks++;
+        }
+
+        std::string name = run == 0 ? "Texture streaming full budget" : "Texture streaming reduced budget";
+        RecordStartup((name + " (MB)").c_str(), settings.BudgetBytes / (1024.0f * 1024.0f));
+        RecordStartup((name + " peak committed (MB)").c_str(), peakCommitted / (1024.0f * 1024.0f));
+        RecordStartup((name + " final resident (MB)").c_str(), policy.GetResidentBytes() / (1024.0f * 1024.0f));
+        RecordStartup((name + " frames over budget").c_str(), (float)framesOverBudget);
+        RecordStartup((name + " streams").c_str(), (float)policy.GetStreamsStarted());
+        RecordStartup((name + " frames to settle").c_str(), (float)settleFrames);
+        RecordStartup((name + " average missing mips").c_str(), visibleUses > 0 ? (float)(missingMips / visibleUses) : 0.0f);
+        RecordStartup((name + " policy (ms per frame)").c_str(), frame > 0 ? (float)(policyTime / frame) : 0.0f);
+    }
+}
+
+void Benchmark::RunTexturePackBenchmarks(JobSystem& jobSystem)
+{
+    TexturePackSettings settings;
+
+    //Planning only reads headers, so generated sizes are enough to see how full the pages get
+    if (_texturePackInputs > 0)
+    {
+        std::vector<TexturePackInput> inputs(_texturePackInputs);
+        uint32_t random = 1;
+        for (TexturePackInput& input : inputs)
+        {
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+
+            input.Desc.Dimension = DDS_DIMENSION_TEXTURE2D;
+            input.Desc.Format = DDS_FORMAT_BC7_UNORM;
+            input.Desc.Width = 16u << (random % 5);
+            input.Desc.Height = 16u << ((random >> 8) % 5);
+            input.Desc.Depth = 1;
+            input.Desc.MipCount = 1;
+            input.Desc.ArraySize = 1;
+        }
+
+        TexturePackPlan plan;
+        double start = GetTimeMilliseconds();
+        TexturePacker::Plan(inputs, settings, plan);
+        RecordStartup("Texture atlas plan (ms)", (float)(GetTimeMilliseconds() - start));
+
+        size_t used = 0;
+        size_t total = 0;
+        size_t pages = 0;
+        for (const TexturePack& pack : plan.Packs)
+        {
+            used += pack.UsedTexels;
+            total += (size_t)pack.Width * pack.Height * pack.Slices;
+            pages += pack.Slices;
+        }
+        RecordStartup("Texture atlas pages", (float)pages);
+        RecordStartup("Texture atlas fill (%)", total ? 100.0f * used / total : 0.0f);
+    }
+
+    std::vector<std::unique_ptr<MappedFile>> files;
+    std::vector<TexturePackInput> inputs;
+    WIN32_FIND_DATAA findData;
+    HANDLE find = FindFirstFileA((_textureDirectory + "\\*.dds").c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE) return;
+    do
+    {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+        TexturePackInput input;
+        input.Path = _textureDirectory + "\\" + findData.cFileName;
+        if (!file->Open(input.Path.c_str()) || DDSParser::Parse(file->GetData(), file->GetSize(), input.Desc) != DDS_OK) continue;
+
+        input.Data = file->GetData();
+        input.Size = file->GetSize();
+        inputs.push_back(input);
+        files.push_back(std::move(file));
+    } while (FindNextFileA(find, &findData));
+    FindClose(find);
+
+    TexturePackPlan plan;
+    TexturePacker::Plan(inputs, settings, plan);
+
+    //Each pack is one binding where its textures were one each
+    size_t packed = 0;
+    for (const TexturePack& pack : plan.Packs) packed += pack.Inputs.size();
+    RecordStartup("Texture packs", (float)plan.Packs.size());
+    RecordStartup("Textures packed", (float)packed);
+
+    std::vector<uint8_t> output;
+    double start = GetTimeMilliseconds();
+    for (const TexturePack& pack : plan.Packs)
+    {
+        if (pack.Kind == TEXTURE_PACK_ARRAY) TexturePacker::BuildArray(pack, inputs, output);
+        else TexturePacker::BuildAtlas(pack, plan, inputs, settings.Quality, &jobSystem, output);
+    }
+    RecordStartup("Texture pack build (ms)", (float)(GetTimeMilliseconds() - start));
+}
+
+//Unbuffered reads skip the file cache, so they cost what a first load after a reboot would. The offset and buffer have
+//to be sector aligned and whole sectors are read, which is what the archive's alignment is for
+static HANDLE OpenUncached(const std::string& path)
+{
+    return CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+}
+
+static bool ReadUncached(HANDLE file, uint64_t offset, size_t size, uint8_t* buffer)
+{
+    OVERLAPPED position = {};
+    position.Offset = (DWORD)offset;
+    position.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD read = 0;
+    return ReadFile(file, buffer, (DWORD)((size + 4095) & ~(size_t)4095), &read, &position) && read >= size;
+}
+
+void Benchmark::RunAssetArchiveBenchmarks(JobSystem& jobSystem)
+{
+    AssetPackSettings settings;
+    if (!AssetPacker::LoadSettings(_assetArchiveSettings.c_str(), settings)) return;
+    AssetPacker::FindInputs(settings);
+
+    //A copy of its own, sector aligned whatever the settings say so every entry can be read uncached
+    CreateDirectories(_outputDirectory);
+    settings.OutputPath = _outputDirectory + "\\benchmark.pak";
+    settings.Alignment = std::max(settings.Alignment, 4096u);
+
+    AssetArchiveStats stats;
+    double start = GetTimeMilliseconds();
+    AssetPacker::Run(settings, &jobSystem, &stats);
+    RecordStartup("Asset archive pack (ms)", (float)(GetTimeMilliseconds() - start));
+
+    AssetArchive archive;
+    if (!archive.Open(settings.OutputPath.c_str()) || archive.GetEntryCount() == 0) return;
+    RecordStartup("Asset archive entries", (float)stats.Entries);
+    RecordStartup("Asset archive compressed entries", (float)stats.Compressed);
+    RecordStartup("Asset archive stored (%)", stats.Bytes ? 100.0f * stats.StoredBytes / stats.Bytes : 0.0f);
+
+    //In the order they sit in the archive, and for each the loose file a load would open instead. Meshes are read
+    //through their binary when they have one, the same as OBJLoader::Load
+    std::vector<const AssetArchiveEntry*> entries;
+    for (uint32_t i = 0; i < archive.GetEntryCount(); i++) entries.push_back(&archive.GetEntry(i));
+    std::sort(entries.begin(), entries.end(), [](const AssetArchiveEntry* a, const AssetArchiveEntry* b) { return a->Offset < b->Offset; });
+
+    std::vector<std::string> loosePaths;
+    size_t largest = (size_t)entries.front()->Offset;
+    for (const AssetArchiveEntry* entry : entries)
+    {
+        std::string path = archive.GetPath(*entry);
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (entry->Format == ASSET_FORMAT_MESH && GetFileAttributesExA((path + "Binary").c_str(), GetFileExInfoStandard, &attributes)) path += "Binary";
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes)) continue;
+
+        loosePaths.push_back(path);
+        largest = std::max({ largest, (size_t)entry->StoredSize, (size_t)attributes.nFileSizeLow });
+    }
+
+    uint8_t* buffer = (uint8_t*)VirtualAlloc(nullptr, (largest + 4095) & ~(size_t)4095, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!buffer) return;
+    std::vector<uint8_t> inflated;
+
+    start = GetTimeMilliseconds();
+    for (const std::string& path : loosePaths)
+    {
+        HANDLE file = OpenUncached(path);
+        if (file == INVALID_HANDLE_VALUE) continue;
+
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size)) ReadUncached(file, 0, (size_t)size.QuadPart, buffer);
+        CloseHandle(file);
+    }
+    RecordStartup("Loose assets cold (ms)", (float)(GetTimeMilliseconds() - start));
+
+    //One open, the table of contents, then every entry front to back, inflating what is compressed as a load would
+    start = GetTimeMilliseconds();
+    HANDLE file = OpenUncached(settings.OutputPath);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        ReadUncached(file, 0, (size_t)entries.front()->Offset, buffer);
+        for (const AssetArchiveEntry* entry : entries)
+        {
+            if (!ReadUncached(file, entry->Offset, (size_t)entry->StoredSize, buffer) || entry->Compression == ASSET_COMPRESSION_NONE) continue;
+
+            inflated.resize((size_t)entry->Size);
+            AssetLZ::Decompress(buffer, (size_t)entry->StoredSize, inflated.data(), inflated.size());
+        }
+        CloseHandle(file);
+    }
+    RecordStartup("Asset archive cold (ms)", (float)(GetTimeMilliseconds() - start));
+    VirtualFree(buffer, 0, MEM_RELEASE);
+
+    //Warm, everything is in the file cache after an untimed pass and is mapped and every page touched the way the loaders read it
+    auto touch = [](const uint8_t* data, size_t size)
+    {
+        volatile uint8_t touched = 0;
+        for (size_t i = 0; i < size; i += 4096) touched += data[i];
+    };
+    auto readLoose = [&]()
+    {
+        for (const std::string& path : loosePaths)
+        {
+            MappedFile loose;
+            if (loose.Open(path.c_str())) touch(loose.GetData(), loose.GetSize());
+        }
+    };
+    auto readArchive = [&]()
+    {
+        AssetArchive warm;
+        if (!warm.Open(settings.OutputPath.c_str())) return;
+        for (const AssetArchiveEntry* entry : entries)
+        {
+            AssetFile packed;
+            if (packed.Open(&warm, archive.GetPath(*entry))) touch(packed.GetData(), packed.GetSize());
+        }
+    };
+
+    int repeats = std::max(_assetArchiveRepeats, 1);
+    readLoose();
+    start = GetTimeMilliseconds();
+    for (int repeat = 0; repeat < repeats; repeat++) readLoose();
+    RecordStartup("Loose assets warm (ms)", (float)((GetTimeMilliseconds() - start) / repeats));
+
+    readArchive();
+    start = GetTimeMilliseconds();
+    for (int repeat = 0; repeat < repeats; repeat++) readArchive();
+    RecordStartup("Asset archive warm (ms)", (float)((GetTimeMilliseconds() - start) / repeats));
+
+    //Hashing the normalised path and the binary search, what each load pays before it reads anything
+    std::vector<std::string> paths;
+    for (const AssetArchiveEntry* entry : entries) paths.push_back(archive.GetPath(*entry));
+    size_t found = 0;
+    start = GetTimeMilliseconds();
+    for (int repeat = 0; repeat < 1000; repeat++)
+    {
+        for (const std::string& path : paths) found += archive.Find(path) != nullptr;
+    }
+    RecordStartup("Asset archive lookup (ns)", (float)((GetTimeMilliseconds() - start) * 1.0e6 / std::max(found, (size_t)1)));
+}
+
+void Benchmark::RunSceneStreamBenchmarks()
+{
+    if (_sceneFileObjects <= 0) return;
+    if (!std::ifstream(_sceneFileScenePath).good() && !GenerateLoadScene(_sceneFileScenePath, _sceneFileObjects)) return;
+
+    //Both ways pull the same fields into a desc for every object, which is all InitRunTimeData needs from them
+    float checksum[2] = {};
+
+    //The old way, whole document in memory before the first object can be made
+    size_t baseline = GetPrivateBytes();
+    double start = GetTimeMilliseconds();
+    float documentFirstObject = 0.0f;
+    size_t documentMemory = 0;
+    size_t documentObjects = 0;
+    {
+        std::ifstream fileOpen(_sceneFileScenePath);
+        json scene = json::parse(fileOpen, nullptr, false);
+        if (scene.is_discarded()) return;
+        documentMemory = GetPrivateBytes() - std::min(baseline, GetPrivateBytes());
+
+        for (const json& objectDesc : scene["Gameobjects"])
+        {
+            SceneObjectDesc desc;
+            std::string meshPath = objectDesc.value("MeshLocation", std::string());
+            desc.MeshPath = meshPath.c_str();
+            desc.RotationY = objectDesc.value("RotationY", 0.0f);
+            desc.Scale = objectDesc.value("Scale", 1.0f);
+            desc.Position = XMFLOAT3(objectDesc.value("StartPosX", 0.0f), objectDesc.value("StartPosY", 0.0f), objectDesc.value("StartPosZ", 0.0f));
+            if (documentObjects++ == 0) documentFirstObject = (float)(GetTimeMilliseconds() - start);
+            checksum[0] += desc.Position.x + desc.Scale;
+        }
+    }
+    float documentTime = (float)(GetTimeMilliseconds() - start);
+
+    //Streamed, memory is sampled as it goes since nothing stays around to measure at the end
+    baseline = GetPrivateBytes();
+    start = GetTimeMilliseconds();
+    float streamFirstObject = 0.0f;
+    size_t streamMemory = 0;
+    size_t streamObjects = 0;
+    auto onObject = [&](uint32_t index, const SceneObjectDesc& desc)
+    {
+        if (streamObjects++ == 0) streamFirstObject = (float)(GetTimeMilliseconds() - start);
+        if (index % 1024 == 0) streamMemory = std::max(streamMemory, GetPrivateBytes() - std::min(baseline, GetPrivateBytes()));
+        checksum[1] += desc.Position.x + desc.Scale;
+    };
+    bool streamed = SceneFile::StreamJson(_sceneFileScenePath, onObject, [](uint32_t, uint32_t) {});
+    float streamTime = (float)(GetTimeMilliseconds() - start);
+
+    if (!streamed || streamObjects != documentObjects || checksum[0] != checksum[1])
+    {
+        OutputDebugStringA("Scene stream benchmark: the document and streamed loads didn't read the same objects\n");
+        return;
+    }
+
+    RecordStartup("Scene stream objects", (float)streamObjects);
+    RecordStartup("Scene document first object (ms)", documentFirstObject);
+    RecordStartup("Scene document total (ms)", documentTime);
+    RecordStartup("Scene document memory (KB)", documentMemory / 1024.0f);
+    RecordStartup("Scene stream first object (ms)", streamFirstObject);
+    RecordStartup("Scene stream total (ms)", streamTime);
+    RecordStartup("Scene stream memory (KB)", streamMemory / 1024.0f);
+}
+
+//Same fields and layout GameObject had before transforms moved into ObjectStore, hot and cold mixed together
+struct MixedObject
+{
+    ID3D11ShaderResourceView* texture;
+    ID3D11ShaderResourceView* normalMap;
+    MeshData meshData;
+    XMFLOAT3 world;
+    int hasTexture;
+    float rotation;
+    float scale;
+    PermutationKey permutation;
+
+    XMFLOAT3* GetWorldVector() { return &world; }
+    float GetRotation() { return rotation; }
+    float GetScale() { return scale; }
+};
+
+struct TransformArrays
+{
+    std::vector<XMFLOAT3> Positions;
+    std::vector<float> Rotations;
+    std::vector<float> Scales;
+    std::vector<XMFLOAT4> LocalBounds;
+    std::vector<XMFLOAT4X4> Worlds;
+    std::vector<XMFLOAT4> WorldBounds;
+};
+
+void Benchmark::RunTransformBenchmarks(JobSystem& jobSystem)
+{
+    if (_transformObjects <= 0) return;
+    size_t count = (size_t)_transformObjects;
+
+    std::vector<MixedObject> mixed(count);
+    TransformArrays arrays;
+    arrays.Positions.resize(count);
+    arrays.Rotations.resize(count);
+    arrays.Scales.resize(count);
+    arrays.LocalBounds.assign(count, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+    arrays.Worlds.resize(count);
+    arrays.WorldBounds.resize(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        MixedObject& object = mixed[i];
+        object = MixedObject();
+        object.world = XMFLOAT3((float)(i % 512), 0.0f, (float)(i / 512));
+        object.rotation = (float)i * 0.01f;
+        object.scale = 1.0f + (float)(i % 7) * 0.25f;
+
+        arrays.Positions[i] = object.world;
+        arrays.Rotations[i] = object.rotation;
+        arrays.Scales[i] = object.scale;
+    }
+
+    //What Update used to do per object, three matrices multiplied together through the accessors
+    std::vector<XMFLOAT4X4> mixedWorlds(count);
+    double start = GetTimeMilliseconds();
+    for (size_t i = 0; i < count; i++)
+    {
+        MixedObject& object = mixed[i];
+        XMMATRIX goworld = XMMatrixIdentity() * XMMatrixRotationY(object.GetRotation()) * XMMatrixScaling(object.GetScale(), object.GetScale(), object.GetScale()) * XMMatrixTranslation(object.GetWorldVector()->x, object.GetWorldVector()->y, object.GetWorldVector()->z);
+        XMStoreFloat4x4(&mixedWorlds[i], goworld);
+    }
+    float mixedTime = (float)(GetTimeMilliseconds() - start);
+
+    start = GetTimeMilliseconds();
+    BuildWorldMatrices(arrays.Positions.data(), arrays.Rotations.data(), arrays.Scales.data(), arrays.LocalBounds.data(), arrays.Worlds.data(), arrays.WorldBounds.data(), count);
+    float batchTime = (float)(GetTimeMilliseconds() - start);
+
+    start = GetTimeMilliseconds();
+    jobSystem.ParallelFor((uint32_t)count, 4096, [&arrays](uint32_t first, uint32_t end)
+    {
+        BuildWorldMatrices(&arrays.Positions[first], &arrays.Rotations[first], &arrays.Scales[first], &arrays.LocalBounds[first], &arrays.Worlds[first], &arrays.WorldBounds[first], end - first);
+    });
+    float parallelTime = (float)(GetTimeMilliseconds() - start);
+
+    //Both ways have to build the same matrices or the timings mean nothing
+    float maxError = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* a = &mixedWorlds[i]._11;
+        const float* b = &arrays.Worlds[i]._11;
+        for (int j = 0; j < 16; j++)
+        {
+            maxError = std::max(maxError, fabsf(a[j] - b[j]));
+        }
+    }
+
+    RecordStartup("Transform objects", (float)count);
+    RecordStartup("Transform per object loop (ms)", mixedTime);
+    RecordStartup("Transform SoA batch (ms)", batchTime);
+    RecordStartup("Transform SoA batch ParallelFor (ms)", parallelTime);
+    RecordStartup("Transform SoA batch speed up", batchTime > 0.0f ? mixedTime / batchTime : 0.0f);
+    RecordStartup("Transform max matrix difference", maxError);
+}
+
+//Old style node, each one holds its own children and the walk recurses through them
+struct TreeNode
+{
+    XMFLOAT4X4 Local;
+    XMFLOAT4X4 World;
+    std::vector<TreeNode*> Children;
+};
+
+static void PropagateTree(TreeNode* node, FXMMATRIX parentWorld)
+{
+    XMMATRIX world = XMMatrixMultiply(XMLoadFloat4x4(&node->Local), parentWorld);
+    XMStoreFloat4x4(&node->World, world);
+
+    for (TreeNode* child : node->Children)
+    {
+        PropagateTree(child, world);
+    }
+}
+
+//Splits count objects into trees of treeSize and runs them through the recursive tree walk, ObjectStore's level
+//pass on one thread, and the level pass with each level spread across the workers. A tree is either one chain,
+//each object parented to the one before, or one root with everything else directly under it.
+//Only the roots are moved, the rest follow them
+void Benchmark::RunHierarchyBenchmark(JobSystem& jobSystem, const char* name, size_t count, size_t treeSize, bool chain)
+{
+    treeSize = std::max<size_t>(1, std::min(treeSize, count));
+    count = count / treeSize * treeSize;
+
+    ObjectStore<int> store;
+    std::vector<PoolHandle> handles(count);
+    std::vector<TreeNode> nodes(count);
+
+    //Tree t is objects [t * treeSize, (t + 1) * treeSize), its root first
+    for (size_t i = 0; i < count; i++)
+    {
+        XMFLOAT3 position((float)(i % 7) * 0.5f, 0.25f, (float)(i % 5) * 0.5f);
+        float rotation = (float)i * 0.01f;
+        float scale = 0.9f + (float)(i % 3) * 0.05f;
+
+        handles[i] = store.Create(0);
+        store.SetPosition(handles[i], position);
+        store.SetRotation(handles[i], rotation);
+        store.SetScale(handles[i], scale);
+        if (i % treeSize != 0)
+        {
+            size_t parent = chain ? i - 1 : i - i % treeSize;
+            store.SetParent(handles[i], handles[parent]);
+            nodes[parent].Children.push_back(&nodes[i]);
+        }
+
+        XMStoreFloat4x4(&nodes[i].Local, XMMatrixRotationY(rotation) * XMMatrixScaling(scale, scale, scale) * XMMatrixTranslation(position.x, position.y, position.z));
+    }
+    store.UpdateTransforms(jobSystem);
+
+    double start = GetTimeMilliseconds();
+    for (size_t root = 0; root < count; root += treeSize)
+    {
+        PropagateTree(&nodes[root], XMMatrixIdentity());
+    }
+    float treeTime = (float)(GetTimeMilliseconds() - start);
+
+    for (size_t root = 0; root < count; root += treeSize)
+    {
+        store.SetRotation(handles[root], (float)root * 0.01f);
+    }
+
+    start = GetTimeMilliseconds();
+    store.UpdateDirty(0, store.PrepareDirty());
+    for (size_t level = 0; level < store.GetLevelCount(); level++)
+    {
+        store.PropagateLevel(level, 0, store.GetLevelSize(level));
+    }
+    store.FinishDirty();
+    float serialTime = (float)(GetTimeMilliseconds() - start);
+
+    for (size_t root = 0; root < count; root += treeSize)
+    {
+        store.SetRotation(handles[root], (float)root * 0.01f);
+    }
+
+    start = GetTimeMilliseconds();
+    store.UpdateTransforms(jobSystem);
+    float parallelTime = (float)(GetTimeMilliseconds() - start);
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* a = &nodes[i].World._11;
+        const float* b = &store.GetWorld(store.GetItem(handles[i]))._11;
+        for (int j = 0; j < 16; j++)
+        {
+            maxError = std::max(maxError, fabsf(a[j] - b[j]));
+        }
+    }
+
+    std::string prefix = std::string("Hierarchy ") + name;
+    RecordStartup((prefix + " objects").c_str(), (float)count);
+    RecordStartup((prefix + " levels").c_str(), (float)store.GetLevelCount() + 1.0f);
+    RecordStartup((prefix + " recursive (ms)").c_str(), treeTime);
+    RecordStartup((prefix + " levels (ms)").c_str(), serialTime);
+    RecordStartup((prefix + " levels ParallelFor (ms)").c_str(), parallelTime);
+    RecordStartup((prefix + " max matrix difference").c_str(), maxError);
+}
+
+void Benchmark::RunSceneGraphBenchmarks(JobSystem& jobSystem)
+{
+    if (_sceneGraphObjects <= 0) return;
+
+    //Long chains give many small levels, so the per level hand off to the workers is what gets measured.
+    //Wide trees are one big level that splits well
+    RunHierarchyBenchmark(jobSystem, "deep", (size_t)_sceneGraphObjects, (size_t)std::max(1, _sceneGraphDepth), true);
+    RunHierarchyBenchmark(jobSystem, "wide", (size_t)_sceneGraphObjects, (size_t)std::max(1, _sceneGraphWidth), false);
+}
+
+HRESULT Benchmark::CaptureAndCompare(ID3D11Device* device, ID3D11DeviceContext* context, IDXGISwapChain1* swapChain, int frame)
+{
+    HRESULT hr = S_OK;
+
+    //With a flip model swap chain buffer 0 is always the one being drawn to this frame
+    ID3D11Texture2D* frameBuffer = nullptr;
+    hr = swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&frameBuffer));
+    if (FAILED(hr)) return hr;
+
+    D3D11_TEXTURE2D_DESC stagingDesc = {};
+    frameBuffer->GetDesc(&stagingDesc);
+    stagingDesc.Usage = D3D11_USAGE_STAGING;
+    stagingDesc.BindFlags = 0;
+    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    stagingDesc.MiscFlags = 0;
+
+    ID3D11Texture2D* stagingTexture = nullptr;
+    hr = device->CreateTexture2D(&stagingDesc, nullptr, &stagingTexture);
+    if (FAILED(hr))
+    {
+        frameBuffer->Release();
+        return hr;
+    }
+
+    context->CopyResource(stagingTexture, frameBuffer);
+    frameBuffer->Release();
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    hr = context->Map(stagingTexture, 0, D3D11_MAP_READ, 0, &mapped);
+    if (FAILED(hr))
+    {
+        stagingTexture->Release();
+        return hr;
+    }
+
+    //Back buffer is R8G8B8A8 so drop the alpha and respect the row pitch the driver gave us
+    int width = stagingDesc.Width;
+    int height = stagingDesc.Height;
+    std::vector<unsigned char> rgb(width * height * 3);
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* row = (const unsigned char*)mapped.pData + y * mapped.RowPitch;
+        for (int x = 0; x < width; x++)
+        {
+            rgb[(y * width + x) * 3 + 0] = row[x * 4 + 0];
+            rgb[(y * width + x) * 3 + 1] = row[x * 4 + 1];
+            rgb[(y * width + x) * 3 + 2] = row[x * 4 + 2];
+        }
+    }
+
+    context->Unmap(stagingTexture, 0);
+    stagingTexture->Release();
+
+    char name[32];
+    sprintf_s(name, "frame_%05d.ppm", frame);
+
+    CreateDirectories(_outputDirectory);
+    ImageCompare::WritePPM(_outputDirectory + "\\" + name, width, height, rgb);
+
+    int goldenWidth, goldenHeight;
+    std::vector<unsigned char> golden;
+    std::string goldenPath = _goldenDirectory + "\\" + name;
+    char message[256];
+
+    if (!ImageCompare::ReadPPM(goldenPath, goldenWidth, goldenHeight, golden))
+    {
+        //First run on a new path, save this frame as the golden image to compare against next time
+        CreateDirectories(_goldenDirectory);
+        ImageCompare::WritePPM(goldenPath, width, height, rgb);
+        sprintf_s(message, "Benchmark: frame %d has no golden image, wrote %s\n", frame, goldenPath.c_str());
+        OutputDebugStringA(message);
+        return S_OK;
+    }
+
+    if (goldenWidth != width || goldenHeight != height)
+    {
+        _failedCaptures++;
+        sprintf_s(message, "Benchmark: frame %d is %dx%d but golden image is %dx%d\n", frame, width, height, goldenWidth, goldenHeight);
+        OutputDebugStringA(message);
+        return S_OK;
+    }
+
+    ImageCompareResult result = ImageCompare::Compare(rgb, golden, _pixelTolerance, _maxFailingFraction);
+    if (!result.Passed) _failedCaptures++;
+
+    sprintf_s(message, "Benchmark: frame %d %s (%d pixels over tolerance, max difference %.1f)\n", frame, result.Passed ? "passed" : "FAILED", result.FailingPixels, result.MaxDifference);
+    OutputDebugStringA(message);
+
+    return S_OK;
+}
+
+bool Benchmark::WriteResults()
+{
+    CreateDirectories(_outputDirectory);
+
+    std::ofstream csv(_outputDirectory + "\\timings.csv");
+    if (!csv.good()) return false;
+
+    csv << "Frame";
+    for (int s = 0; s < TIMER_COUNT; s++) csv << "," << sectionNames[s];
+    csv << ",Total\n";
+
+    for (size_t i = 0; i < _timings.size(); i++)
+    {
+        float total = 0.0f;
+        csv << i;
+        for (int s = 0; s < TIMER_COUNT; s++)
+        {
+            csv << "," << _timings[i].Section[s];
+            total += _timings[i].Section[s];
+        }
+        csv << "," << total << "\n";
+    }
+    csv.close();
+
+    //Summary of each section so a regression can be spotted without opening the csv
+    std::ofstream summary(_outputDirectory + "\\summary.txt");
+    summary << "Frames: " << _timings.size() << "\n";
+    summary << "Failed captures: " << _failedCaptures << "\n";
+    summary << "Failed streaming checks: " << _failedStreamingChecks << "\n";
+
+    for (size_t i = 0; i < _startupTimings.size(); i++)
+    {
+        summary << _startupTimings[i].first << ": " << _startupTimings[i].second << "\n";
+    }
+
+    WriteScalingResults(summary);
+
+    summary << "Section, Average ms, Median ms, 95th percentile ms, Max ms\n";
+
+    std::vector<float> values(_timings.size());
+    for (int s = 0; s < TIMER_COUNT; s++)
+    {
+        if (values.empty()) break;
+
+        float sum = 0.0f;
+        for (size_t i = 0; i < _timings.size(); i++)
+        {
+            values[i] = _timings[i].Section[s];
+            sum += values[i];
+        }
+        std::sort(values.begin(), values.end());
+
+        summary << sectionNames[s] << ", " << sum / values.size() << ", " << values[values.size() / 2] << ", "
+            << values[(values.size() * 95) / 100] << ", " << values.back() << "\n";
+    }
+
+    return true;
+}
+
+void Benchmark::WriteScalingResults(std::ofstream& summary)
+{
+    if (_scalingSamples.empty()) return;
+
+    //Stages in the order they were first recorded, sizes smallest first
+    std::vector<std::string> stages;
+    std::vector<int> counts;
+    for (const ScalingSample& sample : _scalingSamples)
+    {
+        if (std::find(stages.begin(), stages.end(), sample.Stage) == stages.end()) stages.push_back(sample.Stage);
+        if (std::find(counts.begin(), counts.end(), sample.Objects) == counts.end()) counts.push_back(sample.Objects);
+    }
+    std::sort(counts.begin(), counts.end());
+
+    auto find = [this](int objects, const std::string& stage) -> const ScalingSample*
+    {
+        for (const ScalingSample& sample : _scalingSamples)
+        {
+            if (sample.Objects == objects && sample.Stage == stage) return &sample;
+        }
+        return nullptr;
+    };
+
+    std::ofstream csv(_outputDirectory + "\\scaling.csv");
+    csv << "Objects";
+    for (const std::string& stage : stages) csv << "," << stage << " ms," << stage << " us per object";
+    csv << "\n";
+
+    for (int objects : counts)
+    {
+        csv << objects;
+        for (const std::string& stage : stages)
+        {
+            const ScalingSample* sample = find(objects, stage);
+            if (sample) csv << "," << sample->Milliseconds << "," << sample->Milliseconds * 1000.0f / std::max(objects, 1);
+            else csv << ",,";
+        }
+        csv << "\n";
+    }
+
+    //Small scenes are mostly fixed overhead, so each size is held against the cheapest per object cost before it
+    //rather than the first. Going over that by _scalingTolerance is where the stage stops being linear
+    summary << "Scaling, Stage, Stops scaling at objects, us per object there, Best us per object before\n";
+    for (const std::string& stage : stages)
+    {
+        float best = 0.0f;
+        bool haveBest = false;
+        int stopsAt = 0;
+        float stopCost = 0.0f;
+        for (int objects : counts)
+        {
+            const ScalingSample* sample = find(objects, stage);
+            if (!sample || objects <= 0) continue;
+
+            float cost = sample->Milliseconds * 1000.0f / objects;
+            if (haveBest && cost > best * _scalingTolerance && best > 0.0f)
+            {
+                stopsAt = objects;
+                stopCost = cost;
+                break;
+            }
+            if (!haveBest || cost < best) best = cost;
+            haveBest = true;
+        }
+
+        if (stopsAt > 0) summary << "Scaling, " << stage << ", " << stopsAt << ", " << stopCost << ", " << best << "\n";
+        else summary << "Scaling, " << stage << ", none up to " << counts.back() << ", , " << best << "\n";
+    }
+}
+
+bool ImageCompare::WritePPM(const std::string& filename, int width, int height, const std::vector<unsigned char>& rgb)
+{
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+    if (!file.good()) return false;
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+    file.write((const char*)rgb.data(), rgb.size());
+    return file.good();
+}
+
+bool ImageCompare::ReadPPM(const std::string& filename, int& width, int& height, std::vector<unsigned char>& rgb)
+{
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file.good()) return false;
+
+    std::string magic;
+    int maxValue;
+    file >> magic >> width >> height >> maxValue;
+    if (magic != "P6" || maxValue != 255 || width <= 0 || height <= 0) return false;
+
+    file.get(); //Single whitespace byte between the header and the pixels
+
+    rgb.resize(width * height * 3);
+    file.read((char*)rgb.data(), rgb.size());
+    return file.gcount() == (std::streamsize)rgb.size();
+}
+
+ImageCompareResult ImageCompare::Compare(const std::vector<unsigned char>& image, const std::vector<unsigned char>& golden, float pixelTolerance, float maxFailingFraction)
+{
+    ImageCompareResult result = {};
+
+    size_t pixelCount = image.size() / 3;
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        float r = (float)image[i * 3 + 0] - golden[i * 3 + 0];
+        float g = (float)image[i * 3 + 1] - golden[i * 3 + 1];
+        float b = (float)image[i * 3 + 2] - golden[i * 3 + 2];
+        float redMean = (image[i * 3 + 0] + golden[i * 3 + 0]) * 0.5f;
+
+        //"Redmean" colour distance, weights green highest and shifts red/blue weight with how red the pixel is.
+        //Divided by 3 so it is on roughly the same 0-255 scale as a single channel
+        float difference = sqrtf((2.0f + redMean / 256.0f) * r * r + 4.0f * g * g + (2.0f + (255.0f - redMean) / 256.0f) * b * b) / 3.0f;
+
+        if (difference > result.MaxDifference) result.MaxDifference = difference;
+        if (difference > pixelTolerance) result.FailingPixels++;
+    }
+
+    result.FailingFraction = pixelCount > 0 ? (float)result.FailingPixels / pixelCount : 0.0f;
+    result.Passed = result.FailingFraction <= maxFailingFraction;
+
+    return result;
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <windows.h>
+#include <d3d11_4.h>
+#include <dxgi1_2.h>
+#include <DirectXMath.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "FrameTimer.h"
+#include "JobSystem.h"
+#include "AssetLoader.h"
+#include "StressScene.h"
+
+using namespace DirectX;
+
+//A point on a recorded camera path, the benchmark interpolates between these each frame
+struct CameraPathKey
+{
+	float Time;
+	XMFLOAT3 Eye;
+	XMFLOAT3 Direction;
+};
+
+//Result of comparing a captured frame to its golden image
+struct ImageCompareResult
+{
+	int FailingPixels;
+	float FailingFraction;
+	float MaxDifference;
+	bool Passed;
+};
+
+//One stage's cost at one scene size in the scaling run
+struct ScalingSample
+{
+	int Objects;
+	std::string Stage;
+	float Milliseconds;
+};
+
+//Runs a fixed number of frames along a recorded camera path, records the CPU cost of each
+//frame and checks selected frames against golden images so regressions in Update/Draw show up
+class Benchmark
+{
+private:
+	std::string _scenePath = "JSON/fileData.json";
+	std::string _goldenDirectory = "Benchmark\\Golden";
+	std::string _outputDirectory = "Benchmark\\Output";
+	std::string _loadScenePath = "JSON/loadBenchmark.json";
+	std::string _sceneFileScenePath = "JSON/sceneFileBenchmark.json";
+	std::string _textureDirectory = "Textures";
+
+	std::vector<CameraPathKey> _cameraPath;
+	std::vector<int> _captureFrames;
+	std::vector<FrameTiming> _timings;
+	std::vector<std::pair<std::string, float>> _startupTimings;
+
+	int _frameCount = 300;
+	float _frameTime = 1.0f / 60.0f; //Simulated seconds per frame, fixed so animation is the same every run
+	float _pixelTolerance = 8.0f;    //Perceptual distance a pixel can be off by before it counts as different
+	float _maxFailingFraction = 0.001f;
+	int _failedCaptures = 0;
+	int _loadSceneObjects = 500;
+	int _sceneFileObjects = 50000;
+	int _transformObjects = 131072;
+	int _sceneGraphObjects = 65536;
+	int _sceneGraphDepth = 64;
+	int _sceneGraphWidth = 1024;
+	int _textureLoadRepeats = 20;
+	int _textureDecodeSize = 2048;
+	int _textureDecodeRepeats = 4;
+
+	//Headless texture streaming run along the camera path, see RunTextureStreamingBenchmarks
+	int _streamingTextures = 64;
+	int _streamingObjects = 1024;
+	float _streamingBudgetFraction = 0.5f;  //Of the most the run with room for everything had resident, for the run that has to leave detail out
+	int _streamingLatency = 3;              //Frames from a stream starting to it being swapped in
+	int _failedStreamingChecks = 0;
+
+	int _texturePackInputs = 512; //Generated small textures the atlas planner lays out, see RunTexturePackBenchmarks
+
+	//What RunAssetArchiveBenchmarks packs, the same settings -pack-assets reads, and how many warm reads it averages over
+	std::string _assetArchiveSettings = "JSON/archiveSettings.json";
+	int _assetArchiveRepeats = 10;
+
+	//Scene sizes the scaling run generates and goes through, each from load to drawn frames
+	std::vector<int> _scalingCounts;
+	int _scalingFrames = 10;
+	float _scalingTolerance = 2.0f; //Per object cost this many times the best seen at a smaller size counts as not scaling
+	StressSceneSettings _scalingScene;
+	std::vector<ScalingSample> _scalingSamples;
+
+	void RunHierarchyBenchmark(JobSystem& jobSystem, const char* name, size_t count, size_t treeSize, bool chain);
+	void WriteScalingResults(std::ofstream& summary);
+
+public:
+	bool LoadSettings(const char* filename);
+
+	void SampleCameraPath(float time, XMFLOAT3& eye, XMFLOAT3& direction);
+	bool ShouldCapture(int frame);
+	void RecordFrame(const FrameTiming& timing) { _timings.push_back(timing); }
+	void RecordStartup(const char* name, float milliseconds) { _startupTimings.push_back(std::make_pair(name, milliseconds)); }
+
+	//Spawn overhead and ParallelFor speed up over a serial loop, reported with the startup timings
+	void RunJobSystemBenchmarks(JobSystem& jobSystem);
+
+	//Writes a scene of _loadSceneObjects copies of the benchmark scene's objects, then loads it the old
+	//one-object-at-a-time way and through AssetLoader so the two can be compared
+	void RunSceneLoadBenchmarks(ID3D11Device* device, JobSystem& jobSystem);
+	bool GenerateLoadScene(const std::string& filename, int objectCount);
+
+	//Every DDS in _textureDirectory loaded _textureLoadRepeats times, read into a heap copy first against mapped, with
+	//how much private and resident memory the source data takes while the texture is made
+	void RunTextureLoadBenchmarks(ID3D11Device* device);
+
+	//Megapixels a second decoding BC1, BC3, BC4, BC5 and BC7 on one thread and over the job system, on a
+	//_textureDecodeSize square of generated blocks per format and on mip 0 of any BC texture in _textureDirectory
+	void RunTextureDecodeBenchmarks(JobSystem& jobSystem);
+
+	//Megapixels a second building a whole mip chain for a _textureDecodeSize square image with each filter, on one
+	//thread and over the job system, linear and sRGB
+	void RunMipGenerationBenchmarks(JobSystem& jobSystem);
+
+	//TextureStreamingPolicy on its own, for _streamingObjects objects over a grid using _streamingTextures BC7 textures
+	//of 256 to 2048, as the camera path goes past. Streams finish _streamingLatency frames after they start. Run once
+	//with room for every mip and once with _streamingBudgetFraction of what that run needed, each checks resident mips
+	//never go over budget and everything settles once the camera stops, and the first that nothing visible is left short
+	void RunTextureStreamingBenchmarks();
+
+	//TexturePacker planning _texturePackInputs generated texture sizes from 16 to 256 into BC7 atlases, how long it
+	//takes and how much of each page is used, then planning and building packs for every DDS in _textureDirectory
+	void RunTexturePackBenchmarks(JobSystem& jobSystem);
+
+	//Packs _assetArchiveSettings' assets into an archive in _outputDirectory, then reads every entry out of it against
+	//opening each loose file: cold with unbuffered reads that have to go to the disk, and warm through mappings
+	void RunAssetArchiveBenchmarks(JobSystem& jobSystem);
+
+	//Reading a _sceneFileObjects object scene from its JSON against from the compiled binary
+	void RunSceneFileBenchmarks();
+
+	//Time until the first object can be made and how much memory goes up, parsing that same scene's JSON into
+	//a document first against streaming it
+	void RunSceneStreamBenchmarks();
+
+	//World matrix throughput for _transformObjects objects, the old per-object accessor loop against ObjectStore's batches
+	void RunTransformBenchmarks(JobSystem& jobSystem);
+
+	//Parent to child world propagation for _sceneGraphObjects objects, as _sceneGraphDepth long chains and as
+	//_sceneGraphWidth sized single level trees, recursive tree walk against ObjectStore's depth levels
+	void RunSceneGraphBenchmarks(JobSystem& jobSystem);
+
+	//The framework runs the scaling scenes itself since it owns the objects, these just collect and report the numbers
+	void RecordScaling(int objects, const char* stage, float milliseconds) { _scalingSamples.push_back({ objects, stage, milliseconds }); }
+	const std::vector<int>& GetScalingCounts() { return _scalingCounts; }
+	int GetScalingFrames() { return _scalingFrames; }
+	const StressSceneSettings& GetScalingScene() { return _scalingScene; }
+
+	HRESULT CaptureAndCompare(ID3D11Device* device, ID3D11DeviceContext* context, IDXGISwapChain1* swapChain, int frame);
+	bool WriteResults();
+
+	const std::string& GetScenePath() { return _scenePath; }
+	int GetFrameCount() { return _frameCount; }
+	float GetFrameTime() { return _frameTime; }
+	int GetFailedCaptures() { return _failedCaptures; }
+	int GetFailedStreamingChecks() { return _failedStreamingChecks; }
+};
+
+namespace ImageCompare
+{
+	//Binary PPM (P6), 8 bits per channel RGB
+	bool WritePPM(const std::string& filename, int width, int height, const std::vector<unsigned char>& rgb);
+	bool ReadPPM(const std::string& filename, int& width, int& height, std::vector<unsigned char>& rgb);
+
+	//Compares two RGB images using a weighted colour distance that roughly tracks how different two colours look
+	ImageCompareResult Compare(const std::vector<unsigned char>& image, const std::vector<unsigned char>& golden, float pixelTolerance, float maxFailingFraction);
+};
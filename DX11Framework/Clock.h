@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+
+//Source of time for the update loop, swapped for SimulatedClock when frames need to be reproducible
+class Clock
+{
+public:
+	virtual ~Clock() = default;
+	virtual double GetSeconds() = 0;
+};
+
+//steady_clock is QueryPerformanceCounter on Windows and CLOCK_MONOTONIC on Linux, both well under a microsecond
+class SystemClock : public Clock
+{
+private:
+	std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+
+public:
+	double GetSeconds() override
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+	}
+};
+
+//Only moves when told to, so the same sequence of Advance calls always produces the same frames
+class SimulatedClock : public Clock
+{
+private:
+	double _time = 0.0;
+
+public:
+	double GetSeconds() override { return _time; }
+	void Advance(double seconds) { _time += seconds; }
+	void SetSeconds(double seconds) { _time = seconds; }
+};
@@ -0,0 +1,888 @@
+#include "DDSParser.h"
+#include <algorithm>
+
+//DDS file structures, see DDS.h in the DirectXTex library
+#pragma pack(push, 1)
+
+const uint32_t DDS_MAGIC = 0x20534444; //"DDS "
+
+#define DDS_MAKEFOURCC(ch0, ch1, ch2, ch3) ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) | ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24))
+
+struct DDS_PIXELFORMAT
+{
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t RGBBitCount;
+    uint32_t RBitMask;
+    uint32_t GBitMask;
+    uint32_t BBitMask;
+    uint32_t ABitMask;
+};
+
+#define DDS_FOURCC      0x00000004  // DDPF_FOURCC
+#define DDS_RGB         0x00000040  // DDPF_RGB
+#define DDS_LUMINANCE   0x00020000  // DDPF_LUMINANCE
+#define DDS_ALPHA       0x00000002  // DDPF_ALPHA
+
+#define DDS_HEADER_FLAGS_TEXTURE    0x00001007 // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT
+#define DDS_HEADER_FLAGS_MIPMAP     0x00020000 // DDSD_MIPMAPCOUNT
+#define DDS_HEADER_FLAGS_VOLUME     0x00800000 // DDSD_DEPTH
+#define DDS_HEADER_FLAGS_LINEARSIZE 0x00080000 // DDSD_LINEARSIZE
+#define DDS_HEIGHT                  0x00000002 // DDSD_HEIGHT
+
+#define DDS_SURFACE_FLAGS_TEXTURE 0x00001000 // DDSCAPS_TEXTURE
+#define DDS_SURFACE_FLAGS_MIPMAP  0x00400008 // DDSCAPS_COMPLEX | DDSCAPS_MIPMAP
+#define DDS_SURFACE_FLAGS_CUBEMAP 0x00000008 // DDSCAPS_COMPLEX
+
+#define DDS_CUBEMAP_ALLFACES 0x0000fe00 // DDSCAPS2_CUBEMAP and all six DDSCAPS2_CUBEMAP_ faces
+#define DDS_CUBEMAP          0x00000200 // DDSCAPS2_CUBEMAP
+
+#define DDS_RESOURCE_MISC_TEXTURECUBE 0x4 // D3D11_RESOURCE_MISC_TEXTURECUBE
+#define DDS_MISC_FLAGS2_ALPHA_MODE_MASK 0x7
+
+struct DDS_HEADER
+{
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitchOrLinearSize;
+    uint32_t depth; //Only if DDS_HEADER_FLAGS_VOLUME is set in flags
+    uint32_t mipMapCount;
+    uint32_t reserved1[11];
+    DDS_PIXELFORMAT ddspf;
+    uint32_t caps;
+    uint32_t caps2;
+    uint32_t caps3;
+    uint32_t caps4;
+    uint32_t reserved2;
+};
+
+struct DDS_HEADER_DXT10
+{
+    uint32_t dxgiFormat;
+    uint32_t resourceDimension;
+    uint32_t miscFlag; //See D3D11_RESOURCE_MISC_FLAG
+    uint32_t arraySize;
+    uint32_t miscFlags2;
+};
+
+#pragma pack(pop)
+
+//D3D11 hardware limits, file metadata bigger than these isn't trusted
+const size_t DDS_MAX_MIP_LEVELS = 15;
+const size_t DDS_MAX_TEXTURE1D_ARRAY = 2048;
+const size_t DDS_MAX_TEXTURE1D_SIZE = 16384;
+const size_t DDS_MAX_TEXTURE2D_ARRAY = 2048;
+const size_t DDS_MAX_TEXTURE2D_SIZE = 16384;
+const size_t DDS_MAX_TEXTURECUBE_SIZE = 16384;
+const size_t DDS_MAX_TEXTURE3D_SIZE = 2048;
+
+#define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
+#define MAKEFOURCC DDS_MAKEFOURCC
+
+//Legacy headers say what they hold with bit masks and FourCCs rather than a format
+static DDSFormat GetFormat(const DDS_PIXELFORMAT& ddpf)
+{
+    if (ddpf.flags & DDS_RGB)
+    {
+        // Note that sRGB formats are written using the "DX10" extended header
+
+        switch (ddpf.RGBBitCount)
+        {
+        case 32:
+            if (ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0xff000000))
+            {
+                return DDS_FORMAT_R8G8B8A8_UNORM;
+            }
+
+            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0xff000000))
+            {
+                return DDS_FORMAT_B8G8R8A8_UNORM;
+            }
+
+            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0x00000000))
+            {
+                return DDS_FORMAT_B8G8R8X8_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
+
+            // Note that many common DDS reader/writers (including D3DX) swap the
+            // the RED/BLUE masks for 10:10:10:2 formats. We assumme
+            // below that the 'backwards' header mask is being used since it is most
+            // likely written by D3DX. The more robust solution is to use the 'DX10'
+            // header extension and specify the DDS_FORMAT_R10G10B10A2_UNORM format directly
+
+            // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
+            if (ISBITMASK(0x3ff00000,0x000ffc00,0x000003ff,0xc0000000))
+            {
+                return DDS_FORMAT_R10G10B10A2_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+
+            if (ISBITMASK(0x0000ffff,0xffff0000,0x00000000,0x00000000))
+            {
+                return DDS_FORMAT_R16G16_UNORM;
+            }
+
+            if (ISBITMASK(0xffffffff,0x00000000,0x00000000,0x00000000))
+            {
+                // Only 32-bit color channel format in D3D9 was R32F
+                return DDS_FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
+            }
+            break;
+
+        case 24:
+            // No 24bpp DXGI formats aka D3DFMT_R8G8B8
+            break;
+
+        case 16:
+            if (ISBITMASK(0x7c00,0x03e0,0x001f,0x8000))
+            {
+                return DDS_FORMAT_B5G5R5A1_UNORM;
+            }
+            if (ISBITMASK(0xf800,0x07e0,0x001f,0x0000))
+            {
+                return DDS_FORMAT_B5G6R5_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+
+            if (ISBITMASK(0x0f00,0x00f0,0x000f,0xf000))
+            {
+                return DDS_FORMAT_B4G4R4A4_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+
+            // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
+            break;
+        }
+    }
+    else if (ddpf.flags & DDS_LUMINANCE)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x00000000))
+            {
+                return DDS_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+
+            // No DXGI format maps to ISBITMASK(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
+        }
+
+        if (16 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x0000ffff,0x00000000,0x00000000,0x00000000))
+            {
+                return DDS_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x0000ff00))
+            {
+                return DDS_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+        }
+    }
+    else if (ddpf.flags & DDS_ALPHA)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            return DDS_FORMAT_A8_UNORM;
+        }
+    }
+    else if (ddpf.flags & DDS_FOURCC)
+    {
+        if (MAKEFOURCC( 'D', 'X', 'T', '1' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC1_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '3' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '5' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC3_UNORM;
+        }
+
+        // While pre-mulitplied alpha isn't directly supported by the DXGI formats,
+        // they are basically the same as these BC formats so they can be mapped
+        if (MAKEFOURCC( 'D', 'X', 'T', '2' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '4' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC3_UNORM;
+        }
+
+        if (MAKEFOURCC( 'A', 'T', 'I', '1' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '4', 'U' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '4', 'S' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC4_SNORM;
+        }
+
+        if (MAKEFOURCC( 'A', 'T', 'I', '2' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '5', 'U' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '5', 'S' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_BC5_SNORM;
+        }
+
+        // BC6H and BC7 are written using the "DX10" extended header
+
+        if (MAKEFOURCC( 'R', 'G', 'B', 'G' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_R8G8_B8G8_UNORM;
+        }
+        if (MAKEFOURCC( 'G', 'R', 'G', 'B' ) == ddpf.fourCC)
+        {
+            return DDS_FORMAT_G8R8_G8B8_UNORM;
+        }
+
+        if (MAKEFOURCC('Y','U','Y','2') == ddpf.fourCC)
+        {
+            return DDS_FORMAT_YUY2;
+        }
+
+        // Check for D3DFORMAT enums being set here
+        switch( ddpf.fourCC )
+        {
+        case 36: // D3DFMT_A16B16G16R16
+            return DDS_FORMAT_R16G16B16A16_UNORM;
+
+        case 110: // D3DFMT_Q16W16V16U16
+            return DDS_FORMAT_R16G16B16A16_SNORM;
+
+        case 111: // D3DFMT_R16F
+            return DDS_FORMAT_R16_FLOAT;
+
+        case 112: // D3DFMT_G16R16F
+            return DDS_FORMAT_R16G16_FLOAT;
+
+        case 113: // D3DFMT_A16B16G16R16F
+            return DDS_FORMAT_R16G16B16A16_FLOAT;
+
+        case 114: // D3DFMT_R32F
+            return DDS_FORMAT_R32_FLOAT;
+
+        case 115: // D3DFMT_G32R32F
+            return DDS_FORMAT_R32G32_FLOAT;
+
+        case 116: // D3DFMT_A32B32G32R32F
+            return DDS_FORMAT_R32G32B32A32_FLOAT;
+        }
+    }
+
+    return DDS_FORMAT_UNKNOWN;
+}
+
+#undef MAKEFOURCC
+#undef ISBITMASK
+
+size_t DDSParser::BitsPerPixel(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_R32G32B32A32_TYPELESS:
+    case DDS_FORMAT_R32G32B32A32_FLOAT:
+    case DDS_FORMAT_R32G32B32A32_UINT:
+    case DDS_FORMAT_R32G32B32A32_SINT:
+        return 128;
+
+    case DDS_FORMAT_R32G32B32_TYPELESS:
+    case DDS_FORMAT_R32G32B32_FLOAT:
+    case DDS_FORMAT_R32G32B32_UINT:
+    case DDS_FORMAT_R32G32B32_SINT:
+        return 96;
+
+    case DDS_FORMAT_R16G16B16A16_TYPELESS:
+    case DDS_FORMAT_R16G16B16A16_FLOAT:
+    case DDS_FORMAT_R16G16B16A16_UNORM:
+    case DDS_FORMAT_R16G16B16A16_UINT:
+    case DDS_FORMAT_R16G16B16A16_SNORM:
+    case DDS_FORMAT_R16G16B16A16_SINT:
+    case DDS_FORMAT_R32G32_TYPELESS:
+    case DDS_FORMAT_R32G32_FLOAT:
+    case DDS_FORMAT_R32G32_UINT:
+    case DDS_FORMAT_R32G32_SINT:
+    case DDS_FORMAT_R32G8X24_TYPELESS:
+    case DDS_FORMAT_D32_FLOAT_S8X24_UINT:
+    case DDS_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+    case DDS_FORMAT_X32_TYPELESS_G8X24_UINT:
+    case DDS_FORMAT_Y416:
+    case DDS_FORMAT_Y210:
+    case DDS_FORMAT_Y216:
+        return 64;
+
+    case DDS_FORMAT_R10G10B10A2_TYPELESS:
+    case DDS_FORMAT_R10G10B10A2_UNORM:
+    case DDS_FORMAT_R10G10B10A2_UINT:
+    case DDS_FORMAT_R11G11B10_FLOAT:
+    case DDS_FORMAT_R8G8B8A8_TYPELESS:
+    case DDS_FORMAT_R8G8B8A8_UNORM:
+    case DDS_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DDS_FORMAT_R8G8B8A8_UINT:
+    case DDS_FORMAT_R8G8B8A8_SNORM:
+    case DDS_FORMAT_R8G8B8A8_SINT:
+    case DDS_FORMAT_R16G16_TYPELESS:
+    case DDS_FORMAT_R16G16_FLOAT:
+    case DDS_FORMAT_R16G16_UNORM:
+    case DDS_FORMAT_R16G16_UINT:
+    case DDS_FORMAT_R16G16_SNORM:
+    case DDS_FORMAT_R16G16_SINT:
+    case DDS_FORMAT_R32_TYPELESS:
+    case DDS_FORMAT_D32_FLOAT:
+    case DDS_FORMAT_R32_FLOAT:
+    case DDS_FORMAT_R32_UINT:
+    case DDS_FORMAT_R32_SINT:
+    case DDS_FORMAT_R24G8_TYPELESS:
+    case DDS_FORMAT_D24_UNORM_S8_UINT:
+    case DDS_FORMAT_R24_UNORM_X8_TYPELESS:
+    case DDS_FORMAT_X24_TYPELESS_G8_UINT:
+    case DDS_FORMAT_R9G9B9E5_SHAREDEXP:
+    case DDS_FORMAT_R8G8_B8G8_UNORM:
+    case DDS_FORMAT_G8R8_G8B8_UNORM:
+    case DDS_FORMAT_B8G8R8A8_UNORM:
+    case DDS_FORMAT_B8G8R8X8_UNORM:
+    case DDS_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+    case DDS_FORMAT_B8G8R8A8_TYPELESS:
+    case DDS_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DDS_FORMAT_B8G8R8X8_TYPELESS:
+    case DDS_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DDS_FORMAT_AYUV:
+    case DDS_FORMAT_Y410:
+    case DDS_FORMAT_YUY2:
+        return 32;
+
+    case DDS_FORMAT_P010:
+    case DDS_FORMAT_P016:
+        return 24;
+
+    case DDS_FORMAT_R8G8_TYPELESS:
+    case DDS_FORMAT_R8G8_UNORM:
+    case DDS_FORMAT_R8G8_UINT:
+    case DDS_FORMAT_R8G8_SNORM:
+    case DDS_FORMAT_R8G8_SINT:
+    case DDS_FORMAT_R16_TYPELESS:
+    case DDS_FORMAT_R16_FLOAT:
+    case DDS_FORMAT_D16_UNORM:
+    case DDS_FORMAT_R16_UNORM:
+    case DDS_FORMAT_R16_UINT:
+    case DDS_FORMAT_R16_SNORM:
+    case DDS_FORMAT_R16_SINT:
+    case DDS_FORMAT_B5G6R5_UNORM:
+    case DDS_FORMAT_B5G5R5A1_UNORM:
+    case DDS_FORMAT_A8P8:
+    case DDS_FORMAT_B4G4R4A4_UNORM:
+        return 16;
+
+    case DDS_FORMAT_NV12:
+    case DDS_FORMAT_420_OPAQUE:
+    case DDS_FORMAT_NV11:
+        return 12;
+
+    case DDS_FORMAT_R8_TYPELESS:
+    case DDS_FORMAT_R8_UNORM:
+    case DDS_FORMAT_R8_UINT:
+    case DDS_FORMAT_R8_SNORM:
+    case DDS_FORMAT_R8_SINT:
+    case DDS_FORMAT_A8_UNORM:
+    case DDS_FORMAT_AI44:
+    case DDS_FORMAT_IA44:
+    case DDS_FORMAT_P8:
+        return 8;
+
+    case DDS_FORMAT_R1_UNORM:
+        return 1;
+
+    case DDS_FORMAT_BC1_TYPELESS:
+    case DDS_FORMAT_BC1_UNORM:
+    case DDS_FORMAT_BC1_UNORM_SRGB:
+    case DDS_FORMAT_BC4_TYPELESS:
+    case DDS_FORMAT_BC4_UNORM:
+    case DDS_FORMAT_BC4_SNORM:
+        return 4;
+
+    case DDS_FORMAT_BC2_TYPELESS:
+    case DDS_FORMAT_BC2_UNORM:
+    case DDS_FORMAT_BC2_UNORM_SRGB:
+    case DDS_FORMAT_BC3_TYPELESS:
+    case DDS_FORMAT_BC3_UNORM:
+    case DDS_FORMAT_BC3_UNORM_SRGB:
+    case DDS_FORMAT_BC5_TYPELESS:
+    case DDS_FORMAT_BC5_UNORM:
+    case DDS_FORMAT_BC5_SNORM:
+    case DDS_FORMAT_BC6H_TYPELESS:
+    case DDS_FORMAT_BC6H_UF16:
+    case DDS_FORMAT_BC6H_SF16:
+    case DDS_FORMAT_BC7_TYPELESS:
+    case DDS_FORMAT_BC7_UNORM:
+    case DDS_FORMAT_BC7_UNORM_SRGB:
+        return 8;
+
+    default:
+        return 0;
+    }
+}
+
+bool DDSParser::IsCompressed(DDSFormat format)
+{
+    return (format >= DDS_FORMAT_BC1_TYPELESS && format <= DDS_FORMAT_BC5_SNORM) ||
+        (format >= DDS_FORMAT_BC6H_TYPELESS && format <= DDS_FORMAT_BC7_UNORM_SRGB);
+}
+
+void DDSParser::GetSurfaceInfo(size_t width, size_t height, DDSFormat format, size_t* outNumBytes, size_t* outRowBytes, size_t* outNumRows)
+{
+    size_t numBytes = 0;
+    size_t rowBytes = 0;
+    size_t numRows = 0;
+
+    bool bc = false;
+    bool packed = false;
+    bool planar = false;
+    size_t bpe = 0;
+    switch (format)
+    {
+    case DDS_FORMAT_BC1_TYPELESS:
+    case DDS_FORMAT_BC1_UNORM:
+    case DDS_FORMAT_BC1_UNORM_SRGB:
+    case DDS_FORMAT_BC4_TYPELESS:
+    case DDS_FORMAT_BC4_UNORM:
+    case DDS_FORMAT_BC4_SNORM:
+        bc = true;
+        bpe = 8;
+        break;
+
+    case DDS_FORMAT_BC2_TYPELESS:
+    case DDS_FORMAT_BC2_UNORM:
+    case DDS_FORMAT_BC2_UNORM_SRGB:
+    case DDS_FORMAT_BC3_TYPELESS:
+    case DDS_FORMAT_BC3_UNORM:
+    case DDS_FORMAT_BC3_UNORM_SRGB:
+    case DDS_FORMAT_BC5_TYPELESS:
+    case DDS_FORMAT_BC5_UNORM:
+    case DDS_FORMAT_BC5_SNORM:
+    case DDS_FORMAT_BC6H_TYPELESS:
+    case DDS_FORMAT_BC6H_UF16:
+    case DDS_FORMAT_BC6H_SF16:
+    case DDS_FORMAT_BC7_TYPELESS:
+    case DDS_FORMAT_BC7_UNORM:
+    case DDS_FORMAT_BC7_UNORM_SRGB:
+        bc = true;
+        bpe = 16;
+        break;
+
+    case DDS_FORMAT_R8G8_B8G8_UNORM:
+    case DDS_FORMAT_G8R8_G8B8_UNORM:
+    case DDS_FORMAT_YUY2:
+        packed = true;
+        bpe = 4;
+        break;
+
+    case DDS_FORMAT_Y210:
+    case DDS_FORMAT_Y216:
+        packed = true;
+        bpe = 8;
+        break;
+
+    case DDS_FORMAT_NV12:
+    case DDS_FORMAT_420_OPAQUE:
+        planar = true;
+        bpe = 2;
+        break;
+
+    case DDS_FORMAT_P010:
+    case DDS_FORMAT_P016:
+        planar = true;
+        bpe = 4;
+        break;
+
+    default:
+        break;
+    }
+
+    if (bc)
+    {
+        size_t numBlocksWide = 0;
+        if (width > 0)
+        {
+            numBlocksWide = std::max<size_t>( 1, (width + 3) / 4 );
+        }
+        size_t numBlocksHigh = 0;
+        if (height > 0)
+        {
+            numBlocksHigh = std::max<size_t>( 1, (height + 3) / 4 );
+        }
+        rowBytes = numBlocksWide * bpe;
+        numRows = numBlocksHigh;
+        numBytes = rowBytes * numBlocksHigh;
+    }
+    else if (packed)
+    {
+        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
+        numRows = height;
+        numBytes = rowBytes * height;
+    }
+    else if ( format == DDS_FORMAT_NV11 )
+    {
+        rowBytes = ( ( width + 3 ) >> 2 ) * 4;
+        numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+        numBytes = rowBytes * numRows;
+    }
+    else if (planar)
+    {
+        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
+        numBytes = ( rowBytes * height ) + ( ( rowBytes * height + 1 ) >> 1 );
+        numRows = height + ( ( height + 1 ) >> 1 );
+    }
+    else
+    {
+        size_t bpp = BitsPerPixel( format );
+        rowBytes = ( width * bpp + 7 ) / 8; // round up to nearest byte
+        numRows = height;
+        numBytes = rowBytes * height;
+    }
+
+    if (outNumBytes)
+    {
+        *outNumBytes = numBytes;
+    }
+    if (outRowBytes)
+    {
+        *outRowBytes = rowBytes;
+    }
+    if (outNumRows)
+    {
+        *outNumRows = numRows;
+    }
+}
+
+DDSFormat DDSParser::MakeSRGB(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_R8G8B8A8_UNORM:
+        return DDS_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+    case DDS_FORMAT_BC1_UNORM:
+        return DDS_FORMAT_BC1_UNORM_SRGB;
+
+    case DDS_FORMAT_BC2_UNORM:
+        return DDS_FORMAT_BC2_UNORM_SRGB;
+
+    case DDS_FORMAT_BC3_UNORM:
+        return DDS_FORMAT_BC3_UNORM_SRGB;
+
+    case DDS_FORMAT_B8G8R8A8_UNORM:
+        return DDS_FORMAT_B8G8R8A8_UNORM_SRGB;
+
+    case DDS_FORMAT_B8G8R8X8_UNORM:
+        return DDS_FORMAT_B8G8R8X8_UNORM_SRGB;
+
+    case DDS_FORMAT_BC7_UNORM:
+        return DDS_FORMAT_BC7_UNORM_SRGB;
+
+    default:
+        return format;
+    }
+}
+
+bool DDSParser::IsSRGB(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DDS_FORMAT_BC1_UNORM_SRGB:
+    case DDS_FORMAT_BC2_UNORM_SRGB:
+    case DDS_FORMAT_BC3_UNORM_SRGB:
+    case DDS_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DDS_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DDS_FORMAT_BC7_UNORM_SRGB:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static DDSAlphaMode GetAlphaMode(const DDS_HEADER* header, const DDS_HEADER_DXT10* extension)
+{
+    if (extension)
+    {
+        uint32_t mode = extension->miscFlags2 & DDS_MISC_FLAGS2_ALPHA_MODE_MASK;
+        if (mode >= DDS_ALPHA_STRAIGHT && mode <= DDS_ALPHA_CUSTOM) return (DDSAlphaMode)mode;
+    }
+    else if ((header->ddspf.flags & DDS_FOURCC) &&
+        (DDS_MAKEFOURCC('D', 'X', 'T', '2') == header->ddspf.fourCC || DDS_MAKEFOURCC('D', 'X', 'T', '4') == header->ddspf.fourCC))
+    {
+        return DDS_ALPHA_PREMULTIPLIED;
+    }
+
+    return DDS_ALPHA_UNKNOWN;
+}
+
+DDSResult DDSParser::Parse(const uint8_t* data, size_t size, DDSTextureDesc& desc)
+{
+    desc = DDSTextureDesc();
+
+    if (!data || size < sizeof(uint32_t) + sizeof(DDS_HEADER)) return DDS_ERROR_NOT_DDS;
+    if (*(const uint32_t*)data != DDS_MAGIC) return DDS_ERROR_NOT_DDS;
+
+    const DDS_HEADER* header = (const DDS_HEADER*)(data + sizeof(uint32_t));
+    if (header->size != sizeof(DDS_HEADER) || header->ddspf.size != sizeof(DDS_PIXELFORMAT)) return DDS_ERROR_NOT_DDS;
+
+    //The DX10 extension follows the header and says the format outright
+    const DDS_HEADER_DXT10* extension = nullptr;
+    if ((header->ddspf.flags & DDS_FOURCC) && DDS_MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC)
+    {
+        if (size < sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)) return DDS_ERROR_NOT_DDS;
+        extension = (const DDS_HEADER_DXT10*)(data + sizeof(uint32_t) + sizeof(DDS_HEADER));
+    }
+
+    size_t width = header->width;
+    size_t height = header->height;
+    size_t depth = header->depth;
+    size_t arraySize = 1;
+    size_t mipCount = std::max<size_t>(header->mipMapCount, 1);
+    DDSDimension dimension = DDS_DIMENSION_UNKNOWN;
+    DDSFormat format = DDS_FORMAT_UNKNOWN;
+    bool isCubeMap = false;
+
+    if (extension)
+    {
+        arraySize = extension->arraySize;
+        if (arraySize == 0) return DDS_ERROR_INVALID_DATA;
+
+        //Palette formats have no D3D11 equivalent, anything past the last known format is rejected the same way
+        format = (DDSFormat)extension->dxgiFormat;
+        switch (format)
+        {
+        case DDS_FORMAT_AI44:
+        case DDS_FORMAT_IA44:
+        case DDS_FORMAT_P8:
+        case DDS_FORMAT_A8P8:
+            return DDS_ERROR_NOT_SUPPORTED;
+
+        default:
+            if (BitsPerPixel(format) == 0) return DDS_ERROR_NOT_SUPPORTED;
+        }
+
+        switch (extension->resourceDimension)
+        {
+        case DDS_DIMENSION_TEXTURE1D:
+            //D3DX writes 1D textures with a fixed Height of 1
+            if ((header->flags & DDS_HEIGHT) && height != 1) return DDS_ERROR_INVALID_DATA;
+            height = depth = 1;
+            break;
+
+        case DDS_DIMENSION_TEXTURE2D:
+            if (extension->miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE)
+            {
+                arraySize *= 6;
+                isCubeMap = true;
+            }
+            depth = 1;
+            break;
+
+        case DDS_DIMENSION_TEXTURE3D:
+            if (!(header->flags & DDS_HEADER_FLAGS_VOLUME)) return DDS_ERROR_INVALID_DATA;
+            if (arraySize > 1) return DDS_ERROR_NOT_SUPPORTED;
+            break;
+
+        default:
+            return DDS_ERROR_NOT_SUPPORTED;
+        }
+
+        dimension = (DDSDimension)extension->resourceDimension;
+    }
+    else
+    {
+        format = GetFormat(header->ddspf);
+        if (format == DDS_FORMAT_UNKNOWN) return DDS_ERROR_NOT_SUPPORTED;
+
+        if (header->flags & DDS_HEADER_FLAGS_VOLUME)
+        {
+            dimension = DDS_DIMENSION_TEXTURE3D;
+        }
+        else
+        {
+            if (header->caps2 & DDS_CUBEMAP)
+            {
+                //All six faces have to be there
+                if ((header->caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES) return DDS_ERROR_NOT_SUPPORTED;
+
+                arraySize = 6;
+                isCubeMap = true;
+            }
+
+            //There's no way for a legacy header to say 1D
+            depth = 1;
+            dimension = DDS_DIMENSION_TEXTURE2D;
+        }
+    }
+
+    if (mipCount > DDS_MAX_MIP_LEVELS) return DDS_ERROR_NOT_SUPPORTED;
+
+    //D3D11 won't create a texture with no texels, and a layout of empty mips is no use to anything else either
+    if (width == 0 || height == 0 || depth == 0) return DDS_ERROR_INVALID_DATA;
+
+    switch (dimension)
+    {
+    case DDS_DIMENSION_TEXTURE1D:
+        if (arraySize > DDS_MAX_TEXTURE1D_ARRAY || width > DDS_MAX_TEXTURE1D_SIZE) return DDS_ERROR_NOT_SUPPORTED;
+        break;
+
+    case DDS_DIMENSION_TEXTURE2D:
+        //arraySize is already NumCubes * 6 for cube maps, so the same array bound applies
+        if (arraySize > DDS_MAX_TEXTURE2D_ARRAY) return DDS_ERROR_NOT_SUPPORTED;
+        if (isCubeMap && (width > DDS_MAX_TEXTURECUBE_SIZE || height > DDS_MAX_TEXTURECUBE_SIZE)) return DDS_ERROR_NOT_SUPPORTED;
+        if (!isCubeMap && (width > DDS_MAX_TEXTURE2D_SIZE || height > DDS_MAX_TEXTURE2D_SIZE)) return DDS_ERROR_NOT_SUPPORTED;
+        break;
+
+    case DDS_DIMENSION_TEXTURE3D:
+        if (arraySize > 1 || width > DDS_MAX_TEXTURE3D_SIZE || height > DDS_MAX_TEXTURE3D_SIZE || depth > DDS_MAX_TEXTURE3D_SIZE) return DDS_ERROR_NOT_SUPPORTED;
+        break;
+
+    default:
+        return DDS_ERROR_NOT_SUPPORTED;
+    }
+
+    desc.Dimension = dimension;
+    desc.Format = format;
+    desc.Width = (uint32_t)width;
+    desc.Height = (uint32_t)height;
+    desc.Depth = (uint32_t)depth;
+    desc.MipCount = (uint32_t)mipCount;
+    desc.ArraySize = (uint32_t)arraySize;
+    desc.IsCubeMap = isCubeMap;
+    desc.AlphaMode = GetAlphaMode(header, extension);
+    desc.DataOffset = sizeof(uint32_t) + sizeof(DDS_HEADER) + (extension ? sizeof(DDS_HEADER_DXT10) : 0);
+    desc.DataSize = size - desc.DataOffset;
+
+    return DDS_OK;
+}
+
+DDSResult DDSParser::GetLayout(const DDSTextureDesc& desc, size_t maxSize, DDSLayout& layout)
+{
+    layout = DDSLayout();
+    layout.Subresources.reserve((size_t)desc.MipCount * desc.ArraySize);
+
+    size_t offset = 0;
+    for (uint32_t item = 0; item < desc.ArraySize; item++)
+    {
+        size_t width = desc.Width;
+        size_t height = desc.Height;
+        size_t depth = desc.Depth;
+        for (uint32_t mip = 0; mip < desc.MipCount; mip++)
+        {
+            size_t numBytes = 0;
+            size_t rowBytes = 0;
+            GetSurfaceInfo(width, height, desc.Format, &numBytes, &rowBytes, nullptr);
+
+            if (desc.MipCount <= 1 || !maxSize || (width <= maxSize && height <= maxSize && depth <= maxSize))
+            {
+                if (!layout.Width)
+                {
+                    layout.Width = (uint32_t)width;
+                    layout.Height = (uint32_t)height;
+                    layout.Depth = (uint32_t)depth;
+                }
+
+                layout.Subresources.push_back({ desc.DataOffset + offset, numBytes * depth, rowBytes, numBytes, (uint32_t)width, (uint32_t)height });
+                layout.Bytes += numBytes * depth;
+            }
+            else if (item == 0)
+            {
+                //Only counted on the first item, every item skips the same ones
+                layout.SkippedMips++;
+            }
+
+            //Compared against what is left rather than by moving a pointer past the end
+            if (numBytes * depth > desc.DataSize - offset) return DDS_ERROR_TRUNCATED;
+            offset += numBytes * depth;
+
+            width = std::max<size_t>(width >> 1, 1);
+            height = std::max<size_t>(height >> 1, 1);
+            depth = std::max<size_t>(depth >> 1, 1);
+        }
+    }
+
+    layout.MipCount = desc.MipCount - layout.SkippedMips;
+    return layout.Subresources.empty() ? DDS_ERROR_NO_MIPS : DDS_OK;
+}
+
+size_t DDSParser::WriteHeader(const DDSTextureDesc& desc, std::vector<uint8_t>& output)
+{
+    DDS_HEADER header = {};
+    header.size = sizeof(DDS_HEADER);
+    header.flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_LINEARSIZE;
+    header.height = desc.Height;
+    header.width = desc.Width;
+    header.depth = desc.Dimension == DDS_DIMENSION_TEXTURE3D ? desc.Depth : 0;
+    header.mipMapCount = desc.MipCount;
+    header.caps = DDS_SURFACE_FLAGS_TEXTURE;
+    header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+    header.ddspf.flags = DDS_FOURCC;
+    header.ddspf.fourCC = DDS_MAKEFOURCC('D', 'X', '1', '0');
+
+    size_t numBytes = 0;
+    GetSurfaceInfo(desc.Width, desc.Height, desc.Format, &numBytes, nullptr, nullptr);
+    header.pitchOrLinearSize = (uint32_t)numBytes;
+
+    if (desc.MipCount > 1)
+    {
+        header.flags |= DDS_HEADER_FLAGS_MIPMAP;
+        header.caps |= DDS_SURFACE_FLAGS_MIPMAP;
+    }
+    if (desc.Dimension == DDS_DIMENSION_TEXTURE3D) header.flags |= DDS_HEADER_FLAGS_VOLUME;
+    if (desc.IsCubeMap)
+    {
+        header.caps |= DDS_SURFACE_FLAGS_CUBEMAP;
+        header.caps2 = DDS_CUBEMAP_ALLFACES;
+    }
+
+    //The extension counts cubes rather than faces
+    DDS_HEADER_DXT10 extension = {};
+    extension.dxgiFormat = desc.Format;
+    extension.resourceDimension = desc.Dimension;
+    extension.miscFlag = desc.IsCubeMap ? DDS_RESOURCE_MISC_TEXTURECUBE : 0;
+    extension.arraySize = desc.IsCubeMap ? desc.ArraySize / 6 : desc.ArraySize;
+    extension.miscFlags2 = desc.AlphaMode & DDS_MISC_FLAGS2_ALPHA_MODE_MASK;
+
+    const uint8_t* parts[] = { (const uint8_t*)&DDS_MAGIC, (const uint8_t*)&header, (const uint8_t*)&extension };
+    const size_t sizes[] = { sizeof(DDS_MAGIC), sizeof(header), sizeof(extension) };
+    for (int i = 0; i < 3; i++) output.insert(output.end(), parts[i], parts[i] + sizes[i]);
+
+    return output.size();
+}
+
+const char* DDSParser::GetResultName(DDSResult result)
+{
+    switch (result)
+    {
+    case DDS_OK: return "ok";
+    case DDS_ERROR_NOT_DDS: return "not a DDS file";
+    case DDS_ERROR_INVALID_DATA: return "invalid header";
+    case DDS_ERROR_NOT_SUPPORTED: return "not supported";
+    case DDS_ERROR_TRUNCATED: return "truncated";
+    case DDS_ERROR_NO_MIPS: return "no mips under the size limit";
+    }
+    return "unknown";
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+//The same numbers as DXGI_FORMAT so a parsed format casts straight across, without needing the D3D headers to parse
+enum DDSFormat : uint32_t
+{
+	DDS_FORMAT_UNKNOWN = 0,
+	DDS_FORMAT_R32G32B32A32_TYPELESS = 1,
+	DDS_FORMAT_R32G32B32A32_FLOAT = 2,
+	DDS_FORMAT_R32G32B32A32_UINT = 3,
+	DDS_FORMAT_R32G32B32A32_SINT = 4,
+	DDS_FORMAT_R32G32B32_TYPELESS = 5,
+	DDS_FORMAT_R32G32B32_FLOAT = 6,
+	DDS_FORMAT_R32G32B32_UINT = 7,
+	DDS_FORMAT_R32G32B32_SINT = 8,
+	DDS_FORMAT_R16G16B16A16_TYPELESS = 9,
+	DDS_FORMAT_R16G16B16A16_FLOAT = 10,
+	DDS_FORMAT_R16G16B16A16_UNORM = 11,
+	DDS_FORMAT_R16G16B16A16_UINT = 12,
+	DDS_FORMAT_R16G16B16A16_SNORM = 13,
+	DDS_FORMAT_R16G16B16A16_SINT = 14,
+	DDS_FORMAT_R32G32_TYPELESS = 15,
+	DDS_FORMAT_R32G32_FLOAT = 16,
+	DDS_FORMAT_R32G32_UINT = 17,
+	DDS_FORMAT_R32G32_SINT = 18,
+	DDS_FORMAT_R32G8X24_TYPELESS = 19,
+	DDS_FORMAT_D32_FLOAT_S8X24_UINT = 20,
+	DDS_FORMAT_R32_FLOAT_X8X24_TYPELESS = 21,
+	DDS_FORMAT_X32_TYPELESS_G8X24_UINT = 22,
+	DDS_FORMAT_R10G10B10A2_TYPELESS = 23,
+	DDS_FORMAT_R10G10B10A2_UNORM = 24,
+	DDS_FORMAT_R10G10B10A2_UINT = 25,
+	DDS_FORMAT_R11G11B10_FLOAT = 26,
+	DDS_FORMAT_R8G8B8A8_TYPELESS = 27,
+	DDS_FORMAT_R8G8B8A8_UNORM = 28,
+	DDS_FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+	DDS_FORMAT_R8G8B8A8_UINT = 30,
+	DDS_FORMAT_R8G8B8A8_SNORM = 31,
+	DDS_FORMAT_R8G8B8A8_SINT = 32,
+	DDS_FORMAT_R16G16_TYPELESS = 33,
+	DDS_FORMAT_R16G16_FLOAT = 34,
+	DDS_FORMAT_R16G16_UNORM = 35,
+	DDS_FORMAT_R16G16_UINT = 36,
+	DDS_FORMAT_R16G16_SNORM = 37,
+	DDS_FORMAT_R16G16_SINT = 38,
+	DDS_FORMAT_R32_TYPELESS = 39,
+	DDS_FORMAT_D32_FLOAT = 40,
+	DDS_FORMAT_R32_FLOAT = 41,
+	DDS_FORMAT_R32_UINT = 42,
+	DDS_FORMAT_R32_SINT = 43,
+	DDS_FORMAT_R24G8_TYPELESS = 44,
+	DDS_FORMAT_D24_UNORM_S8_UINT = 45,
+	DDS_FORMAT_R24_UNORM_X8_TYPELESS = 46,
+	DDS_FORMAT_X24_TYPELESS_G8_UINT = 47,
+	DDS_FORMAT_R8G8_TYPELESS = 48,
+	DDS_FORMAT_R8G8_UNORM = 49,
+	DDS_FORMAT_R8G8_UINT = 50,
+	DDS_FORMAT_R8G8_SNORM = 51,
+	DDS_FORMAT_R8G8_SINT = 52,
+	DDS_FORMAT_R16_TYPELESS = 53,
+	DDS_FORMAT_R16_FLOAT = 54,
+	DDS_FORMAT_D16_UNORM = 55,
+	DDS_FORMAT_R16_UNORM = 56,
+	DDS_FORMAT_R16_UINT = 57,
+	DDS_FORMAT_R16_SNORM = 58,
+	DDS_FORMAT_R16_SINT = 59,
+	DDS_FORMAT_R8_TYPELESS = 60,
+	DDS_FORMAT_R8_UNORM = 61,
+	DDS_FORMAT_R8_UINT = 62,
+	DDS_FORMAT_R8_SNORM = 63,
+	DDS_FORMAT_R8_SINT = 64,
+	DDS_FORMAT_A8_UNORM = 65,
+	DDS_FORMAT_R1_UNORM = 66,
+	DDS_FORMAT_R9G9B9E5_SHAREDEXP = 67,
+	DDS_FORMAT_R8G8_B8G8_UNORM = 68,
+	DDS_FORMAT_G8R8_G8B8_UNORM = 69,
+	DDS_FORMAT_BC1_TYPELESS = 70,
+	DDS_FORMAT_BC1_UNORM = 71,
+	DDS_FORMAT_BC1_UNORM_SRGB = 72,
+	DDS_FORMAT_BC2_TYPELESS = 73,
+	DDS_FORMAT_BC2_UNORM = 74,
+	DDS_FORMAT_BC2_UNORM_SRGB = 75,
+	DDS_FORMAT_BC3_TYPELESS = 76,
+	DDS_FORMAT_BC3_UNORM = 77,
+	DDS_FORMAT_BC3_UNORM_SRGB = 78,
+	DDS_FORMAT_BC4_TYPELESS = 79,
+	DDS_FORMAT_BC4_UNORM = 80,
+	DDS_FORMAT_BC4_SNORM = 81,
+	DDS_FORMAT_BC5_TYPELESS = 82,
+	DDS_FORMAT_BC5_UNORM = 83,
+	DDS_FORMAT_BC5_SNORM = 84,
+	DDS_FORMAT_B5G6R5_UNORM = 85,
+	DDS_FORMAT_B5G5R5A1_UNORM = 86,
+	DDS_FORMAT_B8G8R8A8_UNORM = 87,
+	DDS_FORMAT_B8G8R8X8_UNORM = 88,
+	DDS_FORMAT_R10G10B10_XR_BIAS_A2_UNORM = 89,
+	DDS_FORMAT_B8G8R8A8_TYPELESS = 90,
+	DDS_FORMAT_B8G8R8A8_UNORM_SRGB = 91,
+	DDS_FORMAT_B8G8R8X8_TYPELESS = 92,
+	DDS_FORMAT_B8G8R8X8_UNORM_SRGB = 93,
+	DDS_FORMAT_BC6H_TYPELESS = 94,
+	DDS_FORMAT_BC6H_UF16 = 95,
+	DDS_FORMAT_BC6H_SF16 = 96,
+	DDS_FORMAT_BC7_TYPELESS = 97,
+	DDS_FORMAT_BC7_UNORM = 98,
+	DDS_FORMAT_BC7_UNORM_SRGB = 99,
+	DDS_FORMAT_AYUV = 100,
+	DDS_FORMAT_Y410 = 101,
+	DDS_FORMAT_Y416 = 102,
+	DDS_FORMAT_NV12 = 103,
+	DDS_FORMAT_P010 = 104,
+	DDS_FORMAT_P016 = 105,
+	DDS_FORMAT_420_OPAQUE = 106,
+	DDS_FORMAT_YUY2 = 107,
+	DDS_FORMAT_Y210 = 108,
+	DDS_FORMAT_Y216 = 109,
+	DDS_FORMAT_NV11 = 110,
+	DDS_FORMAT_AI44 = 111,
+	DDS_FORMAT_IA44 = 112,
+	DDS_FORMAT_P8 = 113,
+	DDS_FORMAT_A8P8 = 114,
+	DDS_FORMAT_B4G4R4A4_UNORM = 115,
+};
+
+//The same numbers as D3D11_RESOURCE_DIMENSION
+enum DDSDimension : uint32_t
+{
+	DDS_DIMENSION_UNKNOWN = 0,
+	DDS_DIMENSION_TEXTURE1D = 2,
+	DDS_DIMENSION_TEXTURE2D = 3,
+	DDS_DIMENSION_TEXTURE3D = 4
+};
+
+//The same numbers as DirectX::DDS_ALPHA_MODE
+enum DDSAlphaMode : uint32_t
+{
+	DDS_ALPHA_UNKNOWN = 0,
+	DDS_ALPHA_STRAIGHT = 1,
+	DDS_ALPHA_PREMULTIPLIED = 2,
+	DDS_ALPHA_OPAQUE = 3,
+	DDS_ALPHA_CUSTOM = 4
+};
+
+enum DDSResult
+{
+	DDS_OK,
+	DDS_ERROR_NOT_DDS,       //Too short, wrong magic number or header sizes
+	DDS_ERROR_INVALID_DATA,  //A DDS, but the header contradicts itself
+	DDS_ERROR_NOT_SUPPORTED, //Format or size D3D11 can't create
+	DDS_ERROR_TRUNCATED,     //Header asks for more pixel data than the file has
+	DDS_ERROR_NO_MIPS        //Every mip was over the size limit
+};
+
+//What a DDS file says it holds, from the headers alone
+struct DDSTextureDesc
+{
+	DDSDimension Dimension = DDS_DIMENSION_UNKNOWN;
+	DDSFormat Format = DDS_FORMAT_UNKNOWN;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t Depth = 0;
+	uint32_t MipCount = 0;
+	uint32_t ArraySize = 0; //Faces included, so a cube map is 6
+	bool IsCubeMap = false;
+	DDSAlphaMode AlphaMode = DDS_ALPHA_UNKNOWN;
+	size_t DataOffset = 0;  //Where the pixel data starts in the file
+	size_t DataSize = 0;
+};
+
+//One mip of one array item, all of its depth slices
+struct DDSSubresource
+{
+	size_t Offset; //From the start of the file
+	size_t Size;
+	size_t RowPitch;
+	size_t SlicePitch;
+	uint32_t Width;  //Of this mip, in pixels rather than blocks
+	uint32_t Height;
+};
+
+//Which mips are kept under a size limit and where each one's bytes are
+struct DDSLayout
+{
+	uint32_t Width = 0; //Of the largest mip kept
+	uint32_t Height = 0;
+	uint32_t Depth = 0;
+	uint32_t MipCount = 0;
+	uint32_t SkippedMips = 0;
+	std::vector<DDSSubresource> Subresources; //Item by item, mips in order within each, which is how D3D numbers them
+	size_t Bytes = 0;                         //Total of the kept subresources
+};
+
+//Reads DDS headers and works out mip layouts without a device, so textures can be checked, budgeted and planned on
+//any thread (or any platform). Nothing here reads past the size it is given, whatever the file claims
+namespace DDSParser
+{
+	DDSResult Parse(const uint8_t* data, size_t size, DDSTextureDesc& desc);
+
+	//Mips larger than maxSize in any dimension are skipped, 0 keeps them all. A single mip texture is never skipped
+	DDSResult GetLayout(const DDSTextureDesc& desc, size_t maxSize, DDSLayout& layout);
+
+	size_t BitsPerPixel(DDSFormat format);
+	bool IsCompressed(DDSFormat format);
+	void GetSurfaceInfo(size_t width, size_t height, DDSFormat format, size_t* numBytes, size_t* rowBytes, size_t* numRows);
+	DDSFormat MakeSRGB(DDSFormat format);
+	bool IsSRGB(DDSFormat format);
+
+	//Appends the magic number and headers for desc to output, always with the DX10 extension, and returns where the
+	//pixel data has to start. Subresources then follow in the order GetLayout gives them
+	size_t WriteHeader(const DDSTextureDesc& desc, std::vector<uint8_t>& output);
+
+	const char* GetResultName(DDSResult result);
+};
@@ -6,6 +6,7 @@
 
 #include "Structures.h"
 #include <array>
+#include <unordered_set>
 
 #include <codecvt>
 #include <locale>
@@ -14,16 +15,44 @@
 using json = nlohmann::json;
 //#define RETURNFAIL(x) if(FAILED(x)) return x;
 
+//Turns the feature bits of a permutation into the defines SimpleShaders.hlsl expects, null terminated for D3DCompile
+static void BuildPermutationDefines(PermutationKey key, D3D_SHADER_MACRO defines[SHADER_FEATURE_COUNT + 1])
+{
+    for (int i = 0; i < SHADER_FEATURE_COUNT; i++)
+    {
+        defines[i].Name = GetPermutationDefine(i);
+        defines[i].Definition = (key & (1 << i)) ? "1" : "0";
+    }
+    defines[SHADER_FEATURE_COUNT] = { nullptr, nullptr };
+}
+
+static bool IsTextureArray(ID3D11ShaderResourceView* texture)
+{
+    D3D11_SHADER_RESOURCE_VIEW_DESC desc;
+    texture->GetDesc(&desc);
+    return desc.ViewDimension == D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+}
+
+//Sort keys only need the same texture/mesh to land on the same bits, so the pointer itself is close enough
+static uint32_t PointerSortBits(const void* pointer)
+{
+    return (uint32_t)((uintptr_t)pointer >> 4);
+}
+
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
     PAINTSTRUCT ps;
     HDC hdc;
 
+    //Set in CreateWindowHandle so the window can ask for a redraw when it is idling
+    DX11Framework* framework = reinterpret_cast<DX11Framework*>(GetWindowLongPtrW(hWnd, GWLP_USERDATA));
+
     switch (message)
     {
     case WM_PAINT:
         hdc = BeginPaint(hWnd, &ps);
         EndPaint(hWnd, &ps);
+        if (framework) framework->MarkSceneChanged();
         break;
 
     case WM_DESTROY:
@@ -37,11 +66,172 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     return 0;
 }
 
+bool DX11Framework::EnableBenchmark(const char* settingsFile)
+{
+    if (!_benchmark.LoadSettings(settingsFile)) return false;
+
+    _benchmarkMode = true;
+    _scenePath = _benchmark.GetScenePath();
+
+    //Benchmark frames always advance by the same amount so every run animates identically
+    _clock = &_simulatedClock;
+
+    return true;
+}
+
+int DX11Framework::RunBenchmark()
+{
+    MSG msg = { 0 };
+
+    _benchmark.RunJobSystemBenchmarks(_jobSystem);
+    _benchmark.RunSceneLoadBenchmarks(_device, _jobSystem);
+    _benchmark.RunTextureLoadBenchmarks(_device);
+    _benchmark.RunTextureDecodeBenchmarks(_jobSystem);
+    _benchmark.RunMipGenerationBenchmarks(_jobSystem);
+    _benchmark.RunTextureStreamingBenchmarks();
+    _benchmark.RunTexturePackBenchmarks(_jobSystem);
+    _benchmark.RunAssetArchiveBenchmarks(_jobSystem);
+    _benchmark.RunSceneFileBenchmarks();
+    _benchmark.RunSceneStreamBenchmarks();
+    _benchmark.RunTransformBenchmarks(_jobSystem);
+    _benchmark.RunSceneGraphBenchmarks(_jobSystem);
+    RunScalingBenchmark();
+
+    for (_benchmarkFrame = 0; _benchmarkFrame < _benchmark.GetFrameCount(); _benchmarkFrame++)
+    {
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+
+        //Camera follows the recorded path instead of the keyboard
+        XMFLOAT3 eye;
+        XMFLOAT3 direction;
+        _benchmark.SampleCameraPath(_benchmarkFrame * _benchmark.GetFrameTime(), eye, direction);
+        _lookCamera.SetLook(XMLoadFloat3(&eye), XMLoadFloat3(&direction));
+        CameraUpdate(6);
+
+        _simulatedClock.Advance(_benchmark.GetFrameTime());
+
+        RunFrame();
+        _benchmark.RecordFrame(_frameTimer.GetTiming());
+    }
+
+    _benchmark.WriteResults();
+
+    return _benchmark.GetFailedCaptures() == 0 && _benchmark.GetFailedStreamingChecks() == 0 ? 0 : 1;
+}
+
+void DX11Framework::RunScalingBenchmark()
+{
+    StressSceneSettings settings = _benchmark.GetScalingScene();
+    StressScene::FindAssets(settings);
+
+    //The benchmark scene's objects stay in the store and get drawn along with each generated scene, two objects
+    //make no difference to the numbers. Its entries and camera go back afterwards so the captures still match
+    std::vector<SceneEntry> benchmarkEntries;
+    benchmarkEntries.swap(_sceneEntries);
+    XMVECTOR benchmarkEye = _lookCamera.GetEye();
+    XMVECTOR benchmarkDirection = _lookCamera.GetDirection();
+    _benchmarkFrame = -1; //Nothing drawn here is captured
+
+    for (int count : _benchmark.GetScalingCounts())
+    {
+        settings.ObjectCount = count;
+        if (!StressScene::Generate(settings)) break;
+
+        //Load, split into compiling the JSON, reading the compiled scene, making the objects and their assets arriving
+        std::string binaryPath = SceneCompiler::GetBinaryPath(settings.OutputPath);
+        double start = GetTimeMilliseconds();
+        if (!SceneCompiler::Compile(settings.OutputPath, binaryPath)) break;
+        _benchmark.RecordScaling(count, "Compile", (float)(GetTimeMilliseconds() - start));
+
+        SceneFile scene;
+        start = GetTimeMilliseconds();
+        if (!scene.LoadBinary(binaryPath)) break;
+        _benchmark.RecordScaling(count, "Read", (float)(GetTimeMilliseconds() - start));
+
+        start = GetTimeMilliseconds();
+        SceneEntries::Build(scene.GetObjects(), _sceneEntries);
+        for (SceneEntry& entry : _sceneEntries)
+        {
+            entry.Object = CreateGameObject(entry.GetDesc());
+        }
+        for (SceneEntry& entry : _sceneEntries)
+        {
+            if (entry.Parent != SCENE_NONE) gameobjects.SetParent(entry.Object, _sceneEntries[entry.Parent].Object);
+        }
+        _benchmark.RecordScaling(count, "Create", (float)(GetTimeMilliseconds() - start));
+
+        start = GetTimeMilliseconds();
+        _assetLoader.Start();
+        _assetLoader.Wait();
+        ApplyLoadedAssets();
+        _benchmark.RecordScaling(count, "Assets", (float)(GetTimeMilliseconds() - start));
+
+        //Looking down across the whole scene from one edge, so culling drops some of it but not all
+        float extent = StressScene::GetExtent(settings);
+        XMFLOAT3 eye(0.0f, extent, -extent * 1.5f);
+        XMFLOAT3 direction(0.0f, -0.5f, 0.866f);
+        _lookCamera.SetLook(XMLoadFloat3(&eye), XMLoadFloat3(&direction));
+        CameraUpdate(6);
+
+        //Every root turns each frame so the whole scene is rebuilt and propagated, not just copied into the snapshot.
+        //The clock isn't advanced, the benchmark's own frames still start from the same simulation time
+        FrameTiming total = {};
+        int frames = _benchmark.GetScalingFrames();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            for (const SceneEntry& entry : _sceneEntries)
+            {
+                if (entry.Parent == SCENE_NONE) gameobjects.SetRotation(entry.Object, entry.RotationY + frame * 0.01f);
+            }
+
+            RunFrame();
+            for (int s = 0; s < TIMER_COUNT; s++) total.Section[s] += _frameTimer.GetTiming().Section[s];
+        }
+
+        static const char* sectionStages[TIMER_COUNT] = { "Update", "Culling", "Sorting", "Submission", "Present" };
+        for (int s = 0; s < TIMER_COUNT && frames > 0; s++)
+        {
+            _benchmark.RecordScaling(count, sectionStages[s], total.Section[s] / frames);
+        }
+
+        for (const SceneEntry& entry : _sceneEntries)
+        {
+            DestroyGameObject(entry.Object);
+        }
+        _sceneEntries.clear();
+
+        //Two more frames and neither snapshot holds the destroyed objects, so their assets are released
+        RunFrame();
+        RunFrame();
+    }
+
+    _sceneEntries.swap(benchmarkEntries);
+    _lookCamera.SetLook(benchmarkEye, benchmarkDirection);
+    CameraUpdate(6);
+
+    //The benchmark's first frame has to start the way it would have without this, no snapshot and no step history
+    _snapshots.Reset();
+    _timestep.Reset();
+}
+
 HRESULT DX11Framework::Initialise(HINSTANCE hInstance, int nShowCmd)
 {
 
     HRESULT hr = S_OK;
 
+    //Benchmark always runs flat out, the pacing settings are only for interactive runs
+    if (!_benchmarkMode)
+    {
+        LoadSettings("JSON/settings.json");
+    }
+
+    //Workers are up before anything else so loaders and per-frame systems can hand work to them
+    _jobSystem.Initialise();
+
     hr = CreateWindowHandle(hInstance, nShowCmd);
     if (FAILED(hr)) return E_FAIL;
 
@@ -84,9 +274,21 @@ HRESULT DX11Framework::CreateWindowHandle(HINSTANCE hInstance, int nCmdShow)
 
     RegisterClassW(&wndClass);
 
-    _windowHandle = CreateWindowExW(0, windowName, windowName, WS_OVERLAPPEDWINDOW | WS_VISIBLE, CW_USEDEFAULT, CW_USEDEFAULT, 
+    //Benchmark runs headless so the window is never shown
+    DWORD windowStyle = _benchmarkMode ? WS_OVERLAPPEDWINDOW : WS_OVERLAPPEDWINDOW | WS_VISIBLE;
+
+    _windowHandle = CreateWindowExW(0, windowName, windowName, windowStyle, CW_USEDEFAULT, CW_USEDEFAULT, 
         _WindowWidth, _WindowHeight, nullptr, nullptr, hInstance, nullptr);
 
+    SetWindowLongPtrW(_windowHandle, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+
+    //High resolution timer (Windows 10 1803+) so pacing isn't stuck on the 15.6 ms scheduler tick, plain timer otherwise
+    _pacingTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!_pacingTimer)
+    {
+        _pacingTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+
     return S_OK;
 }
 
@@ -106,7 +308,10 @@ HRESULT DX11Framework::CreateD3DDevice()
 #ifdef _DEBUG
     createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
 #endif
-    hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, D3D11_CREATE_DEVICE_BGRA_SUPPORT | createDeviceFlags, featureLevels, ARRAYSIZE(featureLevels), D3D11_SDK_VERSION, &baseDevice, nullptr, &baseDeviceContext);
+    //WARP rasterizes the same on every machine so benchmark captures can be compared against golden images
+    D3D_DRIVER_TYPE driverType = _benchmarkMode ? D3D_DRIVER_TYPE_WARP : D3D_DRIVER_TYPE_HARDWARE;
+
+    hr = D3D11CreateDevice(nullptr, driverType, nullptr, D3D11_CREATE_DEVICE_BGRA_SUPPORT | createDeviceFlags, featureLevels, ARRAYSIZE(featureLevels), D3D11_SDK_VERSION, &baseDevice, nullptr, &baseDeviceContext);
     if (FAILED(hr)) return hr;
 
     ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -146,11 +351,30 @@ HRESULT DX11Framework::CreateSwapChainAndFrameBuffer()
     swapChainDesc.Scaling = DXGI_SCALING_STRETCH;
     swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
     swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED;
-    swapChainDesc.Flags = 0;
+    swapChainDesc.Flags = _maxFrameLatency > 0 ? DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0;
+
+    if (_benchmarkMode)
+    {
+        //Hidden window client size depends on the window theme, captures need to be the same size every run
+        swapChainDesc.Width = _WindowWidth;
+        swapChainDesc.Height = _WindowHeight;
+    }
 
     hr = _dxgiFactory->CreateSwapChainForHwnd(_device, _windowHandle, &swapChainDesc, nullptr, nullptr, &_swapChain);
     if (FAILED(hr)) return hr;
 
+    //Waitable swap chain lets Draw block until the GPU can take another frame instead of queueing up to 3 ahead
+    if (_maxFrameLatency > 0)
+    {
+        IDXGISwapChain2* swapChain2 = nullptr;
+        if (SUCCEEDED(_swapChain->QueryInterface(__uuidof(IDXGISwapChain2), reinterpret_cast<void**>(&swapChain2))))
+        {
+            swapChain2->SetMaximumFrameLatency(_maxFrameLatency);
+            _frameLatencyWaitable = swapChain2->GetFrameLatencyWaitableObject();
+            swapChain2->Release();
+        }
+    }
+
     ///////////////////////////////////////////////////////////////////////////////////////////////
 
     ID3D11Texture2D* frameBuffer = nullptr;
@@ -179,11 +403,8 @@ HRESULT DX11Framework::CreateSwapChainAndFrameBuffer()
     return hr;
 }
 
-HRESULT DX11Framework::InitShadersAndInputLayout()
+static DWORD GetShaderFlags()
 {
-    HRESULT hr = S_OK;
-    ID3DBlob* errorBlob;
-
     DWORD dwShaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
 #ifdef _DEBUG
     // Set the D3DCOMPILE_DEBUG flag to embed debug information in the shaders.
@@ -192,18 +413,84 @@ HRESULT DX11Framework::InitShadersAndInputLayout()
     // the release configuration of this program.
     dwShaderFlags |= D3DCOMPILE_DEBUG;
 #endif
-    
-    ID3DBlob* vsBlob;
+    return dwShaderFlags;
+}
+
+HRESULT DX11Framework::GetShaderBytecode(ShaderCache& cache, ShaderBlob& vsBlob, ShaderBlob psBlobs[SHADER_PERMUTATION_COUNT], ID3DBlob** errorBlob)
+{
+    DWORD dwShaderFlags = GetShaderFlags();
 
-    hr =  D3DCompileFromFile(L"SimpleShaders.hlsl", nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "VS_main", "vs_5_0", dwShaderFlags, 0, &vsBlob, &errorBlob);
+    HRESULT hr = cache.GetShader(L"SimpleShaders.hlsl", nullptr, "VS_main", "vs_5_0", dwShaderFlags, vsBlob, errorBlob);
+    if (FAILED(hr)) return hr;
+
+    //One pixel shader per permutation, picked per draw from the object's material flags
+    for (PermutationKey key = 0; key < SHADER_PERMUTATION_COUNT; key++)
+    {
+        D3D_SHADER_MACRO defines[SHADER_FEATURE_COUNT + 1];
+        BuildPermutationDefines(key, defines);
+
+        hr = cache.GetShader(L"SimpleShaders.hlsl", defines, "PS_main", "ps_5_0", dwShaderFlags, psBlobs[key], errorBlob);
+        if (FAILED(hr)) return hr;
+    }
+
+    return hr;
+}
+
+HRESULT DX11Framework::CompileShaders()
+{
+    ShaderCache cache;
+    cache.Open(L"SimpleShaders.cache");
+
+    ShaderBlob vsBlob;
+    ShaderBlob psBlobs[SHADER_PERMUTATION_COUNT];
+    ID3DBlob* errorBlob = nullptr;
+
+    HRESULT hr = GetShaderBytecode(cache, vsBlob, psBlobs, &errorBlob);
     if (FAILED(hr))
     {
-        MessageBoxA(_windowHandle, (char*)errorBlob->GetBufferPointer(), nullptr, ERROR);
-        errorBlob->Release();
+        if (errorBlob)
+        {
+            OutputDebugStringA((char*)errorBlob->GetBufferPointer());
+            errorBlob->Release();
+        }
         return hr;
     }
 
-    hr = _device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &_vertexShader);
+    char message[128];
+    sprintf_s(message, "Shader archive: %d up to date, %d compiled\n", cache.GetHits(), cache.GetCompiles());
+    OutputDebugStringA(message);
+
+    return cache.Save();
+}
+
+HRESULT DX11Framework::InitShadersAndInputLayout()
+{
+    HRESULT hr = S_OK;
+    ID3DBlob* errorBlob = nullptr;
+
+    DWORD dwShaderFlags = GetShaderFlags();
+
+    //Bytecode comes from the archive -compile-shaders writes, only shaders missing from it or older than their source get compiled
+    double bytecodeStart = GetTimeMilliseconds();
+    _shaderCache.Open(L"SimpleShaders.cache");
+
+    ShaderBlob vsBlob;
+    ShaderBlob psBlobs[SHADER_PERMUTATION_COUNT];
+
+    hr = GetShaderBytecode(_shaderCache, vsBlob, psBlobs, &errorBlob);
+    if (FAILED(hr))
+    {
+        if (errorBlob)
+        {
+            MessageBoxA(_windowHandle, (char*)errorBlob->GetBufferPointer(), nullptr, ERROR);
+            errorBlob->Release();
+        }
+        return hr;
+    }
+
+    float bytecodeTime = (float)(GetTimeMilliseconds() - bytecodeStart);
+
+    hr = _device->CreateVertexShader(vsBlob.Bytecode, vsBlob.Size, nullptr, &_vertexShader);
 
     if (FAILED(hr)) return hr;
 
@@ -214,25 +501,41 @@ HRESULT DX11Framework::InitShadersAndInputLayout()
         { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA,   0 }
     };
 
-    hr = _device->CreateInputLayout(inputElementDesc, ARRAYSIZE(inputElementDesc), vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), &_inputLayout);
+    hr = _device->CreateInputLayout(inputElementDesc, ARRAYSIZE(inputElementDesc), vsBlob.Bytecode, vsBlob.Size, &_inputLayout);
     if (FAILED(hr)) return hr;
 
     ///////////////////////////////////////////////////////////////////////////////////////////////
 
-    ID3DBlob* psBlob;
-
-    hr = D3DCompileFromFile(L"SimpleShaders.hlsl", nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "PS_main", "ps_5_0", dwShaderFlags, 0, &psBlob, &errorBlob);
-    if (FAILED(hr))
+    for (PermutationKey key = 0; key < SHADER_PERMUTATION_COUNT; key++)
     {
-        MessageBoxA(_windowHandle, (char*)errorBlob->GetBufferPointer(), nullptr, ERROR);
-        errorBlob->Release();
-        return hr;
+        hr = _device->CreatePixelShader(psBlobs[key].Bytecode, psBlobs[key].Size, nullptr, &_pixelShaders[key]);
+        if (FAILED(hr)) return hr;
     }
 
-    hr = _device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &_pixelShader);
+    char message[128];
+    sprintf_s(message, "Shader bytecode: %.2f ms (%d from archive, %d compiled)\n", bytecodeTime, _shaderCache.GetHits(), _shaderCache.GetCompiles());
+    OutputDebugStringA(message);
 
-    vsBlob->Release();
-    psBlob->Release();
+    //Shaders are created so the bytecode can go, write out anything that had to be compiled for next launch
+    _shaderCache.Save();
+    _shaderCache.Close();
+
+    if (_benchmarkMode)
+    {
+        //Compile the same stages straight from source so the summary shows what the archive saves
+        double compileStart = GetTimeMilliseconds();
+        ID3DBlob* blob;
+        if (SUCCEEDED(D3DCompileFromFile(L"SimpleShaders.hlsl", nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "VS_main", "vs_5_0", dwShaderFlags, 0, &blob, nullptr))) blob->Release();
+        for (PermutationKey key = 0; key < SHADER_PERMUTATION_COUNT; key++)
+        {
+            D3D_SHADER_MACRO defines[SHADER_FEATURE_COUNT + 1];
+            BuildPermutationDefines(key, defines);
+            if (SUCCEEDED(D3DCompileFromFile(L"SimpleShaders.hlsl", defines, D3D_COMPILE_STANDARD_FILE_INCLUDE, "PS_main", "ps_5_0", dwShaderFlags, 0, &blob, nullptr))) blob->Release();
+        }
+
+        _benchmark.RecordStartup("Shader bytecode from archive (ms)", bytecodeTime);
+        _benchmark.RecordStartup("Shader bytecode compiled from source (ms)", (float)(GetTimeMilliseconds() - compileStart));
+    }
 
     return hr;
 }
@@ -383,7 +686,7 @@ HRESULT DX11Framework::InitPipelineVariables()
     bilinearSamplerdesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
     bilinearSamplerdesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
     bilinearSamplerdesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-    bilinearSamplerdesc.MaxLOD = 1;
+    bilinearSamplerdesc.MaxLOD = D3D11_FLOAT32_MAX;
     bilinearSamplerdesc.MinLOD = 0;
 
     hr = _device->CreateSamplerState(&bilinearSamplerdesc, &_bilinearSamplerState);
@@ -456,46 +759,99 @@ HRESULT DX11Framework::InitRunTimeData()
 #
 
     CameraUpdate(6);
-    // Reading all the data from the JSON
-    json jFile;
-    std::string tempVar;
-    std::ifstream fileOpen("JSON/fileData.json");
-
-    jFile = json::parse(fileOpen);
-
-    std::string v = jFile["version"].get<std::string>();
-
-    json& objects = jFile["Gameobjects"]; //← gets an array
-    int size = objects.size();
-    for (unsigned int i = 0; i < size; i++)
-    {
-        GameObject g;
-        json& objectDesc = objects.at(i);
-        tempVar = objectDesc["MeshLocation"]; // ← gets a string
-        g.SetRotation(objectDesc["RotationY"]);
-        g.SetScale(objectDesc["Scale"]);
-        g.SetMeshData(OBJLoader::Load((char*)tempVar.c_str(), _device));
-        g.SetHasTexture(objectDesc["HasTexture"]);
-        if (g.GetHasTexture() == 1)
+    //Whatever the archive has is read out of its one mapping, everything else from loose files as before
+    if (!_assetArchivePath.empty() && !_assetArchive.Open(_assetArchivePath.c_str()))
+    {
+        OutputDebugStringA(("Couldn't open " + _assetArchivePath + ", loading loose files\n").c_str());
+    }
+
+    //The crate and the cube stand in for textures and meshes that are still loading
+    AssetFile crateFile;
+    HRESULT hr = crateFile.Open(&_assetArchive, "Textures\\Crate_COLOR.dds") ?
+        CreateDDSTextureFromMemory(_device, crateFile.GetData(), crateFile.GetSize(), nullptr, &_crateTexture) : E_FAIL;
+
+    _placeholderMesh.VertexBuffer = _vertexBuffer;
+    _placeholderMesh.IndexBuffer = _indexBuffer;
+    _placeholderMesh.VBStride = sizeof(SimpleVertex);
+    _placeholderMesh.VBOffset = 0;
+    _placeholderMesh.IndexCount = 36;
+    _placeholderMesh.Bounds = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.7320508f); //Corners of the +-1 cube
+
+    _assetLoader.Initialise(_device, &_jobSystem, &_assetCache);
+    _assetLoader.SetArchive(&_assetArchive);
+
+    //Benchmark frames have to look the same every run, which mips are in depends on how fast streams finish
+    if (_benchmarkMode) _streamingSettings.Enabled = false;
+    _textureStreamer.Initialise(_device, &_jobSystem, &_assetCache, _streamingSettings);
+    _textureStreamer.SetArchive(&_assetArchive);
+    _assetLoader.SetTextureMaxSize(_textureStreamer.GetTailSize());
+
+    //Earth sits on a pivot at the origin and goes round when the pivot turns
+    _orbitPivot = _orbitBodies.Create(0);
+    _earth = _orbitBodies.Create(0);
+    _orbitBodies.SetScale(_earth, 0.3f);
+    _orbitBodies.SetPosition(_earth, XMFLOAT3(2.0f, 0.0f, 2.0f));
+    _orbitBodies.SetParent(_earth, _orbitPivot);
+    _moon = _orbitBodies.Create(0);
+    _orbitBodies.SetScale(_moon, 0.2f);
+    _orbitBodies.SetPosition(_moon, XMFLOAT3(4.0f, 0.0f, 2.0f));
+
+    //What each object was made from is kept in _sceneEntries, so a reload only has to touch what changed
+    _sceneEntries.clear();
+    auto setParent = [this](uint32_t child, uint32_t parent)
+    {
+        _sceneEntries[child].Parent = parent;
+        if (!gameobjects.SetParent(_sceneEntries[child].Object, _sceneEntries[parent].Object))
         {
-            ID3D11ShaderResourceView* temp;
-
-            tempVar = objectDesc["TextureLocation"];
-            std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-            std::wstring wideTempVar = converter.from_bytes(tempVar);
-            /*const char* charPointer = tempVar.c_str();*/
-            HRESULT hr = CreateDDSTextureFromFile(_device, wideTempVar.c_str(), nullptr, &temp);
-            //_immediateContext->PSSetShaderResources(0, 1, &_Texture);
-            g.SetShaderResource(temp);
+            OutputDebugStringA("Ignoring a parent that would make a loop\n");
         }
+    };
 
-        //make a variable of probably ID3D11ShaderResourceView and then pass the pointer to that address where I will pass that data into the game object
-        g.SetWorldVector(XMFLOAT3(objectDesc["StartPosX"], objectDesc["StartPosY"], objectDesc["StartPosZ"]));
+    //The compiled scene is next to the JSON, made the first time it is read and again whenever the JSON is edited
+    SceneFile scene;
+    if (_compiledScenes && scene.Load(_scenePath, &_assetArchive))
+    {
+        const std::vector<SceneObjectDesc>& sceneObjects = scene.GetObjects();
+        SceneEntries::Build(sceneObjects, _sceneEntries);
+        for (SceneEntry& entry : _sceneEntries)
+        {
+            entry.Object = CreateGameObject(entry.GetDesc());
+        }
 
-        gameobjects.push_back(g);
+        //Parents can come later in the file than their children, so they are hooked up after everything is made
+        for (uint32_t i = 0; i < (uint32_t)sceneObjects.size(); i++)
+        {
+            if (sceneObjects[i].Parent != SCENE_NONE) setParent(i, sceneObjects[i].Parent);
+        }
+    }
+    else
+    {
+        //Without one the JSON is streamed, each object's loads start as soon as it is parsed so the workers are
+        //already reading files while the rest of the scene is still being parsed
+        auto onObject = [&](uint32_t index, const SceneObjectDesc& desc)
+        {
+            _sceneEntries.push_back(SceneEntries::Make(desc));
+            _sceneEntries.back().Object = CreateGameObject(desc);
+            if (desc.Parent != SCENE_NONE) setParent(index, desc.Parent);
+            _assetLoader.Start();
+        };
+        if (!SceneFile::StreamJson(_scenePath, onObject, setParent)) return E_FAIL;
+        SceneEntries::AssignKeys(_sceneEntries);
     }
 
-    HRESULT hr = CreateDDSTextureFromFile(_device, L"Textures\\Crate_COLOR.dds", nullptr, &_crateTexture);
+    //Decoding and uploading happen on the workers, the window is up and drawing placeholders meanwhile
+    _assetLoader.Start();
+
+    //Benchmark frames have to look the same every run, so they don't start until everything is in
+    if (_benchmarkMode)
+    {
+        _assetLoader.Wait();
+        ApplyLoadedAssets();
+    }
+    else if (_hotReload && !_fileWatcher.Start(L"."))
+    {
+        OutputDebugStringA("Couldn't watch the working directory, hot reload is off\n");
+    }
 
     _immediateContext->PSSetShaderResources(0, 1, &_crateTexture);
 
@@ -511,12 +867,30 @@ HRESULT DX11Framework::InitRunTimeData()
     _cbData.specularMaterial = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
     _cbData.specularLight = XMFLOAT4(0.8f, 0.8f, 0.8f, 1.0f);
     _cbData.specPower = 10.0f;
+    _cbData.TextureTransform = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f);
+    _cbData.TextureSlice = 0.0f;
 
     return S_OK;
 }
 
 DX11Framework::~DX11Framework()
 {
+    //Waits on any loads and streams still running before the device they are creating on goes away
+    _assetLoader.Release();
+    _textureStreamer.Release();
+
+    _fileWatcher.Stop();
+
+    while (gameobjects.GetCount() > 0)
+    {
+        DestroyGameObject(gameobjects.GetHandle(gameobjects.GetCount() - 1));
+    }
+    ReleaseRetiredAssets(~0ull);
+    _assetCache.Clear();
+
+    if (_frameLatencyWaitable)CloseHandle(_frameLatencyWaitable);
+    if (_pacingTimer)CloseHandle(_pacingTimer);
+
     if(_immediateContext)_immediateContext->Release();
     if(_device)_device->Release();
     if(_dxgiDevice)_dxgiDevice->Release();
@@ -528,7 +902,10 @@ DX11Framework::~DX11Framework()
     if (_wireframeState)_wireframeState->Release();
     if(_vertexShader)_vertexShader->Release();
     if(_inputLayout)_inputLayout->Release();
-    if(_pixelShader)_pixelShader->Release();
+    for (PermutationKey key = 0; key < SHADER_PERMUTATION_COUNT; key++)
+    {
+        if (_pixelShaders[key])_pixelShaders[key]->Release();
+    }
     if(_constantBuffer)_constantBuffer->Release();
     if(_vertexBuffer)_vertexBuffer->Release();
     if(_indexBuffer)_indexBuffer->Release();
@@ -544,14 +921,400 @@ DX11Framework::~DX11Framework()
 }
 
 
-void DX11Framework::Update()
+PoolHandle DX11Framework::CreateGameObject(const SceneObjectDesc& desc)
+{
+    //Made in the pool up front so its handle can be given to the asset requests below
+    PoolHandle objectHandle = gameobjects.Create(GameObject());
+    GameObject& g = *gameobjects.Get(objectHandle);
+
+    gameobjects.SetRotation(objectHandle, desc.RotationY);
+    gameobjects.SetScale(objectHandle, desc.Scale);
+    gameobjects.SetLocalBounds(objectHandle, _placeholderMesh.Bounds);
+    g.SetMeshData(_placeholderMesh);
+    g.SetMeshAsset(_assetLoader.Request(desc.MeshPath, ASSET_USE_MESH, objectHandle));
+
+    g.SetHasTexture(desc.HasTexture);
+    if (g.GetHasTexture() == 1)
+    {
+        g.SetShaderResource(_crateTexture);
+
+        //A packed texture loads as the whole pack, shared with everything else in it, and the object keeps its place there
+        const PackedTexture* packed = FindPackedTexture(desc.TexturePath);
+        g.SetTextureAsset(_assetLoader.Request(packed ? packed->Pack.c_str() : desc.TexturePath, ASSET_USE_TEXTURE, objectHandle));
+        if (packed) g.SetTexturePlacement(packed->Slice, packed->UVTransform);
+    }
+
+    //Optional normal map, the object uses the cheaper variant that skips the tangent frame until it arrives
+    if (desc.NormalPath)
+    {
+        g.SetNormalAsset(_assetLoader.Request(desc.NormalPath, ASSET_USE_NORMAL_MAP, objectHandle));
+    }
+
+    g.SetPermutation(MakePermutationKey(g.GetHasTexture() == 1, desc.HasSpecular, false));
+
+    //Relative to the parent when there is one
+    gameobjects.SetPosition(objectHandle, desc.Position);
+    RefreshRenderKey(objectHandle);
+
+    if (desc.Name) g.SetName(desc.Name);
+
+    return objectHandle;
+}
+
+//Gives the object's asset references back to the cache, whose resources go when nothing else uses them
+void DX11Framework::DestroyGameObject(PoolHandle handle)
+{
+    GameObject* object = gameobjects.Get(handle);
+    if (!object) return;
+
+    //The snapshot drawn this frame can still point at its resources, so they are let go of a frame later
+    _retiredAssets.push_back(std::make_pair(_frameIndex, object->GetMeshAsset()));
+    _retiredAssets.push_back(std::make_pair(_frameIndex, object->GetTextureAsset()));
+    _retiredAssets.push_back(std::make_pair(_frameIndex, object->GetNormalAsset()));
+
+    gameobjects.Destroy(handle);
+    MarkSceneChanged();
+}
+
+void DX11Framework::ReleaseRetiredAssets(uint64_t beforeFrame)
+{
+    size_t kept = 0;
+    for (auto& retired : _retiredAssets)
+    {
+        if (retired.first < beforeFrame) _assetCache.Release(retired.second);
+        else _retiredAssets[kept++] = retired;
+    }
+    _retiredAssets.resize(kept);
+}
+
+void DX11Framework::CheckForChangedFiles()
 {
-    //Static initializes this value only once    
-    static ULONGLONG frameStart = GetTickCount64();
+    std::vector<std::string> changed;
+    bool complete = _fileWatcher.Poll(changed);
+    if (complete && changed.empty()) return;
+
+    //Too much changed to know what, so everything the scene uses is treated as changed
+    bool sceneChanged = !complete;
+    std::string scenePath = AssetCache::NormalizePath(_scenePath);
+    std::vector<std::string> changedAssets;
+    for (const std::string& path : changed)
+    {
+        if (path == scenePath) sceneChanged = true;
+        else changedAssets.push_back(path);
+    }
+    if (!complete)
+    {
+        for (const SceneEntry& entry : _sceneEntries)
+        {
+            changedAssets.push_back(AssetCache::NormalizePath(entry.MeshPath));
+            if (entry.HasTexture == 1) changedAssets.push_back(AssetCache::NormalizePath(GetTextureAssetPath(entry.TexturePath)));
+            if (entry.HasNormal) changedAssets.push_back(AssetCache::NormalizePath(entry.NormalPath));
+        }
+    }
+
+    if (!changedAssets.empty()) ReloadAssets(changedAssets);
+    if (sceneChanged) ReloadScene();
+}
 
-    ULONGLONG frameNow = GetTickCount64();
-    float deltaTime = (frameNow - frameStart) / 1000.0f;
-    frameStart = frameNow;
+void DX11Framework::ReplaceGameObject(SceneEntry& entry)
+{
+    DestroyGameObject(entry.Object);
+    entry.Object = CreateGameObject(entry.GetDesc());
+}
+
+void DX11Framework::FixSceneParents()
+{
+    //Rebuilt objects are new handles, so any child of one is pointing at something that's gone
+    for (SceneEntry& entry : _sceneEntries)
+    {
+        PoolHandle parent = entry.Parent != SCENE_NONE ? _sceneEntries[entry.Parent].Object : PoolHandle();
+        if (gameobjects.GetParent(entry.Object) != parent && !gameobjects.SetParent(entry.Object, parent))
+        {
+            OutputDebugStringA("Ignoring a parent that would make a loop\n");
+        }
+    }
+}
+
+const PackedTexture* DX11Framework::FindPackedTexture(const std::string& path)
+{
+    if (_packedTextures.empty()) return nullptr;
+
+    auto found = _packedTextures.find(AssetCache::NormalizePath(path));
+    return found != _packedTextures.end() ? &found->second : nullptr;
+}
+
+//Whatever file the object actually loads for a diffuse texture, so a changed pack rebuilds everything in it
+std::string DX11Framework::GetTextureAssetPath(const std::string& path)
+{
+    const PackedTexture* packed = FindPackedTexture(path);
+    return packed ? packed->Pack : path;
+}
+
+void DX11Framework::ReloadAssets(const std::vector<std::string>& paths)
+{
+    double start = GetTimeMilliseconds();
+
+    //Most changes the watcher sees are nothing to do with the scene, those are dropped here
+    std::unordered_set<std::string> changed;
+    for (const std::string& path : paths)
+    {
+        changed.insert(path);
+    }
+
+    size_t rebuilt = 0;
+    std::unordered_set<std::string> invalidated;
+    for (SceneEntry& entry : _sceneEntries)
+    {
+        std::string used[3] = { AssetCache::NormalizePath(entry.MeshPath), entry.HasTexture == 1 ? AssetCache::NormalizePath(GetTextureAssetPath(entry.TexturePath)) : std::string(), entry.HasNormal ? AssetCache::NormalizePath(entry.NormalPath) : std::string() };
+
+        bool uses = false;
+        for (const std::string& path : used)
+        {
+            if (path.empty() || changed.find(path) == changed.end()) continue;
+
+            uses = true;
+            if (invalidated.insert(path).second) _assetCache.Invalidate(path);
+        }
+
+        if (uses)
+        {
+            ReplaceGameObject(entry);
+            rebuilt++;
+        }
+    }
+
+    if (rebuilt == 0) return;
+
+    FixSceneParents();
+    _assetLoader.Start();
+
+    char message[128];
+    sprintf_s(message, "Reloaded %zu assets for %zu objects in %.2fms\n", invalidated.size(), rebuilt, GetTimeMilliseconds() - start);
+    OutputDebugStringA(message);
+}
+
+void DX11Framework::ReloadScene()
+{
+    double start = GetTimeMilliseconds();
+
+    //A half saved or broken file keeps the scene as it was, the save that finishes it triggers another reload
+    SceneFile scene;
+    if (!(_compiledScenes ? scene.Load(_scenePath, &_assetArchive) : scene.LoadJson(_scenePath)))
+    {
+        OutputDebugStringA(("Couldn't reload " + _scenePath + ", keeping the current scene\n").c_str());
+        return;
+    }
+
+    SceneDiff diff;
+    SceneEntries::Diff(_sceneEntries, scene.GetObjects(), diff);
+
+    for (PoolHandle removed : diff.Removed)
+    {
+        DestroyGameObject(removed);
+    }
+
+    size_t counts[4] = {};
+    for (size_t i = 0; i < diff.Entries.size(); i++)
+    {
+        SceneEntry& entry = diff.Entries[i];
+        counts[diff.Changes[i]]++;
+
+        switch (diff.Changes[i])
+        {
+        case SCENE_OBJECT_ADDED:
+            entry.Object = CreateGameObject(entry.GetDesc());
+            break;
+
+        case SCENE_OBJECT_REBUILT:
+            ReplaceGameObject(entry);
+            break;
+
+        case SCENE_OBJECT_MOVED:
+            gameobjects.SetPosition(entry.Object, entry.Position);
+            gameobjects.SetRotation(entry.Object, entry.RotationY);
+            gameobjects.SetScale(entry.Object, entry.Scale);
+            MarkSceneChanged();
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    _sceneEntries.swap(diff.Entries);
+    FixSceneParents();
+    _assetLoader.Start();
+
+    char message[160];
+    sprintf_s(message, "Reloaded %s in %.2fms: %zu added, %zu removed, %zu rebuilt, %zu moved, %zu unchanged\n", _scenePath.c_str(), GetTimeMilliseconds() - start,
+        counts[SCENE_OBJECT_ADDED], diff.Removed.size(), counts[SCENE_OBJECT_REBUILT], counts[SCENE_OBJECT_MOVED], counts[SCENE_OBJECT_SAME]);
+    OutputDebugStringA(message);
+}
+
+//Sort so objects sharing a shader variant (then texture, then mesh) draw together, only changes when one of those does
+void DX11Framework::RefreshRenderKey(PoolHandle handle)
+{
+    GameObject* object = gameobjects.Get(handle);
+    if (!object) return;
+
+    gameobjects.SetRenderKey(handle, MakeSortKey(object->GetPermutation(), PointerSortBits(*object->GetShaderResource()), PointerSortBits(object->GetMeshData().VertexBuffer), 0));
+}
+
+void DX11Framework::ApplyLoadedAssets()
+{
+    _assetLoader.CollectFinished(_loadedAssets);
+
+    for (const LoadedAsset& asset : _loadedAssets)
+    {
+        //A failed load leaves the placeholder in, better a crate than a hole
+        if (!asset.Succeeded) continue;
+
+        for (const AssetUser& user : asset.Users)
+        {
+            //Object may have been removed while its assets were loading
+            GameObject* object = gameobjects.Get(user.Object);
+            if (!object) continue;
+
+            if (user.Use == ASSET_USE_MESH)
+            {
+                object->SetMeshData(asset.Mesh);
+                gameobjects.SetLocalBounds(user.Object, asset.Mesh.Bounds);
+            }
+            else if (user.Use == ASSET_USE_TEXTURE)
+            {
+                //Packs of more than one slice load as arrays, which need the variant that samples one
+                object->SetShaderResource(asset.Texture);
+                PermutationKey permutation = object->GetPermutation() & ~SHADER_TEXTURE_ARRAY;
+                if (IsTextureArray(asset.Texture)) permutation |= SHADER_TEXTURE_ARRAY;
+                object->SetPermutation(permutation);
+            }
+            else
+            {
+                object->SetNormalMap(asset.Texture);
+                object->SetPermutation(object->GetPermutation() | SHADER_NORMAL_MAP);
+            }
+
+            RefreshRenderKey(user.Object);
+        }
+
+        if (asset.Texture) _textureStreamer.Register(asset.Handle, asset.Texture);
+        MarkSceneChanged();
+    }
+}
+
+void DX11Framework::UpdateTextureStreaming()
+{
+    if (!_textureStreamer.IsEnabled()) return;
+
+    //The camera Update is about to copy into the snapshot, a view matrix's third column is where it looks
+    XMFLOAT3 eye;
+    XMFLOAT4X4 view;
+    XMFLOAT4X4 projection;
+    if (_activeCamera != 6)
+    {
+        eye = cameraList[_activeCamera].GetEye();
+        view = cameraList[_activeCamera].GetView();
+        projection = cameraList[_activeCamera].GetProj();
+    }
+    else
+    {
+        XMStoreFloat3(&eye, _lookCamera.GetEye());
+        view = _lookCamera.GetView();
+        projection = _lookCamera.GetProj();
+    }
+    XMFLOAT3 forward(view._13, view._23, view._33);
+    float projectionScale = _viewport.Height * 0.5f * projection._22;
+
+    //World bounds are from the last Update, a frame behind at most
+    _textureStreamer.BeginFrame();
+    for (size_t i = 0; i < gameobjects.GetCount(); i++)
+    {
+        float pixels = TextureStreamingPolicy::GetProjectedPixels(gameobjects.GetWorldBounds(i), eye, forward, projectionScale);
+        if (pixels <= 0.0f) continue;
+
+        GameObject& object = gameobjects[i];
+        _textureStreamer.AddUse(*object.GetShaderResource(), pixels);
+        _textureStreamer.AddUse(*object.GetNormalMap(), pixels);
+    }
+
+    _textureStreamer.Update(_frameIndex, _textureSwaps);
+    if (_textureSwaps.empty()) return;
+
+    //Objects keep their own copy of the texture pointer, anything on a replaced texture moves to its new one
+    for (size_t i = 0; i < gameobjects.GetCount(); i++)
+    {
+        GameObject& object = gameobjects[i];
+        for (const TextureSwap& swap : _textureSwaps)
+        {
+            if (*object.GetShaderResource() == swap.Previous)
+            {
+                object.SetShaderResource(swap.Current);
+                RefreshRenderKey(gameobjects.GetHandle(i));
+            }
+            if (*object.GetNormalMap() == swap.Previous) object.SetNormalMap(swap.Current);
+        }
+    }
+    MarkSceneChanged();
+}
+
+void DX11Framework::RunFrame()
+{
+    //GetKeyState only reflects this thread's queue, so input is sampled here and handed to whichever thread runs Update
+    InputState input;
+    if (!_benchmarkMode)
+    {
+        input.Sample();
+    }
+
+    _frameTimer.BeginFrame();
+    _frameIndex++;
+
+    //Last frame's snapshot has been drawn, so anything retired before it started is no longer referenced
+    ReleaseRetiredAssets(_frameIndex - 1);
+    _textureStreamer.ReleaseRetired(_frameIndex - 1);
+
+    //Gameobjects only change between frames, never while an Update job might be reading them
+    if (_fileWatcher.HasChanges()) CheckForChangedFiles();
+    ApplyLoadedAssets();
+    UpdateTextureStreaming();
+
+    //Nothing finished to draw yet on the first frame, so that one runs both stages in order
+    if (_pipelined && _snapshots.GetReadSnapshot().IsComplete())
+    {
+        //Frame N+1 is simulated on a worker while frame N is submitted here, swap once both are done
+        JobCounter updateDone;
+        _jobSystem.Run([this, &input]()
+        {
+            Update(input, _snapshots.BeginWrite(_frameIndex));
+            _snapshots.EndWrite();
+        }, &updateDone);
+
+        DrawLatestSnapshot();
+
+        _jobSystem.Wait(&updateDone);
+        _snapshots.Swap();
+
+        //What was just written only gets drawn next frame, WaitForNextFrame mustn't idle before then
+        _undrawnSnapshot = _snapshots.GetReadSnapshot().Changed;
+    }
+    else
+    {
+        Update(input, _snapshots.BeginWrite(_frameIndex));
+        _snapshots.EndWrite();
+        _snapshots.Swap();
+
+        _undrawnSnapshot = _snapshots.GetReadSnapshot().Changed;
+        DrawLatestSnapshot();
+    }
+}
+
+void DX11Framework::Update(const InputState& input, RenderSnapshot& snapshot)
+{
+    _frameTimer.Begin(TIMER_UPDATE);
+
+    //Simulation runs in fixed steps however fast frames come in, so movement speed doesn't depend on frame rate
+    int steps = _timestep.Advance(_clock->GetSeconds());
+    float step = _timestep.GetStep();
 
    /* if (GetAsyncKeyState(VK_F2) & 0x0001)
     {
@@ -562,109 +1325,273 @@ void DX11Framework::Update()
         _immediateContext->RSSetState(_fillState);
     }*/
 
-    static float simpleCount = 0.0f;
-    simpleCount += deltaTime;
-    _cbData.Count = simpleCount;
-
-    if (GetAsyncKeyState(0x31) & 0x0001)
+    //Toggles happen once per frame, a frame that takes no steps still shouldn't drop a key press
+    if (!_benchmarkMode)
     {
-        CameraUpdate(0);
+        HandleKeyPresses(input);
     }
-    else if (GetAsyncKeyState(0x32) & 0x0001)
+
+    for (int i = 0; i < steps; i++)
     {
-        CameraUpdate(1);
+        //Anything that changes the scene this step resets this back to 0
+        _idleSteps++;
+
+        if (!_benchmarkMode)
+        {
+            HandleInput(input, step);
+        }
+
+        _previousSimulationTime = _simulationTime;
+        if (!_animationPaused)
+        {
+            _simulationTime += step;
+            MarkSceneChanged();
+        }
     }
-    else if (GetAsyncKeyState(0x33) & 0x0001)
+
+    //Render between the last two steps so animation stays smooth when frame rate and step rate don't line up
+    float simpleCount = _previousSimulationTime + (_simulationTime - _previousSimulationTime) * _timestep.GetAlpha();
+    snapshot.Count = simpleCount;
+
+    //Camera matrices are copied out so Draw never sees a camera the next Update is halfway through moving
+    if (_activeCamera != 6)
     {
-        CameraUpdate(2);
+        snapshot.CameraPosition = cameraList[_activeCamera].GetEye();
+        snapshot.View = cameraList[_activeCamera].GetView();
+        snapshot.Projection = cameraList[_activeCamera].GetProj();
     }
-    else if (GetAsyncKeyState(0x34) & 0x0001)
+    else
     {
-        CameraUpdate(3);
+        XMStoreFloat3(&snapshot.CameraPosition, _lookCamera.GetEye());
+        snapshot.View = _lookCamera.GetView();
+        snapshot.Projection = _lookCamera.GetProj();
     }
-    else if (GetAsyncKeyState(0x35) & 0x0001)
+
+    //Only objects moved since last frame (and their children) get their world matrix rebuilt, JSON objects never
+    //move so after loading this is usually nothing. When there is work it is spread across the workers
+    gameobjects.UpdateTransforms(_jobSystem);
+
+    _orbitBodies.SetRotation(_orbitPivot, simpleCount);
+    _orbitBodies.SetRotation(_moon, simpleCount * 2);
+    _orbitBodies.UpdateTransforms(_jobSystem);
+
+    snapshot.Objects.resize(gameobjects.GetCount());
+    _jobSystem.ParallelFor((uint32_t)gameobjects.GetCount(), 256, [this, &snapshot](uint32_t start, uint32_t end)
     {
-        CameraUpdate(4);
-    }
-    else if (GetAsyncKeyState(0x36) & 0x0001)
+        for (uint32_t i = start; i < end; i++)
+        {
+            GameObject& object = gameobjects[i];
+
+            RenderObject& renderObject = snapshot.Objects[i];
+            renderObject.World = gameobjects.GetWorld(i);
+            renderObject.SortKey = gameobjects.GetRenderKey(i);
+            renderObject.Mesh = object.GetMeshData();
+            renderObject.Texture = *object.GetShaderResource();
+            renderObject.NormalMap = *object.GetNormalMap();
+            renderObject.Permutation = object.GetPermutation();
+
+            //The placeholder is a whole texture of its own, the placement only means anything once the pack is in
+            bool placeholder = renderObject.Texture == _crateTexture;
+            renderObject.TextureTransform = placeholder ? XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f) : object.GetTextureTransform();
+            renderObject.TextureSlice = placeholder ? 0.0f : (float)object.GetTextureSlice();
+        }
+    });
+
+    XMStoreFloat4x4(&snapshot.World, XMMatrixIdentity() * XMMatrixRotationY(simpleCount * 0.037f) * XMMatrixRotationX(simpleCount));
+    snapshot.World2 = _orbitBodies.GetWorld(_orbitBodies.GetItem(_earth));
+    snapshot.World3 = _orbitBodies.GetWorld(_orbitBodies.GetItem(_moon));
+    //XMStoreFloat4x4(&_GameObject, XMMatrixIdentity() * XMMatrixRotationY(simpleCount * 2) * XMMatrixScaling(0.2f, 0.2f, 0.2f) * XMMatrixTranslation(4, 0, 2));
+    XMStoreFloat4x4(&snapshot.WorldLine, XMMatrixIdentity());
+
+    //Changes made between frames (window messages, benchmark camera) ride along with this snapshot
+    snapshot.Changed = _sceneChanged;
+    _sceneChanged = false;
+
+    _frameTimer.End(TIMER_UPDATE);
+}
+
+void DX11Framework::HandleKeyPresses(const InputState& input)
+{
+    if (input.WasPressed(0x50)) // P pause animation, lets render on change mode go idle
     {
-        CameraUpdate(5);
+        _animationPaused = !_animationPaused;
+        MarkSceneChanged();
     }
-    else if (GetAsyncKeyState(0x37) & 0x0001)
+
+    for (int camera = 0; camera < 7; camera++)
     {
-        CameraUpdate(6);
+        if (input.WasPressed(0x31 + camera)) // 1-7 pick a camera
+        {
+            CameraUpdate(camera);
+            break;
+        }
     }
+}
 
-    if (GetKeyState(0x41) < 0) // A go right
+void DX11Framework::HandleInput(const InputState& input, float deltaTime)
+{
+    float move = _cameraMoveSpeed * deltaTime;
+    float turn = _cameraTurnSpeed * deltaTime;
+
+    if (input.IsHeld(0x41)) // A go right
     {
-        _lookCamera.UpdateEye(-0.001, 0, 0);
+        _lookCamera.UpdateEye(-move, 0, 0);
         CameraUpdate(6);
     }
-    if (GetKeyState(0x44) < 0) // D go left
+    if (input.IsHeld(0x44)) // D go left
     {
-        _lookCamera.UpdateEye(0.001, 0, 0);
+        _lookCamera.UpdateEye(move, 0, 0);
         CameraUpdate(6);
     }
-    if (GetKeyState(0x57) < 0) // W go forward
+    if (input.IsHeld(0x57)) // W go forward
     {
-        _lookCamera.UpdateEye(0, 0, 0.001);
+        _lookCamera.UpdateEye(0, 0, move);
         CameraUpdate(6);
     }
-    if (GetKeyState(0x53) < 0) // S go back
+    if (input.IsHeld(0x53)) // S go back
     {
-        _lookCamera.UpdateEye(0, 0, -0.001);
+        _lookCamera.UpdateEye(0, 0, -move);
         CameraUpdate(6);
     }
-    if (GetKeyState(0x45) < 0) // E Go up
+    if (input.IsHeld(0x45)) // E Go up
     {
-        _lookCamera.UpdateEye(0, 0.001, 0);
+        _lookCamera.UpdateEye(0, move, 0);
         CameraUpdate(6);
     }
-    if (GetKeyState(0x51) < 0) // Q Go down
+    if (input.IsHeld(0x51)) // Q Go down
     {
-        _lookCamera.UpdateEye(0, -0.001, 0);
+        _lookCamera.UpdateEye(0, -move, 0);
         CameraUpdate(6);
     }
-    if (GetKeyState(0x4A) < 0) // J pan left
+    if (input.IsHeld(0x4A)) // J pan left
     {
-        _lookCamera.UpdateDirection(-0.0002, 'x');
+        _lookCamera.UpdateDirection(-turn, 'x');
         CameraUpdate(6);
     }
-    if (GetKeyState(0x4C) < 0) // L pan right
+    if (input.IsHeld(0x4C)) // L pan right
     {
-        _lookCamera.UpdateDirection(0.0002, 'x');
+        _lookCamera.UpdateDirection(turn, 'x');
         CameraUpdate(6);
     }
-    if (GetKeyState(0x49) < 0) // I pan up
+    if (input.IsHeld(0x49)) // I pan up
     {
-        _lookCamera.UpdateDirection(-0.0002, 'y');
+        _lookCamera.UpdateDirection(-turn, 'y');
         CameraUpdate(6);
     }
-    if (GetKeyState(0x4B) < 0) // K pan down
+    if (input.IsHeld(0x4B)) // K pan down
     {
-        _lookCamera.UpdateDirection(0.0002, 'y');
+        _lookCamera.UpdateDirection(turn, 'y');
         CameraUpdate(6);
     }
-    //if (GetKeyState(0x55) < 0) // U
+    //if (input.IsHeld(0x55)) // U
     //{
     //    _lookCamera.UpdateDirection(0.0002, 'z');
     //    CameraUpdate(6);
     //}
-    //if (GetKeyState(0x4F) < 0) // O
+    //if (input.IsHeld(0x4F)) // O
     //{
     //    _lookCamera.UpdateDirection(-0.0002, 'z');
     //    CameraUpdate(6);
     //}
-    XMStoreFloat4x4(&_World, XMMatrixIdentity() * XMMatrixRotationY(simpleCount * 0.037f) * XMMatrixRotationX(simpleCount));
-    XMStoreFloat4x4(&_World2, XMMatrixIdentity() * XMMatrixScaling(0.3f, 0.3f, 0.3f) * XMMatrixTranslation(2, 0, 2) * XMMatrixRotationY(simpleCount));
-    XMStoreFloat4x4(&_World3, XMMatrixIdentity() * XMMatrixRotationY(simpleCount*2) * XMMatrixScaling(0.2f, 0.2f, 0.2f) * XMMatrixTranslation(4, 0, 2));
-    //XMStoreFloat4x4(&_GameObject, XMMatrixIdentity() * XMMatrixRotationY(simpleCount * 2) * XMMatrixScaling(0.2f, 0.2f, 0.2f) * XMMatrixTranslation(4, 0, 2));
-    XMStoreFloat4x4(&_WorldLine, XMMatrixIdentity());
+}
 
+bool DX11Framework::LoadSettings(const char* filename)
+{
+    std::ifstream fileOpen(filename);
+    if (!fileOpen.good()) return false;
+
+    json jFile = json::parse(fileOpen, nullptr, false);
+    if (jFile.is_discarded()) return false;
+
+    _framePacer.SetTargetRate(jFile.value("TargetFrameRate", 0.0f));
+    _vsync = jFile.value("VSync", _vsync);
+    _maxFrameLatency = jFile.value("MaxFrameLatency", _maxFrameLatency);
+    _renderOnChange = jFile.value("RenderOnChange", _renderOnChange);
+    _pipelined = jFile.value("PipelinedUpdate", _pipelined);
+    _compiledScenes = jFile.value("CompiledScenes", _compiledScenes);
+    _hotReload = jFile.value("HotReload", _hotReload);
+    _assetArchivePath = jFile.value("AssetArchive", _assetArchivePath);
+
+    _streamingSettings.Enabled = jFile.value("TextureStreaming", _streamingSettings.Enabled);
+    _streamingSettings.BudgetBytes = (size_t)(jFile.value("TextureBudgetMB", _streamingSettings.BudgetBytes / (1024.0 * 1024.0)) * 1024.0 * 1024.0);
+    _streamingSettings.TailSize = jFile.value("TextureTailSize", _streamingSettings.TailSize);
+    _streamingSettings.MipBias = jFile.value("TextureMipBias", _streamingSettings.MipBias);
+    _streamingSettings.MaxStreamsInFlight = jFile.value("MaxTextureStreams", _streamingSettings.MaxStreamsInFlight);
+
+    //Textures named in the manifest load as their slice of a pack instead, see TexturePacker
+    _packedTextures.clear();
+    std::vector<PackedTexture> packedTextures;
+    std::string packManifest = jFile.value("TexturePackManifest", std::string());
+    if (!packManifest.empty() && TexturePacker::LoadManifest(packManifest.c_str(), packedTextures))
+    {
+        for (const PackedTexture& packed : packedTextures)
+        {
+            _packedTextures[AssetCache::NormalizePath(packed.Source)] = packed;
+        }
+    }
+
+    return true;
 }
 
-void DX11Framework::Draw()
+bool DX11Framework::WaitForNextFrame()
 {
+    //Nothing moved last step so there is nothing new to draw, sleep until a window message or input turns up
+    if (_renderOnChange && !_sceneChanged && !_undrawnSnapshot && _idleSteps > 0 && _assetLoader.IsIdle() && _textureStreamer.IsIdle() && !_fileWatcher.HasChanges())
+    {
+        //A file being saved wakes us too, so hot reload works while idle
+        HANDLE fileEvent = _fileWatcher.GetEvent();
+        MsgWaitForMultipleObjectsEx(fileEvent ? 1 : 0, fileEvent ? &fileEvent : nullptr, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+        //Time spent asleep shouldn't come back as a burst of catch up steps or frames
+        _timestep.Resync(_clock->GetSeconds());
+        _framePacer.Resync();
+        _idleSteps = 0;
+        return false;
+    }
+
+    double wait = _framePacer.GetTimeUntilNextFrame(_clock->GetSeconds());
+    if (wait > 0.0 && _pacingTimer)
+    {
+        //Negative due time is relative, in 100ns units
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -(LONGLONG)(wait * 10000000.0);
+        SetWaitableTimerEx(_pacingTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0);
+
+        //Input arriving first wakes us early, the main loop handles it and comes back here to finish waiting
+        if (MsgWaitForMultipleObjectsEx(1, &_pacingTimer, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE) != WAIT_OBJECT_0)
+        {
+            return false;
+        }
+    }
+
+    _framePacer.FrameStarted(_clock->GetSeconds());
+    return true;
+}
+
+void DX11Framework::DrawLatestSnapshot()
+{
+    const RenderSnapshot& snapshot = _snapshots.BeginRead();
+
+    //Render on change skips Present entirely when the snapshot has nothing new in it
+    if (snapshot.IsComplete() && (!_renderOnChange || _undrawnSnapshot))
+    {
+        Draw(snapshot);
+        _undrawnSnapshot = false;
+    }
+
+    _snapshots.EndRead();
+}
+
+void DX11Framework::Draw(const RenderSnapshot& snapshot)
+{
+    //Blocks until the swap chain has room for another frame, only done when we are actually going to Present
+    if (_frameLatencyWaitable)
+    {
+        WaitForSingleObjectEx(_frameLatencyWaitable, 1000, TRUE);
+    }
+
+    _frameTimer.Begin(TIMER_SUBMISSION);
+
     _immediateContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     //Present unbinds render target, so rebind and clear at start of each frame
     float backgroundColor[4] = { 0.025f, 0.025f, 0.025f, 1.0f };
@@ -673,7 +1600,13 @@ void DX11Framework::Draw()
     _immediateContext->ClearDepthStencilView(_depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0.0f);
    
     //Store this frames data in constant buffer struct
-    _cbData.World = XMMatrixTranspose(XMLoadFloat4x4(&_World));
+    _cbData.View = XMMatrixTranspose(XMLoadFloat4x4(&snapshot.View));
+    _cbData.Projection = XMMatrixTranspose(XMLoadFloat4x4(&snapshot.Projection));
+    _cbData.cameraPosition = snapshot.CameraPosition;
+    _cbData.Count = snapshot.Count;
+    _cbData.World = XMMatrixTranspose(XMLoadFloat4x4(&snapshot.World));
+    _cbData.TextureTransform = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f);
+    _cbData.TextureSlice = 0.0f;
 
     //Write constant buffer data onto GPU
     D3D11_MAPPED_SUBRESOURCE mappedSubresource;
@@ -688,7 +1621,7 @@ void DX11Framework::Draw()
     _immediateContext->IASetIndexBuffer(_indexBuffer, DXGI_FORMAT_R16_UINT, 0);
 
     _immediateContext->VSSetShader(_vertexShader, nullptr, 0);
-    _immediateContext->PSSetShader(_pixelShader, nullptr, 0);
+    _immediateContext->PSSetShader(_pixelShaders[SHADER_TEXTURED | SHADER_SPECULAR], nullptr, 0);
 
     _immediateContext->PSSetShaderResources(0,1, &_crateTexture);
 
@@ -698,7 +1631,7 @@ void DX11Framework::Draw()
     //Remap to update Earth Data
     _immediateContext->Map(_constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
     //Load new world information
-    _cbData.World = XMMatrixTranspose(XMLoadFloat4x4(&_World2));
+    _cbData.World = XMMatrixTranspose(XMLoadFloat4x4(&snapshot.World2));
 
     memcpy(mappedSubresource.pData, &_cbData, sizeof(_cbData));
     _immediateContext->Unmap(_constantBuffer, 0);
@@ -708,7 +1641,7 @@ void DX11Framework::Draw()
     //Remap to update Moon Data
     _immediateContext->Map(_constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
     //Load new world information
-    _cbData.World = XMMatrixTranspose(XMLoadFloat4x4(&_World3));
+    _cbData.World = XMMatrixTranspose(XMLoadFloat4x4(&snapshot.World3));
 
     memcpy(mappedSubresource.pData, &_cbData, sizeof(_cbData));
     _immediateContext->Unmap(_constantBuffer, 0);
@@ -726,63 +1659,81 @@ void DX11Framework::Draw()
         
     _immediateContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     
-    for (int i= 0; i < gameobjects.size(); i++)
+    //Keys were built when each object's assets last changed, sorting groups objects so state only changes between groups
+    _frameTimer.End(TIMER_SUBMISSION);
+    _frameTimer.Begin(TIMER_SORTING);
+
+    _renderQueue.Clear();
+    for (int i = 0; i < snapshot.Objects.size(); i++)
     {
+        _renderQueue.Add(snapshot.Objects[i].SortKey, i);
+    }
+    _renderQueue.Sort();
+
+    _frameTimer.End(TIMER_SORTING);
+    _frameTimer.Begin(TIMER_SUBMISSION);
+
+    PermutationKey boundPermutation = SHADER_TEXTURED | SHADER_SPECULAR;
+    ID3D11ShaderResourceView* boundTexture = _crateTexture;
+
+    for (size_t q = 0; q < _renderQueue.GetCount(); q++)
+    {
+        const RenderObject& object = snapshot.Objects[_renderQueue[q].ObjectIndex];
+
         //Remap to update Mesh Data
         _immediateContext->Map(_constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
-        
-        XMMATRIX goworld = XMMatrixIdentity() * XMMatrixRotationY(gameobjects[i].GetRotation()) * XMMatrixScaling(gameobjects[i].GetScale(), gameobjects[i].GetScale(), gameobjects[i].GetScale()) * XMMatrixTranslation(gameobjects[i].GetWorldVector()->x, gameobjects[i].GetWorldVector()->y, gameobjects[i].GetWorldVector()->z);
 
         //Load new Mesh information
-        _cbData.World = XMMatrixTranspose(goworld);
-        _cbData.hasTexture = gameobjects[i].GetHasTexture();
+        _cbData.World = XMMatrixTranspose(XMLoadFloat4x4(&object.World));
+        _cbData.TextureTransform = object.TextureTransform;
+        _cbData.TextureSlice = object.TextureSlice;
 
         memcpy(mappedSubresource.pData, &_cbData, sizeof(_cbData));
         _immediateContext->Unmap(_constantBuffer, 0);
 
-        ID3D11Buffer* ppBuffer = gameobjects[i].GetMeshData().VertexBuffer;
-        MeshData tempData = gameobjects[i].GetMeshData();
-        _immediateContext->IASetVertexBuffers(0, 1, &ppBuffer, &stride, &offset);
-        _immediateContext->IASetIndexBuffer(tempData.IndexBuffer, DXGI_FORMAT_R16_UINT, 0);
+        const MeshData& meshData = object.Mesh;
+        _immediateContext->IASetVertexBuffers(0, 1, &meshData.VertexBuffer, &stride, &offset);
+        _immediateContext->IASetIndexBuffer(meshData.IndexBuffer, DXGI_FORMAT_R16_UINT, 0);
 
-        if (_cbData.hasTexture == 1)
+        PermutationKey permutation = object.Permutation;
+        if (permutation != boundPermutation)
         {
-            _immediateContext->PSSetShaderResources(0, 1, gameobjects[i].GetShaderResource());
+            _immediateContext->PSSetShader(_pixelShaders[permutation], nullptr, 0);
+            boundPermutation = permutation;
         }
 
-        ID3D11ShaderResourceView* tmp = nullptr;
+        //Untextured variants never sample t0 so whatever is bound there can stay
+        if (HasFeature(permutation, SHADER_TEXTURED) && object.Texture != boundTexture)
+        {
+            _immediateContext->PSSetShaderResources(0, 1, &object.Texture);
+            boundTexture = object.Texture;
+        }
 
-        _immediateContext->DrawIndexed(gameobjects[i].GetMeshData().IndexCount, 0, 0);
-        _immediateContext->PSSetShaderResources(0, 1, &tmp);
-    }
+        if (HasFeature(permutation, SHADER_NORMAL_MAP))
+        {
+            _immediateContext->PSSetShaderResources(1, 1, &object.NormalMap);
+        }
 
-    //Present Backbuffer to screen
-    _swapChain->Present(0, 0);
-}
+        _immediateContext->DrawIndexed(meshData.IndexCount, 0, 0);
+    }
 
-void DX11Framework::CameraUpdate(int listPosition)
-{        
+    _frameTimer.End(TIMER_SUBMISSION);
 
-    if (listPosition != 6)
+    //Capture has to happen before Present, flip model back buffers are undefined afterwards
+    if (_benchmarkMode && _benchmark.ShouldCapture(_benchmarkFrame))
     {
-        XMFLOAT4X4 tempView;
-        _cbData.cameraPosition = cameraList[listPosition].GetEye();
-        tempView = cameraList[listPosition].GetView();
-        _cbData.View = XMMatrixTranspose(XMLoadFloat4x4(&tempView));
-        tempView = cameraList[listPosition].GetProj();
-        _cbData.Projection = XMMatrixTranspose(XMLoadFloat4x4(&tempView));
+        _benchmark.CaptureAndCompare(_device, _immediateContext, _swapChain, _benchmarkFrame);
     }
-    else
-    {
 
-        XMFLOAT4X4 tempView;
-        XMFLOAT3 tempCamPosition;
-        XMStoreFloat3(&tempCamPosition, _lookCamera.GetEye());
-        _cbData.cameraPosition = tempCamPosition;
-        tempView = _lookCamera.GetView();
-        _cbData.View = XMMatrixTranspose(XMLoadFloat4x4(&tempView));
-        tempView = _lookCamera.GetProj();
-        _cbData.Projection = XMMatrixTranspose(XMLoadFloat4x4(&tempView));
-    }
+    //Present Backbuffer to screen
+    _frameTimer.Begin(TIMER_PRESENT);
+    _swapChain->Present(_vsync ? 1 : 0, 0);
+    _frameTimer.End(TIMER_PRESENT);
+}
 
+void DX11Framework::CameraUpdate(int listPosition)
+{
+    //Matrices are read from the active camera when Update fills the next snapshot
+    _activeCamera = listPosition;
+    MarkSceneChanged();
 }
@@ -2,10 +2,32 @@
 
 #include <windows.h>
 #include <d3d11_4.h>
+#include <dxgi1_3.h>
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
+#include <string>
 #include "OBJLoader.h"
 #include "Structures.h"
+#include "Benchmark.h"
+#include "ShaderCache.h"
+#include "RenderQueue.h"
+#include "Clock.h"
+#include "FixedTimestep.h"
+#include "FramePacer.h"
+#include "JobSystem.h"
+#include "InputState.h"
+#include "RenderSnapshot.h"
+#include "AssetArchive.h"
+#include "AssetLoader.h"
+#include "TextureStreamer.h"
+#include "TexturePacker.h"
+#include "ObjectStore.h"
+#include "SceneFile.h"
+#include "FileWatcher.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
 
 
 using namespace DirectX;
@@ -15,11 +37,18 @@ class GameObject
 {
 private:
 	ID3D11ShaderResourceView* texture = nullptr;
+	ID3D11ShaderResourceView* normalMap = nullptr;
 	MeshData meshData;
-	DirectX::XMFLOAT3 world;
 	int hasTexture;
-	float rotation;
-	float scale;
+	PermutationKey permutation = 0;
+	XMFLOAT4 textureTransform = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f); //Where its diffuse sits in a packed texture, see TexturePacker
+	uint32_t textureSlice = 0;
+	std::string name; //From the scene file, empty if it didn't give one
+
+	//References held on the asset cache, released when the object goes
+	AssetHandle meshAsset;
+	AssetHandle textureAsset;
+	AssetHandle normalAsset;
 
 public:
 
@@ -27,17 +56,26 @@ public:
 
 	void SetShaderResource(ID3D11ShaderResourceView* in) { texture = in; }
 	void SetMeshData(MeshData in) { meshData = in; }
-	void SetWorldVector(XMFLOAT3 in) { world = in; }
 	void SetHasTexture(int in) { hasTexture = in; }
-	void SetRotation(float in) { rotation = in; }
-	void SetScale(float in) { scale = in; }
+	void SetNormalMap(ID3D11ShaderResourceView* in) { normalMap = in; }
+	void SetPermutation(PermutationKey in) { permutation = in; }
+	void SetTexturePlacement(uint32_t slice, const XMFLOAT4& transform) { textureSlice = slice; textureTransform = transform; }
+	void SetMeshAsset(AssetHandle in) { meshAsset = in; }
+	void SetTextureAsset(AssetHandle in) { textureAsset = in; }
+	void SetNormalAsset(AssetHandle in) { normalAsset = in; }
+	void SetName(const std::string& in) { name = in; }
 
 	ID3D11ShaderResourceView** GetShaderResource() { return &texture; }
 	MeshData& GetMeshData() { return meshData; }
-	XMFLOAT3* GetWorldVector() { return &world; }
 	int GetHasTexture() { return hasTexture; }
-	float GetRotation() { return rotation; }
-	float GetScale() { return scale; }
+	ID3D11ShaderResourceView** GetNormalMap() { return &normalMap; }
+	PermutationKey GetPermutation() { return permutation; }
+	const XMFLOAT4& GetTextureTransform() { return textureTransform; }
+	uint32_t GetTextureSlice() { return textureSlice; }
+	AssetHandle GetMeshAsset() { return meshAsset; }
+	AssetHandle GetTextureAsset() { return textureAsset; }
+	AssetHandle GetNormalAsset() { return normalAsset; }
+	const std::string& GetName() { return name; }
 };
 
 class BaseCamera
@@ -131,6 +169,7 @@ public:
 
 	void UpdateEye(float x, float y, float z);
 	void UpdateDirection(float angle, char axis);
+	void SetLook(XMVECTOR eye, XMVECTOR direction);
 
 	XMVECTOR GetEye() { return _eye; }
 	void SetEye(XMVECTOR eye) { _eye = eye; }
@@ -195,6 +234,16 @@ inline void LookCamera::UpdateDirection(float angle, char axis)
 }
 ;
 
+//Places the camera directly, used when following a recorded path rather than keyboard input
+inline void LookCamera::SetLook(XMVECTOR eye, XMVECTOR direction)
+{
+	_eye = eye;
+	_direction = direction;
+
+	XMStoreFloat4x4(&_view, XMMatrixLookToLH(_eye, _direction, _up));
+	XMStoreFloat4x4(&_projection, XMMatrixPerspectiveFovLH(XMConvertToRadians(90), _windowWidth / _windowHeight, _nearDepth, _farDepth));
+}
+
 inline LookCamera::LookCamera(XMVECTOR eye, XMVECTOR direction, XMVECTOR up, float windowWidth, float windowHeight, float nearDepth, float farDepth)
 {
 	_eye = eye;
@@ -215,7 +264,13 @@ class DX11Framework
 	int _WindowWidth = 1280;
 	int _WindowHeight = 768;
 
-	std::vector<GameObject> gameobjects;
+	ObjectStore<GameObject> gameobjects; //Transforms and other per-frame data live in the store's own arrays
+
+	//Earth, its orbit pivot and the moon, only the transforms are wanted so the payload is unused
+	ObjectStore<int> _orbitBodies;
+	PoolHandle _orbitPivot;
+	PoolHandle _earth;
+	PoolHandle _moon;
 	std::vector<BaseCamera> cameraList;
 
 	LookCamera _lookCamera;
@@ -233,7 +288,8 @@ class DX11Framework
 	ID3D11RasterizerState* _wireframeState;
 	ID3D11VertexShader* _vertexShader;
 	ID3D11InputLayout* _inputLayout;
-	ID3D11PixelShader* _pixelShader;
+	ID3D11PixelShader* _pixelShaders[SHADER_PERMUTATION_COUNT] = {};
+	ShaderCache _shaderCache;
 	ID3D11Buffer* _constantBuffer;
 	ID3D11Buffer* _vertexBuffer;
 	ID3D11Buffer* _indexBuffer;
@@ -250,22 +306,93 @@ class DX11Framework
 
 	HWND _windowHandle;
 
-	XMFLOAT4X4 _World;
-	XMFLOAT4X4 _World2;
-	XMFLOAT4X4 _World3;
-	XMFLOAT4X4 _WorldLine;
 	XMFLOAT4X4 _GameObject;
 	XMFLOAT4X4 _View;
 	XMFLOAT4X4 _Projection;
 
 	ConstantBuffer _cbData;
+	RenderQueue _renderQueue;
+	JobSystem _jobSystem;
+
+	//Update fills one snapshot on a worker while Draw submits the other, see RunFrame
+	SnapshotBuffer _snapshots;
+	uint64_t _frameIndex = 0;
+	bool _pipelined = true;
+	bool _undrawnSnapshot = false;
+	int _activeCamera = 6;
 
 	XMFLOAT4 _diffuseLight;
 	XMFLOAT4 _diffuseMaterial;
 	XMFLOAT3 _lightDir;
 
+	std::string _scenePath = "JSON/fileData.json";
+	bool _compiledScenes = true; //Load through the binary compiled from _scenePath rather than the JSON itself
+	bool _hotReload = true;      //Watch the scene and the files it uses, and apply edits while running
+
+	//What each scene object was made from, in scene file order, so a reload can work out what changed
+	std::vector<SceneEntry> _sceneEntries;
+	MeshData _placeholderMesh = {};
+	FileWatcher _fileWatcher;
+
+	//Packed by -pack-assets. Anything in it is read from it instead of the loose file, so edits to those files only
+	//show once it is packed again. Declared ahead of the loader and streamer so it outlives what they read from it
+	std::string _assetArchivePath;
+	AssetArchive _assetArchive;
+
+	//Asset references from destroyed objects, with the frame they went in. Held until no snapshot can use them
+	std::vector<std::pair<uint64_t, AssetHandle>> _retiredAssets;
+	AssetCache _assetCache;
+	AssetLoader _assetLoader;
+	std::vector<LoadedAsset> _loadedAssets;
+
+	//Loaded textures start with just their tail mips, the rest stream in and out with what is on screen
+	TextureStreamingSettings _streamingSettings;
+	TextureStreamer _textureStreamer;
+	std::vector<TextureSwap> _textureSwaps;
+
+	//Diffuse textures the packer put in a shared array or atlas, by normalised source path. Empty unless the settings name a manifest
+	std::unordered_map<std::string, PackedTexture> _packedTextures;
+
+	SystemClock _systemClock;
+	SimulatedClock _simulatedClock;
+	Clock* _clock = &_systemClock;
+	FixedTimestep _timestep;
+	float _simulationTime = 0.0f;
+	float _previousSimulationTime = 0.0f;
+
+	float _cameraMoveSpeed = 4.0f; //Units per second
+	float _cameraTurnSpeed = 1.0f; //Radians per second
+
+	FramePacer _framePacer;
+	HANDLE _pacingTimer = nullptr;
+	HANDLE _frameLatencyWaitable = nullptr;
+	bool _vsync = false;
+	int _maxFrameLatency = 0; //0 leaves the swap chain non-waitable
+	bool _renderOnChange = false;
+	bool _animationPaused = false;
+	bool _sceneChanged = true;
+	int _idleSteps = 0;
+
+	FrameTimer _frameTimer;
+	Benchmark _benchmark;
+	bool _benchmarkMode = false;
+	int _benchmarkFrame = 0;
+
 public:
+	bool EnableBenchmark(const char* settingsFile);
+	int RunBenchmark();
+
+	//Generates stress scenes at each of the benchmark's sizes and times loading, updating and drawing them
+	void RunScalingBenchmark();
+
+	//Every shader the renderer uses, from the cache or compiled into it
+	static HRESULT GetShaderBytecode(ShaderCache& cache, ShaderBlob& vsBlob, ShaderBlob psBlobs[SHADER_PERMUTATION_COUNT], ID3DBlob** errorBlob);
+
+	//Brings SimpleShaders.cache up to date with the HLSL without a window or device, the release build runs it after linking
+	static HRESULT CompileShaders();
+
 	HRESULT Initialise(HINSTANCE hInstance, int nCmdShow);
+	bool LoadSettings(const char* filename);
 	HRESULT CreateWindowHandle(HINSTANCE hInstance, int nCmdShow);
 	HRESULT CreateD3DDevice();
 	HRESULT CreateSwapChainAndFrameBuffer();
@@ -274,7 +401,26 @@ public:
 	HRESULT InitPipelineVariables();
 	HRESULT InitRunTimeData();
 	~DX11Framework();
-	void Update();
-	void Draw();
+	bool WaitForNextFrame();
+	PoolHandle CreateGameObject(const SceneObjectDesc& desc);
+	void DestroyGameObject(PoolHandle handle);
+	void ReplaceGameObject(SceneEntry& entry);
+	void ReleaseRetiredAssets(uint64_t beforeFrame);
+	void CheckForChangedFiles();
+	void ReloadScene();
+	void ReloadAssets(const std::vector<std::string>& paths);
+	void FixSceneParents();
+	const PackedTexture* FindPackedTexture(const std::string& path);
+	std::string GetTextureAssetPath(const std::string& path);
+	void RefreshRenderKey(PoolHandle handle);
+	void ApplyLoadedAssets();
+	void UpdateTextureStreaming();
+	void RunFrame();
+	void Update(const InputState& input, RenderSnapshot& snapshot);
+	void HandleKeyPresses(const InputState& input);
+	void HandleInput(const InputState& input, float deltaTime);
+	void DrawLatestSnapshot();
+	void Draw(const RenderSnapshot& snapshot);
+	void MarkSceneChanged() { _sceneChanged = true; _idleSteps = 0; }
 	void CameraUpdate(int listPosition);
 };
@@ -0,0 +1,48 @@
+#include "FileUtilities.h"
+#include <windows.h>
+
+bool EndsWith(const std::string& text, const std::string& suffix)
+{
+    if (text.size() < suffix.size()) return false;
+    return _stricmp(text.c_str() + text.size() - suffix.size(), suffix.c_str()) == 0;
+}
+
+bool EndsWithAny(const std::string& text, const std::vector<std::string>& suffixes)
+{
+    for (const std::string& suffix : suffixes)
+    {
+        if (EndsWith(text, suffix)) return true;
+    }
+    return false;
+}
+
+//CreateDirectoryA only makes the last folder in the path so walk the path and make each one
+void CreateDirectories(const std::string& path)
+{
+    for (size_t i = 0; i <= path.size(); i++)
+    {
+        if (i == path.size() || path[i] == '\\' || path[i] == '/')
+        {
+            CreateDirectoryA(path.substr(0, i).c_str(), nullptr);
+        }
+    }
+}
+
+void FindFiles(const std::string& directory, const std::vector<std::string>& suffixes, std::vector<std::string>& files, const std::string& skip)
+{
+    WIN32_FIND_DATAA findData;
+    HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE) return;
+
+    do
+    {
+        std::string name = findData.cFileName;
+        std::string path = directory + "\\" + name;
+        if (name == "." || name == ".." || _stricmp(path.c_str(), skip.c_str()) == 0) continue;
+
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) FindFiles(path, suffixes, files, skip);
+        else if (EndsWithAny(name, suffixes)) files.push_back(path);
+    } while (FindNextFileA(find, &findData));
+
+    FindClose(find);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//Small Win32 file helpers the offline tools share
+
+//Case insensitive, as Windows paths are
+bool EndsWith(const std::string& text, const std::string& suffix);
+bool EndsWithAny(const std::string& text, const std::vector<std::string>& suffixes);
+
+//Makes every missing folder along the path, not just the last one
+void CreateDirectories(const std::string& path);
+
+//Appends every file under directory ending in one of suffixes, recursing into subfolders except skip
+void FindFiles(const std::string& directory, const std::vector<std::string>& suffixes, std::vector<std::string>& files, const std::string& skip = "");
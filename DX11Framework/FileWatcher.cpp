@@ -0,0 +1,90 @@
+#include "FileWatcher.h"
+#include "AssetCache.h"
+
+#include <algorithm>
+#include <codecvt>
+#include <locale>
+
+bool FileWatcher::Start(const wchar_t* directory)
+{
+    Stop();
+
+    _directory = CreateFileW(directory, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (_directory == INVALID_HANDLE_VALUE) return false;
+
+    _overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!_overlapped.hEvent || !Issue())
+    {
+        Stop();
+        return false;
+    }
+
+    return true;
+}
+
+void FileWatcher::Stop()
+{
+    if (_directory != INVALID_HANDLE_VALUE)
+    {
+        //The buffer and OVERLAPPED have to outlive the read, so wait for the cancel to land before letting go
+        DWORD bytes = 0;
+        if (CancelIoEx(_directory, &_overlapped))
+        {
+            GetOverlappedResult(_directory, &_overlapped, &bytes, TRUE);
+        }
+        CloseHandle(_directory);
+    }
+    if (_overlapped.hEvent) CloseHandle(_overlapped.hEvent);
+
+    _directory = INVALID_HANDLE_VALUE;
+    _overlapped = {};
+}
+
+bool FileWatcher::Issue()
+{
+    ResetEvent(_overlapped.hEvent);
+
+    //Subdirectories too, the scene, models and textures all live in different ones
+    return ReadDirectoryChangesW(_directory, _buffer, sizeof(_buffer), TRUE,
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE, nullptr, &_overlapped, nullptr) != 0;
+}
+
+bool FileWatcher::Poll(std::vector<std::string>& changed)
+{
+    changed.clear();
+    if (_directory == INVALID_HANDLE_VALUE) return true;
+
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(_directory, &_overlapped, &bytes, FALSE))
+    {
+        if (GetLastError() != ERROR_IO_INCOMPLETE) Stop();
+        return true;
+    }
+
+    //Nothing in the buffer after a completed read means it overflowed and the system dropped what didn't fit
+    bool complete = bytes != 0;
+
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+    const uint8_t* next = (const uint8_t*)_buffer;
+    while (complete)
+    {
+        const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)next;
+
+        //An editor saving usually shows up as several writes or a rename onto the real name, each file is reported once
+        if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME)
+        {
+            std::wstring name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            std::string path = AssetCache::NormalizePath(converter.to_bytes(name));
+            if (std::find(changed.begin(), changed.end(), path) == changed.end())
+            {
+                changed.push_back(path);
+            }
+        }
+
+        if (info->NextEntryOffset == 0) break;
+        next += info->NextEntryOffset;
+    }
+
+    if (!Issue()) Stop();
+    return complete;
+}
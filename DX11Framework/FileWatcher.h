@@ -0,0 +1,35 @@
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <vector>
+
+//Watches a directory tree for files being written, created or renamed into place. Wraps an overlapped
+//ReadDirectoryChangesW, so nothing blocks, and the event can go in a wait list to wake an idle loop
+class FileWatcher
+{
+private:
+	HANDLE _directory = INVALID_HANDLE_VALUE;
+	OVERLAPPED _overlapped = {};
+	DWORD _buffer[4096]; //Notifications have to be DWORD aligned
+
+	bool Issue();
+
+public:
+	FileWatcher() = default;
+	~FileWatcher() { Stop(); }
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	bool Start(const wchar_t* directory);
+	void Stop();
+
+	//Paths relative to the directory, normalised the way AssetCache does, that changed since the last call.
+	//Returns false if so much changed at once that some were lost, the caller should treat everything as changed
+	bool Poll(std::vector<std::string>& changed);
+
+	//Signalled while there are changes Poll hasn't picked up yet
+	HANDLE GetEvent() { return _overlapped.hEvent; }
+	bool HasChanges() { return _overlapped.hEvent && WaitForSingleObject(_overlapped.hEvent, 0) == WAIT_OBJECT_0; }
+};
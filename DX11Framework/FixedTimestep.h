@@ -0,0 +1,51 @@
+#pragma once
+
+//Turns variable frame times into a whole number of fixed size simulation steps.
+//Leftover time carries into the next frame and GetAlpha says how far between the last two steps rendering is
+class FixedTimestep
+{
+private:
+	double _step;
+	double _accumulator = 0.0;
+	double _previousTime = 0.0;
+	int _maxSteps;
+	bool _started = false;
+
+public:
+	FixedTimestep(double step = 1.0 / 120.0, int maxSteps = 8) : _step(step), _maxSteps(maxSteps) {}
+
+	int Advance(double now);
+
+	float GetStep() { return (float)_step; }
+	float GetAlpha() { return (float)(_accumulator / _step); }
+	void Reset() { _started = false; _accumulator = 0.0; }
+
+	//Forget time that passed while nothing was running (e.g. sleeping on an idle scene)
+	void Resync(double now) { _previousTime = now; _accumulator = 0.0; _started = true; }
+};
+
+inline int FixedTimestep::Advance(double now)
+{
+	if (!_started)
+	{
+		_previousTime = now;
+		_started = true;
+		return 0;
+	}
+
+	_accumulator += now - _previousTime;
+	_previousTime = now;
+
+	int steps = (int)(_accumulator / _step);
+
+	//After a long stall (breakpoint, window drag) don't try to catch up all at once, just drop the time
+	if (steps > _maxSteps)
+	{
+		steps = _maxSteps;
+		_accumulator = 0.0;
+		return steps;
+	}
+
+	_accumulator -= steps * _step;
+	return steps;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+//Decides when the next frame is due for a target frame rate. Works purely on times passed in
+//so it can be driven by SystemClock in the app or SimulatedClock anywhere else
+class FramePacer
+{
+private:
+	double _interval = 0.0; //0 means unlimited
+	double _nextFrame = 0.0;
+	bool _started = false;
+
+public:
+	void SetTargetRate(float framesPerSecond) { _interval = framesPerSecond > 0.0f ? 1.0 / framesPerSecond : 0.0; }
+	float GetTargetRate() { return _interval > 0.0 ? (float)(1.0 / _interval) : 0.0f; }
+
+	double GetTimeUntilNextFrame(double now);
+	void FrameStarted(double now);
+	void Resync() { _started = false; }
+};
+
+inline double FramePacer::GetTimeUntilNextFrame(double now)
+{
+	if (!_started || _interval <= 0.0 || now >= _nextFrame) return 0.0;
+	return _nextFrame - now;
+}
+
+inline void FramePacer::FrameStarted(double now)
+{
+	//Schedule from the previous deadline rather than from now so small oversleeps don't drift the rate,
+	//but if we fell more than a whole frame behind start over instead of rendering a burst to catch up
+	if (!_started || now - _nextFrame > _interval)
+	{
+		_nextFrame = now;
+	}
+
+	_nextFrame += _interval;
+	_started = true;
+}
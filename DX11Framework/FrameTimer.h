@@ -0,0 +1,72 @@
+#pragma once
+
+#include <windows.h>
+
+//Current QueryPerformanceCounter time in milliseconds, for timing one off things like startup
+inline double GetTimeMilliseconds()
+{
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER now;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&now);
+	return now.QuadPart * 1000.0 / frequency.QuadPart;
+}
+
+//Sections of a frame that get timed separately, sections that a frame doesn't use just report 0
+enum TimerSection
+{
+	TIMER_UPDATE,
+	TIMER_CULLING,
+	TIMER_SORTING,
+	TIMER_SUBMISSION,
+	TIMER_PRESENT,
+	TIMER_COUNT
+};
+
+//CPU timings for a single frame, in milliseconds
+struct FrameTiming
+{
+	float Section[TIMER_COUNT];
+};
+
+//Accumulates QueryPerformanceCounter time per section for the current frame
+class FrameTimer
+{
+private:
+	LARGE_INTEGER _frequency;
+	LARGE_INTEGER _sectionStart[TIMER_COUNT];
+	FrameTiming _timing;
+
+public:
+	FrameTimer();
+
+	void BeginFrame();
+	void Begin(TimerSection section) { QueryPerformanceCounter(&_sectionStart[section]); }
+	void End(TimerSection section);
+
+	const FrameTiming& GetTiming() { return _timing; }
+};
+
+inline FrameTimer::FrameTimer()
+{
+	QueryPerformanceFrequency(&_frequency);
+	BeginFrame();
+}
+
+inline void FrameTimer::BeginFrame()
+{
+	for (int i = 0; i < TIMER_COUNT; i++)
+	{
+		_timing.Section[i] = 0.0f;
+		_sectionStart[i].QuadPart = 0;
+	}
+}
+
+inline void FrameTimer::End(TimerSection section)
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	//Sections can be entered more than once a frame so add rather than overwrite
+	_timing.Section[section] += (float)((now.QuadPart - _sectionStart[section].QuadPart) * 1000.0 / _frequency.QuadPart);
+}
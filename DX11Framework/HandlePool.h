@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+//Index into a HandlePool plus the generation of the slot when the handle was made. Destroying an item bumps
+//its slot's generation, so an old handle to a reused slot is caught rather than quietly finding the new item
+struct PoolHandle
+{
+	uint32_t Index = 0;
+	uint32_t Generation = 0; //Never handed out, so a default handle is always invalid
+
+	bool IsValid() const { return Generation != 0; }
+	bool operator==(const PoolHandle& other) const { return Index == other.Index && Generation == other.Generation; }
+	bool operator!=(const PoolHandle& other) const { return !(*this == other); }
+};
+
+//What GetItem gives back for a handle that isn't valid
+const size_t POOL_INVALID_ITEM = ~(size_t)0;
+
+//Items live packed together in one array so walking the pool is a straight run through memory. Handles go
+//through a slot table to find them, and destroying swaps the last item into the hole, so create, destroy and
+//lookup are all O(1). Pointers from Get are only good until the next Create or Destroy
+template<typename T>
+class HandlePool
+{
+private:
+	struct Slot
+	{
+		uint32_t Item;
+		uint32_t Generation;
+	};
+
+	std::vector<T> _items;
+	std::vector<uint32_t> _itemSlots; //Slot that points at each item, needed to fix up the slot of the item moved by Destroy
+	std::vector<Slot> _slots;
+	std::vector<uint32_t> _freeSlots;
+
+public:
+	PoolHandle Create(const T& item);
+	bool Destroy(PoolHandle handle);
+	void Clear();
+
+	bool IsValid(PoolHandle handle) const;
+	T* Get(PoolHandle handle);
+	const T* Get(PoolHandle handle) const;
+
+	//Packed order, which changes when anything is destroyed
+	size_t GetCount() const { return _items.size(); }
+	T& operator[](size_t item) { return _items[item]; }
+	const T& operator[](size_t item) const { return _items[item]; }
+	PoolHandle GetHandle(size_t item) const;
+
+	//Packed position of a live handle. Destroy always moves the last item into the removed one's place,
+	//so anything keeping arrays in step with the pool can do the same with this index
+	size_t GetItem(PoolHandle handle) const { return IsValid(handle) ? _slots[handle.Index].Item : POOL_INVALID_ITEM; }
+
+	typename std::vector<T>::iterator begin() { return _items.begin(); }
+	typename std::vector<T>::iterator end() { return _items.end(); }
+	typename std::vector<T>::const_iterator begin() const { return _items.begin(); }
+	typename std::vector<T>::const_iterator end() const { return _items.end(); }
+};
+
+template<typename T>
+PoolHandle HandlePool<T>::Create(const T& item)
+{
+	uint32_t slotIndex;
+	if (!_freeSlots.empty())
+	{
+		slotIndex = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+	else
+	{
+		slotIndex = (uint32_t)_slots.size();
+		_slots.push_back({ 0, 1 });
+	}
+
+	Slot& slot = _slots[slotIndex];
+	slot.Item = (uint32_t)_items.size();
+	_items.push_back(item);
+	_itemSlots.push_back(slotIndex);
+
+	PoolHandle handle;
+	handle.Index = slotIndex;
+	handle.Generation = slot.Generation;
+	return handle;
+}
+
+template<typename T>
+bool HandlePool<T>::Destroy(PoolHandle handle)
+{
+	if (!IsValid(handle)) return false;
+
+	Slot& slot = _slots[handle.Index];
+	uint32_t hole = slot.Item;
+	uint32_t last = (uint32_t)_items.size() - 1;
+
+	if (hole != last)
+	{
+		_items[hole] = std::move(_items[last]);
+		_itemSlots[hole] = _itemSlots[last];
+		_slots[_itemSlots[hole]].Item = hole;
+	}
+	_items.pop_back();
+	_itemSlots.pop_back();
+
+	//Skip 0 on wrap around so a default handle can never match
+	slot.Generation = slot.Generation + 1 == 0 ? 1 : slot.Generation + 1;
+	_freeSlots.push_back(handle.Index);
+	return true;
+}
+
+template<typename T>
+void HandlePool<T>::Clear()
+{
+	while (!_items.empty())
+	{
+		Destroy(GetHandle(_items.size() - 1));
+	}
+}
+
+template<typename T>
+bool HandlePool<T>::IsValid(PoolHandle handle) const
+{
+	return handle.IsValid() && handle.Index < _slots.size() && _slots[handle.Index].Generation == handle.Generation;
+}
+
+template<typename T>
+T* HandlePool<T>::Get(PoolHandle handle)
+{
+	return IsValid(handle) ? &_items[_slots[handle.Index].Item] : nullptr;
+}
+
+template<typename T>
+const T* HandlePool<T>::Get(PoolHandle handle) const
+{
+	return IsValid(handle) ? &_items[_slots[handle.Index].Item] : nullptr;
+}
+
+template<typename T>
+PoolHandle HandlePool<T>::GetHandle(size_t item) const
+{
+	PoolHandle handle;
+	handle.Index = _itemSlots[item];
+	handle.Generation = _slots[handle.Index].Generation;
+	return handle;
+}
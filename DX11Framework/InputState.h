@@ -0,0 +1,35 @@
+#pragma once
+
+#include <windows.h>
+
+//Keyboard state sampled once per frame on the window's thread. GetKeyState only reflects the
+//calling thread's message queue, so the update stage works from this copy instead of asking itself
+struct InputState
+{
+	bool Held[256] = {};
+	bool Pressed[256] = {};
+
+	bool IsHeld(int key) const { return Held[key & 0xFF]; }
+	bool WasPressed(int key) const { return Pressed[key & 0xFF]; }
+
+	void Sample();
+};
+
+inline void InputState::Sample()
+{
+	BYTE keys[256];
+	if (GetKeyboardState(keys))
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			Held[i] = (keys[i] & 0x80) != 0;
+		}
+	}
+
+	//Only keys that toggle something need the pressed since last call bit
+	const int toggleKeys[] = { 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x50 };
+	for (int key : toggleKeys)
+	{
+		Pressed[key] = (GetAsyncKeyState(key) & 0x0001) != 0;
+	}
+}
@@ -0,0 +1,329 @@
+#include "JobSystem.h"
+
+//Which of the system's queues belongs to this thread, -1 for threads the system didn't create
+static thread_local int t_queueIndex = -1;
+static thread_local JobSystem* t_jobSystem = nullptr;
+
+//Every operation on top/bottom is seq_cst rather than relying on standalone fences,
+//it costs little here and keeps ThreadSanitizer able to follow the synchronisation
+bool WorkStealingQueue::Push(Job* job)
+{
+    int64_t bottom = _bottom.load(std::memory_order_relaxed);
+    int64_t top = _top.load(std::memory_order_acquire);
+
+    if (bottom - top >= CAPACITY) return false;
+
+    _jobs[bottom & MASK].store(job, std::memory_order_relaxed);
+    _bottom.store(bottom + 1, std::memory_order_seq_cst);
+
+    return true;
+}
+
+Job* WorkStealingQueue::Pop()
+{
+    int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+    _bottom.store(bottom, std::memory_order_seq_cst);
+    int64_t top = _top.load(std::memory_order_seq_cst);
+
+    if (top > bottom)
+    {
+        //Empty, put bottom back
+        _bottom.store(bottom + 1, std::memory_order_seq_cst);
+        return nullptr;
+    }
+
+    Job* job = _jobs[bottom & MASK].load(std::memory_order_relaxed);
+
+    if (top == bottom)
+    {
+        //Last job, race any thieves for it
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            job = nullptr;
+        }
+        _bottom.store(bottom + 1, std::memory_order_seq_cst);
+    }
+
+    return job;
+}
+
+Job* WorkStealingQueue::Steal()
+{
+    int64_t top = _top.load(std::memory_order_seq_cst);
+    int64_t bottom = _bottom.load(std::memory_order_seq_cst);
+
+    if (top >= bottom) return nullptr;
+
+    Job* job = _jobs[top & MASK].load(std::memory_order_relaxed);
+    if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+
+    return job;
+}
+
+void JobSystem::Initialise(int workerCount)
+{
+    if (_running) return;
+
+    if (workerCount <= 0)
+    {
+        workerCount = (int)std::thread::hardware_concurrency() - 1;
+        if (workerCount < 1) workerCount = 1;
+    }
+
+    _running = true;
+
+    for (int i = 0; i <= workerCount; i++)
+    {
+        _queues.push_back(new WorkStealingQueue());
+    }
+
+    t_queueIndex = 0;
+    t_jobSystem = this;
+
+    for (int i = 1; i <= workerCount; i++)
+    {
+        _workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+void JobSystem::Shutdown()
+{
+    if (!_running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _running = false;
+    }
+    _wake.notify_all();
+
+    for (std::thread& worker : _workers)
+    {
+        worker.join();
+    }
+    _workers.clear();
+
+    //Anything left over never ran, finish it here so no counter is left waiting forever
+    Job* job;
+    while ((job = GetJob(0)) != nullptr)
+    {
+        Execute(job);
+    }
+
+    for (WorkStealingQueue* queue : _queues)
+    {
+        delete queue;
+    }
+    _queues.clear();
+
+    if (t_jobSystem == this)
+    {
+        t_queueIndex = -1;
+        t_jobSystem = nullptr;
+    }
+}
+
+void JobSystem::WorkerLoop(int queueIndex)
+{
+    t_queueIndex = queueIndex;
+    t_jobSystem = this;
+
+    while (_running)
+    {
+        Job* job = GetJob(queueIndex);
+        if (job)
+        {
+            Execute(job);
+            continue;
+        }
+
+        //Nothing to do anywhere, sleep until Run has something. _sleepingWorkers is raised before checking
+        //_queuedJobs and Run raises _queuedJobs before checking _sleepingWorkers, so one of them always sees the other
+        _sleepingWorkers++;
+        {
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            _wake.wait(lock, [this] { return !_running || _queuedJobs.load() > 0; });
+        }
+        _sleepingWorkers--;
+    }
+}
+
+Job* JobSystem::GetJob(int queueIndex)
+{
+    //Own queue first (newest job, still warm in cache), then steal the oldest job from everyone else
+    if (queueIndex >= 0)
+    {
+        Job* job = _queues[queueIndex]->Pop();
+        if (job)
+        {
+            _queuedJobs--;
+            return job;
+        }
+    }
+
+    int queueCount = (int)_queues.size();
+    int start = queueIndex >= 0 ? queueIndex + 1 : 0;
+    for (int i = 0; i < queueCount; i++)
+    {
+        int victim = (start + i) % queueCount;
+        if (victim == queueIndex) continue;
+
+        Job* job = _queues[victim]->Steal();
+        if (job)
+        {
+            _queuedJobs--;
+            return job;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_sharedMutex);
+    if (_sharedQueue.empty()) return nullptr;
+
+    Job* job = _sharedQueue.front();
+    _sharedQueue.pop_front();
+    _queuedJobs--;
+    return job;
+}
+
+void JobSystem::Submit(Job* job)
+{
+    //Parked on the counter rather than queued, so nothing pops it, finds it blocked and spins on putting it back.
+    //The check and the park happen under the counter's lock, the same lock Finish takes it to 0 and releases under
+    if (job->Dependency)
+    {
+        std::lock_guard<std::mutex> lock(job->Dependency->Mutex);
+        if (!job->Dependency->IsDone())
+        {
+            job->Dependency->Dependents.push_back(job);
+            return;
+        }
+    }
+
+    Enqueue(job);
+}
+
+void JobSystem::Enqueue(Job* job)
+{
+    _queuedJobs++;
+
+    bool ownQueue = t_jobSystem == this && t_queueIndex >= 0;
+    if (!ownQueue || !_queues[t_queueIndex]->Push(job))
+    {
+        std::lock_guard<std::mutex> lock(_sharedMutex);
+        _sharedQueue.push_back(job);
+    }
+
+    if (_sleepingWorkers.load() > 0)
+    {
+        //Taking the lock makes sure a worker between checking its predicate and sleeping can't miss this
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+        }
+        _wake.notify_one();
+    }
+}
+
+void JobSystem::Execute(Job* job)
+{
+    job->Function();
+
+    if (job->Counter)
+    {
+        Finish(job->Counter);
+    }
+
+    delete job;
+}
+
+void JobSystem::Finish(JobCounter* counter)
+{
+    //Only the decrement that reaches 0 takes the lock, so jobs sharing a counter don't all contend on it
+    int remaining = counter->Remaining.load(std::memory_order_relaxed);
+    while (remaining > 1)
+    {
+        if (counter->Remaining.compare_exchange_weak(remaining, remaining - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) return;
+    }
+
+    std::vector<Job*> dependents;
+    {
+        std::lock_guard<std::mutex> lock(counter->Mutex);
+        if (counter->Remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            dependents.swap(counter->Dependents);
+        }
+    }
+
+    //After Shutdown there are no queues left to release them into
+    for (Job* job : dependents)
+    {
+        if (_running) Enqueue(job);
+        else Execute(job);
+    }
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter, JobCounter* dependency)
+{
+    if (counter)
+    {
+        counter->Remaining.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //Not initialised, just do it now so callers don't need a separate code path
+    if (!_running)
+    {
+        if (dependency) Wait(dependency);
+        function();
+        if (counter) Finish(counter);
+        return;
+    }
+
+    Submit(new Job{ std::move(function), counter, dependency });
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+    int queueIndex = t_jobSystem == this ? t_queueIndex : -1;
+
+    while (!counter->IsDone())
+    {
+        Job* job = _running ? GetJob(queueIndex) : nullptr;
+        if (job)
+        {
+            Execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    //The job that took it to 0 may still hold the lock releasing dependents, let it finish before the caller can destroy the counter
+    std::lock_guard<std::mutex> lock(counter->Mutex);
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)>& function)
+{
+    if (count == 0) return;
+    if (batchSize == 0) batchSize = 1;
+
+    //Not worth a job for a single batch
+    if (count <= batchSize || !_running)
+    {
+        function(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (uint32_t start = batchSize; start < count; start += batchSize)
+    {
+        uint32_t end = start + batchSize < count ? start + batchSize : count;
+        Run([&function, start, end]() { function(start, end); }, &counter);
+    }
+
+    //Calling thread does the first batch itself rather than sitting idle
+    function(0, batchSize);
+
+    Wait(&counter);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Job;
+
+//Counts jobs still outstanding, Wait on it to know a group of jobs is finished or pass it as a dependency.
+//Wait on a counter before destroying it, the job that finishes it can still be releasing dependents after IsDone
+struct JobCounter
+{
+	std::atomic<int> Remaining{ 0 };
+
+	//Jobs parked until Remaining reaches 0, released by whichever job gets it there
+	std::mutex Mutex;
+	std::vector<Job*> Dependents;
+
+	bool IsDone() { return Remaining.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job
+{
+	std::function<void()> Function;
+	JobCounter* Counter;    //Decremented when the job finishes, can be null
+	JobCounter* Dependency; //Job is parked on this until it reaches 0, can be null
+};
+
+//Chase-Lev deque. The owning thread pushes and pops at the bottom, any other thread steals from the top.
+//Fixed size, Push fails when full and the caller falls back to the shared queue
+class WorkStealingQueue
+{
+private:
+	static const int64_t CAPACITY = 4096;
+	static const int64_t MASK = CAPACITY - 1;
+
+	std::atomic<int64_t> _top{ 0 };
+	std::atomic<int64_t> _bottom{ 0 };
+	std::atomic<Job*> _jobs[CAPACITY];
+
+public:
+	bool Push(Job* job);
+	Job* Pop();
+	Job* Steal();
+};
+
+//Work stealing scheduler, one queue per worker plus one for the thread that created it.
+//Threads that aren't part of the system can still Run jobs, those go through a locked shared queue
+class JobSystem
+{
+private:
+	std::vector<std::thread> _workers;
+	std::vector<WorkStealingQueue*> _queues; //Index 0 belongs to the thread that called Initialise
+
+	std::mutex _sharedMutex;
+	std::deque<Job*> _sharedQueue;
+
+	std::mutex _sleepMutex;
+	std::condition_variable _wake;
+	std::atomic<int> _queuedJobs{ 0 };
+	std::atomic<int> _sleepingWorkers{ 0 };
+	std::atomic<bool> _running{ false };
+
+	void WorkerLoop(int queueIndex);
+	Job* GetJob(int queueIndex);
+	void Submit(Job* job);
+	void Enqueue(Job* job);
+	void Execute(Job* job);
+	void Finish(JobCounter* counter);
+
+public:
+	JobSystem() = default;
+	~JobSystem() { Shutdown(); }
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	//workerCount 0 uses one worker per hardware thread minus the calling thread
+	void Initialise(int workerCount = 0);
+	void Shutdown();
+
+	void Run(std::function<void()> function, JobCounter* counter, JobCounter* dependency = nullptr);
+
+	//Runs other jobs while waiting so the calling thread is never just blocked
+	void Wait(JobCounter* counter);
+
+	//Calls function(start, end) over [0, count) in batches spread across the workers, returns when all are done
+	void ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)>& function);
+
+	int GetWorkerCount() { return (int)_workers.size(); }
+	bool IsRunning() { return _running.load(); }
+};
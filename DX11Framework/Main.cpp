@@ -1,20 +1,97 @@
 #include <windows.h>
 #include "DX11Framework.h"
+#include "StressScene.h"
+#include "TextureBaker.h"
+#include "TexturePacker.h"
+#include "AssetPacker.h"
+#include "JobSystem.h"
 
 //Dependencies:user32.lib;d3d11.lib;d3dcompiler.lib;dxgi.lib;
 
 int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPWSTR lpCmdLine, _In_ int nCmdShow)
 {
 	UNREFERENCED_PARAMETER(hPrevInstance);
-	UNREFERENCED_PARAMETER(lpCmdLine);
+
+	//-generate-scene writes a stress scene from JSON/stressSettings.json and exits, -objects N overrides its object count
+	if (wcsstr(lpCmdLine, L"-generate-scene") != nullptr)
+	{
+		StressSceneSettings settings;
+		if (!StressScene::LoadSettings("JSON/stressSettings.json", settings)) return -1;
+
+		const wchar_t* objects = wcsstr(lpCmdLine, L"-objects ");
+		if (objects) settings.ObjectCount = _wtoi(objects + wcslen(L"-objects "));
+
+		StressScene::FindAssets(settings);
+		return StressScene::Generate(settings) ? 0 : -1;
+	}
+
+	//-bake-textures compresses the textures listed by JSON/bakeSettings.json to BC formats, writes a report and exits
+	if (wcsstr(lpCmdLine, L"-bake-textures") != nullptr)
+	{
+		TextureBakeSettings settings;
+		if (!TextureBaker::LoadSettings("JSON/bakeSettings.json", settings)) return -1;
+		TextureBaker::FindInputs(settings);
+
+		JobSystem jobSystem;
+		jobSystem.Initialise();
+		bool baked = TextureBaker::Run(settings, &jobSystem);
+		jobSystem.Shutdown();
+		return baked ? 0 : -1;
+	}
+
+	//-pack-textures groups the textures listed by JSON/packSettings.json into arrays and atlases, writes their manifest and exits
+	if (wcsstr(lpCmdLine, L"-pack-textures") != nullptr)
+	{
+		TexturePackSettings settings;
+		if (!TexturePacker::LoadSettings("JSON/packSettings.json", settings)) return -1;
+		TexturePacker::FindInputs(settings);
+
+		JobSystem jobSystem;
+		jobSystem.Initialise();
+		bool packed = TexturePacker::Run(settings, &jobSystem);
+		jobSystem.Shutdown();
+		return packed ? 0 : -1;
+	}
+
+	//-compile-shaders brings SimpleShaders.cache up to date with the HLSL and exits, release builds run it after linking
+	if (wcsstr(lpCmdLine, L"-compile-shaders") != nullptr)
+	{
+		return SUCCEEDED(DX11Framework::CompileShaders()) ? 0 : -1;
+	}
+
+	//-pack-assets packs the scenes and files listed by JSON/archiveSettings.json into one archive and exits
+	if (wcsstr(lpCmdLine, L"-pack-assets") != nullptr)
+	{
+		AssetPackSettings settings;
+		if (!AssetPacker::LoadSettings("JSON/archiveSettings.json", settings)) return -1;
+		bool found = AssetPacker::FindInputs(settings);
+
+		JobSystem jobSystem;
+		jobSystem.Initialise();
+		bool packed = AssetPacker::Run(settings, &jobSystem);
+		jobSystem.Shutdown();
+		return found && packed ? 0 : -1;
+	}
 
 	DX11Framework application = DX11Framework();
 
+	//-benchmark renders a recorded camera path headless and writes timings and captures instead of running interactively
+	bool benchmark = wcsstr(lpCmdLine, L"-benchmark") != nullptr;
+	if (benchmark && !application.EnableBenchmark("JSON/benchmark.json"))
+	{
+		return -1;
+	}
+
 	if (FAILED(application.Initialise(hInstance, nCmdShow)))
 	{
 		return -1;
 	}
 
+	if (benchmark)
+	{
+		return application.RunBenchmark();
+	}
+
 	// Main message loop
 	MSG msg = { 0 };
 
@@ -26,10 +103,10 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 			TranslateMessage(&msg);
 			DispatchMessageW(&msg);
 		}
-		else
+		else if (application.WaitForNextFrame())
 		{
-			application.Update();
-			application.Draw();
+			//Sleeps until the next frame is due (or input arrives) instead of spinning, and skips Draw when nothing changed
+			application.RunFrame();
 		}
 	}
 
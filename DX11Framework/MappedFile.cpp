@@ -0,0 +1,118 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+
+#include <string>
+
+bool MappedFile::Open(const wchar_t* filename)
+{
+    Close();
+
+    _file = CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_file == INVALID_HANDLE_VALUE) return false;
+
+    //A 32 bit build can't map more than its address space, so anything bigger than size_t is refused
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_file, &fileSize) || fileSize.QuadPart == 0 || (uint64_t)fileSize.QuadPart > (uint64_t)SIZE_MAX)
+    {
+        Close();
+        return false;
+    }
+
+    _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!_mapping)
+    {
+        Close();
+        return false;
+    }
+
+    _data = (const uint8_t*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!_data)
+    {
+        Close();
+        return false;
+    }
+
+    _size = (size_t)fileSize.QuadPart;
+
+    return true;
+}
+
+bool MappedFile::Open(const char* filename)
+{
+    int length = MultiByteToWideChar(CP_UTF8, 0, filename, -1, nullptr, 0);
+    if (length <= 0) return false;
+
+    std::wstring wideName(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, filename, -1, &wideName[0], length);
+    return Open(wideName.c_str());
+}
+
+void MappedFile::Close()
+{
+    if (_data) UnmapViewOfFile(_data);
+    if (_mapping) CloseHandle(_mapping);
+    if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+
+    _data = nullptr;
+    _mapping = nullptr;
+    _file = INVALID_HANDLE_VALUE;
+    _size = 0;
+}
+
+#else
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+
+bool MappedFile::Open(const wchar_t* filename)
+{
+    size_t length = wcstombs(nullptr, filename, 0);
+    if (length == (size_t)-1) return false;
+
+    std::string narrowName(length, '\0');
+    wcstombs(&narrowName[0], filename, length);
+    return Open(narrowName.c_str());
+}
+
+bool MappedFile::Open(const char* filename)
+{
+    Close();
+
+    int file = open(filename, O_RDONLY | O_CLOEXEC);
+    if (file < 0) return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size <= 0 || (uint64_t)status.st_size > (uint64_t)SIZE_MAX)
+    {
+        close(file);
+        return false;
+    }
+
+    //The mapping keeps its own reference to the file, the descriptor isn't needed once it exists
+    void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) return false;
+
+    //Same hint FILE_FLAG_SEQUENTIAL_SCAN gives on Windows, read ahead and drop pages behind
+    madvise(data, (size_t)status.st_size, MADV_SEQUENTIAL);
+
+    _data = (const uint8_t*)data;
+    _size = (size_t)status.st_size;
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (_data) munmap((void*)_data, _size);
+
+    _data = nullptr;
+    _size = 0;
+}
+
+#endif
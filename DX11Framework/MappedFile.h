@@ -0,0 +1,35 @@
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <stdint.h>
+#include <stddef.h>
+
+//Read only view of a whole file, the OS pages it in on demand so there is no copy into our own buffer.
+//File mapping on Windows, mmap everywhere else, sizes are 64 bit on both so large files are fine in a 64 bit build
+class MappedFile
+{
+private:
+#ifdef _WIN32
+	HANDLE _file = INVALID_HANDLE_VALUE;
+	HANDLE _mapping = nullptr;
+#endif
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+
+public:
+	MappedFile() = default;
+	~MappedFile() { Close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const wchar_t* filename);
+	bool Open(const char* filename); //UTF-8
+	void Close();
+
+	bool IsOpen() { return _data != nullptr; }
+	const uint8_t* GetData() { return _data; }
+	size_t GetSize() { return _size; }
+};
@@ -0,0 +1,289 @@
+#include "MipGenerator.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <functional>
+#include <math.h>
+#include <string.h>
+#include <xmmintrin.h>
+
+const float MIP_PI = 3.14159265f;
+const float KAISER_ALPHA = 4.0f;
+const float FILTER_RADIUS = 3.0f; //In output pixels, for Kaiser and Lanczos
+
+//Which source pixels make each output pixel along one axis. Every output has the same number of taps, padded with
+//zero weights, so the inner loops never branch
+struct FilterTaps
+{
+    uint32_t Count = 0;
+    std::vector<uint32_t> Sources;
+    std::vector<float> Weights;
+};
+
+//sRGB to linear for each 8 bit value, and the linear value halfway between each pair of neighbours for rounding back
+struct SRGBTables
+{
+    float ToLinear[256];
+    float Thresholds[255];
+
+    SRGBTables()
+    {
+        for (int i = 0; i < 256; i++) ToLinear[i] = Decode(i / 255.0f);
+        for (int i = 0; i < 255; i++) Thresholds[i] = Decode((i + 0.5f) / 255.0f);
+    }
+
+    static float Decode(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+    }
+};
+
+static const SRGBTables& GetSRGBTables()
+{
+    static const SRGBTables tables;
+    return tables;
+}
+
+static float Sinc(float x)
+{
+    if (fabsf(x) < 1e-5f) return 1.0f;
+    x *= MIP_PI;
+    return sinf(x) / x;
+}
+
+//Zeroth order modified Bessel function of the first kind, the series converges in a few terms for the sizes used here
+static float BesselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    for (int k = 1; k < 32 && term > sum * 1e-8f; k++)
+    {
+        float half = x / (2.0f * k);
+        term *= half * half;
+        sum += term;
+    }
+    return sum;
+}
+
+//Weight at x output pixels from the centre of an output pixel
+static float EvaluateFilter(MipFilter filter, float x)
+{
+    switch (filter)
+    {
+    case MIP_FILTER_KAISER:
+    {
+        float t = x / FILTER_RADIUS;
+        if (fabsf(t) >= 1.0f) return 0.0f;
+        return Sinc(x) * BesselI0(KAISER_ALPHA * sqrtf(1.0f - t * t)) / BesselI0(KAISER_ALPHA);
+    }
+
+    case MIP_FILTER_LANCZOS:
+        if (fabsf(x) >= FILTER_RADIUS) return 0.0f;
+        return Sinc(x) * Sinc(x / FILTER_RADIUS);
+
+    default:
+        return fabsf(x) < 0.5f ? 1.0f : 0.0f;
+    }
+}
+
+static void BuildTaps(uint32_t sourceSize, uint32_t outputSize, const MipSettings& settings, FilterTaps& taps)
+{
+    //Odd sizes round down, so an output pixel can cover a little more than two source pixels
+    float scale = (float)sourceSize / outputSize;
+    float radius = (settings.Filter == MIP_FILTER_BOX ? 0.5f : FILTER_RADIUS) * scale;
+
+    taps.Count = (uint32_t)ceilf(radius * 2.0f) + 1;
+    taps.Sources.resize((size_t)outputSize * taps.Count);
+    taps.Weights.resize((size_t)outputSize * taps.Count);
+
+    for (uint32_t i = 0; i < outputSize; i++)
+    {
+        float centre = (i + 0.5f) * scale;
+        int first = (int)floorf(centre - radius);
+        float total = 0.0f;
+
+        for (uint32_t t = 0; t < taps.Count; t++)
+        {
+            int source = first + (int)t;
+            float weight = EvaluateFilter(settings.Filter, (source + 0.5f - centre) / scale);
+            if (settings.Wrap) source = ((source % (int)sourceSize) + (int)sourceSize) % (int)sourceSize;
+            else source = std::min(std::max(source, 0), (int)sourceSize - 1);
+
+            taps.Sources[i * taps.Count + t] = (uint32_t)source;
+            taps.Weights[i * taps.Count + t] = weight;
+            total += weight;
+        }
+
+        for (uint32_t t = 0; t < taps.Count; t++) taps.Weights[i * taps.Count + t] /= total;
+    }
+}
+
+static void ForRows(uint32_t rows, JobSystem* jobSystem, const std::function<void(uint32_t, uint32_t)>& function)
+{
+    if (jobSystem && jobSystem->IsRunning() && rows > 1)
+    {
+        jobSystem->ParallelFor(rows, std::max(rows / (uint32_t)(jobSystem->GetWorkerCount() * 4 + 1), 1u), function);
+    }
+    else
+    {
+        function(0, rows);
+    }
+}
+
+//Fraction of pixels whose alpha, scaled, passes the test
+static float GetCoverage(const float* pixels, size_t pixelCount, float scale, float reference)
+{
+    size_t passed = 0;
+    for (size_t i = 0; i < pixelCount; i++) passed += pixels[i * 4 + 3] * scale > reference;
+    return (float)passed / pixelCount;
+}
+
+//Binary search for the alpha scale that gets closest to the top mip's coverage, the same search DirectXTex does
+static float GetAlphaScale(const float* pixels, size_t pixelCount, float targetCoverage, float reference)
+{
+    float low = 0.0f;
+    float high = 4.0f;
+    float best = 1.0f;
+    float bestError = fabsf(GetCoverage(pixels, pixelCount, 1.0f, reference) - targetCoverage);
+
+    for (int i = 0; i < 16; i++)
+    {
+        float scale = (low + high) * 0.5f;
+        float coverage = GetCoverage(pixels, pixelCount, scale, reference);
+        float error = fabsf(coverage - targetCoverage);
+        if (error < bestError)
+        {
+            bestError = error;
+            best = scale;
+        }
+
+        if (coverage < targetCoverage) low = scale;
+        else if (coverage > targetCoverage) high = scale;
+        else break;
+    }
+    return best;
+}
+
+static uint8_t ToUnorm(float value)
+{
+    return (uint8_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+static uint8_t ToSRGB(float value)
+{
+    const float* thresholds = GetSRGBTables().Thresholds;
+    return (uint8_t)(std::upper_bound(thresholds, thresholds + 255, value) - thresholds);
+}
+
+uint32_t MipGenerator::GetMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t count = 1;
+    while ((std::max(width, height) >> count) > 0) count++;
+    return count;
+}
+
+void MipGenerator::Generate(const uint8_t* pixels, size_t pitch, uint32_t width, uint32_t height, uint32_t mipCount, const MipSettings& settings,
+    std::vector<std::vector<uint8_t>>& mips, JobSystem* jobSystem)
+{
+    mips.resize(std::max(mipCount, 1u));
+    mips[0].resize((size_t)width * height * 4);
+    for (uint32_t y = 0; y < height; y++) memcpy(mips[0].data() + (size_t)y * width * 4, pixels + y * pitch, (size_t)width * 4);
+    if (mipCount <= 1) return;
+
+    const float* toLinear = GetSRGBTables().ToLinear;
+    std::vector<float> level((size_t)width * height * 4);
+    ForRows(height, jobSystem, [&](uint32_t start, uint32_t end)
+    {
+        for (size_t i = (size_t)start * width * 4; i < (size_t)end * width * 4; i++)
+        {
+            bool linear = settings.SRGB && (i & 3) != 3;
+            level[i] = linear ? toLinear[mips[0][i]] : mips[0][i] / 255.0f;
+        }
+    });
+
+    float targetCoverage = settings.AlphaCoverageReference > 0.0f ? GetCoverage(level.data(), (size_t)width * height, 1.0f, settings.AlphaCoverageReference) : 0.0f;
+
+    std::vector<float> horizontal;
+    std::vector<float> next;
+    FilterTaps columnTaps;
+    FilterTaps rowTaps;
+    for (uint32_t mip = 1; mip < mipCount; mip++)
+    {
+        uint32_t outputWidth = std::max(width >> 1, 1u);
+        uint32_t outputHeight = std::max(height >> 1, 1u);
+        BuildTaps(width, outputWidth, settings, columnTaps);
+        BuildTaps(height, outputHeight, settings, rowTaps);
+
+        //Across each row first, then down the columns of that, a pixel's four channels are one SSE register
+        horizontal.resize((size_t)outputWidth * height * 4);
+        ForRows(height, jobSystem, [&](uint32_t start, uint32_t end)
+        {
+            for (uint32_t y = start; y < end; y++)
+            {
+                const float* source = level.data() + (size_t)y * width * 4;
+                float* output = horizontal.data() + (size_t)y * outputWidth * 4;
+                for (uint32_t x = 0; x < outputWidth; x++)
+                {
+                    const uint32_t* sources = columnTaps.Sources.data() + x * columnTaps.Count;
+                    const float* weights = columnTaps.Weights.data() + x * columnTaps.Count;
+                    __m128 sum = _mm_setzero_ps();
+                    for (uint32_t t = 0; t < columnTaps.Count; t++)
+                    {
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(source + sources[t] * 4), _mm_set1_ps(weights[t])));
+                    }
+                    _mm_storeu_ps(output + x * 4, sum);
+                }
+            }
+        });
+
+        //Each output row adds up whole source rows, which keeps the reads in order
+        next.resize((size_t)outputWidth * outputHeight * 4);
+        ForRows(outputHeight, jobSystem, [&](uint32_t start, uint32_t end)
+        {
+            size_t rowFloats = (size_t)outputWidth * 4;
+            for (uint32_t y = start; y < end; y++)
+            {
+                float* output = next.data() + y * rowFloats;
+                memset(output, 0, rowFloats * sizeof(float));
+                for (uint32_t t = 0; t < rowTaps.Count; t++)
+                {
+                    const float* source = horizontal.data() + rowTaps.Sources[y * rowTaps.Count + t] * rowFloats;
+                    __m128 weight = _mm_set1_ps(rowTaps.Weights[y * rowTaps.Count + t]);
+                    for (size_t i = 0; i < rowFloats; i += 4)
+                    {
+                        _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_mul_ps(_mm_loadu_ps(source + i), weight)));
+                    }
+                }
+            }
+        });
+
+        //Only the stored alpha is scaled, the next level is still filtered from the unscaled one
+        size_t pixelCount = (size_t)outputWidth * outputHeight;
+        float alphaScale = settings.AlphaCoverageReference > 0.0f ? GetAlphaScale(next.data(), pixelCount, targetCoverage, settings.AlphaCoverageReference) : 1.0f;
+
+        std::vector<uint8_t>& output = mips[mip];
+        output.resize(pixelCount * 4);
+        ForRows(outputHeight, jobSystem, [&](uint32_t start, uint32_t end)
+        {
+            for (size_t i = (size_t)start * outputWidth; i < (size_t)end * outputWidth; i++)
+            {
+                for (int c = 0; c < 3; c++) output[i * 4 + c] = settings.SRGB ? ToSRGB(next[i * 4 + c]) : ToUnorm(next[i * 4 + c]);
+                output[i * 4 + 3] = ToUnorm(next[i * 4 + 3] * alphaScale);
+            }
+        });
+
+        level.swap(next);
+        width = outputWidth;
+        height = outputHeight;
+    }
+}
+
+const char* MipGenerator::GetFilterName(MipFilter filter)
+{
+    switch (filter)
+    {
+    case MIP_FILTER_BOX: return "Box";
+    case MIP_FILTER_KAISER: return "Kaiser";
+    case MIP_FILTER_LANCZOS: return "Lanczos";
+    }
+    return "";
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+class JobSystem;
+
+enum MipFilter
+{
+	MIP_FILTER_BOX,     //2x2 average, fastest and the softest
+	MIP_FILTER_KAISER,  //Kaiser windowed sinc, sharp with little ringing, what the baker uses
+	MIP_FILTER_LANCZOS  //Lanczos 3, sharpest but rings a little round hard edges
+};
+
+struct MipSettings
+{
+	MipFilter Filter = MIP_FILTER_KAISER;
+	bool SRGB = false;                   //Colour is filtered as linear light, alpha never is
+	bool Wrap = true;                    //Filters read past the edges from the other side, as the wrapping sampler does
+	float AlphaCoverageReference = 0.0f; //Alpha tested textures give this the test value so each mip keeps the top mip's coverage, 0 turns it off
+};
+
+//Builds mip chains for RGBA8 images on the CPU, once at bake or load time rather than on a device. Channels are in any
+//order as long as alpha is the fourth. Each level is filtered from the one above in float so rounding never builds up,
+//four channels at a time with SSE, and rows are shared out over jobSystem when there is one
+namespace MipGenerator
+{
+	//Down to 1x1
+	uint32_t GetMipCount(uint32_t width, uint32_t height);
+
+	//mips[0] is a copy of pixels, each after it is tightly packed and half the size, down to mipCount levels
+	void Generate(const uint8_t* pixels, size_t pitch, uint32_t width, uint32_t height, uint32_t mipCount, const MipSettings& settings,
+		std::vector<std::vector<uint8_t>>& mips, JobSystem* jobSystem = nullptr);
+
+	const char* GetFilterName(MipFilter filter);
+};
@@ -1,5 +1,6 @@
 #include "OBJLoader.h"
 #include <string>
+#include <string.h>
 
 bool OBJLoader::FindSimilarVertex(const SimpleVertex& vertex, std::map<SimpleVertex, unsigned short>& vertToIndexMap, unsigned short& index)
 {
@@ -62,6 +63,31 @@ void OBJLoader::CreateIndices(const std::vector<XMFLOAT3>& inVertices,
 	}
 }
 
+XMFLOAT4 OBJLoader::ComputeBounds(const SimpleVertex* vertices, unsigned int numVertices)
+{
+	if (numVertices == 0) return XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+
+	XMVECTOR minimum = XMLoadFloat3(&vertices[0].Pos);
+	XMVECTOR maximum = minimum;
+	for (unsigned int i = 1; i < numVertices; ++i)
+	{
+		XMVECTOR position = XMLoadFloat3(&vertices[i].Pos);
+		minimum = XMVectorMin(minimum, position);
+		maximum = XMVectorMax(maximum, position);
+	}
+
+	XMVECTOR centre = XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f);
+	XMVECTOR radiusSquared = XMVectorZero();
+	for (unsigned int i = 0; i < numVertices; ++i)
+	{
+		radiusSquared = XMVectorMax(radiusSquared, XMVector3LengthSq(XMVectorSubtract(XMLoadFloat3(&vertices[i].Pos), centre)));
+	}
+
+	XMFLOAT4 bounds;
+	XMStoreFloat4(&bounds, XMVectorSetW(centre, sqrtf(XMVectorGetX(radiusSquared))));
+	return bounds;
+}
+
 //WARNING: This code makes a big assumption -- that your models have texture coordinates AND normals which they should have anyway (else you can't do texturing and lighting!)
 //If your .obj file has no lines beginning with "vt" or "vn", then you'll need to change the Export settings in your modelling software so that it exports the texture coordinates 
 //and normals. If you still have no "vt" lines, you'll need to do some texture unwrapping, also known as UV unwrapping.
@@ -70,7 +96,15 @@ MeshData OBJLoader::Load(char* filename, ID3D11Device* _pd3dDevice, bool invertT
 	std::string binaryFilename = filename;
 	binaryFilename.append("Binary");
 	std::ifstream binaryInFile;
-	binaryInFile.open(binaryFilename, std::ios::in | std::ios::binary);
+
+	//The binary is only used while it is at least as new as the OBJ, editing the OBJ makes it parse again
+	WIN32_FILE_ATTRIBUTE_DATA source;
+	WIN32_FILE_ATTRIBUTE_DATA binary;
+	if (!GetFileAttributesExA(filename, GetFileExInfoStandard, &source) || !GetFileAttributesExA(binaryFilename.c_str(), GetFileExInfoStandard, &binary) ||
+		CompareFileTime(&binary.ftLastWriteTime, &source.ftLastWriteTime) >= 0)
+	{
+		binaryInFile.open(binaryFilename, std::ios::in | std::ios::binary);
+	}
 
 	if(!binaryInFile.good())
 	{
@@ -223,6 +257,7 @@ MeshData OBJLoader::Load(char* filename, ID3D11Device* _pd3dDevice, bool invertT
 			meshData.VertexBuffer = vertexBuffer;
 			meshData.VBOffset = 0;
 			meshData.VBStride = sizeof(SimpleVertex);
+			meshData.Bounds = ComputeBounds(finalVerts, numMeshVertices);
 
 			unsigned short* indicesArray = new unsigned short[meshIndices.size()];
 			unsigned int numMeshIndices = meshIndices.size();
@@ -297,6 +332,7 @@ MeshData OBJLoader::Load(char* filename, ID3D11Device* _pd3dDevice, bool invertT
 		meshData.VertexBuffer = vertexBuffer;
 		meshData.VBOffset = 0;
 		meshData.VBStride = sizeof(SimpleVertex);
+		meshData.Bounds = ComputeBounds(finalVerts, numVertices);
 
 		ID3D11Buffer* indexBuffer;
 
@@ -319,4 +355,75 @@ MeshData OBJLoader::Load(char* filename, ID3D11Device* _pd3dDevice, bool invertT
 
 		return meshData;
 	}
+}
+
+//A mesh already in the .objBinary layout, such as one read out of an asset archive
+MeshData OBJLoader::LoadBinary(const uint8_t* data, size_t size, ID3D11Device* _pd3dDevice)
+{
+	MeshData meshData;
+	unsigned int numVertices;
+	unsigned int numIndices;
+
+	//Read in array sizes, then check the arrays are really there so a truncated file is a failed load not a crash.
+	//An empty mesh is refused too, D3D won't make a zero sized buffer
+	size_t headerSize = sizeof(unsigned int) * 2;
+	if (size < headerSize)
+	{
+		return MeshData();
+	}
+	memcpy(&numVertices, data, sizeof(unsigned int));
+	memcpy(&numIndices, data + sizeof(unsigned int), sizeof(unsigned int));
+	if (numVertices == 0 || numIndices == 0 ||
+		size < headerSize + sizeof(SimpleVertex) * (size_t)numVertices + sizeof(unsigned short) * (size_t)numIndices)
+	{
+		return MeshData();
+	}
+
+	//The buffers are made straight from the file's bytes, nothing is copied on the way
+	const SimpleVertex* finalVerts = (const SimpleVertex*)(data + headerSize);
+	const unsigned short* indices = (const unsigned short*)(finalVerts + numVertices);
+
+	ID3D11Buffer* vertexBuffer = nullptr;
+
+	D3D11_BUFFER_DESC bd;
+	ZeroMemory(&bd, sizeof(bd));
+	bd.Usage = D3D11_USAGE_DEFAULT;
+	bd.ByteWidth = sizeof(SimpleVertex) * numVertices;
+	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bd.CPUAccessFlags = 0;
+
+	D3D11_SUBRESOURCE_DATA InitData;
+	ZeroMemory(&InitData, sizeof(InitData));
+	InitData.pSysMem = finalVerts;
+
+	if (FAILED(_pd3dDevice->CreateBuffer(&bd, &InitData, &vertexBuffer)))
+	{
+		return MeshData();
+	}
+
+	meshData.VertexBuffer = vertexBuffer;
+	meshData.VBOffset = 0;
+	meshData.VBStride = sizeof(SimpleVertex);
+	meshData.Bounds = ComputeBounds(finalVerts, numVertices);
+
+	ID3D11Buffer* indexBuffer = nullptr;
+
+	ZeroMemory(&bd, sizeof(bd));
+	bd.Usage = D3D11_USAGE_DEFAULT;
+	bd.ByteWidth = sizeof(WORD) * numIndices;     
+	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	bd.CPUAccessFlags = 0;
+
+	ZeroMemory(&InitData, sizeof(InitData));
+	InitData.pSysMem = indices;
+	if (FAILED(_pd3dDevice->CreateBuffer(&bd, &InitData, &indexBuffer)))
+	{
+		vertexBuffer->Release();
+		return MeshData();
+	}
+
+	meshData.IndexCount = numIndices;
+	meshData.IndexBuffer = indexBuffer;
+
+	return meshData;
 }
\ No newline at end of file
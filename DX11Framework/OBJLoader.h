@@ -2,6 +2,7 @@
 #include <windows.h>
 #include <d3d11_1.h>
 #include <directxmath.h>
+#include <stdint.h>
 #include <fstream>		//For loading in an external file
 #include <vector>		//For storing the XMFLOAT3/2 variables
 #include <map>			//For fast searching when re-creating the index buffer
@@ -15,10 +16,16 @@ namespace OBJLoader
 	//The only method you'll need to call
 	MeshData Load(char* filename, ID3D11Device* _pd3dDevice, bool invertTexCoords = true);
 
+	//Vertex and index buffers made straight from data in the .objBinary layout, empty if it is shorter than its counts say
+	MeshData LoadBinary(const uint8_t* data, size_t size, ID3D11Device* _pd3dDevice);
+
 	//Helper methods for the above method
 	//Searhes to see if a similar vertex already exists in the buffer -- if true, we re-use that index
 	bool FindSimilarVertex(const SimpleVertex& vertex, std::map<SimpleVertex, unsigned short>& vertToIndexMap, unsigned short& index);
 
+	//Sphere around the middle of the vertices' bounding box, good enough for culling
+	XMFLOAT4 ComputeBounds(const SimpleVertex* vertices, unsigned int numVertices);
+
 	//Re-creates a single index buffer from the 3 given in the OBJ file
 	void CreateIndices(const std::vector<XMFLOAT3>& inVertices, const std::vector<XMFLOAT2>& inTexCoords, const std::vector<XMFLOAT3>& inNormals, std::vector<unsigned short>& outIndices, std::vector<XMFLOAT3>& outVertices, std::vector<XMFLOAT2>& outTexCoords, std::vector<XMFLOAT3>& outNormals);
 };
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "ObjectStore.h"
+#include <cmath>
+#include <emmintrin.h>
+
+//RotationY * Scaling * Translation written out, with s and c already multiplied by the scale. Skips the two
+//full matrix multiplies and all the zero terms they would spend time on
+static inline void WriteWorld(const XMFLOAT3& position, float s, float c, float scale, const XMFLOAT4& localBounds, XMFLOAT4X4& world, XMFLOAT4& worldBounds)
+{
+    world = XMFLOAT4X4(c, 0.0f, -s, 0.0f,
+                       0.0f, scale, 0.0f, 0.0f,
+                       s, 0.0f, c, 0.0f,
+                       position.x, position.y, position.z, 1.0f);
+
+    worldBounds.x = localBounds.x * c + localBounds.z * s + position.x;
+    worldBounds.y = localBounds.y * scale + position.y;
+    worldBounds.z = localBounds.z * c - localBounds.x * s + position.z;
+    worldBounds.w = localBounds.w * fabsf(scale);
+}
+
+void BuildWorldMatrices(const XMFLOAT3* positions, const float* rotations, const float* scales, const XMFLOAT4* localBounds, XMFLOAT4X4* worlds, XMFLOAT4* worldBounds, size_t count)
+{
+    size_t i = 0;
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 wOne = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    //Four objects a pass. Rotations, scales and bounds are worked on a lane per object and shuffled out into rows,
+    //so every matrix is four stores with no scalar math in between
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 scale = _mm_loadu_ps(scales + i);
+
+        XMVECTOR sine;
+        XMVECTOR cosine;
+        XMVectorSinCos(&sine, &cosine, _mm_loadu_ps(rotations + i));
+        __m128 s = _mm_mul_ps(sine, scale);
+        __m128 c = _mm_mul_ps(cosine, scale);
+
+        //Rows 0 and 2 are (c, 0, -s, 0) and (s, 0, c, 0). Interleaving with zero spreads each pair across the row
+        __m128 row0Low = _mm_unpacklo_ps(c, _mm_xor_ps(s, signMask));
+        __m128 row0High = _mm_unpackhi_ps(c, _mm_xor_ps(s, signMask));
+        __m128 row2Low = _mm_unpacklo_ps(s, c);
+        __m128 row2High = _mm_unpackhi_ps(s, c);
+        __m128 row1Low = _mm_unpacklo_ps(zero, scale);
+        __m128 row1High = _mm_unpackhi_ps(zero, scale);
+
+        //Four XMFLOAT3s are exactly three registers, each position is shifted down to the front of one
+        const float* position = &positions[i].x;
+        __m128 p0 = _mm_loadu_ps(position);
+        __m128 p1 = _mm_loadu_ps(position + 4);
+        __m128 p2 = _mm_loadu_ps(position + 8);
+        __m128 row3[4] =
+        {
+            p0,
+            _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(1, 0, 3, 3)),
+            _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(0, 0, 3, 2)),
+            _mm_shuffle_ps(p2, p2, _MM_SHUFFLE(3, 3, 2, 1)),
+        };
+        row3[1] = _mm_shuffle_ps(row3[1], row3[1], _MM_SHUFFLE(3, 3, 2, 1));
+        for (int j = 0; j < 4; j++) row3[j] = _mm_or_ps(_mm_and_ps(row3[j], xyzMask), wOne);
+
+        float* world = &worlds[i]._11;
+        _mm_storeu_ps(world, _mm_unpacklo_ps(row0Low, zero));
+        _mm_storeu_ps(world + 4, _mm_movelh_ps(row1Low, zero));
+        _mm_storeu_ps(world + 8, _mm_unpacklo_ps(row2Low, zero));
+        _mm_storeu_ps(world + 12, row3[0]);
+        _mm_storeu_ps(world + 16, _mm_unpackhi_ps(row0Low, zero));
+        _mm_storeu_ps(world + 20, _mm_movehl_ps(zero, row1Low));
+        _mm_storeu_ps(world + 24, _mm_unpackhi_ps(row2Low, zero));
+        _mm_storeu_ps(world + 28, row3[1]);
+        _mm_storeu_ps(world + 32, _mm_unpacklo_ps(row0High, zero));
+        _mm_storeu_ps(world + 36, _mm_movelh_ps(row1High, zero));
+        _mm_storeu_ps(world + 40, _mm_unpacklo_ps(row2High, zero));
+        _mm_storeu_ps(world + 44, row3[2]);
+        _mm_storeu_ps(world + 48, _mm_unpackhi_ps(row0High, zero));
+        _mm_storeu_ps(world + 52, _mm_movehl_ps(zero, row1High));
+        _mm_storeu_ps(world + 56, _mm_unpackhi_ps(row2High, zero));
+        _mm_storeu_ps(world + 60, row3[3]);
+
+        //Bounds the same way as WriteWorld but a lane per object, in and out through a transpose
+        __m128 bx = _mm_loadu_ps(&localBounds[i].x);
+        __m128 by = _mm_loadu_ps(&localBounds[i + 1].x);
+        __m128 bz = _mm_loadu_ps(&localBounds[i + 2].x);
+        __m128 bw = _mm_loadu_ps(&localBounds[i + 3].x);
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+        __m128 px = row3[0];
+        __m128 py = row3[1];
+        __m128 pz = row3[2];
+        __m128 pw = row3[3];
+        _MM_TRANSPOSE4_PS(px, py, pz, pw);
+
+        __m128 wx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(bx, c), _mm_mul_ps(bz, s)), px);
+        __m128 wy = _mm_add_ps(_mm_mul_ps(by, scale), py);
+        __m128 wz = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(bz, c), _mm_mul_ps(bx, s)), pz);
+        __m128 ww = _mm_mul_ps(bw, _mm_andnot_ps(signMask, scale));
+        _MM_TRANSPOSE4_PS(wx, wy, wz, ww);
+
+        _mm_storeu_ps(&worldBounds[i].x, wx);
+        _mm_storeu_ps(&worldBounds[i + 1].x, wy);
+        _mm_storeu_ps(&worldBounds[i + 2].x, wz);
+        _mm_storeu_ps(&worldBounds[i + 3].x, ww);
+    }
+
+    for (; i < count; i++)
+    {
+        float sine;
+        float cosine;
+        XMScalarSinCos(&sine, &cosine, rotations[i]);
+        WriteWorld(positions[i], sine * scales[i], cosine * scales[i], scales[i], localBounds[i], worlds[i], worldBounds[i]);
+    }
+}
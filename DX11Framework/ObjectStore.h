@@ -0,0 +1,482 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "HandlePool.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+//Builds World = RotationY * Scaling * Translation (uniform scale) for count objects, four at a time, and moves
+//each object's local bounding sphere (xyz centre, w radius) into world space on the way
+void BuildWorldMatrices(const XMFLOAT3* positions, const float* rotations, const float* scales, const XMFLOAT4* localBounds, XMFLOAT4X4* worlds, XMFLOAT4* worldBounds, size_t count);
+
+//Scene objects split by how often they get touched. Transforms, world matrices, bounds and sort keys each have
+//their own packed array in the same order as the pool holding the cold per-object data, so the per-frame loops
+//only pull in the arrays they actually use.
+//World matrices and bounds are cached, only objects whose transform was set since the last update get rebuilt,
+//and those objects are listed in GetChanged afterwards for anything that keeps its own copy of them.
+//An object can have a parent, its transform is then relative to the parent's world. Children are kept in a flat
+//list sorted by depth, so propagation is one pass down that list, a whole depth level at a time
+template<typename T>
+class ObjectStore
+{
+private:
+	HandlePool<T> _objects;
+
+	std::vector<XMFLOAT3> _positions;
+	std::vector<float> _rotations;
+	std::vector<float> _scales;
+	std::vector<XMFLOAT4> _localBounds;
+	std::vector<XMFLOAT4X4> _locals;       //Relative to the parent, the same as the world for an object without one
+	std::vector<XMFLOAT4> _parentBounds;   //Bounds in the parent's space
+	std::vector<XMFLOAT4X4> _worlds;
+	std::vector<XMFLOAT4> _worldBounds;
+	std::vector<uint64_t> _renderKeys;
+	std::vector<uint8_t> _dirty;
+	std::vector<uint8_t> _updated;         //World rebuilt this update, tells children they have to follow
+	std::vector<PoolHandle> _parents;
+	std::vector<uint32_t> _depths;
+
+	//Every object with a parent, sorted by depth. Level n is [_levelStarts[n], _levelStarts[n + 1]) and holds
+	//depth n + 1, _parentItems is each one's parent already looked up. Rebuilt whenever parenting or packing changes
+	std::vector<uint32_t> _childItems;
+	std::vector<uint32_t> _parentItems;
+	std::vector<size_t> _levelStarts;
+	size_t _parentCount = 0;
+	bool _hierarchyChanged = false;
+
+	//Handles rather than packed positions, since Destroy moves items around before the next update
+	std::vector<PoolHandle> _dirtyHandles;
+	std::vector<uint32_t> _dirtyItems;
+	std::vector<PoolHandle> _changed;
+
+	void MarkDirty(size_t item);
+	size_t GetParentItem(size_t item) const;
+	void RebuildHierarchy();
+
+	template<typename U>
+	static void RemoveItem(std::vector<U>& items, size_t item)
+	{
+		items[item] = items.back();
+		items.pop_back();
+	}
+
+public:
+	PoolHandle Create(const T& object);
+	bool Destroy(PoolHandle handle);
+
+	T* Get(PoolHandle handle) { return _objects.Get(handle); }
+	size_t GetCount() const { return _objects.GetCount(); }
+	PoolHandle GetHandle(size_t item) const { return _objects.GetHandle(item); }
+	size_t GetItem(PoolHandle handle) const { return _objects.GetItem(handle); }
+	T& operator[](size_t item) { return _objects[item]; }
+
+	void SetPosition(PoolHandle handle, XMFLOAT3 position);
+	void SetRotation(PoolHandle handle, float rotation);
+	void SetScale(PoolHandle handle, float scale);
+	void SetLocalBounds(PoolHandle handle, XMFLOAT4 bounds);
+	void SetRenderKey(PoolHandle handle, uint64_t key);
+
+	//Parents handle to parent, or unparents it with an invalid parent. Fails rather than making a loop.
+	//Destroying a parent leaves its children as roots where they are relative to the origin
+	bool SetParent(PoolHandle handle, PoolHandle parent);
+	PoolHandle GetParent(PoolHandle handle) const;
+
+	//Rebuilds local matrices and bounds for items [first, end), separate ranges can be done on separate threads.
+	//Objects without a parent get their world from this too, children wait for PropagateLevel
+	void UpdateWorlds(size_t first, size_t end);
+
+	//Incremental version: PrepareDirty returns how many objects need rebuilding, UpdateDirty does entries
+	//[first, end) of those (again safe to split across threads). Then each level in order has PropagateLevel run
+	//over its [first, end), which rebuilds children that moved or whose parent moved, again splittable within the
+	//level. FinishDirty publishes everything that was rebuilt as the changed list
+	size_t PrepareDirty();
+	void UpdateDirty(size_t first, size_t end);
+	size_t GetLevelCount() const { return _levelStarts.empty() ? 0 : _levelStarts.size() - 1; }
+	size_t GetLevelSize(size_t level) const { return _levelStarts[level + 1] - _levelStarts[level]; }
+	void PropagateLevel(size_t level, size_t first, size_t end);
+	void FinishDirty();
+
+	//All of the above, spread across the job system's workers
+	void UpdateTransforms(JobSystem& jobSystem);
+
+	//Objects whose world matrix or bounds changed in the last FinishDirty, may include ones destroyed since
+	const std::vector<PoolHandle>& GetChanged() const { return _changed; }
+
+	const XMFLOAT4X4& GetWorld(size_t item) const { return _worlds[item]; }
+	const XMFLOAT4& GetWorldBounds(size_t item) const { return _worldBounds[item]; }
+	uint64_t GetRenderKey(size_t item) const { return _renderKeys[item]; }
+
+	typename std::vector<T>::iterator begin() { return _objects.begin(); }
+	typename std::vector<T>::iterator end() { return _objects.end(); }
+};
+
+template<typename T>
+PoolHandle ObjectStore<T>::Create(const T& object)
+{
+	PoolHandle handle = _objects.Create(object);
+
+	XMFLOAT4X4 identity;
+	XMStoreFloat4x4(&identity, XMMatrixIdentity());
+
+	_positions.push_back(XMFLOAT3(0.0f, 0.0f, 0.0f));
+	_rotations.push_back(0.0f);
+	_scales.push_back(1.0f);
+	_localBounds.push_back(XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+	_locals.push_back(identity);
+	_parentBounds.push_back(XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+	_worlds.push_back(identity);
+	_worldBounds.push_back(XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+	_renderKeys.push_back(0);
+	_dirty.push_back(0);
+	_updated.push_back(0);
+	_parents.push_back(PoolHandle());
+	_depths.push_back(0);
+
+	MarkDirty(_dirty.size() - 1);
+	return handle;
+}
+
+template<typename T>
+bool ObjectStore<T>::Destroy(PoolHandle handle)
+{
+	size_t item = _objects.GetItem(handle);
+	if (item == POOL_INVALID_ITEM) return false;
+
+	//Level lists hold item numbers, one is about to move and any children of this one need unparenting
+	if (_parentCount > 0 || !_childItems.empty()) _hierarchyChanged = true;
+	if (_parents[item].IsValid()) _parentCount--;
+
+	//Pool moves its last item into the hole, the arrays have to do exactly the same to stay lined up
+	_objects.Destroy(handle);
+	RemoveItem(_positions, item);
+	RemoveItem(_rotations, item);
+	RemoveItem(_scales, item);
+	RemoveItem(_localBounds, item);
+	RemoveItem(_locals, item);
+	RemoveItem(_parentBounds, item);
+	RemoveItem(_worlds, item);
+	RemoveItem(_worldBounds, item);
+	RemoveItem(_renderKeys, item);
+	RemoveItem(_dirty, item);
+	RemoveItem(_updated, item);
+	RemoveItem(_parents, item);
+	RemoveItem(_depths, item);
+	return true;
+}
+
+template<typename T>
+void ObjectStore<T>::SetPosition(PoolHandle handle, XMFLOAT3 position)
+{
+	size_t item = _objects.GetItem(handle);
+	if (item == POOL_INVALID_ITEM) return;
+
+	_positions[item] = position;
+	MarkDirty(item);
+}
+
+template<typename T>
+void ObjectStore<T>::SetRotation(PoolHandle handle, float rotation)
+{
+	size_t item = _objects.GetItem(handle);
+	if (item == POOL_INVALID_ITEM) return;
+
+	_rotations[item] = rotation;
+	MarkDirty(item);
+}
+
+template<typename T>
+void ObjectStore<T>::SetScale(PoolHandle handle, float scale)
+{
+	size_t item = _objects.GetItem(handle);
+	if (item == POOL_INVALID_ITEM) return;
+
+	_scales[item] = scale;
+	MarkDirty(item);
+}
+
+template<typename T>
+void ObjectStore<T>::SetLocalBounds(PoolHandle handle, XMFLOAT4 bounds)
+{
+	size_t item = _objects.GetItem(handle);
+	if (item == POOL_INVALID_ITEM) return;
+
+	_localBounds[item] = bounds;
+	MarkDirty(item);
+}
+
+template<typename T>
+void ObjectStore<T>::SetRenderKey(PoolHandle handle, uint64_t key)
+{
+	size_t item = _objects.GetItem(handle);
+	if (item != POOL_INVALID_ITEM) _renderKeys[item] = key;
+}
+
+template<typename T>
+bool ObjectStore<T>::SetParent(PoolHandle handle, PoolHandle parent)
+{
+	size_t item = _objects.GetItem(handle);
+	if (item == POOL_INVALID_ITEM) return false;
+
+	if (parent.IsValid())
+	{
+		if (_objects.GetItem(parent) == POOL_INVALID_ITEM) return false;
+
+		//Walk up from the new parent, meeting this object on the way means it would end up its own ancestor
+		PoolHandle ancestor = parent;
+		while (ancestor.IsValid())
+		{
+			if (ancestor == handle) return false;
+
+			size_t ancestorItem = _objects.GetItem(ancestor);
+			if (ancestorItem == POOL_INVALID_ITEM) break;
+			ancestor = _parents[ancestorItem];
+		}
+	}
+
+	if (_parents[item].IsValid()) _parentCount--;
+	if (parent.IsValid()) _parentCount++;
+
+	_parents[item] = parent;
+	_hierarchyChanged = true;
+	MarkDirty(item);
+	return true;
+}
+
+template<typename T>
+PoolHandle ObjectStore<T>::GetParent(PoolHandle handle) const
+{
+	size_t item = _objects.GetItem(handle);
+	return item == POOL_INVALID_ITEM ? PoolHandle() : _parents[item];
+}
+
+template<typename T>
+size_t ObjectStore<T>::GetParentItem(size_t item) const
+{
+	return _parents[item].IsValid() ? _objects.GetItem(_parents[item]) : POOL_INVALID_ITEM;
+}
+
+template<typename T>
+void ObjectStore<T>::RebuildHierarchy()
+{
+	_hierarchyChanged = false;
+
+	size_t count = _objects.GetCount();
+	_childItems.clear();
+	_parentItems.clear();
+	_levelStarts.clear();
+
+	if (_parentCount == 0)
+	{
+		std::fill(_depths.begin(), _depths.end(), 0);
+		return;
+	}
+
+	//Children of destroyed objects fall back to being roots, which moves them
+	for (size_t item = 0; item < count; item++)
+	{
+		if (_parents[item].IsValid() && GetParentItem(item) == POOL_INVALID_ITEM)
+		{
+			_parents[item] = PoolHandle();
+			_parentCount--;
+			MarkDirty(item);
+		}
+	}
+
+	//Depth of each object, walking up until an object whose depth is already known. Each object is only
+	//resolved once, so this stays linear however deep the chains go
+	const uint32_t unknown = ~(uint32_t)0;
+	std::fill(_depths.begin(), _depths.end(), unknown);
+
+	std::vector<uint32_t> chain;
+	uint32_t maxDepth = 0;
+	for (size_t item = 0; item < count; item++)
+	{
+		size_t current = item;
+		while (current != POOL_INVALID_ITEM && _depths[current] == unknown)
+		{
+			chain.push_back((uint32_t)current);
+			current = GetParentItem(current);
+		}
+
+		uint32_t depth = current == POOL_INVALID_ITEM ? 0 : _depths[current] + 1;
+		while (!chain.empty())
+		{
+			_depths[chain.back()] = depth++;
+			chain.pop_back();
+		}
+
+		maxDepth = std::max(maxDepth, _depths[item]);
+	}
+
+	//Counting sort of the children into their levels
+	_levelStarts.assign(maxDepth + 1, 0);
+	for (size_t item = 0; item < count; item++)
+	{
+		if (_depths[item] > 0) _levelStarts[_depths[item]]++;
+	}
+
+	size_t total = 0;
+	for (uint32_t level = 0; level < maxDepth; level++)
+	{
+		size_t size = _levelStarts[level + 1];
+		_levelStarts[level] = total;
+		total += size;
+	}
+	_levelStarts[maxDepth] = total;
+
+	_childItems.resize(total);
+	_parentItems.resize(total);
+	std::vector<size_t> next(_levelStarts.begin(), _levelStarts.end() - 1);
+	for (size_t item = 0; item < count; item++)
+	{
+		if (_depths[item] == 0) continue;
+
+		size_t slot = next[_depths[item] - 1]++;
+		_childItems[slot] = (uint32_t)item;
+		_parentItems[slot] = (uint32_t)GetParentItem(item);
+	}
+}
+
+template<typename T>
+void ObjectStore<T>::UpdateWorlds(size_t first, size_t end)
+{
+	if (end <= first) return;
+	BuildWorldMatrices(&_positions[first], &_rotations[first], &_scales[first], &_localBounds[first], &_locals[first], &_parentBounds[first], end - first);
+
+	for (size_t item = first; item < end; item++)
+	{
+		_updated[item] = 1;
+		if (_depths[item] == 0)
+		{
+			_worlds[item] = _locals[item];
+			_worldBounds[item] = _parentBounds[item];
+		}
+	}
+}
+
+template<typename T>
+void ObjectStore<T>::PropagateLevel(size_t level, size_t first, size_t end)
+{
+	size_t start = _levelStarts[level];
+	for (size_t i = start + first; i < start + end; i++)
+	{
+		uint32_t item = _childItems[i];
+		uint32_t parent = _parentItems[i];
+		if (!_updated[item] && !_updated[parent]) continue;
+
+		//Parents are a level up so were finished before this level started
+		XMMATRIX parentWorld = XMLoadFloat4x4(&_worlds[parent]);
+		XMStoreFloat4x4(&_worlds[item], XMMatrixMultiply(XMLoadFloat4x4(&_locals[item]), parentWorld));
+
+		//Scales are uniform all the way up, so the length of one axis is the whole chain's scale
+		const XMFLOAT4& bounds = _parentBounds[item];
+		XMVECTOR centre = XMVector3Transform(XMVectorSet(bounds.x, bounds.y, bounds.z, 1.0f), parentWorld);
+		float scale = XMVectorGetX(XMVector3Length(parentWorld.r[0]));
+		XMStoreFloat4(&_worldBounds[item], XMVectorSetW(centre, bounds.w * scale));
+
+		_updated[item] = 1;
+	}
+}
+
+template<typename T>
+void ObjectStore<T>::MarkDirty(size_t item)
+{
+	if (_dirty[item]) return;
+
+	_dirty[item] = 1;
+	_dirtyHandles.push_back(_objects.GetHandle(item));
+}
+
+template<typename T>
+size_t ObjectStore<T>::PrepareDirty()
+{
+	//Can mark children of destroyed objects dirty, so before the dirty list is read
+	if (_hierarchyChanged) RebuildHierarchy();
+
+	_dirtyItems.clear();
+	for (PoolHandle handle : _dirtyHandles)
+	{
+		size_t item = _objects.GetItem(handle);
+		if (item != POOL_INVALID_ITEM) _dirtyItems.push_back((uint32_t)item);
+	}
+
+	//In order so neighbouring dirty objects land in the same batch below
+	std::sort(_dirtyItems.begin(), _dirtyItems.end());
+	return _dirtyItems.size();
+}
+
+template<typename T>
+void ObjectStore<T>::UpdateDirty(size_t first, size_t end)
+{
+	//Runs of consecutive items go through BuildWorldMatrices together, a lone one is just a run of one
+	size_t run = first;
+	while (run < end)
+	{
+		size_t runEnd = run + 1;
+		while (runEnd < end && _dirtyItems[runEnd] == _dirtyItems[runEnd - 1] + 1)
+		{
+			runEnd++;
+		}
+
+		UpdateWorlds(_dirtyItems[run], _dirtyItems[runEnd - 1] + 1);
+		run = runEnd;
+	}
+}
+
+template<typename T>
+void ObjectStore<T>::FinishDirty()
+{
+	_changed.clear();
+	for (uint32_t item : _dirtyItems)
+	{
+		_dirty[item] = 0;
+		if (_depths[item] == 0)
+		{
+			_updated[item] = 0;
+			_changed.push_back(_objects.GetHandle(item));
+		}
+	}
+
+	//Children are picked up here instead, dirty or not, since they also change when a parent does
+	if (!_dirtyItems.empty())
+	{
+		for (uint32_t item : _childItems)
+		{
+			if (!_updated[item]) continue;
+
+			_updated[item] = 0;
+			_changed.push_back(_objects.GetHandle(item));
+		}
+	}
+
+	_dirtyHandles.clear();
+	_dirtyItems.clear();
+}
+
+template<typename T>
+void ObjectStore<T>::UpdateTransforms(JobSystem& jobSystem)
+{
+	size_t dirtyCount = PrepareDirty();
+	jobSystem.ParallelFor((uint32_t)dirtyCount, 256, [this](uint32_t start, uint32_t end)
+	{
+		UpdateDirty(start, end);
+	});
+
+	//Nothing moved means no child can have either
+	if (dirtyCount > 0)
+	{
+		for (size_t level = 0; level < GetLevelCount(); level++)
+		{
+			jobSystem.ParallelFor((uint32_t)GetLevelSize(level), 256, [this, level](uint32_t start, uint32_t end)
+			{
+				PropagateLevel(level, start, end);
+			});
+		}
+	}
+
+	FinishDirty();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include "ShaderPermutation.h"
+
+//One draw waiting to be submitted, ObjectIndex points back into whatever list the draw came from
+struct DrawItem
+{
+	uint64_t SortKey;
+	uint32_t ObjectIndex;
+};
+
+//Collects draws for a frame and sorts them so objects sharing a shader variant, then texture, then mesh draw together
+class RenderQueue
+{
+private:
+	std::vector<DrawItem> _items;
+
+public:
+	void Clear() { _items.clear(); }
+	void Add(uint64_t sortKey, uint32_t objectIndex) { _items.push_back({ sortKey, objectIndex }); }
+	void Sort();
+
+	size_t GetCount() { return _items.size(); }
+	const DrawItem& operator[](size_t i) const { return _items[i]; }
+	const std::vector<DrawItem>& GetItems() { return _items; }
+};
+
+inline void RenderQueue::Sort()
+{
+	//Stable so equal keys keep submission order and frames don't flicker between orders
+	std::stable_sort(_items.begin(), _items.end(), [](const DrawItem& a, const DrawItem& b) { return a.SortKey < b.SortKey; });
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <d3d11_4.h>
+#include <DirectXMath.h>
+#include <assert.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "Structures.h"
+#include "ShaderPermutation.h"
+
+using namespace DirectX;
+
+//Everything Draw needs about one scene object, copied out of gameobjects so Draw never touches live simulation state
+struct RenderObject
+{
+	XMFLOAT4X4 World;
+	uint64_t SortKey;
+	MeshData Mesh;
+	ID3D11ShaderResourceView* Texture;
+	ID3D11ShaderResourceView* NormalMap;
+	PermutationKey Permutation;
+	XMFLOAT4 TextureTransform;
+	float TextureSlice;
+};
+
+//One frame's worth of render state. FrameIndex is written first and SealedFrameIndex last,
+//so a reader that sees them differ is looking at a snapshot that is still being written
+struct RenderSnapshot
+{
+	uint64_t FrameIndex = 0;
+
+	XMFLOAT4X4 View;
+	XMFLOAT4X4 Projection;
+	XMFLOAT3 CameraPosition;
+	float Count;
+
+	XMFLOAT4X4 World;
+	XMFLOAT4X4 World2;
+	XMFLOAT4X4 World3;
+	XMFLOAT4X4 WorldLine;
+
+	std::vector<RenderObject> Objects;
+	bool Changed = false;
+
+	uint64_t SealedFrameIndex = 0;
+
+	bool IsComplete() const { return FrameIndex != 0 && SealedFrameIndex == FrameIndex; }
+};
+
+//Double buffered snapshots, the update stage writes one while the render stage reads the other.
+//Swap only happens between frames once both stages are finished with their side
+class SnapshotBuffer
+{
+private:
+	RenderSnapshot _snapshots[2];
+	int _writeIndex = 0;
+
+	//Debug bookkeeping so any overlap of a read and a write on the same snapshot trips an assert
+	std::atomic<int> _writing{ -1 };
+	std::atomic<int> _reading{ -1 };
+
+public:
+	RenderSnapshot& BeginWrite(uint64_t frameIndex);
+	void EndWrite();
+
+	const RenderSnapshot& BeginRead();
+	void EndRead() { _reading = -1; }
+
+	const RenderSnapshot& GetReadSnapshot() { return _snapshots[1 - _writeIndex]; }
+
+	void Swap();
+
+	//Back to how it started, so the next frame runs both stages in order again. Only between frames
+	void Reset();
+};
+
+inline RenderSnapshot& SnapshotBuffer::BeginWrite(uint64_t frameIndex)
+{
+	assert(_reading.load() != _writeIndex && "Render stage is reading the snapshot update wants to write");
+	_writing = _writeIndex;
+
+	RenderSnapshot& snapshot = _snapshots[_writeIndex];
+	snapshot.SealedFrameIndex = 0;
+	snapshot.FrameIndex = frameIndex;
+	return snapshot;
+}
+
+inline void SnapshotBuffer::EndWrite()
+{
+	RenderSnapshot& snapshot = _snapshots[_writeIndex];
+	snapshot.SealedFrameIndex = snapshot.FrameIndex;
+	_writing = -1;
+}
+
+inline const RenderSnapshot& SnapshotBuffer::BeginRead()
+{
+	int readIndex = 1 - _writeIndex;
+	assert(_writing.load() != readIndex && "Update stage is writing the snapshot render wants to read");
+	_reading = readIndex;
+
+	const RenderSnapshot& snapshot = _snapshots[readIndex];
+	assert((snapshot.FrameIndex == 0 || snapshot.IsComplete()) && "Render stage saw a torn snapshot");
+	return snapshot;
+}
+
+inline void SnapshotBuffer::Swap()
+{
+	assert(_writing.load() == -1 && _reading.load() == -1 && "Snapshots swapped while a stage was still using one");
+	_writeIndex = 1 - _writeIndex;
+}
+
+inline void SnapshotBuffer::Reset()
+{
+	assert(_writing.load() == -1 && _reading.load() == -1 && "Snapshots reset while a stage was still using one");
+	for (RenderSnapshot& snapshot : _snapshots)
+	{
+		snapshot.FrameIndex = 0;
+		snapshot.SealedFrameIndex = 0;
+		std::vector<RenderObject>().swap(snapshot.Objects);
+	}
+	_writeIndex = 0;
+}
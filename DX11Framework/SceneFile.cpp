@@ -0,0 +1,507 @@
+#include "SceneFile.h"
+#include "AssetCache.h"
+#include <windows.h>
+#include <fstream>
+#include <unordered_map>
+
+#include "JSON\json.hpp"
+using json = nlohmann::json;
+
+const char* SceneFile::Keep(const std::string& text)
+{
+    _strings.push_back(text);
+    return _strings.back().c_str();
+}
+
+void SceneFile::Clear()
+{
+    _binary.Close();
+    _objects.clear();
+    _strings.clear();
+}
+
+//Picks the fields of each entry in "Gameobjects" out of the parser's events as they go past. Only the entry
+//being parsed is held, so memory doesn't grow with the file, and anything it doesn't know about is skipped
+class SceneSaxHandler : public nlohmann::json_sax<json>
+{
+private:
+    const std::function<void(uint32_t, const SceneObjectDesc&)>& _onObject;
+    const std::function<void(uint32_t, uint32_t)>& _onParent;
+
+    //1 is the file's outer object, 2 the Gameobjects array, 3 an entry in it, deeper is inside one of its fields
+    int _depth = 0;
+    bool _inObjects = false;
+    bool _objectsKey = false;
+    std::string _key;
+    uint32_t _objectCount = 0;
+
+    SceneObjectDesc _desc;
+    std::string _meshPath;
+    std::string _texturePath;
+    std::string _normalPath;
+    std::string _name;
+    std::string _parentName;
+    bool _hasNormal = false;
+
+    //Names seen so far, and children whose parent hasn't turned up yet
+    std::unordered_map<std::string, uint32_t> _namedObjects;
+    std::unordered_multimap<std::string, uint32_t> _waitingChildren;
+
+    bool InField() { return _inObjects && _depth == 3; }
+
+    void Number(double value)
+    {
+        if (!InField()) return;
+
+        if (_key == "HasTexture") _desc.HasTexture = (int)value;
+        else if (_key == "HasSpecular") _desc.HasSpecular = value == 1.0;
+        else if (_key == "RotationY") _desc.RotationY = (float)value;
+        else if (_key == "Scale") _desc.Scale = (float)value;
+        else if (_key == "StartPosX") _desc.Position.x = (float)value;
+        else if (_key == "StartPosY") _desc.Position.y = (float)value;
+        else if (_key == "StartPosZ") _desc.Position.z = (float)value;
+    }
+
+    void FinishObject()
+    {
+        uint32_t index = _objectCount++;
+
+        _desc.MeshPath = _meshPath.c_str();
+        _desc.TexturePath = _desc.HasTexture == 1 ? _texturePath.c_str() : nullptr;
+        _desc.NormalPath = _hasNormal ? _normalPath.c_str() : nullptr;
+        _desc.Name = _name.empty() ? nullptr : _name.c_str();
+        _desc.Parent = SCENE_NONE;
+
+        if (!_parentName.empty())
+        {
+            auto parent = _namedObjects.find(_parentName);
+            if (parent != _namedObjects.end()) _desc.Parent = parent->second;
+            else _waitingChildren.emplace(_parentName, index);
+        }
+
+        _onObject(index, _desc);
+
+        if (!_name.empty())
+        {
+            _namedObjects[_name] = index;
+
+            auto waiting = _waitingChildren.equal_range(_name);
+            for (auto child = waiting.first; child != waiting.second; ++child)
+            {
+                _onParent(child->second, index);
+            }
+            _waitingChildren.erase(waiting.first, waiting.second);
+        }
+    }
+
+public:
+    SceneSaxHandler(const std::function<void(uint32_t, const SceneObjectDesc&)>& onObject, const std::function<void(uint32_t, uint32_t)>& onParent)
+        : _onObject(onObject), _onParent(onParent)
+    {
+    }
+
+    void ReportMissingParents()
+    {
+        for (auto& child : _waitingChildren)
+        {
+            OutputDebugStringA(("Ignoring parent " + child.first + ", no object has that name\n").c_str());
+        }
+    }
+
+    bool null() override { return true; }
+    bool boolean(bool val) override { Number(val ? 1.0 : 0.0); return true; }
+    bool number_integer(number_integer_t val) override { Number((double)val); return true; }
+    bool number_unsigned(number_unsigned_t val) override { Number((double)val); return true; }
+    bool number_float(number_float_t val, const string_t&) override { Number(val); return true; }
+    bool binary(binary_t&) override { return true; }
+
+    bool string(string_t& val) override
+    {
+        if (!InField()) return true;
+
+        if (_key == "MeshLocation") _meshPath = val;
+        else if (_key == "TextureLocation") _texturePath = val;
+        else if (_key == "NormalLocation") { _normalPath = val; _hasNormal = true; }
+        else if (_key == "Name") _name = val;
+        else if (_key == "Parent") _parentName = val;
+        return true;
+    }
+
+    bool key(string_t& val) override
+    {
+        if (_depth == 1) _objectsKey = val == "Gameobjects";
+        else if (InField()) _key = val;
+        return true;
+    }
+
+    bool start_object(std::size_t) override
+    {
+        _depth++;
+
+        //A new entry starts from the same defaults LoadBinary's records would have
+        if (_inObjects && _depth == 3)
+        {
+            _desc = SceneObjectDesc();
+            _meshPath.clear();
+            _texturePath.clear();
+            _normalPath.clear();
+            _name.clear();
+            _parentName.clear();
+            _hasNormal = false;
+            _key.clear();
+        }
+        return true;
+    }
+
+    bool end_object() override
+    {
+        if (InField()) FinishObject();
+        _depth--;
+        return true;
+    }
+
+    bool start_array(std::size_t) override
+    {
+        _depth++;
+        if (_depth == 2 && _objectsKey) _inObjects = true;
+        return true;
+    }
+
+    bool end_array() override
+    {
+        if (_depth == 2) _inObjects = false;
+        _depth--;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& error) override
+    {
+        OutputDebugStringA(("Scene parse error at byte " + std::to_string(position) + ": " + error.what() + "\n").c_str());
+        return false;
+    }
+};
+
+bool SceneFile::StreamJson(const std::string& filename, const std::function<void(uint32_t, const SceneObjectDesc&)>& onObject, const std::function<void(uint32_t, uint32_t)>& onParent)
+{
+    std::ifstream fileOpen(filename, std::ios::binary);
+    if (!fileOpen.good()) return false;
+
+    SceneSaxHandler handler(onObject, onParent);
+    if (!json::sax_parse(fileOpen, &handler)) return false;
+
+    handler.ReportMissingParents();
+    return true;
+}
+
+bool SceneFile::LoadJson(const std::string& filename)
+{
+    Clear();
+
+    auto onObject = [this](uint32_t index, const SceneObjectDesc& streamed)
+    {
+        //Streamed strings only last until the next object, so they are copied into ones this keeps
+        SceneObjectDesc desc = streamed;
+        desc.MeshPath = Keep(streamed.MeshPath);
+        if (streamed.TexturePath) desc.TexturePath = Keep(streamed.TexturePath);
+        if (streamed.NormalPath) desc.NormalPath = Keep(streamed.NormalPath);
+        if (streamed.Name) desc.Name = Keep(streamed.Name);
+        _objects.push_back(desc);
+    };
+    auto onParent = [this](uint32_t child, uint32_t parent) { _objects[child].Parent = parent; };
+
+    if (!StreamJson(filename, onObject, onParent))
+    {
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+bool SceneFile::LoadBinary(const std::string& filename, const AssetArchive* archive)
+{
+    Clear();
+
+    if (!_binary.Open(archive, filename)) return false;
+
+    const uint8_t* data = _binary.GetData();
+    size_t size = _binary.GetSize();
+
+    //Everything is checked against the file size before use, a truncated or stale file is a failed load not a crash
+    if (size < sizeof(SceneFileHeader))
+    {
+        Clear();
+        return false;
+    }
+
+    const SceneFileHeader* header = (const SceneFileHeader*)data;
+    size_t assetsStart = sizeof(SceneFileHeader);
+    size_t objectsStart = assetsStart + (size_t)header->AssetCount * sizeof(uint32_t);
+    size_t stringsStart = objectsStart + (size_t)header->ObjectCount * sizeof(SceneObjectRecord);
+    if (header->Magic != SCENE_FILE_MAGIC || header->Version != SCENE_FILE_VERSION || header->StringTableSize == 0 ||
+        stringsStart + header->StringTableSize != size || data[size - 1] != 0)
+    {
+        Clear();
+        return false;
+    }
+
+    const uint32_t* assets = (const uint32_t*)(data + assetsStart);
+    const SceneObjectRecord* records = (const SceneObjectRecord*)(data + objectsStart);
+    const char* strings = (const char*)(data + stringsStart);
+
+    for (uint32_t i = 0; i < header->AssetCount; i++)
+    {
+        if (assets[i] >= header->StringTableSize)
+        {
+            Clear();
+            return false;
+        }
+    }
+
+    auto assetPath = [&](uint32_t asset) -> const char* { return asset < header->AssetCount ? strings + assets[asset] : nullptr; };
+
+    _objects.resize(header->ObjectCount);
+    for (uint32_t i = 0; i < header->ObjectCount; i++)
+    {
+        //Textured objects go on to request their texture by path, so the flag without a path is as damaged as a bad index
+        const SceneObjectRecord& record = records[i];
+        if ((record.Name != SCENE_NONE && record.Name >= header->StringTableSize) || record.Mesh >= header->AssetCount ||
+            (record.Texture != SCENE_NONE && record.Texture >= header->AssetCount) ||
+            ((record.Flags & SCENE_OBJECT_HAS_TEXTURE) && record.Texture == SCENE_NONE) ||
+            (record.NormalMap != SCENE_NONE && record.NormalMap >= header->AssetCount) ||
+            (record.Parent != SCENE_NONE && record.Parent >= header->ObjectCount))
+        {
+            Clear();
+            return false;
+        }
+
+        SceneObjectDesc& desc = _objects[i];
+        desc.Name = record.Name != SCENE_NONE ? strings + record.Name : nullptr;
+        desc.MeshPath = assetPath(record.Mesh);
+        desc.TexturePath = assetPath(record.Texture);
+        desc.NormalPath = assetPath(record.NormalMap);
+        desc.HasTexture = (record.Flags & SCENE_OBJECT_HAS_TEXTURE) ? 1 : 0;
+        desc.HasSpecular = (record.Flags & SCENE_OBJECT_HAS_SPECULAR) != 0;
+        desc.RotationY = record.RotationY;
+        desc.Scale = record.Scale;
+        desc.Position = XMFLOAT3(record.Position[0], record.Position[1], record.Position[2]);
+        desc.Parent = record.Parent;
+    }
+
+    return true;
+}
+
+bool SceneFile::Load(const std::string& jsonFilename, const AssetArchive* archive)
+{
+    std::string binaryFilename = SceneCompiler::GetBinaryPath(jsonFilename);
+
+    //A packed scene was compiled when the archive was made and there is no JSON in there to compare it with
+    if (archive && archive->Find(binaryFilename)) return LoadBinary(binaryFilename, archive);
+
+    bool compiled = false;
+    if (!SceneCompiler::IsUpToDate(jsonFilename, binaryFilename))
+    {
+        compiled = SceneCompiler::Compile(jsonFilename, binaryFilename);
+    }
+    if (LoadBinary(binaryFilename)) return true;
+
+    //Newer than the JSON but written by an older version of the compiler, or damaged
+    return !compiled && SceneCompiler::Compile(jsonFilename, binaryFilename) && LoadBinary(binaryFilename);
+}
+
+std::string SceneCompiler::GetBinaryPath(const std::string& jsonFilename)
+{
+    size_t extension = jsonFilename.find_last_of('.');
+    size_t directory = jsonFilename.find_last_of("/\\");
+    if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+    {
+        return jsonFilename + ".scene";
+    }
+    return jsonFilename.substr(0, extension) + ".scene";
+}
+
+bool SceneCompiler::IsUpToDate(const std::string& jsonFilename, const std::string& binaryFilename)
+{
+    WIN32_FILE_ATTRIBUTE_DATA source;
+    WIN32_FILE_ATTRIBUTE_DATA binary;
+    if (!GetFileAttributesExA(jsonFilename.c_str(), GetFileExInfoStandard, &source)) return false;
+    if (!GetFileAttributesExA(binaryFilename.c_str(), GetFileExInfoStandard, &binary)) return false;
+
+    return CompareFileTime(&binary.ftLastWriteTime, &source.ftLastWriteTime) >= 0;
+}
+
+bool SceneCompiler::Compile(const std::string& jsonFilename, const std::string& binaryFilename)
+{
+    SceneFile source;
+    if (!source.LoadJson(jsonFilename)) return false;
+
+    //Strings and asset paths are stored once however many objects use them
+    std::string strings;
+    std::unordered_map<std::string, uint32_t> stringOffsets;
+    auto addString = [&](const char* text) -> uint32_t
+    {
+        auto found = stringOffsets.find(text);
+        if (found != stringOffsets.end()) return found->second;
+
+        uint32_t offset = (uint32_t)strings.size();
+        strings.append(text);
+        strings.push_back('\0');
+        stringOffsets[text] = offset;
+        return offset;
+    };
+
+    std::vector<uint32_t> assets;
+    std::unordered_map<uint32_t, uint32_t> assetIndices;
+    auto addAsset = [&](const char* path) -> uint32_t
+    {
+        if (!path) return SCENE_NONE;
+
+        uint32_t offset = addString(path);
+        auto found = assetIndices.find(offset);
+        if (found != assetIndices.end()) return found->second;
+
+        uint32_t index = (uint32_t)assets.size();
+        assets.push_back(offset);
+        assetIndices[offset] = index;
+        return index;
+    };
+
+    std::vector<SceneObjectRecord> records;
+    records.reserve(source.GetObjects().size());
+    for (const SceneObjectDesc& desc : source.GetObjects())
+    {
+        SceneObjectRecord record;
+        record.Position[0] = desc.Position.x;
+        record.Position[1] = desc.Position.y;
+        record.Position[2] = desc.Position.z;
+        record.RotationY = desc.RotationY;
+        record.Scale = desc.Scale;
+        record.Name = desc.Name ? addString(desc.Name) : SCENE_NONE;
+        record.Mesh = addAsset(desc.MeshPath);
+        record.Texture = addAsset(desc.TexturePath);
+        record.NormalMap = addAsset(desc.NormalPath);
+        record.Parent = desc.Parent;
+        record.Flags = (desc.HasTexture == 1 ? SCENE_OBJECT_HAS_TEXTURE : 0) | (desc.HasSpecular ? SCENE_OBJECT_HAS_SPECULAR : 0);
+        records.push_back(record);
+    }
+
+    //Never empty, so the last byte of a valid file is always a terminator
+    if (strings.empty()) strings.push_back('\0');
+
+    SceneFileHeader header = {};
+    header.Magic = SCENE_FILE_MAGIC;
+    header.Version = SCENE_FILE_VERSION;
+    header.ObjectCount = (uint32_t)records.size();
+    header.AssetCount = (uint32_t)assets.size();
+    header.StringTableSize = (uint32_t)strings.size();
+
+    //Written to the side and moved over the old one, so a half written file is never picked up
+    std::string temporaryFilename = binaryFilename + ".tmp";
+    {
+        std::ofstream output(temporaryFilename, std::ios::binary | std::ios::trunc);
+        if (!output.good()) return false;
+
+        output.write((const char*)&header, sizeof(header));
+        output.write((const char*)assets.data(), assets.size() * sizeof(uint32_t));
+        output.write((const char*)records.data(), records.size() * sizeof(SceneObjectRecord));
+        output.write(strings.data(), strings.size());
+        if (!output.good()) return false;
+    }
+
+    return MoveFileExA(temporaryFilename.c_str(), binaryFilename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+SceneEntry SceneEntries::Make(const SceneObjectDesc& desc)
+{
+    SceneEntry entry;
+    entry.Name = desc.Name ? desc.Name : "";
+    entry.MeshPath = desc.MeshPath ? desc.MeshPath : "";
+    entry.TexturePath = desc.TexturePath ? desc.TexturePath : "";
+    entry.NormalPath = desc.NormalPath ? desc.NormalPath : "";
+    entry.HasTexture = desc.HasTexture;
+    entry.HasSpecular = desc.HasSpecular;
+    entry.HasNormal = desc.NormalPath != nullptr;
+    entry.RotationY = desc.RotationY;
+    entry.Scale = desc.Scale;
+    entry.Position = desc.Position;
+    entry.Parent = desc.Parent;
+    return entry;
+}
+
+void SceneEntries::AssignKeys(std::vector<SceneEntry>& entries)
+{
+    //Unnamed objects are told apart by mesh and order among objects using that mesh, so adding one object only
+    //shifts the keys of others with the same mesh rather than everything after it
+    std::unordered_map<std::string, int> meshUses;
+    for (SceneEntry& entry : entries)
+    {
+        if (!entry.Name.empty())
+        {
+            entry.Key = "name:" + entry.Name;
+        }
+        else
+        {
+            std::string mesh = AssetCache::NormalizePath(entry.MeshPath);
+            entry.Key = "mesh:" + mesh + "#" + std::to_string(meshUses[mesh]++);
+        }
+    }
+}
+
+void SceneEntries::Build(const std::vector<SceneObjectDesc>& objects, std::vector<SceneEntry>& entries)
+{
+    entries.clear();
+    entries.reserve(objects.size());
+    for (const SceneObjectDesc& desc : objects)
+    {
+        entries.push_back(Make(desc));
+    }
+    AssignKeys(entries);
+}
+
+void SceneEntries::Diff(const std::vector<SceneEntry>& live, const std::vector<SceneObjectDesc>& scene, SceneDiff& diff)
+{
+    Build(scene, diff.Entries);
+    diff.Changes.assign(diff.Entries.size(), SCENE_OBJECT_ADDED);
+    diff.Removed.clear();
+
+    std::unordered_map<std::string, size_t> liveKeys;
+    for (size_t i = 0; i < live.size(); i++)
+    {
+        liveKeys.emplace(live[i].Key, i);
+    }
+
+    std::vector<uint8_t> matched(live.size(), 0);
+    for (size_t i = 0; i < diff.Entries.size(); i++)
+    {
+        SceneEntry& entry = diff.Entries[i];
+
+        //A name used twice only carries the first one over, the rest are new objects
+        auto found = liveKeys.find(entry.Key);
+        if (found == liveKeys.end() || matched[found->second]) continue;
+
+        const SceneEntry& old = live[found->second];
+        matched[found->second] = 1;
+        entry.Object = old.Object;
+
+        if (AssetCache::NormalizePath(entry.MeshPath) != AssetCache::NormalizePath(old.MeshPath) ||
+            AssetCache::NormalizePath(entry.TexturePath) != AssetCache::NormalizePath(old.TexturePath) ||
+            AssetCache::NormalizePath(entry.NormalPath) != AssetCache::NormalizePath(old.NormalPath) ||
+            entry.HasTexture != old.HasTexture || entry.HasSpecular != old.HasSpecular || entry.HasNormal != old.HasNormal)
+        {
+            diff.Changes[i] = SCENE_OBJECT_REBUILT;
+        }
+        else if (entry.RotationY != old.RotationY || entry.Scale != old.Scale || entry.Position.x != old.Position.x ||
+                 entry.Position.y != old.Position.y || entry.Position.z != old.Position.z)
+        {
+            diff.Changes[i] = SCENE_OBJECT_MOVED;
+        }
+        else
+        {
+            diff.Changes[i] = SCENE_OBJECT_SAME;
+        }
+    }
+
+    for (size_t i = 0; i < live.size(); i++)
+    {
+        if (!matched[i]) diff.Removed.push_back(live[i].Object);
+    }
+}
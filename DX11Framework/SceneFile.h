@@ -0,0 +1,176 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include "AssetArchive.h"
+#include "HandlePool.h"
+
+using namespace DirectX;
+
+//Marks a missing name, asset or parent in SceneObjectDesc and the binary records
+const uint32_t SCENE_NONE = ~(uint32_t)0;
+
+//What the scene file says about one object, the same whichever format it was read from. The strings point
+//into the SceneFile it came from and only last as long as that does
+struct SceneObjectDesc
+{
+	const char* Name = nullptr;
+	const char* MeshPath = "";
+	const char* TexturePath = nullptr; //Only set with HasTexture
+	const char* NormalPath = nullptr;
+	int HasTexture = 0;
+	bool HasSpecular = true;
+	float RotationY = 0.0f;
+	float Scale = 1.0f;
+	XMFLOAT3 Position = XMFLOAT3(0.0f, 0.0f, 0.0f); //Relative to the parent when there is one
+	uint32_t Parent = SCENE_NONE;                   //Index of the parent in the same scene
+};
+
+//Compiled scene layout: header, asset table, object records, then the string table. Names and paths are
+//offsets into the string table, assets are indices into the asset table and parents are object indices, so
+//loading is just checking the numbers add up
+const uint32_t SCENE_FILE_MAGIC = 0x424E4353; //"SCNB"
+const uint32_t SCENE_FILE_VERSION = 1;
+
+enum SceneObjectFlags
+{
+	SCENE_OBJECT_HAS_TEXTURE = 1,
+	SCENE_OBJECT_HAS_SPECULAR = 2
+};
+
+struct SceneFileHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t ObjectCount;
+	uint32_t AssetCount;
+	uint32_t StringTableSize;
+	uint32_t Reserved;
+};
+
+struct SceneObjectRecord
+{
+	float Position[3];
+	float RotationY;
+	float Scale;
+	uint32_t Name;
+	uint32_t Mesh;
+	uint32_t Texture;
+	uint32_t NormalMap;
+	uint32_t Parent;
+	uint32_t Flags;
+};
+
+//One scene's objects, from either the compiled binary (one mapped read, no parsing) or the source JSON
+class SceneFile
+{
+private:
+	AssetFile _binary;
+	std::vector<SceneObjectDesc> _objects;
+	std::deque<std::string> _strings; //Backing for the descs when they came from JSON, a deque so they never move
+
+	const char* Keep(const std::string& text);
+
+public:
+	SceneFile() = default;
+
+	SceneFile(const SceneFile&) = delete;
+	SceneFile& operator=(const SceneFile&) = delete;
+
+	//Out of archive when that has it, the archive then has to outlive this
+	bool LoadBinary(const std::string& filename, const AssetArchive* archive = nullptr);
+	bool LoadJson(const std::string& filename);
+
+	//Loads the compiled version of jsonFilename, compiling it first when it is missing or older than the JSON.
+	//Fails if it can't be compiled, the JSON can still be read directly then. A compiled scene in archive is used as it is
+	bool Load(const std::string& jsonFilename, const AssetArchive* archive = nullptr);
+
+	//Reads the JSON without building a document, onObject gets each object (with its index in the file) as soon as
+	//its closing brace is parsed. The desc's strings only last for the call. A parent named before its child is in
+	//the child's desc, one that only turns up later is passed to onParent(child, parent) right after its own onObject
+	static bool StreamJson(const std::string& filename, const std::function<void(uint32_t, const SceneObjectDesc&)>& onObject, const std::function<void(uint32_t, uint32_t)>& onParent);
+
+	void Clear();
+
+	const std::vector<SceneObjectDesc>& GetObjects() const { return _objects; }
+};
+
+namespace SceneCompiler
+{
+	//fileData.json -> fileData.scene, next to the source
+	std::string GetBinaryPath(const std::string& jsonFilename);
+
+	//Compares last write times, a missing binary is never up to date
+	bool IsUpToDate(const std::string& jsonFilename, const std::string& binaryFilename);
+
+	bool Compile(const std::string& jsonFilename, const std::string& binaryFilename);
+};
+
+//Owned copy of a desc plus the object made from it, kept so a reloaded scene can be compared with what is live
+struct SceneEntry
+{
+	std::string Key; //Name if it has one, otherwise mesh path and which use of that mesh it is
+	std::string Name;
+	std::string MeshPath;
+	std::string TexturePath;
+	std::string NormalPath;
+	int HasTexture = 0;
+	bool HasSpecular = true;
+	bool HasNormal = false;
+	float RotationY = 0.0f;
+	float Scale = 1.0f;
+	XMFLOAT3 Position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	uint32_t Parent = SCENE_NONE;
+	PoolHandle Object;
+
+	//Points into this entry's strings
+	SceneObjectDesc GetDesc() const
+	{
+		SceneObjectDesc desc;
+		desc.Name = Name.empty() ? nullptr : Name.c_str();
+		desc.MeshPath = MeshPath.c_str();
+		desc.TexturePath = HasTexture == 1 ? TexturePath.c_str() : nullptr;
+		desc.NormalPath = HasNormal ? NormalPath.c_str() : nullptr;
+		desc.HasTexture = HasTexture;
+		desc.HasSpecular = HasSpecular;
+		desc.RotationY = RotationY;
+		desc.Scale = Scale;
+		desc.Position = Position;
+		desc.Parent = Parent;
+		return desc;
+	}
+};
+
+//What has to happen to a live object for it to match the reloaded scene
+enum SceneObjectChange
+{
+	SCENE_OBJECT_SAME,
+	SCENE_OBJECT_MOVED,   //Only the transform differs, it can be set in place
+	SCENE_OBJECT_REBUILT, //Assets or shader options differ, the object is made again
+	SCENE_OBJECT_ADDED
+};
+
+struct SceneDiff
+{
+	std::vector<SceneEntry> Entries;        //The new scene, Object is set on everything matched to a live object
+	std::vector<SceneObjectChange> Changes; //One per entry
+	std::vector<PoolHandle> Removed;        //Live objects nothing in the new scene matched
+};
+
+namespace SceneEntries
+{
+	//Entries for a scene's objects, keys worked out but no objects yet
+	void Build(const std::vector<SceneObjectDesc>& objects, std::vector<SceneEntry>& entries);
+
+	//The same one at a time, for objects streamed in. Keys are only right once AssignKeys has seen them all
+	SceneEntry Make(const SceneObjectDesc& desc);
+	void AssignKeys(std::vector<SceneEntry>& entries);
+
+	//Matches scene up against live by key and works out what changed. Parents aren't compared, since a rebuilt
+	//parent is a different object anyway, whoever applies the diff checks every object's parent afterwards
+	void Diff(const std::vector<SceneEntry>& live, const std::vector<SceneObjectDesc>& scene, SceneDiff& diff);
+};
@@ -0,0 +1,215 @@
+#include "ShaderCache.h"
+#include <d3d11shader.h>
+#include <fstream>
+#include <string.h>
+#include "Hash.h"
+
+static const uint32_t SHADER_ARCHIVE_MAGIC = 0x43444853; //"SHDC"
+static const uint32_t SHADER_ARCHIVE_VERSION = 2;
+
+static uint64_t HashName(const wchar_t* name)
+{
+    return HashBytes(name, wcslen(name) * sizeof(wchar_t));
+}
+
+static uint64_t HashDefines(const D3D_SHADER_MACRO* defines)
+{
+    uint64_t hash = HASH_SEED;
+    for (const D3D_SHADER_MACRO* define = defines; define && define->Name; define++)
+    {
+        hash = HashString(define->Name, hash);
+        hash = HashString("=", hash);
+        hash = HashString(define->Definition ? define->Definition : "", hash);
+        hash = HashString(";", hash);
+    }
+    return hash;
+}
+
+static void Reflect(const void* bytecode, size_t size, ShaderReflectionInfo& info)
+{
+    info = {};
+
+    ID3D11ShaderReflection* reflection = nullptr;
+    if (FAILED(D3DReflect(bytecode, size, __uuidof(ID3D11ShaderReflection), reinterpret_cast<void**>(&reflection)))) return;
+
+    D3D11_SHADER_DESC desc;
+    reflection->GetDesc(&desc);
+    info.ConstantBuffers = desc.ConstantBuffers;
+    info.BoundResources = desc.BoundResources;
+    info.InputParameters = desc.InputParameters;
+    info.InstructionCount = desc.InstructionCount;
+
+    if (desc.ConstantBuffers > 0)
+    {
+        D3D11_SHADER_BUFFER_DESC bufferDesc;
+        reflection->GetConstantBufferByIndex(0)->GetDesc(&bufferDesc);
+        info.ConstantBufferSize = bufferDesc.Size;
+    }
+
+    reflection->Release();
+}
+
+bool ShaderCache::Open(const wchar_t* archivePath)
+{
+    _archivePath = archivePath;
+
+    if (!_archive.Open(archivePath)) return false;
+
+    //Anything that doesn't look like a current archive is ignored and rebuilt on Save
+    const ShaderArchiveHeader* header = (const ShaderArchiveHeader*)_archive.GetData();
+    if (_archive.GetSize() < sizeof(ShaderArchiveHeader) ||
+        header->Magic != SHADER_ARCHIVE_MAGIC || header->Version != SHADER_ARCHIVE_VERSION ||
+        _archive.GetSize() < sizeof(ShaderArchiveHeader) + header->EntryCount * sizeof(ShaderArchiveEntry))
+    {
+        _archive.Close();
+        return false;
+    }
+
+    _archiveEntries = (const ShaderArchiveEntry*)(_archive.GetData() + sizeof(ShaderArchiveHeader));
+    _archiveEntryCount = header->EntryCount;
+
+    return true;
+}
+
+void ShaderCache::Close()
+{
+    _archive.Close();
+    _archiveEntries = nullptr;
+    _archiveEntryCount = 0;
+    _compiled.clear();
+}
+
+uint64_t ShaderCache::GetSourceHash(const wchar_t* sourceFile)
+{
+    auto it = _sourceHashes.find(sourceFile);
+    if (it != _sourceHashes.end()) return it->second;
+
+    std::ifstream file(sourceFile, std::ios::in | std::ios::binary);
+    std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    uint64_t hash = HashString(source);
+    _sourceHashes[sourceFile] = hash;
+
+    return hash;
+}
+
+bool ShaderCache::Matches(const ShaderArchiveEntry& entry, uint64_t nameHash, uint64_t definesHash, const char* entryPoint, const char* profile, DWORD flags)
+{
+    return entry.SourceNameHash == nameHash && entry.DefinesHash == definesHash && entry.Flags == flags &&
+        strncmp(entry.EntryPoint, entryPoint, sizeof(entry.EntryPoint)) == 0 &&
+        strncmp(entry.Profile, profile, sizeof(entry.Profile)) == 0;
+}
+
+HRESULT ShaderCache::GetShader(const wchar_t* sourceFile, const D3D_SHADER_MACRO* defines, const char* entryPoint, const char* profile, DWORD flags, ShaderBlob& shader, ID3DBlob** errorBlob)
+{
+    uint64_t nameHash = HashName(sourceFile);
+    uint64_t definesHash = HashDefines(defines);
+
+    //The source is checked every launch so an edit shows up without deleting the archive, and an archive left
+    //over from older HLSL never gets used. Hashing the file is far cheaper than compiling it
+    uint64_t sourceHash = GetSourceHash(sourceFile);
+
+    for (const CompiledShader& compiled : _compiled)
+    {
+        if (Matches(compiled.Entry, nameHash, definesHash, entryPoint, profile, flags))
+        {
+            shader = { compiled.Bytecode.data(), compiled.Bytecode.size(), compiled.Entry.Reflection };
+            _hits++;
+            return S_OK;
+        }
+    }
+
+    for (uint32_t i = 0; i < _archiveEntryCount; i++)
+    {
+        const ShaderArchiveEntry& entry = _archiveEntries[i];
+        if (!Matches(entry, nameHash, definesHash, entryPoint, profile, flags)) continue;
+
+        if (entry.SourceHash != sourceHash) break;
+
+        if ((size_t)entry.BytecodeOffset + entry.BytecodeSize > _archive.GetSize()) break;
+
+        shader = { _archive.GetData() + entry.BytecodeOffset, entry.BytecodeSize, entry.Reflection };
+        _hits++;
+        return S_OK;
+    }
+
+    //Not in the archive (or out of date) so compile it and keep it for Save
+    ID3DBlob* blob = nullptr;
+    HRESULT hr = D3DCompileFromFile(sourceFile, defines, D3D_COMPILE_STANDARD_FILE_INCLUDE, entryPoint, profile, flags, 0, &blob, errorBlob);
+    if (FAILED(hr)) return hr;
+
+    CompiledShader compiled = {};
+    compiled.Entry.SourceNameHash = nameHash;
+    compiled.Entry.SourceHash = sourceHash;
+    compiled.Entry.DefinesHash = definesHash;
+    compiled.Entry.Flags = flags;
+    strncpy_s(compiled.Entry.EntryPoint, entryPoint, _TRUNCATE);
+    strncpy_s(compiled.Entry.Profile, profile, _TRUNCATE);
+    compiled.Bytecode.assign((const uint8_t*)blob->GetBufferPointer(), (const uint8_t*)blob->GetBufferPointer() + blob->GetBufferSize());
+    Reflect(blob->GetBufferPointer(), blob->GetBufferSize(), compiled.Entry.Reflection);
+    blob->Release();
+
+    _compiled.push_back(compiled);
+    _compiles++;
+
+    const CompiledShader& added = _compiled.back();
+    shader = { added.Bytecode.data(), added.Bytecode.size(), added.Entry.Reflection };
+
+    return S_OK;
+}
+
+HRESULT ShaderCache::Save()
+{
+    if (_compiled.empty() || _archivePath.empty()) return S_OK;
+
+    std::vector<ShaderArchiveEntry> entries;
+    std::vector<uint8_t> bytecode;
+
+    //Keep archive entries that weren't replaced by a recompile
+    for (uint32_t i = 0; i < _archiveEntryCount; i++)
+    {
+        const ShaderArchiveEntry& entry = _archiveEntries[i];
+
+        bool replaced = false;
+        for (const CompiledShader& compiled : _compiled)
+        {
+            if (Matches(compiled.Entry, entry.SourceNameHash, entry.DefinesHash, entry.EntryPoint, entry.Profile, entry.Flags)) replaced = true;
+        }
+
+        if (replaced || (size_t)entry.BytecodeOffset + entry.BytecodeSize > _archive.GetSize()) continue;
+
+        ShaderArchiveEntry copy = entry;
+        copy.BytecodeOffset = (uint32_t)bytecode.size();
+        bytecode.insert(bytecode.end(), _archive.GetData() + entry.BytecodeOffset, _archive.GetData() + entry.BytecodeOffset + entry.BytecodeSize);
+        entries.push_back(copy);
+    }
+
+    for (const CompiledShader& compiled : _compiled)
+    {
+        ShaderArchiveEntry copy = compiled.Entry;
+        copy.BytecodeOffset = (uint32_t)bytecode.size();
+        copy.BytecodeSize = (uint32_t)compiled.Bytecode.size();
+        bytecode.insert(bytecode.end(), compiled.Bytecode.begin(), compiled.Bytecode.end());
+        entries.push_back(copy);
+    }
+
+    //Offsets so far are relative to the start of the bytecode, make them relative to the file
+    uint32_t dataStart = (uint32_t)(sizeof(ShaderArchiveHeader) + entries.size() * sizeof(ShaderArchiveEntry));
+    for (ShaderArchiveEntry& entry : entries)
+    {
+        entry.BytecodeOffset += dataStart;
+    }
+
+    //Archive is still mapped, it has to be released before the file can be rewritten
+    Close();
+
+    ShaderArchiveHeader header = { SHADER_ARCHIVE_MAGIC, SHADER_ARCHIVE_VERSION, (uint32_t)entries.size(), 0 };
+
+    std::ofstream outbin(_archivePath.c_str(), std::ios::out | std::ios::binary);
+    outbin.write((char*)&header, sizeof(header));
+    outbin.write((char*)entries.data(), sizeof(ShaderArchiveEntry) * entries.size());
+    outbin.write((char*)bytecode.data(), bytecode.size());
+    outbin.close();
+
+    return outbin.good() ? S_OK : E_FAIL;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <windows.h>
+#include <d3d11_4.h>
+#include <d3dcompiler.h>
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+//Bits of D3DReflect output that are worth keeping so we don't need to reflect again at runtime
+struct ShaderReflectionInfo
+{
+	uint32_t ConstantBuffers;
+	uint32_t ConstantBufferSize; //Size of the first constant buffer
+	uint32_t BoundResources;
+	uint32_t InputParameters;
+	uint32_t InstructionCount;
+};
+
+//On disk layout of the archive, header then an entry table then the bytecode of every entry
+struct ShaderArchiveHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t EntryCount;
+	uint32_t Reserved;
+};
+
+struct ShaderArchiveEntry
+{
+	uint64_t SourceNameHash;
+	uint64_t SourceHash;
+	uint64_t DefinesHash;
+	uint32_t Flags;
+	uint32_t BytecodeOffset;
+	uint32_t BytecodeSize;
+	ShaderReflectionInfo Reflection;
+	char EntryPoint[32];
+	char Profile[16];
+};
+
+//Bytecode for one shader stage, points into the archive or a freshly compiled blob and stays valid until Save/Close
+struct ShaderBlob
+{
+	const void* Bytecode;
+	size_t Size;
+	ShaderReflectionInfo Reflection;
+};
+
+//Precompiled shader archive so startup doesn't pay for D3DCompileFromFile every launch.
+//Entries carry a hash of their .hlsl source and anything that changed is recompiled rather than loaded stale. The
+//release build writes the archive with -compile-shaders after linking so it ships matching the HLSL
+class ShaderCache
+{
+private:
+	struct CompiledShader
+	{
+		ShaderArchiveEntry Entry;
+		std::vector<uint8_t> Bytecode;
+	};
+
+	std::wstring _archivePath;
+	MappedFile _archive;
+	const ShaderArchiveEntry* _archiveEntries = nullptr;
+	uint32_t _archiveEntryCount = 0;
+
+	std::deque<CompiledShader> _compiled; //deque so blobs handed out don't move when more are added
+	std::map<std::wstring, uint64_t> _sourceHashes;
+
+	int _hits = 0;
+	int _compiles = 0;
+
+	uint64_t GetSourceHash(const wchar_t* sourceFile);
+	bool Matches(const ShaderArchiveEntry& entry, uint64_t nameHash, uint64_t definesHash, const char* entryPoint, const char* profile, DWORD flags);
+
+public:
+	bool Open(const wchar_t* archivePath);
+	void Close();
+
+	//defines is a null terminated D3D_SHADER_MACRO list (or nullptr), each permutation is its own archive entry
+	HRESULT GetShader(const wchar_t* sourceFile, const D3D_SHADER_MACRO* defines, const char* entryPoint, const char* profile, DWORD flags, ShaderBlob& shader, ID3DBlob** errorBlob);
+
+	//Writes the archive back out if anything had to be compiled, invalidates every ShaderBlob handed out
+	HRESULT Save();
+
+	int GetHits() { return _hits; }
+	int GetCompiles() { return _compiles; }
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+
+//Features a pixel shader variant is compiled with, each one becomes a preprocessor define in SimpleShaders.hlsl
+enum ShaderFeature : uint32_t
+{
+	SHADER_TEXTURED = 1 << 0,
+	SHADER_SPECULAR = 1 << 1,
+	SHADER_NORMAL_MAP = 1 << 2,
+	SHADER_TEXTURE_ARRAY = 1 << 3, //Diffuse is a slice of a packed Texture2DArray, see TexturePacker
+};
+
+const int SHADER_FEATURE_COUNT = 4;
+const int SHADER_PERMUTATION_COUNT = 1 << SHADER_FEATURE_COUNT;
+
+//Index of a variant, just the feature bits so it can index an array of compiled shaders directly
+typedef uint32_t PermutationKey;
+
+//Define name for each feature bit, in bit order
+inline const char* GetPermutationDefine(int featureIndex)
+{
+	static const char* defines[SHADER_FEATURE_COUNT] = { "HAS_TEXTURE", "HAS_SPECULAR", "HAS_NORMAL_MAP", "HAS_TEXTURE_ARRAY" };
+	return defines[featureIndex];
+}
+
+inline PermutationKey MakePermutationKey(bool textured, bool specular, bool normalMap)
+{
+	PermutationKey key = 0;
+	if (textured) key |= SHADER_TEXTURED;
+	if (specular) key |= SHADER_SPECULAR;
+	if (normalMap) key |= SHADER_NORMAL_MAP;
+	return key;
+}
+
+inline bool HasFeature(PermutationKey key, ShaderFeature feature)
+{
+	return (key & feature) != 0;
+}
+
+//Render queue sort key, most significant bits change state the most expensively so they are sorted first:
+//[63..60 permutation][59..40 texture][39..20 mesh][19..0 depth]
+const int SORT_KEY_PERMUTATION_SHIFT = 60;
+const int SORT_KEY_TEXTURE_SHIFT = 40;
+const int SORT_KEY_MESH_SHIFT = 20;
+const uint64_t SORT_KEY_TEXTURE_MASK = (1ull << 20) - 1;
+const uint64_t SORT_KEY_MESH_MASK = (1ull << 20) - 1;
+const uint64_t SORT_KEY_DEPTH_MASK = (1ull << 20) - 1;
+
+inline uint64_t MakeSortKey(PermutationKey permutation, uint32_t texture, uint32_t mesh, uint32_t depth)
+{
+	return ((uint64_t)(permutation & (SHADER_PERMUTATION_COUNT - 1)) << SORT_KEY_PERMUTATION_SHIFT) |
+		((texture & SORT_KEY_TEXTURE_MASK) << SORT_KEY_TEXTURE_SHIFT) |
+		((mesh & SORT_KEY_MESH_MASK) << SORT_KEY_MESH_SHIFT) |
+		(depth & SORT_KEY_DEPTH_MASK);
+}
+
+inline PermutationKey GetSortKeyPermutation(uint64_t sortKey)
+{
+	return (PermutationKey)(sortKey >> SORT_KEY_PERMUTATION_SHIFT);
+}
@@ -1,4 +1,24 @@
+//Variant defines, set per permutation by the C++ side. Defaults let the file compile on its own too
+#ifndef HAS_TEXTURE
+#define HAS_TEXTURE 1
+#endif
+#ifndef HAS_SPECULAR
+#define HAS_SPECULAR 1
+#endif
+#ifndef HAS_NORMAL_MAP
+#define HAS_NORMAL_MAP 0
+#endif
+#ifndef HAS_TEXTURE_ARRAY
+#define HAS_TEXTURE_ARRAY 0
+#endif
+
+//Packed diffuse textures are one slice of an array, each object says which with TextureSlice
+#if HAS_TEXTURE_ARRAY
+Texture2DArray diffuseTex : register(t0);
+#else
 Texture2D diffuseTex : register(t0);
+#endif
+Texture2D normalTex : register(t1);
 
 SamplerState bilinearSampler : register(s0);
 
@@ -17,8 +37,8 @@ cbuffer ConstantBuffer : register(b0)
     float4 specularMaterial;
     float3 cameraPosition;
     float specPower;
-    int hasTexture;
-    
+    float4 TextureTransform;
+    float TextureSlice;
 }
 
 struct VS_Out
@@ -29,6 +49,7 @@ struct VS_Out
     float3 PosW : POSITION0;
     float3 WorldVertexNormal : wvNormal;
     float2 TexCoord : TEXCOORD;
+    float2 DiffuseCoord : TEXCOORD1; //TexCoord moved into the object's place in a packed texture
 };
 
 VS_Out VS_main(float3 Position : POSITION, float3 Normal : NORMAL, float2 TexCoord : TEXCOORD)
@@ -46,46 +67,72 @@ VS_Out VS_main(float3 Position : POSITION, float3 Normal : NORMAL, float2 TexCoo
     output.WorldVertexNormal = NormalW;
     
     output.TexCoord = TexCoord;
+    output.DiffuseCoord = TexCoord * TextureTransform.xy + TextureTransform.zw;
     
     output.normal = Normal;
     
     return output;
 }
 
+#if HAS_NORMAL_MAP
+//No tangents in the vertex format so build the tangent frame from screen space derivatives instead
+float3 PerturbNormal(float3 normal, float3 position, float2 texCoord)
+{
+    float3 dp1 = ddx(position);
+    float3 dp2 = ddy(position);
+    float2 duv1 = ddx(texCoord);
+    float2 duv2 = ddy(texCoord);
+
+    float3 dp2perp = cross(dp2, normal);
+    float3 dp1perp = cross(normal, dp1);
+    float3 tangent = dp2perp * duv1.x + dp1perp * duv2.x;
+    float3 bitangent = dp2perp * duv1.y + dp1perp * duv2.y;
+
+    float invMax = rsqrt(max(dot(tangent, tangent), dot(bitangent, bitangent)));
+    float3x3 TBN = float3x3(tangent * invMax, bitangent * invMax, normal);
+
+    float3 mapNormal = normalTex.Sample(bilinearSampler, texCoord).xyz * 2.0f - 1.0f;
+    return normalize(mul(mapNormal, TBN));
+}
+#endif
+
 float4 PS_main(VS_Out input) : SV_TARGET
 {
     float3 NormalDir = normalize(input.WorldVertexNormal);
+
+#if HAS_NORMAL_MAP
+    NormalDir = PerturbNormal(NormalDir, input.PosW, input.TexCoord);
+#endif
+
     float DiffuseAmount = saturate(dot(LightDir, NormalDir));
-    
-    float4 texColor = diffuseTex.Sample(bilinearSampler, input.TexCoord);
-    
+
+#if HAS_TEXTURE
+#if HAS_TEXTURE_ARRAY
+    float4 texColor = diffuseTex.Sample(bilinearSampler, float3(input.DiffuseCoord, TextureSlice));
+#else
+    float4 texColor = diffuseTex.Sample(bilinearSampler, input.DiffuseCoord);
+#endif
+    float4 SurfaceColour = texColor;
+    float4 AmbientSurface = texColor;
+#else
+    float4 SurfaceColour = DiffuseMaterial;
+    float4 AmbientSurface = ambientColour;
+#endif
+
+    float4 PotentialDiffuse = DiffuseLight * SurfaceColour;
+    float4 TotalColour = (PotentialDiffuse * DiffuseAmount);
+    TotalColour += (AmbientSurface * ambientLighting);
+
+#if HAS_SPECULAR
     ////Specular lighting Stuff
     float3 reflectedDir = reflect(-LightDir, NormalDir);
     float3 ObjectToCamera = normalize(cameraPosition - input.PosW);
     float SpecularDot = saturate(dot(ObjectToCamera, reflectedDir));
-    //float3 SpecularIntensity = reflectedDir * ObjectToCamera;
     
     float SpecularIntensity = pow(SpecularDot, specPower);
-    
-    float4 TotalColour;
-    
-    if (hasTexture == 1)
-    {
-        float4 PotentialDiffuse = DiffuseLight * texColor;
-        TotalColour = (PotentialDiffuse * DiffuseAmount);
-        TotalColour += (texColor * ambientLighting);
-        TotalColour += SpecularIntensity * (specularLight * specularMaterial);
-
-    }
-    else
-    {
-        float4 PotentialDiffuse = DiffuseLight * DiffuseMaterial;
-        TotalColour = (PotentialDiffuse * DiffuseAmount);
-        TotalColour += (ambientColour * ambientLighting);
-        TotalColour += SpecularIntensity * (specularLight * specularMaterial);
-    }
+    TotalColour += SpecularIntensity * (specularLight * specularMaterial);
+#endif
 
-    
     input.color = TotalColour;
     
     return input.color;
@@ -0,0 +1,166 @@
+#include "StressScene.h"
+#include <windows.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include "FileUtilities.h"
+
+#include "JSON\json.hpp"
+using json = nlohmann::json;
+
+//xorshift32, std::uniform_real_distribution isn't the same across standard libraries and the scenes have to be
+static uint32_t NextRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//[0, 1)
+static float RandomFloat(uint32_t& state)
+{
+    return (NextRandom(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+bool StressScene::LoadSettings(const char* filename, StressSceneSettings& settings)
+{
+    std::ifstream fileOpen(filename);
+    if (!fileOpen.good()) return false;
+
+    json jFile = json::parse(fileOpen, nullptr, false);
+    if (jFile.is_discarded()) return false;
+
+    settings.OutputPath = jFile.value("Output", settings.OutputPath);
+    settings.ObjectCount = jFile.value("Objects", settings.ObjectCount);
+    settings.TexturedFraction = jFile.value("TexturedFraction", settings.TexturedFraction);
+    settings.Spacing = jFile.value("Spacing", settings.Spacing);
+    settings.ClusterCount = jFile.value("Clusters", settings.ClusterCount);
+    settings.HierarchyDepth = jFile.value("HierarchyDepth", settings.HierarchyDepth);
+    settings.Seed = jFile.value("Seed", settings.Seed);
+
+    if (jFile.contains("Meshes")) settings.Meshes = jFile["Meshes"].get<std::vector<std::string>>();
+    if (jFile.contains("Textures")) settings.Textures = jFile["Textures"].get<std::vector<std::string>>();
+
+    std::string distribution = jFile.value("Distribution", std::string("Grid"));
+    if (distribution == "Random") settings.Distribution = STRESS_RANDOM;
+    else if (distribution == "Clusters") settings.Distribution = STRESS_CLUSTERS;
+    else settings.Distribution = STRESS_GRID;
+
+    return settings.ObjectCount >= 0;
+}
+
+void StressScene::FindAssets(StressSceneSettings& settings)
+{
+    if (settings.Meshes.empty())
+    {
+        FindFiles("Test models", { ".obj" }, settings.Meshes);
+        std::sort(settings.Meshes.begin(), settings.Meshes.end());
+    }
+
+    //Only colour maps, the normal, specular and displacement maps next to them aren't meant to be drawn directly
+    if (settings.Textures.empty())
+    {
+        FindFiles("Textures", { "_COLOR.dds" }, settings.Textures);
+        FindFiles("Test models", { "_COLOR.dds" }, settings.Textures);
+        std::sort(settings.Textures.begin(), settings.Textures.end());
+    }
+}
+
+float StressScene::GetExtent(const StressSceneSettings& settings)
+{
+    int roots = (settings.ObjectCount + std::max(settings.HierarchyDepth, 1) - 1) / std::max(settings.HierarchyDepth, 1);
+    return ceilf(sqrtf((float)std::max(roots, 1))) * settings.Spacing * 0.5f;
+}
+
+bool StressScene::Generate(const StressSceneSettings& settings)
+{
+    if (settings.Meshes.empty()) return false;
+
+    std::ofstream output(settings.OutputPath);
+    if (!output.good()) return false;
+
+    uint32_t random = settings.Seed ? settings.Seed : 1;
+    int depth = std::max(settings.HierarchyDepth, 1);
+    float extent = GetExtent(settings);
+    int side = (int)ceilf(sqrtf((float)std::max((settings.ObjectCount + depth - 1) / depth, 1)));
+
+    std::vector<float> clusters;
+    float clusterRadius = extent / sqrtf((float)std::max(settings.ClusterCount, 1));
+    for (int i = 0; i < settings.ClusterCount * 2; i++)
+    {
+        clusters.push_back((RandomFloat(random) * 2.0f - 1.0f) * (extent - clusterRadius));
+    }
+
+    //Paths go through json so their backslashes come out escaped
+    std::vector<std::string> meshes;
+    std::vector<std::string> textures;
+    for (const std::string& mesh : settings.Meshes) meshes.push_back(json(mesh).dump());
+    for (const std::string& texture : settings.Textures) textures.push_back(json(texture).dump());
+
+    output << "{\n  \"Gameobjects\": [";
+
+    int root = 0;
+    for (int i = 0; i < settings.ObjectCount; i++)
+    {
+        bool isRoot = i % depth == 0;
+        float x = 0.0f;
+        float y = 2.0f; //Children sit just above their parent
+        float z = 0.0f;
+        float scale = 1.0f;
+
+        if (isRoot)
+        {
+            if (settings.Distribution == STRESS_GRID)
+            {
+                x = ((root % side) - (side - 1) * 0.5f) * settings.Spacing;
+                z = ((root / side) - (side - 1) * 0.5f) * settings.Spacing;
+                y = 0.0f;
+            }
+            else if (settings.Distribution == STRESS_RANDOM)
+            {
+                x = (RandomFloat(random) * 2.0f - 1.0f) * extent;
+                z = (RandomFloat(random) * 2.0f - 1.0f) * extent;
+                y = RandomFloat(random) * settings.Spacing;
+            }
+            else
+            {
+                //Sum of three is close enough to a normal distribution for clumping
+                int cluster = settings.ClusterCount > 0 ? (int)(NextRandom(random) % settings.ClusterCount) : 0;
+                float offsetX = RandomFloat(random) + RandomFloat(random) + RandomFloat(random) - 1.5f;
+                float offsetZ = RandomFloat(random) + RandomFloat(random) + RandomFloat(random) - 1.5f;
+                x = (clusters.empty() ? 0.0f : clusters[cluster * 2]) + offsetX * clusterRadius;
+                z = (clusters.empty() ? 0.0f : clusters[cluster * 2 + 1]) + offsetZ * clusterRadius;
+                y = RandomFloat(random) * settings.Spacing;
+            }
+
+            //Only roots get a random scale, children would otherwise compound it down the chain
+            scale = 0.5f + RandomFloat(random) * 1.5f;
+            root++;
+        }
+
+        float rotation = RandomFloat(random) * 6.2831853f;
+        const std::string& mesh = meshes[NextRandom(random) % meshes.size()];
+        bool textured = !textures.empty() && RandomFloat(random) < settings.TexturedFraction;
+
+        output << (i == 0 ? "\n" : ",\n") << "    { \"Name\": \"Stress" << i << "\", \"MeshLocation\": " << mesh;
+        if (textured)
+        {
+            output << ", \"TextureLocation\": " << textures[NextRandom(random) % textures.size()] << ", \"HasTexture\": 1";
+        }
+        else
+        {
+            output << ", \"HasTexture\": 0";
+        }
+        output << ", \"RotationY\": " << rotation << ", \"Scale\": " << scale
+            << ", \"StartPosX\": " << x << ", \"StartPosY\": " << y << ", \"StartPosZ\": " << z;
+        if (!isRoot)
+        {
+            output << ", \"Parent\": \"Stress" << i - 1 << "\"";
+        }
+        output << " }";
+    }
+
+    output << "\n  ],\n  \"version\": \"1.1\"\n}\n";
+    return output.good();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//Where the generator puts root objects, everything is centred on the origin
+enum StressDistribution
+{
+	STRESS_GRID,     //Square grid Spacing apart on the ground plane
+	STRESS_RANDOM,   //Uniform over the same area the grid would cover, some height variation
+	STRESS_CLUSTERS  //Clumped round ClusterCount random centres, lots of overlap inside each
+};
+
+//What to generate, read from JSON/stressSettings.json. Empty mesh or texture lists are filled from the Test models and Textures folders
+struct StressSceneSettings
+{
+	std::string OutputPath = "JSON/stressScene.json";
+	int ObjectCount = 10000;
+	std::vector<std::string> Meshes;
+	std::vector<std::string> Textures;
+	float TexturedFraction = 0.75f; //The rest fall back to the untextured shader
+	StressDistribution Distribution = STRESS_GRID;
+	float Spacing = 10.0f;
+	int ClusterCount = 16;
+	int HierarchyDepth = 1;         //Objects come in parent to child chains this long, 1 is all roots
+	uint32_t Seed = 1;
+};
+
+//Writes scenes in fileData.json's schema with as many objects as wanted, so loading, updating and drawing can be
+//tried at sizes the hand made scenes never get near. The same settings and seed always give the same file
+namespace StressScene
+{
+	bool LoadSettings(const char* filename, StressSceneSettings& settings);
+
+	//Every .obj under Test models\ and every *_COLOR.dds under Textures\ and Test models\, sorted so the order is stable
+	void FindAssets(StressSceneSettings& settings);
+
+	//Streams the objects straight out, a million object document would take far more memory than the file
+	bool Generate(const StressSceneSettings& settings);
+
+	//Half the width of the area the roots are spread over, for pointing a camera at the whole scene
+	float GetExtent(const StressSceneSettings& settings);
+};
@@ -19,7 +19,9 @@ struct ConstantBuffer
 	XMFLOAT4 specularMaterial;
 	XMFLOAT3 cameraPosition;
 	float specPower;
-	int hasTexture;
+	XMFLOAT4 TextureTransform; //Diffuse coordinates into a packed slice, xy scale and zw offset
+	float TextureSlice;
+	XMFLOAT3 pad;
 };
 
 struct MeshData
@@ -29,6 +31,7 @@ struct MeshData
 	UINT VBStride;
 	UINT VBOffset;
 	UINT IndexCount;
+	XMFLOAT4 Bounds; //Bounding sphere in model space, xyz centre and w radius
 };
 
 struct SimpleVertex
@@ -0,0 +1,385 @@
+#include "TextureBaker.h"
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include "BCDecoder.h"
+#include "FileUtilities.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+
+#include "JSON\json.hpp"
+using json = nlohmann::json;
+
+//Names the settings and the report use, sRGB follows the source so it isn't named
+static const struct { const char* Name; DDSFormat Format; } formatNames[] =
+{
+    { "BC1", DDS_FORMAT_BC1_UNORM },
+    { "BC3", DDS_FORMAT_BC3_UNORM },
+    { "BC4", DDS_FORMAT_BC4_UNORM },
+    { "BC5", DDS_FORMAT_BC5_UNORM },
+    { "BC7", DDS_FORMAT_BC7_UNORM },
+    { "BC1 sRGB", DDS_FORMAT_BC1_UNORM_SRGB },
+    { "BC3 sRGB", DDS_FORMAT_BC3_UNORM_SRGB },
+    { "BC7 sRGB", DDS_FORMAT_BC7_UNORM_SRGB },
+};
+
+static DDSFormat ParseFormat(const std::string& name, DDSFormat fallback)
+{
+    for (const auto& format : formatNames)
+    {
+        if (_stricmp(format.Name, name.c_str()) == 0) return format.Format;
+    }
+    return fallback;
+}
+
+//File name without its folders or extension
+static std::string GetStem(const std::string& path)
+{
+    size_t start = path.find_last_of("\\/");
+    start = start == std::string::npos ? 0 : start + 1;
+    size_t end = path.find_last_of('.');
+    if (end == std::string::npos || end < start) end = path.size();
+    return path.substr(start, end - start);
+}
+
+//Every 8 bit RGBA or BGRA layout to RGBA8, anything else would need a proper conversion and isn't worth baking from
+static bool ConvertToRGBA(const uint8_t* source, size_t rowPitch, uint32_t width, uint32_t height, DDSFormat format, std::vector<uint8_t>& pixels)
+{
+    bool swizzle = false;
+    bool opaque = false;
+    switch (format)
+    {
+    case DDS_FORMAT_R8G8B8A8_TYPELESS:
+    case DDS_FORMAT_R8G8B8A8_UNORM:
+    case DDS_FORMAT_R8G8B8A8_UNORM_SRGB:
+        break;
+
+    case DDS_FORMAT_B8G8R8A8_TYPELESS:
+    case DDS_FORMAT_B8G8R8A8_UNORM:
+    case DDS_FORMAT_B8G8R8A8_UNORM_SRGB:
+        swizzle = true;
+        break;
+
+    case DDS_FORMAT_B8G8R8X8_TYPELESS:
+    case DDS_FORMAT_B8G8R8X8_UNORM:
+    case DDS_FORMAT_B8G8R8X8_UNORM_SRGB:
+        swizzle = opaque = true;
+        break;
+
+    default:
+        return false;
+    }
+
+    pixels.resize((size_t)width * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const uint8_t* sourceRow = source + y * rowPitch;
+        uint8_t* row = pixels.data() + (size_t)y * width * 4;
+        memcpy(row, sourceRow, (size_t)width * 4);
+
+        for (uint32_t x = 0; x < width && (swizzle || opaque); x++)
+        {
+            if (swizzle) std::swap(row[x * 4], row[x * 4 + 2]);
+            if (opaque) row[x * 4 + 3] = 255;
+        }
+    }
+
+    return true;
+}
+
+//BC4 only keeps red and BC5 red and green, BC1 is scored on colour because its alpha is all or nothing
+static uint32_t GetScoredChannels(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_BC4_UNORM: return 1;
+    case DDS_FORMAT_BC5_UNORM: return 2;
+    case DDS_FORMAT_BC1_UNORM:
+    case DDS_FORMAT_BC1_UNORM_SRGB: return 3;
+    default: return 4;
+    }
+}
+
+static double GetPSNR(const uint8_t* original, const uint8_t* decoded, size_t pixelCount, uint32_t channels)
+{
+    double squaredError = 0.0;
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        for (uint32_t c = 0; c < channels; c++)
+        {
+            double difference = (double)original[i * 4 + c] - decoded[i * 4 + c];
+            squaredError += difference * difference;
+        }
+    }
+
+    if (squaredError == 0.0) return INFINITY;
+    double meanSquaredError = squaredError / (pixelCount * channels);
+    return 10.0 * log10(255.0 * 255.0 / meanSquaredError);
+}
+
+bool TextureBaker::LoadSettings(const char* filename, TextureBakeSettings& settings)
+{
+    std::ifstream fileOpen(filename);
+    if (!fileOpen.good()) return false;
+
+    json jFile = json::parse(fileOpen, nullptr, false);
+    if (jFile.is_discarded()) return false;
+
+    settings.InputDirectory = jFile.value("InputDirectory", settings.InputDirectory);
+    settings.OutputDirectory = jFile.value("OutputDirectory", settings.OutputDirectory);
+    settings.ReportPath = jFile.value("Report", settings.ReportPath);
+    settings.GenerateMips = jFile.value("Mips", settings.GenerateMips);
+    settings.AlphaCoverage = jFile.value("AlphaCoverage", settings.AlphaCoverage);
+    settings.DefaultFormat = ParseFormat(jFile.value("Format", std::string("BC7")), DDS_FORMAT_UNKNOWN);
+
+    if (jFile.contains("Inputs")) settings.Inputs = jFile["Inputs"].get<std::vector<std::string>>();
+
+    std::string quality = jFile.value("Quality", std::string("Normal"));
+    if (quality == "Fast") settings.Quality = BC_QUALITY_FAST;
+    else if (quality == "High") settings.Quality = BC_QUALITY_HIGH;
+    else settings.Quality = BC_QUALITY_NORMAL;
+
+    std::string filter = jFile.value("MipFilter", std::string("Kaiser"));
+    if (filter == "Box") settings.Filter = MIP_FILTER_BOX;
+    else if (filter == "Lanczos") settings.Filter = MIP_FILTER_LANCZOS;
+    else settings.Filter = MIP_FILTER_KAISER;
+
+    if (jFile.contains("Rules"))
+    {
+        for (const json& rule : jFile["Rules"])
+        {
+            DDSFormat format = ParseFormat(rule.value("Format", std::string()), DDS_FORMAT_UNKNOWN);
+            if (format == DDS_FORMAT_UNKNOWN) return false;
+            settings.Rules.push_back({ rule.value("Suffix", std::string()), format });
+        }
+    }
+
+    if (jFile.contains("Raw"))
+    {
+        for (const json& raw : jFile["Raw"])
+        {
+            RawTextureInput input;
+            input.Path = raw.value("Input", std::string());
+            input.Width = raw.value("Width", 0u);
+            input.Height = raw.value("Height", 0u);
+            input.Format = ParseFormat(raw.value("Format", std::string()), DDS_FORMAT_UNKNOWN);
+            if (input.Path.empty() || input.Width == 0 || input.Height == 0) return false;
+            settings.RawInputs.push_back(input);
+        }
+    }
+
+    return settings.DefaultFormat != DDS_FORMAT_UNKNOWN;
+}
+
+void TextureBaker::FindInputs(TextureBakeSettings& settings)
+{
+    if (!settings.Inputs.empty()) return;
+
+    FindFiles(settings.InputDirectory, { ".dds" }, settings.Inputs, settings.OutputDirectory);
+    std::sort(settings.Inputs.begin(), settings.Inputs.end());
+}
+
+DDSFormat TextureBaker::GetFormat(const TextureBakeSettings& settings, const std::string& path)
+{
+    std::string stem = GetStem(path);
+    for (const TextureBakeRule& rule : settings.Rules)
+    {
+        if (EndsWith(stem, rule.Suffix)) return rule.Format;
+    }
+    return settings.DefaultFormat;
+}
+
+bool TextureBaker::BakeImage(const uint8_t* pixels, uint32_t width, uint32_t height, DDSFormat format, const TextureBakeSettings& settings,
+    JobSystem* jobSystem, std::vector<uint8_t>& output, TextureBakeResult& result)
+{
+    result.Format = format;
+    result.Width = width;
+    result.Height = height;
+    if (!BCEncoder::IsSupported(format))
+    {
+        result.Error = "format can't be encoded";
+        return false;
+    }
+
+    //D3D11 wants the top mip of a block compressed texture to be whole blocks
+    if (width == 0 || height == 0 || width % 4 != 0 || height % 4 != 0)
+    {
+        result.Error = "size isn't a multiple of 4";
+        return false;
+    }
+
+    DDSTextureDesc desc;
+    desc.Dimension = DDS_DIMENSION_TEXTURE2D;
+    desc.Format = format;
+    desc.Width = width;
+    desc.Height = height;
+    desc.Depth = 1;
+    desc.ArraySize = 1;
+    desc.MipCount = settings.GenerateMips ? MipGenerator::GetMipCount(width, height) : 1;
+
+    output.clear();
+    size_t dataOffset = DDSParser::WriteHeader(desc, output);
+    result.MipCount = desc.MipCount;
+
+    auto start = std::chrono::steady_clock::now();
+
+    //sRGB outputs are filtered in linear light, which keeps bright detail from darkening as it shrinks
+    MipSettings mipSettings;
+    mipSettings.Filter = settings.Filter;
+    mipSettings.SRGB = DDSParser::IsSRGB(format);
+    mipSettings.AlphaCoverageReference = settings.AlphaCoverage;
+
+    std::vector<std::vector<uint8_t>> mips;
+    MipGenerator::Generate(pixels, (size_t)width * 4, width, height, desc.MipCount, mipSettings, mips, jobSystem);
+
+    for (uint32_t level = 0; level < desc.MipCount; level++)
+    {
+        uint32_t mipWidth = std::max(width >> level, 1u);
+        uint32_t mipHeight = std::max(height >> level, 1u);
+        size_t numBytes = 0;
+        size_t rowBytes = 0;
+        DDSParser::GetSurfaceInfo(mipWidth, mipHeight, format, &numBytes, &rowBytes, nullptr);
+
+        size_t offset = output.size();
+        output.resize(offset + numBytes);
+        BCEncoder::Encode(format, mips[level].data(), (size_t)mipWidth * 4, mipWidth, mipHeight, output.data() + offset, rowBytes, settings.Quality, jobSystem);
+    }
+
+    result.EncodeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.BakedBytes = output.size();
+
+    //Scored the way it will be drawn, through the same decode the loader's CPU path uses
+    size_t topRowBytes = 0;
+    size_t topBytes = 0;
+    DDSParser::GetSurfaceInfo(width, height, format, &topBytes, &topRowBytes, nullptr);
+    std::vector<uint8_t> decoded((size_t)width * height * 4);
+    BCDecoder::Decode(format, output.data() + dataOffset, topBytes, topRowBytes, width, height, decoded.data(), (size_t)width * 4, jobSystem);
+    result.PSNR = GetPSNR(pixels, decoded.data(), (size_t)width * height, GetScoredChannels(format));
+
+    return true;
+}
+
+bool TextureBaker::BakeFile(const std::string& path, const RawTextureInput* raw, const TextureBakeSettings& settings, JobSystem* jobSystem,
+    TextureBakeResult& result)
+{
+    result = TextureBakeResult();
+    result.Input = path;
+    result.Output = settings.OutputDirectory + "\\" + GetStem(path) + ".dds";
+
+    MappedFile file;
+    if (!file.Open(path.c_str()))
+    {
+        result.Error = "can't open";
+        return false;
+    }
+    result.SourceBytes = file.GetSize();
+
+    std::vector<uint8_t> pixels;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    DDSFormat format = raw && raw->Format != DDS_FORMAT_UNKNOWN ? raw->Format : GetFormat(settings, path);
+
+    if (raw)
+    {
+        width = raw->Width;
+        height = raw->Height;
+        if (file.GetSize() < (size_t)width * height * 4)
+        {
+            result.Error = "smaller than its size says";
+            return false;
+        }
+        pixels.assign(file.GetData(), file.GetData() + (size_t)width * height * 4);
+    }
+    else
+    {
+        DDSTextureDesc desc;
+        DDSLayout layout;
+        DDSResult parsed = DDSParser::Parse(file.GetData(), file.GetSize(), desc);
+        if (parsed == DDS_OK) parsed = DDSParser::GetLayout(desc, 0, layout);
+        if (parsed != DDS_OK)
+        {
+            result.Error = DDSParser::GetResultName(parsed);
+            return false;
+        }
+
+        //Cube maps, arrays and volumes are left for the tools that made them
+        if (desc.Dimension != DDS_DIMENSION_TEXTURE2D || desc.ArraySize != 1)
+        {
+            result.Error = "only single 2D textures are baked";
+            return false;
+        }
+
+        //The source's own mips are replaced by ones made from its top mip
+        const DDSSubresource& top = layout.Subresources[0];
+        width = top.Width;
+        height = top.Height;
+        if (!ConvertToRGBA(file.GetData() + top.Offset, top.RowPitch, width, height, desc.Format, pixels))
+        {
+            result.Error = DDSParser::IsCompressed(desc.Format) ? "already compressed" : "not 8 bit RGBA or BGRA";
+            return false;
+        }
+
+        //Colour stored as sRGB stays sRGB, BC4 and BC5 have no sRGB form and stay as they are
+        if (DDSParser::IsSRGB(desc.Format)) format = DDSParser::MakeSRGB(format);
+    }
+    file.Close();
+
+    std::vector<uint8_t> output;
+    if (!BakeImage(pixels.data(), width, height, format, settings, jobSystem, output, result)) return false;
+
+    std::ofstream outputFile(result.Output, std::ios::binary);
+    outputFile.write((const char*)output.data(), output.size());
+    if (!outputFile.good())
+    {
+        result.Error = "can't write";
+        return false;
+    }
+
+    return true;
+}
+
+bool TextureBaker::Run(const TextureBakeSettings& settings, JobSystem* jobSystem)
+{
+    CreateDirectories(settings.OutputDirectory);
+
+    std::vector<TextureBakeResult> results;
+    bool succeeded = true;
+    for (const std::string& input : settings.Inputs)
+    {
+        results.emplace_back();
+        succeeded &= BakeFile(input, nullptr, settings, jobSystem, results.back());
+    }
+    for (const RawTextureInput& input : settings.RawInputs)
+    {
+        results.emplace_back();
+        succeeded &= BakeFile(input.Path, &input, settings, jobSystem, results.back());
+    }
+
+    size_t folder = settings.ReportPath.find_last_of("\\/");
+    if (folder != std::string::npos) CreateDirectories(settings.ReportPath.substr(0, folder));
+
+    std::ofstream csv(settings.ReportPath);
+    if (!csv.good()) return false;
+
+    csv << "Input,Output,Format,Width,Height,Mips,Source bytes,Baked bytes,Ratio,Encode ms,PSNR,Error\n";
+    for (const TextureBakeResult& result : results)
+    {
+        csv << result.Input << "," << result.Output << "," << GetFormatName(result.Format) << "," << result.Width << "," << result.Height << ","
+            << result.MipCount << "," << result.SourceBytes << "," << result.BakedBytes << ","
+            << (result.BakedBytes ? (double)result.SourceBytes / result.BakedBytes : 0.0) << "," << result.EncodeMilliseconds << ","
+            << result.PSNR << "," << result.Error << "\n";
+    }
+
+    return succeeded;
+}
+
+const char* TextureBaker::GetFormatName(DDSFormat format)
+{
+    for (const auto& name : formatNames)
+    {
+        if (name.Format == format) return name.Name;
+    }
+    return "";
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "BCEncoder.h"
+#include "DDSParser.h"
+#include "MipGenerator.h"
+
+class JobSystem;
+
+//Textures whose file name (without extension) ends with Suffix are baked to Format
+struct TextureBakeRule
+{
+	std::string Suffix;
+	DDSFormat Format;
+};
+
+//Tightly packed RGBA8 with no header, so the size has to be given
+struct RawTextureInput
+{
+	std::string Path;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	DDSFormat Format = DDS_FORMAT_UNKNOWN; //Unknown goes by the rules like any other file
+};
+
+//What to bake, read from JSON/bakeSettings.json. An empty Inputs list is filled with every .dds under InputDirectory
+struct TextureBakeSettings
+{
+	std::string InputDirectory = "Textures";
+	std::string OutputDirectory = "Textures\\Baked";
+	std::string ReportPath = "Textures\\Baked\\bakeReport.csv";
+	std::vector<std::string> Inputs;
+	std::vector<RawTextureInput> RawInputs;
+	std::vector<TextureBakeRule> Rules;
+	DDSFormat DefaultFormat = DDS_FORMAT_BC7_UNORM;
+	BCQuality Quality = BC_QUALITY_NORMAL;
+	bool GenerateMips = true; //Full chain down to 1x1, otherwise just the top mip
+	MipFilter Filter = MIP_FILTER_KAISER;
+	float AlphaCoverage = 0.0f; //Alpha test value to keep coverage for through the mips, 0 for none
+};
+
+//One line of the report
+struct TextureBakeResult
+{
+	std::string Input;
+	std::string Output;
+	std::string Error; //Empty when the bake worked
+	DDSFormat Format = DDS_FORMAT_UNKNOWN;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t MipCount = 0;
+	size_t SourceBytes = 0;
+	size_t BakedBytes = 0;
+	double EncodeMilliseconds = 0.0; //Mips and compression, not file reads and writes
+	double PSNR = 0.0;               //Top mip decoded again, over the channels the format keeps. Infinite when lossless
+};
+
+//Compresses uncompressed textures to BC1, BC3, BC4, BC5 or BC7 ahead of time, writing DDS files the loader takes
+//as they are. Blocks are encoded across jobSystem when there is one. Run with -bake-textures
+namespace TextureBaker
+{
+	bool LoadSettings(const char* filename, TextureBakeSettings& settings);
+
+	//Every .dds under InputDirectory, sorted, when Inputs is empty. Output files are left out so a rerun doesn't bake them again
+	void FindInputs(TextureBakeSettings& settings);
+
+	//The first rule matching path's file name, or the default
+	DDSFormat GetFormat(const TextureBakeSettings& settings, const std::string& path);
+
+	//width x height tightly packed RGBA8 to a whole DDS file in output
+	bool BakeImage(const uint8_t* pixels, uint32_t width, uint32_t height, DDSFormat format, const TextureBakeSettings& settings,
+		JobSystem* jobSystem, std::vector<uint8_t>& output, TextureBakeResult& result);
+
+	//Reads an uncompressed 2D DDS, or a raw file when raw is given, and writes the baked copy to OutputDirectory
+	bool BakeFile(const std::string& path, const RawTextureInput* raw, const TextureBakeSettings& settings, JobSystem* jobSystem,
+		TextureBakeResult& result);
+
+	//Bakes everything and writes the report, false if any texture failed
+	bool Run(const TextureBakeSettings& settings, JobSystem* jobSystem);
+
+	const char* GetFormatName(DDSFormat format);
+};
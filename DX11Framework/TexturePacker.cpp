@@ -0,0 +1,151 @@
+#include "TexturePacker.h"
+#include <windows.h>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string.h>
+#include "FileUtilities.h"
+#include "MappedFile.h"
+
+#include "JSON\json.hpp"
+using json = nlohmann::json;
+
+bool TexturePacker::LoadSettings(const char* filename, TexturePackSettings& settings)
+{
+    std::ifstream fileOpen(filename);
+    if (!fileOpen.good()) return false;
+
+    json jFile = json::parse(fileOpen, nullptr, false);
+    if (jFile.is_discarded()) return false;
+
+    settings.InputDirectory = jFile.value("InputDirectory", settings.InputDirectory);
+    settings.OutputDirectory = jFile.value("OutputDirectory", settings.OutputDirectory);
+    settings.ManifestPath = jFile.value("Manifest", settings.ManifestPath);
+    settings.MinSlices = jFile.value("MinSlices", settings.MinSlices);
+    settings.AtlasMaxInputSize = jFile.value("AtlasMaxInputSize", settings.AtlasMaxInputSize);
+    settings.AtlasSize = jFile.value("AtlasSize", settings.AtlasSize);
+    settings.AtlasPadding = jFile.value("AtlasPadding", settings.AtlasPadding);
+
+    if (jFile.contains("Inputs")) settings.Inputs = jFile["Inputs"].get<std::vector<std::string>>();
+
+    std::string quality = jFile.value("Quality", std::string("Normal"));
+    if (quality == "Fast") settings.Quality = BC_QUALITY_FAST;
+    else if (quality == "High") settings.Quality = BC_QUALITY_HIGH;
+    else settings.Quality = BC_QUALITY_NORMAL;
+
+    return settings.AtlasSize > 0;
+}
+
+void TexturePacker::FindInputs(TexturePackSettings& settings)
+{
+    if (!settings.Inputs.empty()) return;
+
+    FindFiles(settings.InputDirectory, { ".dds" }, settings.Inputs, settings.OutputDirectory);
+    std::sort(settings.Inputs.begin(), settings.Inputs.end());
+}
+
+bool TexturePacker::Run(const TexturePackSettings& settings, JobSystem* jobSystem)
+{
+    CreateDirectories(settings.OutputDirectory);
+
+    //Every input stays mapped until its pack is written
+    bool succeeded = true;
+    std::vector<std::unique_ptr<MappedFile>> files;
+    std::vector<TexturePackInput> inputs;
+    for (const std::string& path : settings.Inputs)
+    {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+        TexturePackInput input;
+        input.Path = path;
+        if (!file->Open(path.c_str()) || DDSParser::Parse(file->GetData(), file->GetSize(), input.Desc) != DDS_OK)
+        {
+            succeeded = false;
+            continue;
+        }
+
+        input.Data = file->GetData();
+        input.Size = file->GetSize();
+        inputs.push_back(input);
+        files.push_back(std::move(file));
+    }
+
+    TexturePackPlan plan;
+    Plan(inputs, settings, plan);
+
+    json manifest;
+    manifest["Packs"] = json::array();
+    manifest["Textures"] = json::array();
+
+    std::vector<uint8_t> output;
+    for (size_t p = 0; p < plan.Packs.size(); p++)
+    {
+        const TexturePack& pack = plan.Packs[p];
+        bool built = pack.Kind == TEXTURE_PACK_ARRAY ? BuildArray(pack, inputs, output) :
+            BuildAtlas(pack, plan, inputs, settings.Quality, jobSystem, output);
+
+        std::string path = settings.OutputDirectory + "\\pack" + std::to_string(p) + ".dds";
+        if (built)
+        {
+            std::ofstream packFile(path, std::ios::binary);
+            packFile.write((const char*)output.data(), output.size());
+            built = packFile.good();
+        }
+
+        //Textures of a pack that couldn't be made stay out of the manifest, so they still load on their own
+        if (!built)
+        {
+            succeeded = false;
+            continue;
+        }
+
+        manifest["Packs"].push_back({ { "Path", path }, { "Kind", pack.Kind == TEXTURE_PACK_ARRAY ? "Array" : "Atlas" },
+            { "Format", (uint32_t)pack.Format }, { "Width", pack.Width }, { "Height", pack.Height }, { "Mips", pack.MipCount },
+            { "Slices", pack.Slices }, { "Textures", pack.Inputs.size() } });
+
+        for (uint32_t index : pack.Inputs)
+        {
+            const TexturePlacement& placement = plan.Placements[index];
+            const XMFLOAT4& transform = placement.UVTransform;
+            manifest["Textures"].push_back({ { "Source", inputs[index].Path }, { "Pack", path }, { "Slice", placement.Slice },
+                { "UVTransform", { transform.x, transform.y, transform.z, transform.w } } });
+        }
+    }
+
+    size_t folder = settings.ManifestPath.find_last_of("\\/");
+    if (folder != std::string::npos) CreateDirectories(settings.ManifestPath.substr(0, folder));
+
+    std::ofstream manifestFile(settings.ManifestPath);
+    manifestFile << manifest.dump(4);
+    return succeeded && manifestFile.good();
+}
+
+bool TexturePacker::LoadManifest(const char* filename, std::vector<PackedTexture>& textures)
+{
+    textures.clear();
+
+    std::ifstream fileOpen(filename);
+    if (!fileOpen.good()) return false;
+
+    json jFile = json::parse(fileOpen, nullptr, false);
+    if (jFile.is_discarded() || !jFile.contains("Textures")) return false;
+
+    for (const json& texture : jFile["Textures"])
+    {
+        PackedTexture packed;
+        packed.Source = texture.value("Source", std::string());
+        packed.Pack = texture.value("Pack", std::string());
+        packed.Slice = texture.value("Slice", 0u);
+        if (packed.Source.empty() || packed.Pack.empty()) return false;
+
+        if (texture.contains("UVTransform"))
+        {
+            std::vector<float> transform = texture["UVTransform"].get<std::vector<float>>();
+            if (transform.size() != 4) return false;
+            packed.UVTransform = XMFLOAT4(transform[0], transform[1], transform[2], transform[3]);
+        }
+
+        textures.push_back(packed);
+    }
+
+    return true;
+}
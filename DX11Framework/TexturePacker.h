@@ -0,0 +1,112 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "BCEncoder.h"
+#include "DDSParser.h"
+
+using namespace DirectX;
+
+class JobSystem;
+
+enum TexturePackKind
+{
+	TEXTURE_PACK_ARRAY, //Same format, size and mips, each texture a slice copied across as it is
+	TEXTURE_PACK_ATLAS  //Small textures of one format side by side with padded borders, each page a slice
+};
+
+//What to pack, read from JSON/packSettings.json. An empty Inputs list is filled with every .dds under InputDirectory
+struct TexturePackSettings
+{
+	std::string InputDirectory = "Textures";
+	std::string OutputDirectory = "Textures\\Packed";
+	std::string ManifestPath = "Textures\\Packed\\packManifest.json";
+	std::vector<std::string> Inputs;
+	uint32_t MinSlices = 2;                //Fewer textures than this that could share a pack are left on their own
+	uint32_t AtlasMaxInputSize = 256;      //Textures no larger than this both ways go to atlases instead, 0 for no atlases
+	uint32_t AtlasSize = 2048;             //Largest atlas page, pages are cut down to what they use
+	uint32_t AtlasPadding = 8;             //Edge texels repeated round each texture, which also decides how many mips atlases keep
+	BCQuality Quality = BC_QUALITY_NORMAL; //Compressed atlases are decoded, laid out and encoded again
+};
+
+//One texture going in. Planning goes by Desc alone, Data is only read to build
+struct TexturePackInput
+{
+	std::string Path;
+	DDSTextureDesc Desc;
+	const uint8_t* Data = nullptr;
+	size_t Size = 0;
+};
+
+//Where one input ends up
+struct TexturePlacement
+{
+	int Pack = -1; //-1 when it is left on its own
+	uint32_t Slice = 0;
+	uint32_t X = 0; //Texels from the page's corner to the texture's, inside its padding
+	uint32_t Y = 0;
+	XMFLOAT4 UVTransform = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f); //xy scale and zw offset from the texture's own coordinates to the slice's
+};
+
+struct TexturePack
+{
+	TexturePackKind Kind = TEXTURE_PACK_ARRAY;
+	DDSFormat Format = DDS_FORMAT_UNKNOWN;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t MipCount = 0;
+	uint32_t Slices = 0;
+	uint32_t Padding = 0;         //Atlases, the setting rounded up to Alignment
+	uint32_t Alignment = 1;       //Atlases, every texture's padded corner and size are a multiple of this
+	std::vector<uint32_t> Inputs; //Input indices, in slice order for arrays
+	size_t UsedTexels = 0;        //Atlases, texels covered by textures and their padding
+};
+
+struct TexturePackPlan
+{
+	std::vector<TexturePack> Packs;
+	std::vector<TexturePlacement> Placements; //One per input, in the same order
+};
+
+//A packed texture read back from a manifest, so whatever asks for Source can be given its slice of Pack instead
+struct PackedTexture
+{
+	std::string Source;
+	std::string Pack;
+	uint32_t Slice = 0;
+	XMFLOAT4 UVTransform = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f);
+};
+
+//Groups textures so objects using different ones can share one binding: textures with the same format, size and
+//mips become slices of a Texture2DArray, and small ones are laid out on atlas pages with padded borders, the pages
+//becoming slices in turn. Objects then pick a slice and remap their texture coordinates in the shader. Planning and
+//building need no device or file system and live in TexturePacking.cpp, which builds on any platform. Finding inputs,
+//reading settings and writing the packs out are Windows only. Run with -pack-textures
+namespace TexturePacker
+{
+	bool LoadSettings(const char* filename, TexturePackSettings& settings);
+
+	//Every .dds under InputDirectory, sorted, when Inputs is empty. Output files are left out so a rerun doesn't pack them again
+	void FindInputs(TexturePackSettings& settings);
+
+	//Only single 2D textures are packed, atlases also need a format that can be decoded and written again
+	bool CanArray(const DDSTextureDesc& desc);
+	bool CanAtlas(const DDSTextureDesc& desc);
+
+	//Packs and placements from the inputs' headers, the same inputs always give the same plan
+	void Plan(const std::vector<TexturePackInput>& inputs, const TexturePackSettings& settings, TexturePackPlan& plan);
+
+	//A whole DDS file for one planned pack. Arrays copy each texture's bytes, atlases are laid out as RGBA8, given box
+	//filtered mips and encoded back to the pack's format, with blocks shared out over jobSystem when there is one
+	bool BuildArray(const TexturePack& pack, const std::vector<TexturePackInput>& inputs, std::vector<uint8_t>& output);
+	bool BuildAtlas(const TexturePack& pack, const TexturePackPlan& plan, const std::vector<TexturePackInput>& inputs, BCQuality quality,
+		JobSystem* jobSystem, std::vector<uint8_t>& output);
+
+	//Packs every input, writing the packs to OutputDirectory and where each input went to ManifestPath.
+	//False if anything couldn't be read or written
+	bool Run(const TexturePackSettings& settings, JobSystem* jobSystem);
+
+	bool LoadManifest(const char* filename, std::vector<PackedTexture>& textures);
+};
@@ -0,0 +1,382 @@
+#include "TexturePacker.h"
+#include "BCDecoder.h"
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <map>
+#include <string.h>
+#include <tuple>
+
+//D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION, without needing the D3D headers to plan
+static const uint32_t MAX_ARRAY_SLICES = 2048;
+
+static uint32_t RoundUp(uint32_t value, uint32_t multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+//8 bit layouts that can be laid out and filtered byte for byte, whichever order the channels are in
+static bool IsRGBA8(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_R8G8B8A8_TYPELESS:
+    case DDS_FORMAT_R8G8B8A8_UNORM:
+    case DDS_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DDS_FORMAT_B8G8R8A8_TYPELESS:
+    case DDS_FORMAT_B8G8R8A8_UNORM:
+    case DDS_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DDS_FORMAT_B8G8R8X8_TYPELESS:
+    case DDS_FORMAT_B8G8R8X8_UNORM:
+    case DDS_FORMAT_B8G8R8X8_UNORM_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//Atlases keep 1 + log2(padding) mips, as many as still have a texel of padding round every texture
+static uint32_t GetAtlasMipCount(uint32_t padding)
+{
+    uint32_t mipCount = 1;
+    while ((2u << (mipCount - 1)) <= padding) mipCount++;
+    return mipCount;
+}
+
+//Every texture's corner and padded size are a multiple of this, so each mip's 2x2 box never reaches into a neighbour
+//and compressed blocks never straddle two textures
+static uint32_t GetAtlasAlignment(DDSFormat format, uint32_t mipCount)
+{
+    return std::max(DDSParser::IsCompressed(format) ? 4u : 1u, 1u << (mipCount - 1));
+}
+
+//Texture plus padding on both sides, out to the alignment
+static void GetPaddedSize(const DDSTextureDesc& desc, uint32_t padding, uint32_t alignment, uint32_t& width, uint32_t& height)
+{
+    width = RoundUp(desc.Width + padding * 2, alignment);
+    height = RoundUp(desc.Height + padding * 2, alignment);
+}
+
+//Cuts every page down to the largest one's extent, which the alignment keeps a multiple of what the mips need, and
+//gives each texture its UVs on it. A pack with too few textures to be worth it leaves them on their own again
+static void FinishAtlas(TexturePack& pack, uint32_t slices, const std::vector<TexturePackInput>& inputs, const TexturePackSettings& settings,
+    TexturePackPlan& plan)
+{
+    if (pack.Inputs.size() < std::max(settings.MinSlices, 2u))
+    {
+        for (uint32_t index : pack.Inputs) plan.Placements[index] = TexturePlacement();
+        return;
+    }
+
+    pack.Slices = slices;
+    pack.MipCount = std::min(pack.MipCount, MipGenerator::GetMipCount(pack.Width, pack.Height));
+    for (uint32_t index : pack.Inputs)
+    {
+        TexturePlacement& placement = plan.Placements[index];
+        const DDSTextureDesc& desc = inputs[index].Desc;
+        placement.UVTransform = XMFLOAT4((float)desc.Width / pack.Width, (float)desc.Height / pack.Height,
+            (float)placement.X / pack.Width, (float)placement.Y / pack.Height);
+    }
+
+    plan.Packs.push_back(pack);
+}
+
+//Lays out one format's small textures on shelves, tallest first, starting a page whenever one fills and another
+//pack whenever the pages reach the most slices an array can have
+static void PlanAtlas(DDSFormat format, const std::vector<uint32_t>& candidates, const std::vector<TexturePackInput>& inputs,
+    const TexturePackSettings& settings, TexturePackPlan& plan)
+{
+    TexturePack empty;
+    empty.Kind = TEXTURE_PACK_ATLAS;
+    empty.Format = format;
+    empty.MipCount = GetAtlasMipCount(settings.AtlasPadding);
+
+    uint32_t alignment = GetAtlasAlignment(format, empty.MipCount);
+    uint32_t pageSize = settings.AtlasSize / alignment * alignment;
+    empty.Padding = RoundUp(settings.AtlasPadding, alignment);
+    empty.Alignment = alignment;
+
+    std::vector<uint32_t> order;
+    for (uint32_t index : candidates)
+    {
+        uint32_t width, height;
+        GetPaddedSize(inputs[index].Desc, empty.Padding, alignment, width, height);
+        if (width <= pageSize && height <= pageSize) order.push_back(index);
+    }
+    if (order.size() < std::max(settings.MinSlices, 2u)) return;
+
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+    {
+        const DDSTextureDesc& descA = inputs[a].Desc;
+        const DDSTextureDesc& descB = inputs[b].Desc;
+        return descA.Height != descB.Height ? descA.Height > descB.Height : descA.Width > descB.Width;
+    });
+
+    TexturePack pack = empty;
+    uint32_t page = 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t shelfHeight = 0;
+    for (uint32_t index : order)
+    {
+        uint32_t width, height;
+        GetPaddedSize(inputs[index].Desc, pack.Padding, alignment, width, height);
+
+        if (x + width > pageSize)
+        {
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        if (y + height > pageSize)
+        {
+            page++;
+            x = y = shelfHeight = 0;
+        }
+        if (page == MAX_ARRAY_SLICES)
+        {
+            FinishAtlas(pack, page, inputs, settings, plan);
+            pack = empty;
+            page = 0;
+        }
+
+        TexturePlacement& placement = plan.Placements[index];
+        placement.Pack = (int)plan.Packs.size();
+        placement.Slice = page;
+        placement.X = x + pack.Padding;
+        placement.Y = y + pack.Padding;
+
+        pack.Inputs.push_back(index);
+        pack.UsedTexels += (size_t)width * height;
+        pack.Width = std::max(pack.Width, x + width);
+        pack.Height = std::max(pack.Height, y + height);
+
+        x += width;
+        shelfHeight = std::max(shelfHeight, height);
+    }
+
+    FinishAtlas(pack, page + 1, inputs, settings, plan);
+}
+
+//Texture plus padding repeating its edges, with (x, y) the padding's corner on the page
+static void CopyPadded(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t padding, uint32_t paddedWidth, uint32_t paddedHeight,
+    uint8_t* page, uint32_t pageWidth, uint32_t x, uint32_t y)
+{
+    for (uint32_t row = 0; row < paddedHeight; row++)
+    {
+        uint32_t sourceRow = (uint32_t)std::min(std::max((int)row - (int)padding, 0), (int)height - 1);
+        const uint8_t* source = pixels + (size_t)sourceRow * width * 4;
+        uint8_t* destination = page + ((size_t)(y + row) * pageWidth + x) * 4;
+
+        for (uint32_t column = 0; column < padding; column++) memcpy(destination + column * 4, source, 4);
+        memcpy(destination + padding * 4, source, (size_t)width * 4);
+        for (uint32_t column = padding + width; column < paddedWidth; column++) memcpy(destination + column * 4, source + (width - 1) * 4, 4);
+    }
+}
+
+//The input's top mip, tightly packed. Compressed inputs come out as RGBA8, the rest keep their own channel order
+static bool GetTopMip(const TexturePackInput& input, std::vector<uint8_t>& pixels, JobSystem* jobSystem)
+{
+    DDSLayout layout;
+    if (!input.Data || DDSParser::GetLayout(input.Desc, 0, layout) != DDS_OK) return false;
+
+    const DDSSubresource& top = layout.Subresources[0];
+    if (top.Offset + top.Size > input.Size) return false;
+
+    if (DDSParser::IsCompressed(input.Desc.Format)) return BCDecoder::DecodeSubresource(input.Data, input.Desc, top, pixels, jobSystem);
+
+    size_t rowBytes = (size_t)top.Width * 4;
+    pixels.resize(rowBytes * top.Height);
+    for (uint32_t y = 0; y < top.Height; y++)
+    {
+        memcpy(pixels.data() + y * rowBytes, input.Data + top.Offset + y * top.RowPitch, rowBytes);
+    }
+    return true;
+}
+
+bool TexturePacker::CanArray(const DDSTextureDesc& desc)
+{
+    return desc.Dimension == DDS_DIMENSION_TEXTURE2D && desc.ArraySize == 1 && !desc.IsCubeMap && desc.MipCount > 0;
+}
+
+bool TexturePacker::CanAtlas(const DDSTextureDesc& desc)
+{
+    if (!CanArray(desc)) return false;
+    if (IsRGBA8(desc.Format)) return true;
+    return BCDecoder::IsSupported(desc.Format) && BCEncoder::IsSupported(desc.Format);
+}
+
+void TexturePacker::Plan(const std::vector<TexturePackInput>& inputs, const TexturePackSettings& settings, TexturePackPlan& plan)
+{
+    plan.Packs.clear();
+    plan.Placements.assign(inputs.size(), TexturePlacement());
+
+    //Ordered maps so the plan only depends on the inputs, never on hashing
+    std::map<DDSFormat, std::vector<uint32_t>> atlasGroups;
+    for (uint32_t i = 0; i < (uint32_t)inputs.size(); i++)
+    {
+        const DDSTextureDesc& desc = inputs[i].Desc;
+        if (CanAtlas(desc) && desc.Width <= settings.AtlasMaxInputSize && desc.Height <= settings.AtlasMaxInputSize)
+        {
+            atlasGroups[desc.Format].push_back(i);
+        }
+    }
+
+    for (const auto& group : atlasGroups)
+    {
+        PlanAtlas(group.first, group.second, inputs, settings, plan);
+    }
+
+    //Whatever no atlas took, including small textures whose atlas would have been too empty to be worth it
+    std::map<std::tuple<DDSFormat, uint32_t, uint32_t, uint32_t>, std::vector<uint32_t>> arrayGroups;
+    for (uint32_t i = 0; i < (uint32_t)inputs.size(); i++)
+    {
+        const DDSTextureDesc& desc = inputs[i].Desc;
+        if (plan.Placements[i].Pack < 0 && CanArray(desc))
+        {
+            arrayGroups[std::make_tuple(desc.Format, desc.Width, desc.Height, desc.MipCount)].push_back(i);
+        }
+    }
+
+    for (const auto& group : arrayGroups)
+    {
+        const std::vector<uint32_t>& members = group.second;
+        for (size_t start = 0; start < members.size(); start += MAX_ARRAY_SLICES)
+        {
+            size_t count = std::min(members.size() - start, (size_t)MAX_ARRAY_SLICES);
+            if (count < std::max(settings.MinSlices, 2u)) break;
+
+            TexturePack pack;
+            pack.Kind = TEXTURE_PACK_ARRAY;
+            pack.Format = std::get<0>(group.first);
+            pack.Width = std::get<1>(group.first);
+            pack.Height = std::get<2>(group.first);
+            pack.MipCount = std::get<3>(group.first);
+            pack.Slices = (uint32_t)count;
+            pack.UsedTexels = (size_t)pack.Width * pack.Height * count;
+
+            for (size_t slice = 0; slice < count; slice++)
+            {
+                uint32_t index = members[start + slice];
+                plan.Placements[index].Pack = (int)plan.Packs.size();
+                plan.Placements[index].Slice = (uint32_t)slice;
+                pack.Inputs.push_back(index);
+            }
+
+            plan.Packs.push_back(pack);
+        }
+    }
+}
+
+bool TexturePacker::BuildArray(const TexturePack& pack, const std::vector<TexturePackInput>& inputs, std::vector<uint8_t>& output)
+{
+    output.clear();
+    if (pack.Kind != TEXTURE_PACK_ARRAY || pack.Inputs.empty()) return false;
+
+    DDSTextureDesc desc = inputs[pack.Inputs[0]].Desc;
+    desc.ArraySize = pack.Slices;
+    DDSParser::WriteHeader(desc, output);
+
+    //Every slice has the same layout, so each texture's subresources go across in the order D3D numbers them
+    for (uint32_t index : pack.Inputs)
+    {
+        const TexturePackInput& input = inputs[index];
+        const DDSTextureDesc& inputDesc = input.Desc;
+        if (!input.Data || !CanArray(inputDesc) || inputDesc.Format != pack.Format || inputDesc.Width != pack.Width ||
+            inputDesc.Height != pack.Height || inputDesc.MipCount != pack.MipCount)
+        {
+            return false;
+        }
+
+        DDSLayout layout;
+        if (DDSParser::GetLayout(inputDesc, 0, layout) != DDS_OK) return false;
+
+        for (const DDSSubresource& subresource : layout.Subresources)
+        {
+            if (subresource.Offset + subresource.Size > input.Size) return false;
+            output.insert(output.end(), input.Data + subresource.Offset, input.Data + subresource.Offset + subresource.Size);
+        }
+    }
+
+    return true;
+}
+
+bool TexturePacker::BuildAtlas(const TexturePack& pack, const TexturePackPlan& plan, const std::vector<TexturePackInput>& inputs, BCQuality quality,
+    JobSystem* jobSystem, std::vector<uint8_t>& output)
+{
+    output.clear();
+    if (pack.Kind != TEXTURE_PACK_ATLAS || pack.Inputs.empty() || pack.Width == 0 || pack.Height == 0) return false;
+    if (pack.Alignment == 0 || pack.Width % pack.Alignment != 0 || pack.Height % pack.Alignment != 0) return false;
+
+    bool compressed = DDSParser::IsCompressed(pack.Format);
+    if (compressed ? !BCEncoder::IsSupported(pack.Format) : !IsRGBA8(pack.Format)) return false;
+
+    DDSTextureDesc desc;
+    desc.Dimension = DDS_DIMENSION_TEXTURE2D;
+    desc.Format = pack.Format;
+    desc.Width = pack.Width;
+    desc.Height = pack.Height;
+    desc.Depth = 1;
+    desc.MipCount = pack.MipCount;
+    desc.ArraySize = pack.Slices;
+    desc.AlphaMode = inputs[pack.Inputs[0]].Desc.AlphaMode;
+    DDSParser::WriteHeader(desc, output);
+
+    //Box filtering with every texture aligned to the mip count keeps each mip's texels from its own texture alone
+    MipSettings mipSettings;
+    mipSettings.Filter = MIP_FILTER_BOX;
+    mipSettings.SRGB = DDSParser::IsSRGB(pack.Format);
+    mipSettings.Wrap = false;
+
+    std::vector<uint8_t> page((size_t)pack.Width * pack.Height * 4);
+    std::vector<uint8_t> pixels;
+    std::vector<std::vector<uint8_t>> mips;
+
+    for (uint32_t slice = 0; slice < pack.Slices; slice++)
+    {
+        std::fill(page.begin(), page.end(), 0);
+
+        for (uint32_t index : pack.Inputs)
+        {
+            const TexturePlacement& placement = plan.Placements[index];
+            if (placement.Slice != slice) continue;
+
+            const DDSTextureDesc& inputDesc = inputs[index].Desc;
+            if (inputDesc.Format != pack.Format || !GetTopMip(inputs[index], pixels, jobSystem)) return false;
+
+            uint32_t paddedWidth, paddedHeight;
+            GetPaddedSize(inputDesc, pack.Padding, pack.Alignment, paddedWidth, paddedHeight);
+            if (placement.X < pack.Padding || placement.Y < pack.Padding || placement.X - pack.Padding + paddedWidth > pack.Width ||
+                placement.Y - pack.Padding + paddedHeight > pack.Height)
+            {
+                return false;
+            }
+
+            CopyPadded(pixels.data(), inputDesc.Width, inputDesc.Height, pack.Padding, paddedWidth, paddedHeight,
+                page.data(), pack.Width, placement.X - pack.Padding, placement.Y - pack.Padding);
+        }
+
+        MipGenerator::Generate(page.data(), (size_t)pack.Width * 4, pack.Width, pack.Height, pack.MipCount, mipSettings, mips, jobSystem);
+
+        for (uint32_t level = 0; level < pack.MipCount; level++)
+        {
+            uint32_t mipWidth = std::max(pack.Width >> level, 1u);
+            uint32_t mipHeight = std::max(pack.Height >> level, 1u);
+            if (!compressed)
+            {
+                output.insert(output.end(), mips[level].begin(), mips[level].end());
+                continue;
+            }
+
+            size_t numBytes = 0;
+            size_t rowBytes = 0;
+            DDSParser::GetSurfaceInfo(mipWidth, mipHeight, pack.Format, &numBytes, &rowBytes, nullptr);
+
+            size_t offset = output.size();
+            output.resize(offset + numBytes);
+            BCEncoder::Encode(pack.Format, mips[level].data(), (size_t)mipWidth * 4, mipWidth, mipHeight, output.data() + offset, rowBytes, quality, jobSystem);
+        }
+    }
+
+    return true;
+}
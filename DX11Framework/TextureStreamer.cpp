@@ -0,0 +1,210 @@
+#include "TextureStreamer.h"
+#include "DDSParser.h"
+#include "DDSTextureLoader.h"
+
+#include <algorithm>
+
+//How many mips the view sees, counting from the smallest
+static uint32_t GetMipLevels(ID3D11ShaderResourceView* texture)
+{
+    D3D11_SHADER_RESOURCE_VIEW_DESC desc;
+    texture->GetDesc(&desc);
+
+    switch (desc.ViewDimension)
+    {
+    case D3D11_SRV_DIMENSION_TEXTURE1D: return desc.Texture1D.MipLevels;
+    case D3D11_SRV_DIMENSION_TEXTURE1DARRAY: return desc.Texture1DArray.MipLevels;
+    case D3D11_SRV_DIMENSION_TEXTURE2D: return desc.Texture2D.MipLevels;
+    case D3D11_SRV_DIMENSION_TEXTURE2DARRAY: return desc.Texture2DArray.MipLevels;
+    case D3D11_SRV_DIMENSION_TEXTURECUBE: return desc.TextureCube.MipLevels;
+    case D3D11_SRV_DIMENSION_TEXTURECUBEARRAY: return desc.TextureCubeArray.MipLevels;
+    case D3D11_SRV_DIMENSION_TEXTURE3D: return desc.Texture3D.MipLevels;
+    default: return 0;
+    }
+}
+
+void TextureStreamer::Initialise(ID3D11Device* device, JobSystem* jobSystem, AssetCache* cache, const TextureStreamingSettings& settings)
+{
+    _device = device;
+    _jobSystem = jobSystem;
+    _cache = cache;
+    _policy.Initialise(settings);
+}
+
+void TextureStreamer::Register(AssetHandle handle, ID3D11ShaderResourceView* texture)
+{
+    if (!IsEnabled() || !texture || _lookup.find(texture) != _lookup.end()) return;
+
+    //A handle sharing by content can go while its owner stays, so the owner is the one kept
+    AssetHandle owner = _cache->GetOwner(handle);
+    if (!owner.IsValid()) return;
+
+    std::unique_ptr<Stream> stream(new Stream());
+    if (!stream->File.Open(_archive, _cache->GetPath(owner))) return;
+
+    DDSTextureDesc desc;
+    DDSLayout layout;
+    if (DDSParser::Parse(stream->File.GetData(), stream->File.GetSize(), desc) != DDS_OK) return;
+    if (DDSParser::GetLayout(desc, 0, layout) != DDS_OK || layout.MipCount == 0) return;
+
+    //Subresources are item by item, every item's share of a mip counts towards it
+    std::vector<size_t> mipBytes(layout.MipCount);
+    for (size_t i = 0; i < layout.Subresources.size(); i++)
+    {
+        mipBytes[i % layout.MipCount] += layout.Subresources[i].Size;
+    }
+
+    uint32_t tailMip = TextureStreamingPolicy::GetTailMip(layout.Width, layout.Height, layout.MipCount, _policy.GetSettings().TailSize);
+    if (tailMip == 0) return;
+
+    //Whatever the loader actually kept, in case it fell back to more or fewer mips than it was asked for
+    uint32_t levels = GetMipLevels(texture);
+    uint32_t residentMip = levels == 0 || levels >= layout.MipCount ? 0 : layout.MipCount - levels;
+
+    stream->Owner = owner;
+    stream->Width = layout.Width;
+    stream->Height = layout.Height;
+    stream->Depth = layout.Depth;
+    stream->Texture = texture;
+    stream->PolicyId = _policy.Add(layout.Width, layout.Height, mipBytes, residentMip);
+
+    _lookup[texture] = stream.get();
+    _streams.push_back(std::move(stream));
+}
+
+void TextureStreamer::AddUse(ID3D11ShaderResourceView* texture, float projectedPixels)
+{
+    if (projectedPixels <= 0.0f) return;
+
+    auto found = _lookup.find(texture);
+    if (found != _lookup.end()) _policy.AddUse(found->second->PolicyId, projectedPixels);
+}
+
+void TextureStreamer::StreamMips(Stream* stream, uint32_t mip)
+{
+    //The loader's size limit takes off the mips above this one, the same way the tail was made
+    size_t maxSize = std::max({ stream->Width >> mip, stream->Height >> mip, stream->Depth >> mip, 1u });
+
+    ID3D11ShaderResourceView* texture = nullptr;
+    stream->Succeeded = SUCCEEDED(DirectX::CreateDDSTextureFromMemory(_device, stream->File.GetData(), stream->File.GetSize(), nullptr, &texture, maxSize));
+    stream->Result = texture;
+
+    std::lock_guard<std::mutex> lock(_finishedMutex);
+    _finished.push_back(stream);
+}
+
+void TextureStreamer::RemoveStreams()
+{
+    //Only once nothing is in flight for them, a job may still be reading the file
+    _streams.erase(std::remove_if(_streams.begin(), _streams.end(), [](const std::unique_ptr<Stream>& stream)
+    {
+        return stream->Removed && !stream->InFlight;
+    }), _streams.end());
+}
+
+void TextureStreamer::Update(uint64_t frameIndex, std::vector<TextureSwap>& swaps)
+{
+    swaps.clear();
+    if (!IsEnabled()) return;
+
+    //Entries only go on the main thread, so one found stale here can't come back
+    for (auto& stream : _streams)
+    {
+        if (stream->Removed || _cache->GetState(stream->Owner) == ASSET_LOADED) continue;
+
+        stream->Removed = true;
+        _lookup.erase(stream->Texture);
+        _policy.Remove(stream->PolicyId);
+    }
+
+    std::vector<Stream*> finished;
+    {
+        std::lock_guard<std::mutex> lock(_finishedMutex);
+        finished.swap(_finished);
+    }
+
+    for (Stream* stream : finished)
+    {
+        stream->InFlight = false;
+
+        ID3D11ShaderResourceView* previous = nullptr;
+        bool swapped = !stream->Removed && stream->Succeeded && _cache->ReplaceTexture(stream->Owner, stream->Result, &previous);
+        if (swapped)
+        {
+            _lookup.erase(stream->Texture);
+            _lookup[stream->Result] = stream;
+            stream->Texture = stream->Result;
+
+            _retired.push_back(std::make_pair(frameIndex, previous));
+            swaps.push_back({ previous, stream->Texture });
+        }
+        else if (stream->Result)
+        {
+            stream->Result->Release();
+        }
+
+        stream->Result = nullptr;
+        _policy.Complete(stream->PolicyId, swapped, frameIndex);
+    }
+
+    RemoveStreams();
+
+    _policy.ChooseTargets();
+    _policy.GetRequests(_requests);
+    if (_requests.empty()) return;
+
+    std::vector<Stream*> byPolicyId(_policy.GetTextureCount(), nullptr);
+    for (auto& stream : _streams)
+    {
+        if (!stream->Removed) byPolicyId[stream->PolicyId] = stream.get();
+    }
+
+    for (const TextureStreamRequest& request : _requests)
+    {
+        Stream* stream = byPolicyId[request.Texture];
+        uint32_t mip = request.Mip;
+        stream->InFlight = true;
+        _jobSystem->Run([this, stream, mip]() { StreamMips(stream, mip); }, &_pending);
+    }
+}
+
+void TextureStreamer::ReleaseRetired(uint64_t beforeFrame)
+{
+    _policy.ReleaseRetired(beforeFrame);
+
+    size_t kept = 0;
+    for (auto& retired : _retired)
+    {
+        if (retired.first < beforeFrame) retired.second->Release();
+        else _retired[kept++] = retired;
+    }
+    _retired.resize(kept);
+}
+
+bool TextureStreamer::IsIdle()
+{
+    //Jobs add to the finished list before their counter drops, so checking in this order can't miss one
+    if (!_pending.IsDone()) return false;
+
+    std::lock_guard<std::mutex> lock(_finishedMutex);
+    return _finished.empty();
+}
+
+void TextureStreamer::Release()
+{
+    if (_jobSystem)
+    {
+        _jobSystem->Wait(&_pending);
+    }
+
+    //Finished but never swapped in, nothing else has these
+    for (Stream* stream : _finished)
+    {
+        if (stream->Result) stream->Result->Release();
+    }
+    _finished.clear();
+
+    ReleaseRetired(~0ull);
+    _streams.clear();
+    _lookup.clear();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <d3d11_4.h>
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "AssetArchive.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+#include "TextureStreaming.h"
+
+//A streamed texture that was swapped for a copy with different mips, objects pointing at Previous should point at Current
+struct TextureSwap
+{
+	ID3D11ShaderResourceView* Previous;
+	ID3D11ShaderResourceView* Current;
+};
+
+//Streams mips of loaded DDS textures in and out under TextureStreamingPolicy. Textures load with just their tail
+//(see AssetLoader::SetTextureMaxSize) and each one's file stays mapped, so when the policy wants a different set of
+//mips a job makes a new texture with them from the file and it replaces the old one in the cache between frames.
+//Everything but the jobs is main thread only
+class TextureStreamer
+{
+private:
+	struct Stream
+	{
+		AssetHandle Owner; //Cache entry holding the texture
+		uint32_t PolicyId = 0;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t Depth = 0;
+		ID3D11ShaderResourceView* Texture = nullptr;
+		AssetFile File;
+		bool InFlight = false;
+		bool Removed = false;
+
+		//Written by the job, read once it is on the finished list
+		ID3D11ShaderResourceView* Result = nullptr;
+		bool Succeeded = false;
+	};
+
+	ID3D11Device* _device = nullptr;
+	JobSystem* _jobSystem = nullptr;
+	AssetCache* _cache = nullptr;
+	const AssetArchive* _archive = nullptr;
+	TextureStreamingPolicy _policy;
+
+	//unique_ptr so a job's pointer stays put as streams come and go
+	std::vector<std::unique_ptr<Stream>> _streams;
+	std::unordered_map<ID3D11ShaderResourceView*, Stream*> _lookup;
+	std::vector<TextureStreamRequest> _requests;
+
+	std::mutex _finishedMutex;
+	std::vector<Stream*> _finished;
+	JobCounter _pending;
+
+	//Textures streams replaced, with the frame they went. The snapshot being drawn can still use them
+	std::vector<std::pair<uint64_t, ID3D11ShaderResourceView*>> _retired;
+
+	void StreamMips(Stream* stream, uint32_t mip);
+	void RemoveStreams();
+
+public:
+	TextureStreamer() = default;
+	~TextureStreamer() { Release(); }
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	void Initialise(ID3D11Device* device, JobSystem* jobSystem, AssetCache* cache, const TextureStreamingSettings& settings);
+	bool IsEnabled() { return _device != nullptr && _policy.GetSettings().Enabled; }
+
+	//Textures the archive has are streamed from it, the same as AssetLoader::SetArchive. A compressed one is inflated
+	//once on Register and that copy kept for as long as it streams
+	void SetArchive(const AssetArchive* archive) { _archive = archive; }
+
+	//What AssetLoader should limit textures to before they are registered here
+	size_t GetTailSize() { return IsEnabled() ? _policy.GetSettings().TailSize : 0; }
+
+	//Takes over streaming for a texture asset that just finished loading. Textures with nothing above their tail,
+	//or that were registered already through another handle, are left as they are
+	void Register(AssetHandle handle, ID3D11ShaderResourceView* texture);
+
+	//Every draw of a texture this frame with how big its object is on screen, see TextureStreamingPolicy::GetProjectedPixels
+	void BeginFrame() { _policy.BeginFrame(); }
+	void AddUse(ID3D11ShaderResourceView* texture, float projectedPixels);
+
+	//Swaps in finished streams, listing each in swaps so objects can be pointed at the new texture, drops textures
+	//whose cache entry has gone and starts streams for what the policy wants next
+	void Update(uint64_t frameIndex, std::vector<TextureSwap>& swaps);
+
+	//Lets go of replaced textures from before beforeFrame
+	void ReleaseRetired(uint64_t beforeFrame);
+
+	//True when no stream is in flight or waiting to be swapped in
+	bool IsIdle();
+
+	size_t GetStreamCount() { return _streams.size(); }
+	size_t GetResidentBytes() { return _policy.GetResidentBytes(); }
+	size_t GetCommittedBytes() { return _policy.GetCommittedBytes(); }
+
+	//Waits for streams in flight and lets go of every texture still held, the cache keeps the ones it has
+	void Release();
+};
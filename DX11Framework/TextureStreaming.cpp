@@ -0,0 +1,258 @@
+#include "TextureStreaming.h"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+float TextureStreamingPolicy::GetProjectedPixels(const XMFLOAT4& bounds, const XMFLOAT3& eye, const XMFLOAT3& forward, float projectionScale)
+{
+    float x = bounds.x - eye.x;
+    float y = bounds.y - eye.y;
+    float z = bounds.z - eye.z;
+    if (bounds.w <= 0.0f || x * forward.x + y * forward.y + z * forward.z < -bounds.w) return 0.0f;
+
+    //From inside the sphere it is treated as touching the camera, about a screen high
+    float distance = std::max(sqrtf(x * x + y * y + z * z), bounds.w);
+    return 2.0f * bounds.w * projectionScale / distance;
+}
+
+float TextureStreamingPolicy::GetDesiredMip(uint32_t width, uint32_t height, float projectedPixels, float bias)
+{
+    if (projectedPixels <= 0.0f) return FLT_MAX;
+    return std::max(log2f((float)std::max(width, height) / projectedPixels) + bias, 0.0f);
+}
+
+uint32_t TextureStreamingPolicy::GetTailMip(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t tailSize)
+{
+    for (uint32_t mip = 0; mip < mipCount; mip++)
+    {
+        if (std::max(width >> mip, 1u) <= tailSize && std::max(height >> mip, 1u) <= tailSize) return mip;
+    }
+    return mipCount > 0 ? mipCount - 1 : 0;
+}
+
+size_t TextureStreamingPolicy::GetBytes(const StreamedTexture& texture, uint32_t mip)
+{
+    size_t bytes = 0;
+    for (size_t m = mip; m < texture.MipBytes.size(); m++) bytes += texture.MipBytes[m];
+    return bytes;
+}
+
+uint32_t TextureStreamingPolicy::Add(uint32_t width, uint32_t height, const std::vector<size_t>& mipBytes, uint32_t residentMip)
+{
+    uint32_t id = (uint32_t)_textures.size();
+    if (!_free.empty())
+    {
+        id = _free.back();
+        _free.pop_back();
+    }
+    else
+    {
+        _textures.emplace_back();
+    }
+
+    StreamedTexture& texture = _textures[id];
+    texture = StreamedTexture();
+    texture.Width = width;
+    texture.Height = height;
+    texture.MipBytes = mipBytes;
+    texture.TailMip = GetTailMip(width, height, (uint32_t)mipBytes.size(), _settings.TailSize);
+    texture.ResidentMip = std::min(residentMip, texture.TailMip);
+    texture.TargetMip = texture.ResidentMip;
+    texture.DesiredMip = FLT_MAX;
+    texture.Live = true;
+    return id;
+}
+
+void TextureStreamingPolicy::Remove(uint32_t texture)
+{
+    StreamedTexture& removed = _textures[texture];
+    if (!removed.Live) return;
+
+    removed.Live = false;
+    if (removed.PendingMip == STREAM_NO_MIP) _free.push_back(texture);
+}
+
+void TextureStreamingPolicy::BeginFrame()
+{
+    for (StreamedTexture& texture : _textures)
+    {
+        texture.DesiredMip = FLT_MAX;
+        texture.ProjectedPixels = 0.0f;
+    }
+}
+
+void TextureStreamingPolicy::AddUse(uint32_t texture, float projectedPixels)
+{
+    //Whichever use is largest on screen decides, the rest would be happy with less
+    StreamedTexture& used = _textures[texture];
+    if (projectedPixels <= used.ProjectedPixels) return;
+
+    used.ProjectedPixels = projectedPixels;
+    used.DesiredMip = GetDesiredMip(used.Width, used.Height, projectedPixels, _settings.MipBias);
+}
+
+void TextureStreamingPolicy::ChooseTargets()
+{
+    //Dropping mip m of a texture leaves it (m + 1 - desired) mips short of what it wants, the budget takes the
+    //smallest of those first. They only grow with m for one texture, so sorting them all keeps each texture's in order
+    struct BudgetStep
+    {
+        float Cost;
+        size_t Bytes;
+        uint32_t Texture;
+    };
+    std::vector<BudgetStep> steps;
+    size_t total = 0;
+
+    for (uint32_t i = 0; i < (uint32_t)_textures.size(); i++)
+    {
+        StreamedTexture& texture = _textures[i];
+        if (!texture.Live) continue;
+
+        if (texture.Failed)
+        {
+            texture.TargetMip = texture.ResidentMip;
+            total += GetBytes(texture, texture.ResidentMip);
+            continue;
+        }
+
+        float desired = std::min(texture.DesiredMip, (float)texture.TailMip);
+        uint32_t target = (uint32_t)desired;
+
+        //A mip just past what is wanted stays, so standing at a boundary doesn't stream the same mip in and out
+        if (texture.ResidentMip < target && desired < texture.ResidentMip + 1.0f + _settings.Hysteresis)
+        {
+            target = texture.ResidentMip;
+        }
+
+        texture.TargetMip = target;
+        total += GetBytes(texture, target);
+        for (uint32_t mip = target; mip < texture.TailMip; mip++)
+        {
+            steps.push_back({ mip + 1.0f - desired, texture.MipBytes[mip], i });
+        }
+    }
+
+    if (total <= _settings.BudgetBytes) return;
+
+    std::sort(steps.begin(), steps.end(), [](const BudgetStep& a, const BudgetStep& b)
+    {
+        return a.Cost != b.Cost ? a.Cost < b.Cost : a.Bytes > b.Bytes;
+    });
+
+    for (const BudgetStep& step : steps)
+    {
+        if (total <= _settings.BudgetBytes) break;
+        _textures[step.Texture].TargetMip++;
+        total -= step.Bytes;
+    }
+}
+
+void TextureStreamingPolicy::GetRequests(std::vector<TextureStreamRequest>& requests)
+{
+    requests.clear();
+
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < (uint32_t)_textures.size(); i++)
+    {
+        const StreamedTexture& texture = _textures[i];
+        if (texture.Live && !texture.Failed && texture.PendingMip == STREAM_NO_MIP && texture.TargetMip != texture.ResidentMip) order.push_back(i);
+    }
+
+    //Dropping detail frees memory for adding it, so those go first, then the textures biggest on screen
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+    {
+        bool aDrops = _textures[a].TargetMip > _textures[a].ResidentMip;
+        bool bDrops = _textures[b].TargetMip > _textures[b].ResidentMip;
+        if (aDrops != bDrops) return aDrops;
+        return _textures[a].ProjectedPixels > _textures[b].ProjectedPixels;
+    });
+
+    size_t committed = GetCommittedBytes();
+    size_t inFlight = GetInFlightCount();
+    for (uint32_t i : order)
+    {
+        if (inFlight >= (size_t)std::max(_settings.MaxStreamsInFlight, 1)) break;
+
+        //Adding detail goes as far towards the target as fits now, the rest comes once retired textures are let go of.
+        //Dropping it always goes ahead, its copy is the smaller one and it is what makes room
+        StreamedTexture& texture = _textures[i];
+        uint32_t mip = texture.TargetMip;
+        while (mip < texture.ResidentMip && committed + GetBytes(texture, mip) > _settings.BudgetBytes) mip++;
+        if (mip == texture.ResidentMip) continue;
+
+        committed += GetBytes(texture, mip);
+        texture.PendingMip = mip;
+        inFlight++;
+        _streamsStarted++;
+        requests.push_back({ i, mip });
+    }
+}
+
+void TextureStreamingPolicy::Complete(uint32_t texture, bool succeeded, uint64_t frame)
+{
+    StreamedTexture& completed = _textures[texture];
+    uint32_t mip = completed.PendingMip;
+    completed.PendingMip = STREAM_NO_MIP;
+
+    //Removed while streaming, whatever the stream made is let go of straight away by the caller
+    if (!completed.Live)
+    {
+        _free.push_back(texture);
+        return;
+    }
+
+    if (!succeeded || mip == STREAM_NO_MIP)
+    {
+        completed.Failed = true;
+        return;
+    }
+
+    size_t replaced = GetBytes(completed, completed.ResidentMip);
+    _retiring.push_back(std::make_pair(frame, replaced));
+    _retiringBytes += replaced;
+    completed.ResidentMip = mip;
+}
+
+void TextureStreamingPolicy::ReleaseRetired(uint64_t beforeFrame)
+{
+    size_t kept = 0;
+    for (auto& retired : _retiring)
+    {
+        if (retired.first < beforeFrame) _retiringBytes -= retired.second;
+        else _retiring[kept++] = retired;
+    }
+    _retiring.resize(kept);
+}
+
+size_t TextureStreamingPolicy::GetResidentBytes() const
+{
+    size_t bytes = 0;
+    for (const StreamedTexture& texture : _textures)
+    {
+        if (texture.Live) bytes += GetBytes(texture, texture.ResidentMip);
+    }
+    return bytes;
+}
+
+size_t TextureStreamingPolicy::GetCommittedBytes() const
+{
+    size_t bytes = _retiringBytes;
+    for (const StreamedTexture& texture : _textures)
+    {
+        if (texture.Live) bytes += GetBytes(texture, texture.ResidentMip);
+        if (texture.PendingMip != STREAM_NO_MIP) bytes += GetBytes(texture, texture.PendingMip);
+    }
+    return bytes;
+}
+
+size_t TextureStreamingPolicy::GetInFlightCount() const
+{
+    size_t inFlight = 0;
+    for (const StreamedTexture& texture : _textures)
+    {
+        if (texture.PendingMip != STREAM_NO_MIP) inFlight++;
+    }
+    return inFlight;
+}
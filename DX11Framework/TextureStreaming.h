@@ -0,0 +1,111 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+using namespace DirectX;
+
+const uint32_t STREAM_NO_MIP = 0xFFFFFFFF;
+
+//Read from JSON/settings.json
+struct TextureStreamingSettings
+{
+	bool Enabled = true;
+	size_t BudgetBytes = 256 * 1024 * 1024; //Every streamed texture's mips together, counting copies still being made or let go of
+	uint32_t TailSize = 64;                 //Mips no larger than this are uploaded with the texture and never dropped
+	float MipBias = 0.0f;                   //Added to every desired mip, positive trades detail for memory
+	float Hysteresis = 0.25f;               //How far past a resident mip's size the desired mip has to go before it is dropped
+	int MaxStreamsInFlight = 4;
+};
+
+//A texture as the policy sees it, its sizes and which mips are where. Mip numbers are the file's, 0 is the largest
+struct StreamedTexture
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t TailMip = 0;                //Most detailed mip that is always resident
+	std::vector<size_t> MipBytes;        //Each mip across every array item
+	uint32_t ResidentMip = 0;            //Most detailed mip on the GPU
+	uint32_t PendingMip = STREAM_NO_MIP; //What the stream in flight will leave resident
+	uint32_t TargetMip = 0;              //Where the budget lets it go this frame
+	float DesiredMip = 0.0f;             //Where this frame's uses want it, before the budget
+	float ProjectedPixels = 0.0f;        //Largest on screen size of anything using it this frame, 0 when nothing visible does
+	bool Failed = false;                 //A stream for it failed, it stays as it is rather than retrying every frame
+	bool Live = false;
+};
+
+struct TextureStreamRequest
+{
+	uint32_t Texture;
+	uint32_t Mip;
+};
+
+//Decides which mips of each streamed texture should be resident. Each frame's uses give every texture the mip that
+//matches its on screen size, the budget then drops whichever mips would be missed least until everything fits, and
+//streams are asked for the differences, letting go of detail before adding any. Nothing here touches a device, so
+//the benchmark and TextureStreamingPolicyTests run the same policy headless along simulated camera paths
+class TextureStreamingPolicy
+{
+private:
+	TextureStreamingSettings _settings;
+	std::vector<StreamedTexture> _textures;
+	std::vector<uint32_t> _free;
+
+	//Bytes of textures a finished stream replaced, with the frame they went. A snapshot can still be drawing them
+	std::vector<std::pair<uint64_t, size_t>> _retiring;
+	size_t _retiringBytes = 0;
+	size_t _streamsStarted = 0;
+
+public:
+	void Initialise(const TextureStreamingSettings& settings) { _settings = settings; }
+	const TextureStreamingSettings& GetSettings() const { return _settings; }
+
+	//Diameter in pixels of a bounding sphere (xyz centre, w radius), projectionScale is half the screen height times
+	//the projection's [1][1]. Spheres wholly behind the camera are 0. Nothing is culled against the sides, so a
+	//texture turned away from keeps its detail for the moment it takes to turn back
+	static float GetProjectedPixels(const XMFLOAT4& bounds, const XMFLOAT3& eye, const XMFLOAT3& forward, float projectionScale);
+
+	//Mip whose size matches projectedPixels, taking the texture to be stretched once across whatever uses it
+	static float GetDesiredMip(uint32_t width, uint32_t height, float projectedPixels, float bias);
+
+	//First mip no larger than tailSize in either dimension, or the last mip if none are
+	static uint32_t GetTailMip(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t tailSize);
+
+	//Resident size with mip and everything smaller on the GPU
+	static size_t GetBytes(const StreamedTexture& texture, uint32_t mip);
+
+	//Returns the texture's id. residentMip is what was uploaded when it loaded
+	uint32_t Add(uint32_t width, uint32_t height, const std::vector<size_t>& mipBytes, uint32_t residentMip);
+
+	//Its id is reused once any stream in flight for it completes
+	void Remove(uint32_t texture);
+	const StreamedTexture& Get(uint32_t texture) const { return _textures[texture]; }
+	size_t GetTextureCount() const { return _textures.size(); }
+
+	//Forgets last frame's uses, then every visible use this frame is added
+	void BeginFrame();
+	void AddUse(uint32_t texture, float projectedPixels);
+
+	//Sets every texture's target mip from this frame's uses and the budget
+	void ChooseTargets();
+
+	//Streams to start now, up to MaxStreamsInFlight at once. Detail is only added while it fits in the budget
+	//alongside everything resident, in flight and retiring, the most visible textures first
+	void GetRequests(std::vector<TextureStreamRequest>& requests);
+
+	//A stream asked for by GetRequests finished. The texture it replaced counts against the budget until ReleaseRetired
+	void Complete(uint32_t texture, bool succeeded, uint64_t frame);
+	void ReleaseRetired(uint64_t beforeFrame);
+
+	//Resident mips of every live texture, what the budget limits once streams settle
+	size_t GetResidentBytes() const;
+
+	//Resident plus streams in flight and retired textures not yet released, all the memory streaming holds right now
+	size_t GetCommittedBytes() const;
+
+	size_t GetInFlightCount() const;
+	size_t GetStreamsStarted() const { return _streamsStarted; }
+};
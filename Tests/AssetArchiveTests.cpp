@@ -0,0 +1,269 @@
+#include "TestFramework.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string.h>
+#include "AssetArchive.h"
+#include "Hash.h"
+#include "JobSystem.h"
+
+//Archives are written next to the test binary, the tests run from DX11Framework so the loose files it ships can be opened
+static std::string GetOutputPath(const char* name)
+{
+    return std::string(TEST_OUTPUT_DIR) + "/" + name;
+}
+
+static std::vector<uint8_t> ReadFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void WriteFile(const std::string& path, const std::vector<uint8_t>& data)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char*)data.data(), data.size());
+}
+
+static std::vector<uint8_t> MakeNoise(size_t size, uint32_t seed)
+{
+    std::vector<uint8_t> data(size);
+    for (uint8_t& byte : data)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        byte = (uint8_t)seed;
+    }
+    return data;
+}
+
+static std::vector<uint8_t> MakeText(size_t lines)
+{
+    std::string text;
+    for (size_t i = 0; i < lines; i++) text += "v " + std::to_string(i % 37) + ".5 " + std::to_string(i % 11) + ".25 -1.0\n";
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+static bool RoundTrips(const std::vector<uint8_t>& data, size_t* compressedSize = nullptr)
+{
+    std::vector<uint8_t> compressed;
+    AssetLZ::Compress(data.data(), data.size(), compressed);
+    if (compressedSize) *compressedSize = compressed.size();
+
+    std::vector<uint8_t> inflated(data.size() + 1, 0xCD);
+    return AssetLZ::Decompress(compressed.data(), compressed.size(), inflated.data(), data.size()) &&
+        memcmp(inflated.data(), data.data(), data.size()) == 0 && inflated[data.size()] == 0xCD;
+}
+
+TEST(LZRoundTrips)
+{
+    size_t size = 0;
+    CHECK(RoundTrips(std::vector<uint8_t>(), &size) && size == 1);
+    CHECK(RoundTrips(std::vector<uint8_t>(1, 7)));
+    CHECK(RoundTrips(std::vector<uint8_t>(3, 7)));
+    CHECK(RoundTrips(MakeText(2000), &size) && size < MakeText(2000).size() / 4);
+
+    //Nothing to find, so one long run of literals, which only ever costs its length bytes and a token
+    std::vector<uint8_t> noise = MakeNoise(100000, 1);
+    CHECK(RoundTrips(noise, &size) && size <= noise.size() + noise.size() / 255 + 2);
+
+    //One byte over and over is a match of the byte before it, overlapping everything it copies, far longer than
+    //15 + 255 so the length takes several extra bytes
+    std::vector<uint8_t> run(5000, 0x42);
+    CHECK(RoundTrips(run, &size) && size < 40);
+
+    //A short pattern repeating overlaps the same way, three bytes back
+    std::vector<uint8_t> pattern;
+    for (int i = 0; i < 3000; i++) pattern.push_back((uint8_t)"xyz"[i % 3]);
+    CHECK(RoundTrips(pattern, &size) && size < 40);
+
+    //Literal runs longer than 15 + 255 between matches, and matches as far back as the offset goes
+    std::vector<uint8_t> mixed = MakeNoise(300, 2);
+    mixed.insert(mixed.end(), run.begin(), run.begin() + 20);
+    std::vector<uint8_t> far = MakeNoise(70000, 3);
+    mixed.insert(mixed.end(), far.begin(), far.end());
+    mixed.insert(mixed.end(), far.begin() + 10000, far.begin() + 12000);
+    CHECK(RoundTrips(mixed));
+}
+
+TEST(LZRejectsDamagedStreams)
+{
+    std::vector<uint8_t> data = MakeText(500);
+    std::vector<uint8_t> compressed;
+    AssetLZ::Compress(data.data(), data.size(), compressed);
+    std::vector<uint8_t> inflated(data.size() + 16);
+
+    //Every truncation comes up short of the size or runs out partway through a sequence
+    bool truncationsFail = true;
+    for (size_t length = 0; length < compressed.size(); length++)
+    {
+        truncationsFail &= !AssetLZ::Decompress(compressed.data(), length, inflated.data(), data.size());
+    }
+    CHECK(truncationsFail);
+
+    //Inflating to more or less than the size it should have is damage too
+    CHECK(!AssetLZ::Decompress(compressed.data(), compressed.size(), inflated.data(), data.size() - 1));
+    CHECK(!AssetLZ::Decompress(compressed.data(), compressed.size(), inflated.data(), data.size() + 1));
+    std::vector<uint8_t> longer = compressed;
+    longer.insert(longer.end(), { 0x00, 0x01, 0x00 });
+    CHECK(!AssetLZ::Decompress(longer.data(), longer.size(), inflated.data(), data.size()));
+
+    //Matches from before the start, or from nowhere, are refused rather than read out of bounds
+    const uint8_t beforeStart[] = { 0x20, 'a', 'b', 0x03, 0x00, 0x00 };
+    const uint8_t zeroOffset[] = { 0x20, 'a', 'b', 0x00, 0x00, 0x00 };
+    const uint8_t valid[] = { 0x20, 'a', 'b', 0x02, 0x00, 0x00 };
+    CHECK(!AssetLZ::Decompress(beforeStart, sizeof(beforeStart), inflated.data(), 6));
+    CHECK(!AssetLZ::Decompress(zeroOffset, sizeof(zeroOffset), inflated.data(), 6));
+    CHECK(AssetLZ::Decompress(valid, sizeof(valid), inflated.data(), 6) && memcmp(inflated.data(), "ababab", 6) == 0);
+
+    //A length that keeps going past the end of the stream
+    const uint8_t endlessLength[] = { 0xF0, 0xFF, 0xFF };
+    CHECK(!AssetLZ::Decompress(endlessLength, sizeof(endlessLength), inflated.data(), 1000));
+}
+
+static std::vector<AssetArchiveInput> MakeInputs()
+{
+    std::vector<AssetArchiveInput> inputs(5);
+    inputs[0].Path = "Textures/Crate_COLOR.dds";
+    inputs[0].Data = MakeNoise(10000, 4);
+    inputs[1].Path = "JSON/fileData.scene";
+    inputs[1].Data = MakeText(400);
+    inputs[1].Compress = true;
+    inputs[2].Path = "Test models\\Car\\Car.obj";
+    inputs[2].Data = MakeText(3000);
+    inputs[2].Format = ASSET_FORMAT_MESH;
+    inputs[2].Compress = true;
+    inputs[3].Path = "Textures/Noise.dds";
+    inputs[3].Data = MakeNoise(5000, 5);
+    inputs[3].Compress = true;
+    inputs[4].Path = "Textures/Empty.dds";
+    return inputs;
+}
+
+TEST(ArchivesRoundTripThroughAssetFile)
+{
+    std::vector<AssetArchiveInput> inputs = MakeInputs();
+    std::string path = GetOutputPath("RoundTrip.pak");
+    AssetArchiveStats stats;
+    CHECK(AssetArchiveWriter::Write(path, inputs, 4096, 0.1f, nullptr, &stats));
+    CHECK(stats.Entries == 5 && stats.Compressed == 2 && stats.FileSize == ReadFile(path).size());
+
+    AssetArchive archive;
+    CHECK(archive.Open(path.c_str()));
+    CHECK(archive.GetEntryCount() == 5);
+
+    //Noise that doesn't compress is stored as it is however it was asked for
+    const AssetCompression compression[] = { ASSET_COMPRESSION_NONE, ASSET_COMPRESSION_LZ, ASSET_COMPRESSION_LZ, ASSET_COMPRESSION_NONE, ASSET_COMPRESSION_NONE };
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        const AssetArchiveEntry* entry = archive.Find(inputs[i].Path);
+        CHECK(entry != nullptr);
+        if (!entry) continue;
+        CHECK(entry->Offset % 4096 == 0 && entry->Compression == compression[i] && entry->Size == inputs[i].Data.size());
+        CHECK(AssetArchive::NormalizePath(inputs[i].Path) == archive.GetPath(*entry));
+
+        AssetFile file;
+        CHECK(file.Open(&archive, inputs[i].Path));
+        CHECK(file.IsArchived() && file.GetFormat() == inputs[i].Format && file.GetSize() == inputs[i].Data.size());
+        CHECK(inputs[i].Data.empty() || memcmp(file.GetData(), inputs[i].Data.data(), inputs[i].Data.size()) == 0);
+        CHECK(file.GetContentHash() == HashBytes(inputs[i].Data.data(), inputs[i].Data.size()));
+    }
+
+    //Paths are found whatever their case and slashes, and anything else isn't
+    CHECK(archive.Find("TEXTURES\\crate_color.DDS") == archive.Find("Textures/Crate_COLOR.dds"));
+    CHECK(archive.Find("test models/car/car.OBJ") == archive.Find("Test models\\Car\\Car.obj"));
+    CHECK(archive.Find("Textures/Crate_COLOR.dd") == nullptr && archive.Find("") == nullptr);
+
+    //Paths the archive doesn't have come from the loose file instead
+    AssetFile loose;
+    CHECK(loose.Open(&archive, "JSON/settings.json") && !loose.IsArchived() && loose.GetFormat() == ASSET_FORMAT_RAW);
+    CHECK(!loose.Open(&archive, "Textures/Missing.dds"));
+
+    //Compressing over the job system makes the same file
+    JobSystem jobSystem;
+    jobSystem.Initialise(2);
+    std::string parallelPath = GetOutputPath("RoundTripParallel.pak");
+    CHECK(AssetArchiveWriter::Write(parallelPath, inputs, 4096, 0.1f, &jobSystem));
+    CHECK(ReadFile(parallelPath) == ReadFile(path));
+    jobSystem.Shutdown();
+
+    //The same path twice can't be told apart once normalised
+    inputs[3].Path = "textures\\CRATE_color.dds";
+    CHECK(!AssetArchiveWriter::Write(GetOutputPath("Duplicate.pak"), inputs, 4096, 0.1f, nullptr));
+}
+
+//Writes bytes as an archive and tries to open it
+static bool OpensAs(const std::vector<uint8_t>& bytes)
+{
+    std::string path = GetOutputPath("Damaged.pak");
+    WriteFile(path, bytes);
+    AssetArchive archive;
+    return archive.Open(path.c_str());
+}
+
+static AssetArchiveEntry* GetEntries(std::vector<uint8_t>& bytes)
+{
+    return (AssetArchiveEntry*)(bytes.data() + sizeof(AssetArchiveHeader));
+}
+
+TEST(DamagedArchivesDontOpen)
+{
+    std::string path = GetOutputPath("Valid.pak");
+    CHECK(AssetArchiveWriter::Write(path, MakeInputs(), 4096, 0.1f, nullptr));
+    const std::vector<uint8_t> valid = ReadFile(path);
+    CHECK(OpensAs(valid));
+
+    //Cut off in the header, in the table, in the strings, and one byte short of the last entry's data
+    const AssetArchiveHeader* header = (const AssetArchiveHeader*)valid.data();
+    size_t stringsStart = sizeof(AssetArchiveHeader) + header->EntryCount * sizeof(AssetArchiveEntry);
+    const size_t truncations[] = { 0, sizeof(AssetArchiveHeader) - 1, sizeof(AssetArchiveHeader) + 10, stringsStart + 3, valid.size() - 1 };
+    for (size_t length : truncations)
+    {
+        CHECK(!OpensAs(std::vector<uint8_t>(valid.begin(), valid.begin() + length)));
+    }
+
+    std::vector<uint8_t> damaged = valid;
+    ((AssetArchiveHeader*)damaged.data())->Magic ^= 1;
+    CHECK(!OpensAs(damaged));
+
+    //Out of hash order, so the binary search couldn't be trusted
+    damaged = valid;
+    std::swap(GetEntries(damaged)[1], GetEntries(damaged)[3]);
+    CHECK(!OpensAs(damaged));
+
+    //An entry starting past the end, running past it, or off the alignment the header promises
+    damaged = valid;
+    GetEntries(damaged)[2].Offset = valid.size() + 4096;
+    CHECK(!OpensAs(damaged));
+
+    damaged = valid;
+    for (uint32_t i = 0; i < header->EntryCount; i++)
+    {
+        AssetArchiveEntry& entry = GetEntries(damaged)[i];
+        if (entry.Compression == ASSET_COMPRESSION_NONE) entry.Size = entry.StoredSize = valid.size();
+    }
+    CHECK(!OpensAs(damaged));
+
+    damaged = valid;
+    GetEntries(damaged)[2].Offset += 16;
+    CHECK(!OpensAs(damaged));
+
+    //Or over the table of contents itself
+    damaged = valid;
+    GetEntries(damaged)[2].Offset = 0;
+    CHECK(!OpensAs(damaged));
+
+    //A path outside the string table, and a compressed size that no stream could inflate to
+    damaged = valid;
+    GetEntries(damaged)[0].Path = header->StringTableSize;
+    CHECK(!OpensAs(damaged));
+
+    damaged = valid;
+    for (uint32_t i = 0; i < header->EntryCount; i++)
+    {
+        AssetArchiveEntry& entry = GetEntries(damaged)[i];
+        if (entry.Compression == ASSET_COMPRESSION_LZ) entry.Size = entry.StoredSize * 256;
+    }
+    CHECK(!OpensAs(damaged));
+}
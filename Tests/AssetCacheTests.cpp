@@ -0,0 +1,272 @@
+#include "TestFramework.h"
+#include "AssetCache.h"
+
+//Stand-ins for device resources that count their own references, so the tests can see exactly what the cache releases
+struct FakeView : ID3D11ShaderResourceView
+{
+    int References = 1;
+    ULONG AddRef() override { return ++References; }
+    ULONG Release() override { return --References; }
+};
+
+struct FakeBuffer : ID3D11Buffer
+{
+    int References = 1;
+    ULONG AddRef() override { return ++References; }
+    ULONG Release() override { return --References; }
+};
+
+static MeshData MakeMesh(FakeBuffer& vertices, FakeBuffer& indices)
+{
+    MeshData mesh = {};
+    mesh.VertexBuffer = &vertices;
+    mesh.IndexBuffer = &indices;
+    mesh.IndexCount = 36;
+    return mesh;
+}
+
+TEST(PathsAreNormalised)
+{
+    CHECK(AssetCache::NormalizePath("Test models/Car/Car_COLOR.dds") == "test models\\car\\car_color.dds");
+    CHECK(AssetCache::NormalizePath("TEXTURES\\Crate.DDS") == "textures\\crate.dds");
+    CHECK(AssetCache::NormalizePath("") == "");
+}
+
+TEST(SamePathSharesOneEntry)
+{
+    AssetCache cache;
+    bool created = false;
+    AssetHandle first = cache.Acquire(ASSET_TEXTURE, "Test models/Car/Car_COLOR.dds", &created);
+    CHECK(created && first.IsValid());
+
+    AssetHandle second = cache.Acquire(ASSET_TEXTURE, "test models\\car\\CAR_color.dds", &created);
+    CHECK(!created);
+    CHECK(second == first);
+    CHECK(cache.GetLiveCount() == 1);
+    CHECK(cache.GetPath(first) == "test models\\car\\car_color.dds");
+    CHECK(cache.GetState(first) == ASSET_PENDING);
+
+    //The same file as a mesh is a different asset
+    AssetHandle mesh = cache.Acquire(ASSET_MESH, "Test models/Car/Car_COLOR.dds", &created);
+    CHECK(created && mesh != first);
+    CHECK(cache.GetLiveCount() == 2);
+}
+
+TEST(LastReleaseFreesTheResources)
+{
+    AssetCache cache;
+    FakeView view;
+    FakeBuffer vertices;
+    FakeBuffer indices;
+
+    AssetHandle texture = cache.Acquire(ASSET_TEXTURE, "crate.dds");
+    cache.AddRef(texture);
+    cache.Acquire(ASSET_TEXTURE, "CRATE.dds");
+    cache.SetLoaded(texture, MeshData(), &view);
+    CHECK(cache.GetState(texture) == ASSET_LOADED);
+    CHECK(cache.GetTexture(texture) == &view);
+
+    AssetHandle mesh = cache.Acquire(ASSET_MESH, "car.obj");
+    cache.SetLoaded(mesh, MakeMesh(vertices, indices), nullptr);
+    CHECK(cache.GetMesh(mesh).IndexCount == 36);
+    CHECK(cache.GetResidentCount() == 2);
+
+    //Three references on the texture, two releases leave it alone
+    cache.Release(texture);
+    cache.Release(texture);
+    CHECK(view.References == 1);
+    CHECK(cache.GetTexture(texture) == &view);
+
+    cache.Release(texture);
+    CHECK(view.References == 0);
+    CHECK(cache.GetState(texture) == ASSET_FAILED);
+    CHECK(cache.GetTexture(texture) == nullptr);
+    CHECK(cache.GetLiveCount() == 1);
+
+    cache.Release(mesh);
+    CHECK(vertices.References == 0 && indices.References == 0);
+    CHECK(cache.GetLiveCount() == 0);
+    CHECK(cache.GetResidentCount() == 0);
+}
+
+TEST(StaleHandlesAreCaught)
+{
+    AssetCache cache;
+    FakeView view;
+    AssetHandle old = cache.Acquire(ASSET_TEXTURE, "a.dds");
+    cache.Release(old);
+
+    //The freed slot is reused, the old handle mustn't find the new entry or change its count
+    bool created = false;
+    AssetHandle reused = cache.Acquire(ASSET_TEXTURE, "b.dds", &created);
+    CHECK(created && reused.Index == old.Index && reused != old);
+    CHECK(cache.GetPath(old).empty());
+    cache.Release(old);
+    cache.AddRef(old);
+    cache.SetLoaded(reused, MeshData(), &view);
+    CHECK(cache.GetTexture(reused) == &view);
+
+    //Nothing holds a load that finishes for a stale handle, so its resources are let go of straight away
+    FakeView orphan;
+    cache.SetLoaded(old, MeshData(), &orphan);
+    CHECK(orphan.References == 0);
+
+    CHECK(cache.GetState(AssetHandle()) == ASSET_FAILED);
+    CHECK(cache.GetTexture(AssetHandle()) == nullptr);
+
+    cache.Release(reused);
+    CHECK(view.References == 0);
+}
+
+TEST(SameContentSharesResources)
+{
+    AssetCache cache;
+    FakeView view;
+    const uint64_t hash = 0x1234;
+
+    //Nothing loaded with this content yet, so the first copy loads
+    AssetHandle original = cache.Acquire(ASSET_TEXTURE, "Textures/Crate_COLOR.dds");
+    CHECK(!cache.ShareByContent(original, hash));
+    cache.SetLoaded(original, MeshData(), &view);
+
+    AssetHandle copy = cache.Acquire(ASSET_TEXTURE, "Copies/Crate_COLOR.dds");
+    CHECK(cache.ShareByContent(copy, hash));
+    CHECK(cache.GetState(copy) == ASSET_LOADED);
+    CHECK(cache.GetTexture(copy) == &view);
+    CHECK(cache.GetOwner(copy) == original);
+    CHECK(cache.GetOwner(original) == original);
+    CHECK(cache.GetLiveCount() == 2);
+    CHECK(cache.GetResidentCount() == 1);
+
+    //A mesh with the same bytes is not the same asset
+    AssetHandle mesh = cache.Acquire(ASSET_MESH, "Copies/Crate_COLOR.obj");
+    CHECK(!cache.ShareByContent(mesh, hash));
+    cache.Release(mesh);
+
+    //The copy keeps the original's resources alive after the original path is let go of
+    cache.Release(original);
+    CHECK(view.References == 1);
+    CHECK(cache.GetTexture(copy) == &view);
+    CHECK(cache.GetLiveCount() == 2);
+
+    cache.Release(copy);
+    CHECK(view.References == 0);
+    CHECK(cache.GetLiveCount() == 0);
+}
+
+TEST(LoadsInFlightDontShare)
+{
+    AssetCache cache;
+    FakeView first;
+    FakeView second;
+
+    //Two copies loading at once both load, only a finished entry can be shared from
+    AssetHandle a = cache.Acquire(ASSET_TEXTURE, "a.dds");
+    AssetHandle b = cache.Acquire(ASSET_TEXTURE, "b.dds");
+    CHECK(!cache.ShareByContent(a, 7));
+    CHECK(!cache.ShareByContent(b, 7));
+    cache.SetLoaded(a, MeshData(), &first);
+    cache.SetLoaded(b, MeshData(), &second);
+    CHECK(cache.GetResidentCount() == 2);
+
+    AssetHandle c = cache.Acquire(ASSET_TEXTURE, "c.dds");
+    CHECK(cache.ShareByContent(c, 7));
+    CHECK(cache.GetTexture(c) == &first);
+
+    cache.Clear();
+    CHECK(first.References == 0 && second.References == 0);
+    CHECK(cache.GetLiveCount() == 0);
+}
+
+TEST(InvalidateStartsANewEntryForThePath)
+{
+    AssetCache cache;
+    FakeView oldView;
+    FakeView newView;
+    FakeView otherView;
+
+    bool created = false;
+    AssetHandle old = cache.Acquire(ASSET_TEXTURE, "Textures/Crate_COLOR.dds", &created);
+    CHECK(!cache.ShareByContent(old, 99));
+    cache.SetLoaded(old, MeshData(), &oldView);
+
+    cache.Invalidate("TEXTURES\\crate_color.dds");
+
+    //Holders of the old entry keep it, the next Acquire gets a new one to load the changed file into
+    CHECK(cache.GetTexture(old) == &oldView);
+    AssetHandle fresh = cache.Acquire(ASSET_TEXTURE, "Textures/Crate_COLOR.dds", &created);
+    CHECK(created && fresh != old);
+    CHECK(cache.GetLiveCount() == 2);
+
+    //Nor is the outdated content shared from any more, even by a file whose bytes hash the same
+    AssetHandle other = cache.Acquire(ASSET_TEXTURE, "other.dds");
+    CHECK(!cache.ShareByContent(other, 99));
+    cache.SetLoaded(other, MeshData(), &otherView);
+
+    cache.SetLoaded(fresh, MeshData(), &newView);
+    cache.Release(old);
+    CHECK(oldView.References == 0);
+
+    //Releasing the old entry mustn't take the path away from the new one
+    bool createdAgain = true;
+    AssetHandle again = cache.Acquire(ASSET_TEXTURE, "textures/crate_color.dds", &createdAgain);
+    CHECK(!createdAgain && again == fresh);
+    CHECK(cache.GetTexture(again) == &newView);
+
+    cache.Invalidate("not/in/the/cache.dds");
+    CHECK(cache.GetLiveCount() == 2);
+
+    cache.Release(fresh);
+    cache.Release(again);
+    cache.Release(other);
+    CHECK(newView.References == 0 && otherView.References == 0);
+}
+
+TEST(ReplaceTextureSwapsTheOwnersView)
+{
+    AssetCache cache;
+    FakeView tail;
+    FakeView full;
+
+    AssetHandle original = cache.Acquire(ASSET_TEXTURE, "a.dds");
+    ID3D11ShaderResourceView* previous = nullptr;
+    CHECK(!cache.ReplaceTexture(original, &full, &previous));
+    CHECK(previous == nullptr);
+
+    cache.ShareByContent(original, 5);
+    cache.SetLoaded(original, MeshData(), &tail);
+    AssetHandle copy = cache.Acquire(ASSET_TEXTURE, "b.dds");
+    CHECK(cache.ShareByContent(copy, 5));
+
+    //Replacing through a sharing entry replaces the owner's, so everyone sharing sees the new one
+    CHECK(cache.ReplaceTexture(copy, &full, &previous));
+    CHECK(previous == &tail);
+    CHECK(cache.GetTexture(original) == &full);
+    CHECK(cache.GetTexture(copy) == &full);
+
+    //The caller owns what came back, the cache owns what went in
+    CHECK(tail.References == 1);
+    cache.Release(original);
+    cache.Release(copy);
+    CHECK(full.References == 0);
+    CHECK(tail.References == 1);
+
+    //A stale handle leaves the texture with the caller
+    FakeView unused;
+    previous = nullptr;
+    CHECK(!cache.ReplaceTexture(original, &unused, &previous));
+    CHECK(previous == nullptr && unused.References == 1);
+}
+
+TEST(FailedLoadsHaveNoResources)
+{
+    AssetCache cache;
+    AssetHandle mesh = cache.Acquire(ASSET_MESH, "missing.obj");
+    cache.SetFailed(mesh);
+    CHECK(cache.GetState(mesh) == ASSET_FAILED);
+    CHECK(cache.GetMesh(mesh).VertexBuffer == nullptr);
+    CHECK(cache.GetResidentCount() == 0);
+    CHECK(cache.GetLiveCount() == 1);
+    cache.Release(mesh);
+    CHECK(cache.GetLiveCount() == 0);
+}
@@ -0,0 +1,410 @@
+#include <string.h>
+#include "TestFramework.h"
+#include "BCDecoder.h"
+
+//Hand made blocks and the pixels the format specifications say they decode to. The expected pixels were worked out
+//from the specifications rather than recorded from BCDecoder, so they catch it being wrong as well as it changing
+struct GoldenBlock
+{
+    DDSFormat Format;
+    uint8_t Block[16];
+    uint8_t Pixels[64];
+};
+
+//Red over blue, so four colours, each row reading the palette a different way
+static const GoldenBlock BC1_FOUR_COLOURS =
+{
+    DDS_FORMAT_BC1_UNORM,
+    { 0x00, 0xf8, 0x1f, 0x00, 0xe4, 0x1b, 0x00, 0xff },
+    {
+        255,   0,   0, 255,   0,   0, 255, 255, 170,   0,  85, 255,  85,   0, 170, 255,
+         85,   0, 170, 255, 170,   0,  85, 255,   0,   0, 255, 255, 255,   0,   0, 255,
+        255,   0,   0, 255, 255,   0,   0, 255, 255,   0,   0, 255, 255,   0,   0, 255,
+         85,   0, 170, 255,  85,   0, 170, 255,  85,   0, 170, 255,  85,   0, 170, 255
+    }
+};
+
+//Blue not over green, so three colours and transparent black
+static const GoldenBlock BC1_THREE_COLOURS =
+{
+    DDS_FORMAT_BC1_UNORM,
+    { 0x1f, 0x00, 0xe0, 0x07, 0xe4, 0xe4, 0x39, 0x93 },
+    {
+          0,   0, 255, 255,   0, 255,   0, 255,   0, 128, 128, 255,   0,   0,   0,   0,
+          0,   0, 255, 255,   0, 255,   0, 255,   0, 128, 128, 255,   0,   0,   0,   0,
+          0, 255,   0, 255,   0, 128, 128, 255,   0,   0,   0,   0,   0,   0, 255, 255,
+          0,   0,   0,   0,   0,   0, 255, 255,   0, 255,   0, 255,   0, 128, 128, 255
+    }
+};
+
+//Endpoints whose thirds round up in some channels and down in others
+static const GoldenBlock BC1_ROUNDING =
+{
+    DDS_FORMAT_BC1_UNORM,
+    { 0xcd, 0xa5, 0x3c, 0x4d, 0x8d, 0x72, 0xc6, 0x27 },
+    {
+         74, 166, 231, 255, 104, 173, 190, 255, 165, 186, 107, 255, 135, 179, 148, 255,
+        135, 179, 148, 255, 165, 186, 107, 255, 104, 173, 190, 255,  74, 166, 231, 255,
+        135, 179, 148, 255,  74, 166, 231, 255, 165, 186, 107, 255, 104, 173, 190, 255,
+        104, 173, 190, 255,  74, 166, 231, 255, 135, 179, 148, 255, 165, 186, 107, 255
+    }
+};
+
+//Four bit alpha, and the colour half always has four colours even with its endpoints this way round
+static const GoldenBlock BC2_EXPLICIT_ALPHA =
+{
+    DDS_FORMAT_BC2_UNORM,
+    { 0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x1f, 0x00, 0xe0, 0x07, 0xe4, 0x1b, 0x4e, 0xb1 },
+    {
+          0,   0, 255, 255,   0, 255,   0, 238,   0,  85, 170, 221,   0, 170,  85, 204,
+          0, 170,  85, 187,   0,  85, 170, 170,   0, 255,   0, 153,   0,   0, 255, 136,
+          0,  85, 170, 119,   0, 170,  85, 102,   0,   0, 255,  85,   0, 255,   0,  68,
+          0, 255,   0,  51,   0,   0, 255,  34,   0, 170,  85,  17,   0,  85, 170,   0
+    }
+};
+
+//First alpha over the second, eight interpolated values
+static const GoldenBlock BC3_EIGHT_ALPHAS =
+{
+    DDS_FORMAT_BC3_UNORM,
+    { 0xff, 0x00, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa, 0x00, 0xf8, 0x1f, 0x00, 0xe4, 0x1b, 0x00, 0xff },
+    {
+        255,   0,   0, 255,   0,   0, 255,   0, 170,   0,  85, 219,  85,   0, 170, 182,
+         85,   0, 170, 146, 170,   0,  85, 109,   0,   0, 255,  73, 255,   0,   0,  36,
+        255,   0,   0, 255, 255,   0,   0,   0, 255,   0,   0, 219, 255,   0,   0, 182,
+         85,   0, 170, 146,  85,   0, 170, 109,  85,   0, 170,  73,  85,   0, 170,  36
+    }
+};
+
+//First alpha not over the second, six values plus 0 and 255
+static const GoldenBlock BC3_SIX_ALPHAS =
+{
+    DDS_FORMAT_BC3_UNORM,
+    { 0x28, 0xc8, 0x88, 0xc6, 0xfa, 0x77, 0x39, 0x05, 0xcd, 0xa5, 0x3c, 0x4d, 0x8d, 0x72, 0xc6, 0x27 },
+    {
+         74, 166, 231,  40, 104, 173, 190, 200, 165, 186, 107,  72, 135, 179, 148, 104,
+        135, 179, 148, 136, 165, 186, 107, 168, 104, 173, 190,   0,  74, 166, 231, 255,
+        135, 179, 148, 255,  74, 166, 231,   0, 165, 186, 107, 168, 104, 173, 190, 136,
+        104, 173, 190, 104,  74, 166, 231,  72, 135, 179, 148, 200, 165, 186, 107,  40
+    }
+};
+
+static const GoldenBlock BC4_EIGHT_VALUES =
+{
+    DDS_FORMAT_BC4_UNORM,
+    { 0xc9, 0x0e, 0xeb, 0x21, 0xda, 0xa6, 0xf0, 0x2e },
+    {
+        148,   0,   0, 255,  94,   0,   0, 255,  41,   0,   0, 255, 201,   0,   0, 255,
+        174,   0,   0, 255, 121,   0,   0, 255,  67,   0,   0, 255,  67,   0,   0, 255,
+         67,   0,   0, 255, 121,   0,   0, 255, 174,   0,   0, 255, 201,   0,   0, 255,
+         41,   0,   0, 255,  94,   0,   0, 255, 148,   0,   0, 255,  14,   0,   0, 255
+    }
+};
+
+static const GoldenBlock BC4_SIX_VALUES =
+{
+    DDS_FORMAT_BC4_UNORM,
+    { 0x0e, 0xc9, 0x5d, 0x4c, 0x01, 0x10, 0x9d, 0xf5 },
+    {
+        164,   0,   0, 255,  89,   0,   0, 255, 201,   0,   0, 255,   0,   0,   0, 255,
+        126,   0,   0, 255,  51,   0,   0, 255,  14,   0,   0, 255,  14,   0,   0, 255,
+         14,   0,   0, 255,  51,   0,   0, 255, 126,   0,   0, 255,   0,   0,   0, 255,
+        201,   0,   0, 255,  89,   0,   0, 255, 164,   0,   0, 255, 255,   0,   0, 255
+    }
+};
+
+//Equal endpoints are not first over second, so still six values plus 0 and 255
+static const GoldenBlock BC4_EQUAL_VALUES =
+{
+    DDS_FORMAT_BC4_UNORM,
+    { 0x5a, 0x5a, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa },
+    {
+         90,   0,   0, 255,  90,   0,   0, 255,  90,   0,   0, 255,  90,   0,   0, 255,
+         90,   0,   0, 255,  90,   0,   0, 255,   0,   0,   0, 255, 255,   0,   0, 255,
+         90,   0,   0, 255,  90,   0,   0, 255,  90,   0,   0, 255,  90,   0,   0, 255,
+         90,   0,   0, 255,  90,   0,   0, 255,   0,   0,   0, 255, 255,   0,   0, 255
+    }
+};
+
+//127 over -64, eight values
+static const GoldenBlock BC4_SIGNED_EIGHT_VALUES =
+{
+    DDS_FORMAT_BC4_SNORM,
+    { 0x7f, 0xc0, 0x77, 0x39, 0x05, 0x77, 0x39, 0x05 },
+    {
+         90,   0,   0, 255, 118,   0,   0, 255, 146,   0,   0, 255, 173,   0,   0, 255,
+        200,   0,   0, 255, 228,   0,   0, 255,  63,   0,   0, 255, 255,   0,   0, 255,
+         90,   0,   0, 255, 118,   0,   0, 255, 146,   0,   0, 255, 173,   0,   0, 255,
+        200,   0,   0, 255, 228,   0,   0, 255,  63,   0,   0, 255, 255,   0,   0, 255
+    }
+};
+
+//-128 is read as -127, then not over 127 gives six values plus -127 and 127
+static const GoldenBlock BC4_SIGNED_SIX_VALUES =
+{
+    DDS_FORMAT_BC4_SNORM,
+    { 0x80, 0x7f, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa },
+    {
+          0,   0,   0, 255, 255,   0,   0, 255,  51,   0,   0, 255, 102,   0,   0, 255,
+        153,   0,   0, 255, 204,   0,   0, 255,   0,   0,   0, 255, 255,   0,   0, 255,
+          0,   0,   0, 255, 255,   0,   0, 255,  51,   0,   0, 255, 102,   0,   0, 255,
+        153,   0,   0, 255, 204,   0,   0, 255,   0,   0,   0, 255, 255,   0,   0, 255
+    }
+};
+
+static const GoldenBlock BC5_UNSIGNED =
+{
+    DDS_FORMAT_BC5_UNORM,
+    { 0xc9, 0x0e, 0xeb, 0x21, 0xda, 0xa6, 0xf0, 0x2e, 0x0e, 0xc9, 0x5d, 0x4c, 0x01, 0x10, 0x9d, 0xf5 },
+    {
+        148, 164,   0, 255,  94,  89,   0, 255,  41, 201,   0, 255, 201,   0,   0, 255,
+        174, 126,   0, 255, 121,  51,   0, 255,  67,  14,   0, 255,  67,  14,   0, 255,
+         67,  14,   0, 255, 121,  51,   0, 255, 174, 126,   0, 255, 201,   0,   0, 255,
+         41, 201,   0, 255,  94,  89,   0, 255, 148, 164,   0, 255,  14, 255,   0, 255
+    }
+};
+
+static const GoldenBlock BC5_SIGNED =
+{
+    DDS_FORMAT_BC5_SNORM,
+    { 0x7f, 0xc0, 0x77, 0x39, 0x05, 0x77, 0x39, 0x05, 0x80, 0x7f, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa },
+    {
+         90,   0,   0, 255, 118, 255,   0, 255, 146,  51,   0, 255, 173, 102,   0, 255,
+        200, 153,   0, 255, 228, 204,   0, 255,  63,   0,   0, 255, 255, 255,   0, 255,
+         90,   0,   0, 255, 118, 255,   0, 255, 146,  51,   0, 255, 173, 102,   0, 255,
+        200, 153,   0, 255, 228, 204,   0, 255,  63,   0,   0, 255, 255, 255,   0, 255
+    }
+};
+
+//Three subsets, endpoint p-bits
+static const GoldenBlock BC7_MODE_0 =
+{
+    DDS_FORMAT_BC7_UNORM,
+    { 0xe1, 0x2b, 0xad, 0xf1, 0x7e, 0xdb, 0x52, 0xc5, 0x9c, 0xac, 0xab, 0xb6, 0xab, 0xdd, 0x79, 0x43 },
+    {
+        231, 140, 153, 255, 131, 212,  72, 255, 114, 217, 220, 255, 142, 198, 144, 255,
+        131, 212,  72, 255, 182, 175, 114, 255, 121, 213, 202, 255, 114, 217, 220, 255,
+        106, 230,  53, 255, 157, 136,  92, 255, 184, 124,  85, 255, 114, 217, 220, 255,
+        184, 124,  85, 255, 184, 124,  85, 255, 222, 107,  74, 255, 209, 113,  78, 255
+    }
+};
+
+//Two subsets, shared p-bits
+static const GoldenBlock BC7_MODE_1 =
+{
+    DDS_FORMAT_BC7_UNORM,
+    { 0x36, 0x42, 0x88, 0xd6, 0x8e, 0xda, 0x79, 0xbb, 0x1b, 0x65, 0x47, 0xb7, 0x97, 0xba, 0x44, 0xd0 },
+    {
+         28,  74, 232, 255,  82, 123, 209, 255, 117, 155, 194, 255, 100, 139, 202, 255,
+        100, 139, 202, 255, 135, 171, 187, 255,  45,  90, 224, 255,  45,  90, 224, 255,
+        200, 121,  93, 255, 185, 120,  84, 255, 170, 119,  75, 255, 170, 119,  75, 255,
+        178, 119,  79, 255, 163, 118,  70, 255, 178, 119,  79, 255, 185, 120,  84, 255
+    }
+};
+
+//Three subsets, 2 bit indices
+static const GoldenBlock BC7_MODE_2 =
+{
+    DDS_FORMAT_BC7_UNORM,
+    { 0x44, 0x9e, 0x75, 0x85, 0xc9, 0xd7, 0xa1, 0xdf, 0x9a, 0x91, 0x39, 0x23, 0xca, 0x75, 0x95, 0x21 },
+    {
+        142, 161,  77, 255, 123, 123,  99, 255, 181, 239,  33, 255, 142, 161,  77, 255,
+        142, 161,  77, 255, 181, 239,  33, 255, 142, 161,  77, 255, 142, 161,  77, 255,
+         91, 170, 156, 255,  65, 209, 156, 255, 115, 132, 156, 255,  41, 247, 156, 255,
+         99, 222, 140, 255,  99, 222, 140, 255, 115, 219, 116, 255,  99, 222, 140, 255
+    }
+};
+
+//Two subsets, 7 bit colour
+static const GoldenBlock BC7_MODE_3 =
+{
+    DDS_FORMAT_BC7_UNORM,
+    { 0x18, 0x80, 0x6a, 0x16, 0x16, 0x8f, 0xaf, 0x4a, 0x59, 0x40, 0x9a, 0x03, 0x91, 0xa0, 0xba, 0xf5 },
+    {
+         64, 120,  44, 255,  92, 206,  57, 255,  64, 120,  44, 255,  59,  84,  40, 255,
+         64, 120,  44, 255,  64, 120,  44, 255,  78, 162,  51, 255,  59,  84,  40, 255,
+         78, 162,  51, 255, 106, 248,  64, 255,  78, 162,  51, 255,  88,  82,  14, 255,
+         92, 206,  57, 255,  92, 206,  57, 255, 106, 248,  64, 255,  59,  84,  40, 255
+    }
+};
+
+//Separate alpha, red rotated into alpha and the index sets swapped
+static const GoldenBlock BC7_MODE_4 =
+{
+    DDS_FORMAT_BC7_UNORM,
+    { 0xb0, 0x2d, 0x73, 0x8d, 0x1a, 0x75, 0x2e, 0x07, 0x69, 0x7a, 0x2e, 0x4a, 0x2d, 0x8e, 0x84, 0x92 },
+    {
+        106, 224,  83, 149, 106, 219,  95, 178, 106, 231,  66, 107, 133, 219,  95, 178,
+        158, 221,  90, 164,  81, 226,  78, 135,  81, 224,  83, 149, 133, 229,  72, 121,
+         81, 216, 101, 192, 106, 229,  72, 121, 158, 226,  78, 135,  81, 226,  78, 135,
+        106, 231,  66, 107, 158, 219,  95, 178, 158, 221,  90, 164,  81, 221,  90, 164
+    }
+};
+
+//Separate alpha, blue rotated into alpha
+static const GoldenBlock BC7_MODE_5 =
+{
+    DDS_FORMAT_BC7_UNORM,
+    { 0xe0, 0xfe, 0x14, 0xf7, 0xfe, 0xee, 0x9f, 0x46, 0x01, 0x0f, 0xc6, 0xb0, 0x8c, 0x17, 0xf4, 0x97 },
+    {
+        253, 185, 167, 223, 253, 185,  81, 223, 253, 185, 167, 223, 138, 221, 109, 242,
+         82, 239,  81, 251, 197, 203, 139, 232, 253, 185, 139, 223, 253, 185, 167, 223,
+         82, 239, 167, 251, 253, 185, 139, 223, 138, 221,  81, 242, 197, 203,  81, 232,
+        253, 185,  81, 223, 138, 221, 139, 242, 197, 203, 139, 232, 197, 203, 109, 232
+    }
+};
+
+//Separate alpha, green rotated into alpha with the index sets as they are
+static const GoldenBlock BC7_MODE_4_GREEN_ROTATED =
+{
+    DDS_FORMAT_BC7_UNORM,
+    { 0x50, 0xc5, 0x2f, 0x70, 0x71, 0x87, 0x1c, 0x68, 0x06, 0x8a, 0x7e, 0x91, 0x2d, 0x43, 0xd4, 0x9c },
+    {
+        109,  81, 192,  60, 247,  32, 198,   0,  41,  56, 189,  90,  41, 117, 189,  90,
+         41, 105, 189,  90, 109,  81, 192,  60, 247,  81, 198,   0,  41, 105, 189,  90,
+        247,  81, 198,   0,  41, 117, 189,  90,  41, 105, 189,  90,  41,  93, 189,  90,
+        109,  56, 192,  60, 109, 105, 192,  60,  41,  32, 189,  90, 109,  68, 192,  60
+    }
+};
+
+//4 bit indices
+static const GoldenBlock BC7_MODE_6 =
+{
+    DDS_FORMAT_BC7_UNORM,
+    { 0x40, 0xe3, 0x76, 0xce, 0x39, 0x97, 0x91, 0x51, 0x7a, 0xed, 0x99, 0xe6, 0x81, 0x6c, 0xd8, 0xa4 },
+    {
+        154, 173, 205, 150, 160, 148, 204, 152, 176,  80, 203, 159, 179,  67, 202, 161,
+        165, 127, 204, 155, 165, 127, 204, 155, 157, 159, 204, 151, 179,  67, 202, 161,
+        143, 219, 206, 145, 162, 138, 204, 154, 173,  91, 203, 158, 157, 159, 204, 151,
+        162, 138, 204, 154, 176,  80, 203, 159, 151, 184, 205, 149, 168, 113, 203, 156
+    }
+};
+
+//Two subsets with alpha
+static const GoldenBlock BC7_MODE_7 =
+{
+    DDS_FORMAT_BC7_UNORM,
+    { 0x80, 0x80, 0x44, 0xc5, 0xf5, 0x28, 0x1f, 0x96, 0xcb, 0xdf, 0x80, 0x09, 0x43, 0xec, 0x5a, 0x86 },
+    {
+        146, 235, 195, 186, 146, 235, 195, 186,  93, 133, 196,  89,  44, 150,  93, 199,
+         92, 170, 162,  66, 119, 203, 179, 128, 117, 125, 247,  36,  68, 142, 144, 146,
+        119, 203, 179, 128,  65, 138, 146,   8,  93, 133, 196,  89,  44, 150,  93, 199,
+         65, 138, 146,   8, 146, 235, 195, 186,  44, 150,  93, 199,  68, 142, 144, 146
+    }
+};
+
+static bool DecodesTo(const GoldenBlock& golden, DDSFormat format)
+{
+    uint8_t pixels[64];
+    BCDecoder::DecodeBlock(format, golden.Block, pixels);
+    return memcmp(pixels, golden.Pixels, 64) == 0;
+}
+
+static bool DecodesTo(const GoldenBlock& golden)
+{
+    return DecodesTo(golden, golden.Format);
+}
+
+TEST(BC1Blocks)
+{
+    CHECK(DecodesTo(BC1_FOUR_COLOURS));
+    CHECK(DecodesTo(BC1_THREE_COLOURS));
+    CHECK(DecodesTo(BC1_ROUNDING));
+
+    //sRGB and typeless only change how the GPU reads the bytes, not the bytes
+    CHECK(DecodesTo(BC1_ROUNDING, DDS_FORMAT_BC1_UNORM_SRGB));
+    CHECK(DecodesTo(BC1_ROUNDING, DDS_FORMAT_BC1_TYPELESS));
+}
+
+TEST(BC2AndBC3Blocks)
+{
+    CHECK(DecodesTo(BC2_EXPLICIT_ALPHA));
+    CHECK(DecodesTo(BC3_EIGHT_ALPHAS));
+    CHECK(DecodesTo(BC3_SIX_ALPHAS));
+    CHECK(DecodesTo(BC3_SIX_ALPHAS, DDS_FORMAT_BC3_UNORM_SRGB));
+}
+
+TEST(BC4AndBC5Blocks)
+{
+    CHECK(DecodesTo(BC4_EIGHT_VALUES));
+    CHECK(DecodesTo(BC4_SIX_VALUES));
+    CHECK(DecodesTo(BC4_EQUAL_VALUES));
+    CHECK(DecodesTo(BC5_UNSIGNED));
+    CHECK(DecodesTo(BC5_UNSIGNED, DDS_FORMAT_BC5_TYPELESS));
+}
+
+TEST(SignedBlocksMapFromMinusOneToOne)
+{
+    CHECK(DecodesTo(BC4_SIGNED_EIGHT_VALUES));
+    CHECK(DecodesTo(BC4_SIGNED_SIX_VALUES));
+    CHECK(DecodesTo(BC5_SIGNED));
+
+    //The same bytes read unsigned are a different block altogether
+    CHECK(!DecodesTo(BC4_SIGNED_EIGHT_VALUES, DDS_FORMAT_BC4_UNORM));
+}
+
+TEST(OneBC7BlockPerMode)
+{
+    CHECK(DecodesTo(BC7_MODE_0));
+    CHECK(DecodesTo(BC7_MODE_1));
+    CHECK(DecodesTo(BC7_MODE_2));
+    CHECK(DecodesTo(BC7_MODE_3));
+    CHECK(DecodesTo(BC7_MODE_4));
+    CHECK(DecodesTo(BC7_MODE_4_GREEN_ROTATED));
+    CHECK(DecodesTo(BC7_MODE_5));
+    CHECK(DecodesTo(BC7_MODE_6));
+    CHECK(DecodesTo(BC7_MODE_7));
+    CHECK(DecodesTo(BC7_MODE_6, DDS_FORMAT_BC7_UNORM_SRGB));
+
+    //No mode bit set is reserved, and decodes to transparent black
+    GoldenBlock reserved = {};
+    memset(reserved.Block, 0xff, 16);
+    reserved.Block[0] = 0;
+    CHECK(DecodesTo(reserved, DDS_FORMAT_BC7_UNORM));
+}
+
+//Images of up to 3x2 blocks cut to every size that leaves the last column or row of blocks partly used. Each pixel
+//has to be its block's, and nothing past the width on a row or below the last row may be written
+TEST(OddSizesAreClippedToTheImage)
+{
+    const GoldenBlock* blocks[] = { &BC7_MODE_0, &BC7_MODE_1, &BC7_MODE_2, &BC7_MODE_4, &BC7_MODE_6, &BC7_MODE_7 };
+    std::vector<uint8_t> data;
+    for (const GoldenBlock* block : blocks) data.insert(data.end(), block->Block, block->Block + 16);
+    const size_t rowPitch = 3 * 16;
+    const size_t padding = 12;
+
+    bool matches = true;
+    bool untouched = true;
+    for (uint32_t height = 1; height <= 8; height++)
+    {
+        for (uint32_t width = 1; width <= 12; width++)
+        {
+            size_t outputPitch = width * 4 + padding;
+            std::vector<uint8_t> output(outputPitch * (height + 1), 0xcd);
+            CHECK(BCDecoder::Decode(DDS_FORMAT_BC7_UNORM, data.data(), data.size(), rowPitch, width, height, output.data(), outputPitch));
+
+            for (uint32_t y = 0; y < height + 1; y++)
+            {
+                for (uint32_t x = 0; x < outputPitch; x++)
+                {
+                    uint8_t value = output[y * outputPitch + x];
+                    if (y < height && x < width * 4)
+                    {
+                        const GoldenBlock* block = blocks[(y / 4) * 3 + x / 16];
+                        matches &= value == block->Pixels[(y % 4) * 16 + x % 16];
+                    }
+                    else
+                    {
+                        untouched &= value == 0xcd;
+                    }
+                }
+            }
+        }
+    }
+    CHECK(matches);
+    CHECK(untouched);
+
+    //Partly used blocks still have to be there in full
+    std::vector<uint8_t> output(9 * 4 * 5);
+    CHECK(!BCDecoder::Decode(DDS_FORMAT_BC7_UNORM, data.data(), data.size() - 1, rowPitch, 9, 5, output.data(), 9 * 4));
+}
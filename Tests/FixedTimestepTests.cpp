@@ -0,0 +1,185 @@
+#include "TestFramework.h"
+#include <stdint.h>
+#include <vector>
+#include "Clock.h"
+#include "FixedTimestep.h"
+
+//The same shape as DX11Framework::Update: take whole steps for the time that passed, then render between the
+//last two simulation times by the timestep's alpha
+struct SimulatedLoop
+{
+    SimulatedClock Clock;
+    FixedTimestep Timestep;
+    double SimulationTime = 0.0;
+    double PreviousSimulationTime = 0.0;
+    int TotalSteps = 0;
+
+    SimulatedLoop(double step, int maxSteps) : Timestep(step, maxSteps) {}
+
+    int Frame(double frameTime)
+    {
+        Clock.Advance(frameTime);
+        int steps = Timestep.Advance(Clock.GetSeconds());
+        for (int i = 0; i < steps; i++)
+        {
+            PreviousSimulationTime = SimulationTime;
+            SimulationTime += Timestep.GetStep();
+        }
+        TotalSteps += steps;
+        return steps;
+    }
+
+    double GetRenderTime() { return PreviousSimulationTime + (SimulationTime - PreviousSimulationTime) * Timestep.GetAlpha(); }
+};
+
+//Powers of two so every time below is exact and the checks don't need a tolerance
+const double STEP = 1.0 / 64.0;
+
+TEST(FirstFrameOnlyStartsTheClock)
+{
+    SimulatedLoop loop(STEP, 8);
+    loop.Clock.SetSeconds(100.0);
+    CHECK(loop.Timestep.Advance(loop.Clock.GetSeconds()) == 0);
+    CHECK(loop.Timestep.GetAlpha() == 0.0f);
+    CHECK(loop.Frame(STEP) == 1);
+}
+
+TEST(StepCountFollowsElapsedTimeNotFrameRate)
+{
+    //One simulated second at 32, 64, 128 and 256 frames a second all take 64 steps
+    const double frameTimes[] = { 2.0 * STEP, STEP, STEP / 2.0, STEP / 4.0 };
+    for (double frameTime : frameTimes)
+    {
+        SimulatedLoop loop(STEP, 8);
+        loop.Frame(0.0);
+
+        int frames = (int)(1.0 / frameTime);
+        for (int i = 0; i < frames; i++)
+        {
+            int steps = loop.Frame(frameTime);
+            CHECK(steps == (frameTime >= STEP ? (int)(frameTime / STEP) : (i % (int)(STEP / frameTime) == (int)(STEP / frameTime) - 1)));
+        }
+
+        CHECK(loop.TotalSteps == 64);
+        CHECK(loop.SimulationTime == 1.0);
+    }
+}
+
+TEST(LeftoverTimeCarriesIntoTheNextFrame)
+{
+    SimulatedLoop loop(STEP, 8);
+    loop.Frame(0.0);
+
+    //1.5 steps, then 0.75 steps: the half step left over turns the second frame's 0.75 into a whole step
+    CHECK(loop.Frame(STEP * 1.5) == 1);
+    CHECK(loop.Timestep.GetAlpha() == 0.5f);
+    CHECK(loop.Frame(STEP * 0.75) == 1);
+    CHECK(loop.Timestep.GetAlpha() == 0.25f);
+    CHECK(loop.Frame(STEP * 0.25) == 0);
+    CHECK(loop.Timestep.GetAlpha() == 0.5f);
+}
+
+TEST(IrregularFramesAreDeterministic)
+{
+    const double frameTimes[] = { 0.013, 0.021, 0.002, 0.0167, 0.050, 0.0001, 0.033, 0.008 };
+
+    std::vector<int> firstRun;
+    std::vector<int> secondRun;
+    double firstRender = 0.0;
+    double secondRender = 0.0;
+    for (int run = 0; run < 2; run++)
+    {
+        SimulatedLoop loop(1.0 / 120.0, 8);
+        loop.Frame(0.0);
+        for (int repeat = 0; repeat < 50; repeat++)
+        {
+            for (double frameTime : frameTimes)
+            {
+                (run == 0 ? firstRun : secondRun).push_back(loop.Frame(frameTime));
+            }
+        }
+        (run == 0 ? firstRender : secondRender) = loop.GetRenderTime();
+    }
+
+    CHECK(firstRun == secondRun);
+    CHECK(firstRender == secondRender);
+}
+
+TEST(LongStallsAreClampedAndDropped)
+{
+    SimulatedLoop loop(STEP, 8);
+    loop.Frame(0.0);
+
+    //A two second breakpoint takes the maximum steps and throws the rest away instead of catching up
+    CHECK(loop.Frame(2.0) == 8);
+    CHECK(loop.Timestep.GetAlpha() == 0.0f);
+    CHECK(loop.SimulationTime == 8 * STEP);
+    CHECK(loop.Frame(STEP) == 1);
+
+    //Exactly the maximum is not a stall, and the remainder is kept
+    CHECK(loop.Frame(STEP * 8.5) == 8);
+    CHECK(loop.Timestep.GetAlpha() == 0.5f);
+
+    //One step over is
+    CHECK(loop.Frame(STEP * 9.5) == 8);
+    CHECK(loop.Timestep.GetAlpha() == 0.0f);
+}
+
+TEST(AlphaInterpolatesBetweenTheLastTwoSteps)
+{
+    SimulatedLoop loop(STEP, 8);
+    loop.Frame(0.0);
+    loop.Frame(STEP * 3.0);
+    CHECK(loop.PreviousSimulationTime == 2.0 * STEP);
+    CHECK(loop.SimulationTime == 3.0 * STEP);
+
+    //Quarter steps with no whole step in them move rendering a quarter of the way each time, never past the latest step
+    double previousRender = loop.GetRenderTime();
+    CHECK(previousRender == 2.0 * STEP);
+    for (int i = 1; i < 4; i++)
+    {
+        CHECK(loop.Frame(STEP * 0.25) == 0);
+        CHECK(loop.Timestep.GetAlpha() == 0.25f * i);
+        CHECK(loop.GetRenderTime() == (2.0 + 0.25 * i) * STEP);
+        CHECK(loop.GetRenderTime() > previousRender);
+        previousRender = loop.GetRenderTime();
+    }
+
+    CHECK(loop.Frame(STEP * 0.25) == 1);
+    CHECK(loop.Timestep.GetAlpha() == 0.0f);
+    CHECK(loop.GetRenderTime() == 3.0 * STEP);
+}
+
+TEST(AlphaStaysInRangeForAnyFrameTime)
+{
+    SimulatedLoop loop(1.0 / 120.0, 8);
+    loop.Frame(0.0);
+
+    //A fixed LCG rather than rand() so every platform sees the same frame times
+    uint32_t seed = 12345;
+    for (int i = 0; i < 10000; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        loop.Frame((seed >> 8) / (double)(1 << 24) * 0.1);
+
+        float alpha = loop.Timestep.GetAlpha();
+        CHECK(alpha >= 0.0f && alpha < 1.0f);
+    }
+}
+
+TEST(ResyncForgetsIdleTime)
+{
+    SimulatedLoop loop(STEP, 8);
+    loop.Frame(0.0);
+    loop.Frame(STEP * 1.5);
+
+    //Asleep on an idle scene for ten seconds, then woken
+    loop.Clock.Advance(10.0);
+    loop.Timestep.Resync(loop.Clock.GetSeconds());
+    CHECK(loop.Timestep.GetAlpha() == 0.0f);
+    CHECK(loop.Frame(STEP) == 1);
+
+    loop.Timestep.Reset();
+    CHECK(loop.Frame(5.0) == 0);
+    CHECK(loop.Frame(STEP) == 1);
+}
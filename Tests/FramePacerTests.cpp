@@ -0,0 +1,107 @@
+#include "TestFramework.h"
+#include "Clock.h"
+#include "FramePacer.h"
+
+//Powers of two so every time below is exact and the checks don't need a tolerance
+const double INTERVAL = 1.0 / 64.0;
+const double OVERSLEEP = 1.0 / 1024.0;
+
+//The same shape as DX11Framework::WaitForNextFrame: sleep for whatever the pacer says, waking oversleep late, then
+//start the frame. Returns the time the frame started
+static double PacedFrame(FramePacer& pacer, SimulatedClock& clock, double oversleep)
+{
+    double wait = pacer.GetTimeUntilNextFrame(clock.GetSeconds());
+    if (wait > 0.0) clock.Advance(wait + oversleep);
+    pacer.FrameStarted(clock.GetSeconds());
+    return clock.GetSeconds();
+}
+
+TEST(UnlimitedRateNeverWaits)
+{
+    SimulatedClock clock;
+    FramePacer pacer;
+    pacer.SetTargetRate(0.0f);
+    CHECK(pacer.GetTargetRate() == 0.0f);
+
+    for (int frame = 0; frame < 100; frame++)
+    {
+        CHECK(pacer.GetTimeUntilNextFrame(clock.GetSeconds()) == 0.0);
+        pacer.FrameStarted(clock.GetSeconds());
+        clock.Advance(OVERSLEEP * (frame % 3));
+    }
+}
+
+TEST(FirstFrameNeverWaits)
+{
+    SimulatedClock clock;
+    clock.SetSeconds(10.0);
+    FramePacer pacer;
+    pacer.SetTargetRate(64.0f);
+    CHECK(pacer.GetTargetRate() == 64.0f);
+    CHECK(pacer.GetTimeUntilNextFrame(clock.GetSeconds()) == 0.0);
+
+    pacer.FrameStarted(clock.GetSeconds());
+    CHECK(pacer.GetTimeUntilNextFrame(clock.GetSeconds()) == INTERVAL);
+}
+
+TEST(OversleepsDontDriftTheRate)
+{
+    SimulatedClock clock;
+    FramePacer pacer;
+    pacer.SetTargetRate(64.0f);
+    PacedFrame(pacer, clock, OVERSLEEP);
+
+    //Every frame wakes late, but each deadline is a whole interval after the last one rather than after the late
+    //wake, so frame 640 is still 10 seconds in with only the one oversleep on top
+    for (int frame = 1; frame <= 640; frame++)
+    {
+        double started = PacedFrame(pacer, clock, OVERSLEEP);
+        CHECK(started == frame * INTERVAL + OVERSLEEP);
+    }
+    CHECK(clock.GetSeconds() == 10.0 + OVERSLEEP);
+}
+
+TEST(FallingBehindRestartsTheSchedule)
+{
+    SimulatedClock clock;
+    FramePacer pacer;
+    pacer.SetTargetRate(64.0f);
+    for (int frame = 0; frame < 4; frame++) PacedFrame(pacer, clock, 0.0);
+    CHECK(clock.GetSeconds() == 3 * INTERVAL);
+
+    //Half a frame late stays on the schedule, the next frame comes that much sooner
+    clock.Advance(INTERVAL * 1.5);
+    pacer.FrameStarted(clock.GetSeconds());
+    CHECK(pacer.GetTimeUntilNextFrame(clock.GetSeconds()) == INTERVAL * 0.5);
+    PacedFrame(pacer, clock, 0.0);
+    CHECK(clock.GetSeconds() == 5 * INTERVAL);
+
+    //Five frames late starts over from now, instead of the next several frames going out with no wait to catch up
+    clock.Advance(INTERVAL * 6);
+    pacer.FrameStarted(clock.GetSeconds());
+    double restarted = clock.GetSeconds();
+    for (int frame = 1; frame <= 4; frame++)
+    {
+        CHECK(pacer.GetTimeUntilNextFrame(clock.GetSeconds()) == INTERVAL);
+        CHECK(PacedFrame(pacer, clock, 0.0) == restarted + frame * INTERVAL);
+    }
+}
+
+TEST(ResyncDropsTheSchedule)
+{
+    SimulatedClock clock;
+    FramePacer pacer;
+    pacer.SetTargetRate(64.0f);
+    for (int frame = 0; frame < 4; frame++) PacedFrame(pacer, clock, 0.0);
+    CHECK(pacer.GetTimeUntilNextFrame(clock.GetSeconds()) == INTERVAL);
+
+    //After a sleep the next frame goes straight away, and the schedule after it counts from then
+    pacer.Resync();
+    CHECK(pacer.GetTimeUntilNextFrame(clock.GetSeconds()) == 0.0);
+
+    clock.Advance(OVERSLEEP);
+    double resumed = PacedFrame(pacer, clock, 0.0);
+    CHECK(resumed == 3 * INTERVAL + OVERSLEEP);
+    CHECK(pacer.GetTimeUntilNextFrame(clock.GetSeconds()) == INTERVAL);
+    CHECK(PacedFrame(pacer, clock, 0.0) == resumed + INTERVAL);
+}
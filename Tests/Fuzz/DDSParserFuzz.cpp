@@ -0,0 +1,36 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "DDSParser.h"
+
+//libFuzzer entry point over everything DDSParser does with untrusted bytes. Whatever the input, Parse must not read
+//outside it, and a header it accepts must give layouts whose every subresource lies inside the pixel data.
+//Build with Clang and -DDX11FRAMEWORK_FUZZ=ON, or replay inputs through FuzzReplay with any compiler
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    DDSTextureDesc desc;
+    if (DDSParser::Parse(data, size, desc) != DDS_OK) return 0;
+
+    if (desc.DataOffset > size || desc.DataSize > size - desc.DataOffset) abort();
+
+    //Whole, a limit that drops some mips and one that drops all but the smallest
+    const size_t maxSizes[] = { 0, 64, 1 };
+    for (size_t maxSize : maxSizes)
+    {
+        DDSLayout layout;
+        if (DDSParser::GetLayout(desc, maxSize, layout) != DDS_OK) continue;
+
+        if (layout.MipCount == 0 || layout.MipCount + layout.SkippedMips > desc.MipCount) abort();
+        if (layout.Subresources.size() != (size_t)layout.MipCount * desc.ArraySize) abort();
+
+        size_t bytes = 0;
+        for (const DDSSubresource& subresource : layout.Subresources)
+        {
+            if (subresource.Offset < desc.DataOffset || subresource.Offset > size || subresource.Size > size - subresource.Offset) abort();
+            if (subresource.Width == 0 || subresource.Height == 0) abort();
+            bytes += subresource.Size;
+        }
+        if (bytes != layout.Bytes) abort();
+    }
+
+    return 0;
+}
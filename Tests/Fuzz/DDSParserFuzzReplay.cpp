@@ -0,0 +1,129 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "DDSParser.h"
+
+//Stands in for libFuzzer's driver where it isn't available, so the fuzz target runs under ctest with any compiler.
+//Seeds are the files given plus headers written for formats and shapes the shipped textures don't cover, then each
+//seed's headers are mutated from a fixed starting state so a failure repeats run to run
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+const size_t MUTATIONS_PER_SEED = 20000;
+const size_t HEADER_BYTES = 148; //Magic, DDS_HEADER and the DX10 extension
+const size_t MAX_TRUNCATED_COPY = 1 << 16;
+
+static uint32_t Next(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static void Mutate(uint8_t* data, size_t span, uint32_t& state)
+{
+    int edits = 1 + Next(state) % 4;
+    for (int i = 0; i < edits; i++)
+    {
+        size_t at = Next(state) % span;
+        switch (Next(state) % 4)
+        {
+        case 0: data[at] ^= (uint8_t)(1 << (Next(state) % 8)); break;
+        case 1: data[at] = (uint8_t)Next(state); break;
+        case 2: data[at] = (Next(state) & 1) ? 0xFF : 0x00; break;
+        default:
+            //Header fields are 32 bit, so write whole interesting values over one
+            if (at + 4 <= span)
+            {
+                const uint32_t values[] = { 0, 1, 6, 2048, 16384, 16385, 0x7FFFFFFF, 0xFFFFFFFF };
+                uint32_t value = values[Next(state) % 8];
+                memcpy(data + at, &value, sizeof(value));
+            }
+            break;
+        }
+    }
+}
+
+static std::vector<uint8_t> MakeSeed(DDSDimension dimension, DDSFormat format, uint32_t width, uint32_t height, uint32_t depth,
+    uint32_t mipCount, uint32_t arraySize, bool cubeMap)
+{
+    DDSTextureDesc desc;
+    desc.Dimension = dimension;
+    desc.Format = format;
+    desc.Width = width;
+    desc.Height = height;
+    desc.Depth = depth;
+    desc.MipCount = mipCount;
+    desc.ArraySize = arraySize;
+    desc.IsCubeMap = cubeMap;
+
+    std::vector<uint8_t> seed;
+    desc.DataOffset = DDSParser::WriteHeader(desc, seed);
+    desc.DataSize = SIZE_MAX - desc.DataOffset;
+
+    DDSLayout layout;
+    if (DDSParser::GetLayout(desc, 0, layout) == DDS_OK) seed.resize(seed.size() + layout.Bytes, 0x5A);
+    return seed;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::vector<uint8_t>> seeds;
+    seeds.push_back(MakeSeed(DDS_DIMENSION_TEXTURE2D, DDS_FORMAT_BC1_UNORM, 256, 256, 1, 9, 1, false));
+    seeds.push_back(MakeSeed(DDS_DIMENSION_TEXTURE2D, DDS_FORMAT_BC7_UNORM_SRGB, 64, 32, 1, 7, 3, false));
+    seeds.push_back(MakeSeed(DDS_DIMENSION_TEXTURE2D, DDS_FORMAT_BC5_UNORM, 30, 18, 1, 5, 1, false));
+    seeds.push_back(MakeSeed(DDS_DIMENSION_TEXTURE2D, DDS_FORMAT_R8G8B8A8_UNORM, 32, 32, 1, 6, 6, true));
+    seeds.push_back(MakeSeed(DDS_DIMENSION_TEXTURE3D, DDS_FORMAT_R16G16B16A16_FLOAT, 16, 16, 8, 5, 1, false));
+    seeds.push_back(MakeSeed(DDS_DIMENSION_TEXTURE1D, DDS_FORMAT_R8_UNORM, 128, 1, 1, 8, 2, false));
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file.good())
+        {
+            printf("Couldn't read %s\n", argv[i]);
+            return 1;
+        }
+        seeds.emplace_back((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    uint32_t state = 0x9E3779B9;
+    size_t runs = 0;
+    size_t accepted = 0;
+    for (std::vector<uint8_t>& seed : seeds)
+    {
+        DDSTextureDesc desc;
+        if (DDSParser::Parse(seed.data(), seed.size(), desc) == DDS_OK) accepted++;
+        LLVMFuzzerTestOneInput(seed.data(), seed.size());
+
+        //Headers are mutated in place and put back, large seeds are too big to copy for every run
+        size_t span = seed.size() < HEADER_BYTES ? seed.size() : HEADER_BYTES;
+        std::vector<uint8_t> header(seed.begin(), seed.begin() + span);
+        for (size_t m = 0; m < MUTATIONS_PER_SEED && span > 0; m++)
+        {
+            Mutate(seed.data(), span, state);
+
+            //Some runs cut the file short instead, copied to a buffer of exactly that size so ASan sees a read past its end
+            if (Next(state) % 8 == 0)
+            {
+                size_t limit = seed.size() < MAX_TRUNCATED_COPY ? seed.size() : MAX_TRUNCATED_COPY;
+                std::vector<uint8_t> truncated(seed.begin(), seed.begin() + Next(state) % (limit + 1));
+                truncated.shrink_to_fit();
+                LLVMFuzzerTestOneInput(truncated.data(), truncated.size());
+            }
+            else
+            {
+                LLVMFuzzerTestOneInput(seed.data(), seed.size());
+            }
+
+            memcpy(seed.data(), header.data(), span);
+            runs++;
+        }
+    }
+
+    printf("%zu of %zu seeds parse, %zu mutated inputs ran\n", accepted, seeds.size(), runs);
+    return accepted == seeds.size() ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "JobSystem.h"
+
+//Micro-benchmarks for the job system, built next to the tests but not run by ctest since timings aren't pass or fail.
+//Benchmark mode in the app reports the same spawn and ParallelFor numbers for the machine it runs on
+
+static double GetSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//Empty jobs, so this is purely the cost of allocating, queueing, stealing and counting a job
+static double MeasureSpawn(JobSystem& jobSystem, int jobCount, JobCounter* dependency)
+{
+    JobCounter counter;
+    double start = GetSeconds();
+    for (int i = 0; i < jobCount; i++)
+    {
+        jobSystem.Run([]() {}, &counter, dependency);
+    }
+    jobSystem.Wait(&counter);
+    return (GetSeconds() - start) * 1e9 / jobCount;
+}
+
+static double MeasureParallelFor(JobSystem& jobSystem, std::vector<float>& items, uint32_t batchSize)
+{
+    double start = GetSeconds();
+    jobSystem.ParallelFor((uint32_t)items.size(), batchSize, [&items](uint32_t first, uint32_t end)
+    {
+        for (uint32_t i = first; i < end; i++)
+        {
+            items[i] = sqrtf(items[i] * items[i] + 1.0f);
+        }
+    });
+    return (GetSeconds() - start) * 1000.0;
+}
+
+int main()
+{
+    const int spawnCount = 200000;
+    const uint32_t itemCount = 1 << 22;
+    std::vector<float> items(itemCount, 2.0f);
+
+    int maxWorkers = (int)std::thread::hardware_concurrency() - 1;
+    if (maxWorkers < 1) maxWorkers = 1;
+
+    //Not initialised, ParallelFor runs the loop on the calling thread
+    JobSystem serial;
+    double serialTime = MeasureParallelFor(serial, items, 16384);
+    printf("Serial loop over 4M items: %.2f ms\n\n", serialTime);
+
+    std::vector<int> workerCounts;
+    for (int workers = 1; workers < maxWorkers; workers *= 2) workerCounts.push_back(workers);
+    workerCounts.push_back(maxWorkers);
+
+    //Threads counts the calling thread as well as the workers, it runs jobs too while it waits
+    printf("%8s %14s %14s %14s %14s %10s\n", "Threads", "Spawn (ns)", "Outside (ns)", "Parked (ns)", "ParallelFor", "Speed up");
+    for (int workers : workerCounts)
+    {
+        JobSystem jobSystem;
+        jobSystem.Initialise(workers);
+
+        double spawn = MeasureSpawn(jobSystem, spawnCount, nullptr);
+
+        //From a thread with no deque of its own, so every job goes through the shared queue
+        double outside = 0.0;
+        std::thread producer([&]() { outside = MeasureSpawn(jobSystem, spawnCount, nullptr); });
+        producer.join();
+
+        //Every job parked on a counter held open by one slow job, then released together
+        JobCounter gate;
+        jobSystem.Run([]() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }, &gate);
+        double parked = MeasureSpawn(jobSystem, spawnCount, &gate);
+
+        double parallelTime = MeasureParallelFor(jobSystem, items, 16384);
+        printf("%8d %14.1f %14.1f %14.1f %11.2f ms %9.2fx\n", workers + 1, spawn, outside, parked, parallelTime,
+            parallelTime > 0.0 ? serialTime / parallelTime : 0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+#include "TestFramework.h"
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "JobSystem.h"
+
+//Stress tests meant to be run under ThreadSanitizer as well as plainly:
+//  cmake -S Tests -B build-tsan -DDX11FRAMEWORK_SANITIZER=thread
+
+TEST(EveryJobRunsOnce)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialise(4);
+
+    const int jobCount = 20000;
+    std::vector<std::atomic<int>> runs(jobCount);
+    for (std::atomic<int>& run : runs) run = 0;
+
+    JobCounter counter;
+    for (int i = 0; i < jobCount; i++)
+    {
+        jobSystem.Run([&runs, i]() { runs[i]++; }, &counter);
+    }
+    jobSystem.Wait(&counter);
+
+    bool allOnce = true;
+    for (std::atomic<int>& run : runs) allOnce &= run.load() == 1;
+    CHECK(allOnce);
+    CHECK(counter.IsDone());
+}
+
+TEST(JobsRunFromOutsideThreads)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialise(3);
+
+    //These go through the shared queue since the threads have no deque of their own
+    std::atomic<int> total{ 0 };
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++)
+    {
+        producers.emplace_back([&jobSystem, &total]()
+        {
+            JobCounter counter;
+            for (int i = 0; i < 2000; i++)
+            {
+                jobSystem.Run([&total]() { total++; }, &counter);
+            }
+            jobSystem.Wait(&counter);
+        });
+    }
+    for (std::thread& producer : producers) producer.join();
+
+    CHECK(total.load() == 8000);
+}
+
+TEST(NestedJobsAndWaits)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialise(4);
+
+    //Jobs spawning and waiting on their own children, so workers Wait while running a job and steal each other's children
+    std::atomic<int> leaves{ 0 };
+    JobCounter outer;
+    for (int i = 0; i < 64; i++)
+    {
+        jobSystem.Run([&jobSystem, &leaves]()
+        {
+            JobCounter inner;
+            for (int j = 0; j < 64; j++)
+            {
+                jobSystem.Run([&leaves]() { leaves++; }, &inner);
+            }
+            jobSystem.Wait(&inner);
+        }, &outer);
+    }
+    jobSystem.Wait(&outer);
+
+    CHECK(leaves.load() == 64 * 64);
+}
+
+TEST(ParallelForCoversEveryIndexOnce)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialise(4);
+
+    const uint32_t counts[] = { 0, 1, 7, 64, 1000, 100003 };
+    const uint32_t batchSizes[] = { 0, 1, 3, 64, 4096, 200000 };
+    for (uint32_t count : counts)
+    {
+        for (uint32_t batchSize : batchSizes)
+        {
+            std::unique_ptr<std::atomic<int>[]> hits(new std::atomic<int>[count + 1]);
+            for (uint32_t i = 0; i < count; i++) hits[i] = 0;
+
+            jobSystem.ParallelFor(count, batchSize, [&hits](uint32_t start, uint32_t end)
+            {
+                for (uint32_t i = start; i < end; i++) hits[i]++;
+            });
+
+            bool allOnce = true;
+            for (uint32_t i = 0; i < count; i++) allOnce &= hits[i].load() == 1;
+            CHECK(allOnce);
+        }
+    }
+}
+
+TEST(DependentsWaitForTheirCounter)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialise(4);
+
+    //Chains of stages, each stage's jobs depend on the whole of the stage before
+    const int chainCount = 16;
+    const int stageCount = 8;
+    const int jobsPerStage = 16;
+    std::vector<std::unique_ptr<JobCounter>> stages;
+    std::vector<std::unique_ptr<std::atomic<int>>> finished;
+    std::atomic<int> orderViolations{ 0 };
+
+    for (int chain = 0; chain < chainCount; chain++)
+    {
+        for (int stage = 0; stage < stageCount; stage++)
+        {
+            stages.emplace_back(new JobCounter());
+            finished.emplace_back(new std::atomic<int>(0));
+        }
+    }
+
+    for (int stage = 0; stage < stageCount; stage++)
+    {
+        for (int chain = 0; chain < chainCount; chain++)
+        {
+            int index = chain * stageCount + stage;
+            JobCounter* dependency = stage > 0 ? stages[index - 1].get() : nullptr;
+            std::atomic<int>* previous = stage > 0 ? finished[index - 1].get() : nullptr;
+            std::atomic<int>* current = finished[index].get();
+
+            for (int j = 0; j < jobsPerStage; j++)
+            {
+                jobSystem.Run([previous, current, &orderViolations]()
+                {
+                    if (previous && previous->load() != jobsPerStage) orderViolations++;
+                    (*current)++;
+                }, stages[index].get(), dependency);
+            }
+        }
+    }
+
+    for (std::unique_ptr<JobCounter>& stage : stages)
+    {
+        jobSystem.Wait(stage.get());
+    }
+
+    CHECK(orderViolations.load() == 0);
+    bool allRan = true;
+    for (std::unique_ptr<std::atomic<int>>& count : finished) allRan &= count->load() == jobsPerStage;
+    CHECK(allRan);
+}
+
+TEST(ParkedDependentsDontSpin)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialise(4);
+
+    //Hold a counter open with a job blocked on a future, which sleeps rather than spins
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    JobCounter gate;
+    jobSystem.Run([released]() { released.wait(); }, &gate);
+
+    std::atomic<int> ran{ 0 };
+    JobCounter dependents;
+    for (int i = 0; i < 1000; i++)
+    {
+        jobSystem.Run([&ran]() { ran++; }, &dependents, &gate);
+    }
+
+    //With the dependents parked there is nothing queued, so the idle workers should be asleep and use next to no CPU.
+    //Re-queueing blocked jobs kept every idle worker busy for the whole wait
+    clock_t cpuStart = clock();
+    auto wallStart = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    double cpuSeconds = (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    CHECK(ran.load() == 0);
+    CHECK(cpuSeconds < wallSeconds * 0.5);
+
+    release.set_value();
+    jobSystem.Wait(&dependents);
+    CHECK(ran.load() == 1000);
+}
+
+TEST(DependencyAlreadyDoneRunsStraightAway)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialise(2);
+
+    JobCounter done;
+    std::atomic<int> ran{ 0 };
+    JobCounter counter;
+    jobSystem.Run([&ran]() { ran++; }, &counter, &done);
+    jobSystem.Wait(&counter);
+    CHECK(ran.load() == 1);
+    CHECK(done.Dependents.empty());
+}
+
+TEST(CountersCanBeReused)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialise(4);
+
+    //Stack counters made, waited on and destroyed as fast as possible, Wait must not return while the finishing job still uses one
+    std::atomic<int> total{ 0 };
+    for (int i = 0; i < 2000; i++)
+    {
+        JobCounter first;
+        JobCounter second;
+        jobSystem.Run([&total]() { total++; }, &first);
+        jobSystem.Run([&total]() { total++; }, &second, &first);
+        jobSystem.Wait(&second);
+        jobSystem.Wait(&first);
+    }
+    CHECK(total.load() == 4000);
+}
+
+TEST(ShutdownFinishesOutstandingJobs)
+{
+    std::atomic<int> ran{ 0 };
+    JobCounter gate;
+    JobCounter counter;
+    {
+        JobSystem jobSystem;
+        jobSystem.Initialise(2);
+        for (int i = 0; i < 500; i++)
+        {
+            jobSystem.Run([&ran]() { ran++; }, &gate);
+            jobSystem.Run([&ran]() { ran++; }, &counter, &gate);
+        }
+        jobSystem.Shutdown();
+    }
+
+    CHECK(ran.load() == 1000);
+    CHECK(gate.IsDone());
+    CHECK(counter.IsDone());
+}
+
+TEST(UninitialisedSystemRunsInline)
+{
+    JobSystem jobSystem;
+    int value = 0;
+    JobCounter counter;
+    jobSystem.Run([&value]() { value = 1; }, &counter);
+    CHECK(value == 1);
+    CHECK(counter.IsDone());
+
+    uint32_t total = 0;
+    jobSystem.ParallelFor(100, 10, [&total](uint32_t start, uint32_t end) { total += end - start; });
+    CHECK(total == 100);
+}
+
+TEST(StealingTakesEachJobOnce)
+{
+    //The deque on its own: the owner pushes and pops while thieves steal, every job must come out exactly once
+    const int jobCount = 200000;
+    std::vector<Job> jobs(jobCount);
+    std::vector<std::atomic<int>> taken(jobCount);
+    for (std::atomic<int>& take : taken) take = 0;
+
+    WorkStealingQueue queue;
+    std::atomic<bool> producing{ true };
+    auto take = [&jobs, &taken](Job* job) { taken[job - jobs.data()]++; };
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; t++)
+    {
+        thieves.emplace_back([&queue, &producing, &take]()
+        {
+            while (producing.load())
+            {
+                if (Job* job = queue.Steal()) take(job);
+            }
+            while (Job* job = queue.Steal()) take(job);
+        });
+    }
+
+    for (int i = 0; i < jobCount; i++)
+    {
+        while (!queue.Push(&jobs[i]))
+        {
+            if (Job* job = queue.Pop()) take(job);
+        }
+        if (i % 3 == 0)
+        {
+            if (Job* job = queue.Pop()) take(job);
+        }
+    }
+    while (Job* job = queue.Pop()) take(job);
+
+    producing = false;
+    for (std::thread& thief : thieves) thief.join();
+
+    bool allOnce = true;
+    for (std::atomic<int>& count : taken) allOnce &= count.load() == 1;
+    CHECK(allOnce);
+}
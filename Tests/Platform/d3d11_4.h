@@ -0,0 +1,23 @@
+#pragma once
+
+//Stand-in for the Windows SDK header so framework headers that hold D3D pointers compile for the tests off Windows.
+//The interfaces only have AddRef and Release, tests derive fakes from them to count what gets released
+#include <stdint.h>
+
+typedef unsigned int UINT;
+typedef unsigned long ULONG;
+typedef long HRESULT;
+
+struct IUnknown
+{
+	virtual ULONG AddRef() = 0;
+	virtual ULONG Release() = 0;
+
+protected:
+	~IUnknown() = default;
+};
+
+struct ID3D11DeviceChild : IUnknown {};
+struct ID3D11Buffer : ID3D11DeviceChild {};
+struct ID3D11ShaderResourceView : ID3D11DeviceChild {};
+struct ID3D11Device : IUnknown {};
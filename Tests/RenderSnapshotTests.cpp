@@ -0,0 +1,257 @@
+#include "TestFramework.h"
+#include <functional>
+#include <vector>
+#include "JobSystem.h"
+#include "RenderSnapshot.h"
+
+//Every field the writer stamps with the frame it is writing, so a reader that mixes two frames sees different stamps
+const size_t OBJECT_COUNT = 2;
+
+typedef std::function<void()> Step;
+
+//What one interleaving of a frame's update and render showed the render side
+struct ReadResult
+{
+    bool CompleteAtStart = false;
+    uint64_t FrameIndex = 0;
+    uint64_t SealedFrameIndexAtEnd = 0; //A write that started and finished mid read still leaves the snapshot complete, just a different frame
+    std::vector<float> Stamps;
+
+    //Every stamp read came from the one complete frame the snapshot says it holds
+    bool IsConsistent(uint64_t expectedFrame) const
+    {
+        if (!CompleteAtStart || FrameIndex != expectedFrame || SealedFrameIndexAtEnd != FrameIndex) return false;
+        for (float stamp : Stamps)
+        {
+            if (stamp != (float)expectedFrame) return false;
+        }
+        return Stamps.size() == 3 + OBJECT_COUNT;
+    }
+};
+
+//Update split into one step per field, the same fields DX11Framework::Update fills in
+static std::vector<Step> MakeWriterSteps(std::function<RenderSnapshot&()> begin, std::function<void()> end, uint64_t frame, RenderSnapshot** written)
+{
+    std::vector<Step> steps;
+    steps.push_back([begin, written]() { *written = &begin(); });
+    steps.push_back([written, frame]() { (*written)->View._11 = (float)frame; });
+    steps.push_back([written, frame]() { (*written)->Projection._11 = (float)frame; });
+    steps.push_back([written, frame]() { (*written)->Count = (float)frame; (*written)->Objects.resize(OBJECT_COUNT); });
+    for (size_t i = 0; i < OBJECT_COUNT; i++)
+    {
+        steps.push_back([written, frame, i]() { (*written)->Objects[i].World._11 = (float)frame; });
+    }
+    steps.push_back(end);
+    return steps;
+}
+
+//Draw split into one step per field it reads
+static std::vector<Step> MakeReaderSteps(std::function<const RenderSnapshot&()> begin, std::function<void()> end, const RenderSnapshot** read, ReadResult* result)
+{
+    std::vector<Step> steps;
+    steps.push_back([begin, read, result]()
+    {
+        *read = &begin();
+        result->CompleteAtStart = (*read)->IsComplete();
+        result->FrameIndex = (*read)->FrameIndex;
+    });
+    steps.push_back([read, result]() { result->Stamps.push_back((*read)->View._11); });
+    steps.push_back([read, result]() { result->Stamps.push_back((*read)->Projection._11); });
+    steps.push_back([read, result]() { result->Stamps.push_back((*read)->Count); });
+    for (size_t i = 0; i < OBJECT_COUNT; i++)
+    {
+        steps.push_back([read, result, i]()
+        {
+            if (i < (*read)->Objects.size()) result->Stamps.push_back((*read)->Objects[i].World._11);
+        });
+    }
+    steps.push_back([read, result, end]()
+    {
+        result->SealedFrameIndexAtEnd = (*read)->SealedFrameIndex;
+        end();
+    });
+    return steps;
+}
+
+//Calls visit with every way of merging writerSteps and readerSteps that keeps each side's own order,
+//as a list of which side moves next
+static void ForEachInterleaving(size_t writerSteps, size_t readerSteps, const std::function<void(const std::vector<bool>&)>& visit)
+{
+    std::vector<bool> order;
+    std::function<void(size_t, size_t)> build = [&](size_t writer, size_t reader)
+    {
+        if (writer == writerSteps && reader == readerSteps)
+        {
+            visit(order);
+            return;
+        }
+        if (writer < writerSteps)
+        {
+            order.push_back(true);
+            build(writer + 1, reader);
+            order.pop_back();
+        }
+        if (reader < readerSteps)
+        {
+            order.push_back(false);
+            build(writer, reader + 1);
+            order.pop_back();
+        }
+    };
+    build(0, 0);
+}
+
+static void RunInterleaved(const std::vector<Step>& writer, const std::vector<Step>& reader, const std::vector<bool>& order)
+{
+    size_t writerStep = 0;
+    size_t readerStep = 0;
+    for (bool writerMoves : order)
+    {
+        if (writerMoves) writer[writerStep++]();
+        else reader[readerStep++]();
+    }
+}
+
+//Frame 1 primes the buffer the way the app's first frame does, update then swap then draw
+static void PrimeFirstFrame(SnapshotBuffer& buffer)
+{
+    RenderSnapshot* written = nullptr;
+    std::vector<Step> steps = MakeWriterSteps([&buffer]() -> RenderSnapshot& { return buffer.BeginWrite(1); }, [&buffer]() { buffer.EndWrite(); }, 1, &written);
+    for (Step& step : steps) step();
+    buffer.Swap();
+}
+
+TEST(FreshBufferHasNothingToDraw)
+{
+    SnapshotBuffer buffer;
+    CHECK(!buffer.GetReadSnapshot().IsComplete());
+
+    PrimeFirstFrame(buffer);
+    CHECK(buffer.GetReadSnapshot().IsComplete());
+    CHECK(buffer.GetReadSnapshot().FrameIndex == 1);
+
+    buffer.Reset();
+    CHECK(!buffer.GetReadSnapshot().IsComplete());
+    CHECK(buffer.GetReadSnapshot().Objects.empty());
+}
+
+TEST(SnapshotIsOnlyCompleteOnceWritten)
+{
+    SnapshotBuffer buffer;
+    RenderSnapshot& snapshot = buffer.BeginWrite(7);
+    CHECK(!snapshot.IsComplete());
+    buffer.EndWrite();
+    CHECK(snapshot.IsComplete());
+
+    //Writing it again for a later frame unseals it until that write ends
+    buffer.Swap();
+    buffer.Swap();
+    RenderSnapshot& again = buffer.BeginWrite(9);
+    CHECK(&again == &snapshot);
+    CHECK(!again.IsComplete());
+    buffer.EndWrite();
+    CHECK(again.IsComplete() && again.FrameIndex == 9);
+}
+
+TEST(EveryInterleavingOfUpdateAndDrawSeesWholeFrames)
+{
+    //Frame N+1's update against frame N's draw, in every order the two stages' steps could run in,
+    //for several frames so both halves of the buffer are written and read
+    size_t interleavings = 0;
+    size_t torn = 0;
+    for (uint64_t frame = 2; frame <= 4; frame++)
+    {
+        std::vector<bool> firstOrder;
+        ForEachInterleaving(3 + OBJECT_COUNT + 2, 3 + OBJECT_COUNT + 2, [&](const std::vector<bool>& order)
+        {
+            SnapshotBuffer buffer;
+            PrimeFirstFrame(buffer);
+            for (uint64_t previous = 2; previous < frame; previous++)
+            {
+                RenderSnapshot* written = nullptr;
+                ReadResult ignored;
+                const RenderSnapshot* read = nullptr;
+                for (Step& step : MakeWriterSteps([&]() -> RenderSnapshot& { return buffer.BeginWrite(previous); }, [&]() { buffer.EndWrite(); }, previous, &written)) step();
+                for (Step& step : MakeReaderSteps([&]() -> const RenderSnapshot& { return buffer.BeginRead(); }, [&]() { buffer.EndRead(); }, &read, &ignored)) step();
+                buffer.Swap();
+            }
+
+            RenderSnapshot* written = nullptr;
+            const RenderSnapshot* read = nullptr;
+            ReadResult result;
+            std::vector<Step> writer = MakeWriterSteps([&]() -> RenderSnapshot& { return buffer.BeginWrite(frame); }, [&]() { buffer.EndWrite(); }, frame, &written);
+            std::vector<Step> reader = MakeReaderSteps([&]() -> const RenderSnapshot& { return buffer.BeginRead(); }, [&]() { buffer.EndRead(); }, &read, &result);
+            RunInterleaved(writer, reader, order);
+
+            interleavings++;
+            if (!result.IsConsistent(frame - 1) || written == read) torn++;
+
+            //Once both are done the swap publishes the frame just written
+            buffer.Swap();
+            if (!buffer.GetReadSnapshot().IsComplete() || buffer.GetReadSnapshot().FrameIndex != frame) torn++;
+        });
+    }
+
+    CHECK(interleavings == 3 * 3432);
+    CHECK(torn == 0);
+}
+
+TEST(OneSharedSnapshotWouldTear)
+{
+    //The same interleavings with update and draw on one snapshot, which is what the double buffer prevents.
+    //Shows the check above can see a torn frame when there is one
+    size_t torn = 0;
+    ForEachInterleaving(3 + OBJECT_COUNT + 2, 3 + OBJECT_COUNT + 2, [&](const std::vector<bool>& order)
+    {
+        RenderSnapshot shared;
+        RenderSnapshot* written = nullptr;
+        const RenderSnapshot* read = nullptr;
+        ReadResult result;
+
+        std::vector<Step> prime = MakeWriterSteps([&]() -> RenderSnapshot& { shared.SealedFrameIndex = 0; shared.FrameIndex = 1; return shared; },
+            [&]() { shared.SealedFrameIndex = shared.FrameIndex; }, 1, &written);
+        for (Step& step : prime) step();
+
+        std::vector<Step> writer = MakeWriterSteps([&]() -> RenderSnapshot& { shared.SealedFrameIndex = 0; shared.FrameIndex = 2; return shared; },
+            [&]() { shared.SealedFrameIndex = shared.FrameIndex; }, 2, &written);
+        std::vector<Step> reader = MakeReaderSteps([&]() -> const RenderSnapshot& { return shared; }, []() {}, &read, &result);
+        RunInterleaved(writer, reader, order);
+
+        if (!result.IsConsistent(1)) torn++;
+    });
+
+    //Only the orders where one stage runs entirely before the other get a whole frame
+    CHECK(torn == 3432 - 1);
+}
+
+TEST(PipelinedFramesOnTheJobSystem)
+{
+    //The app's loop with real threads: update on a job while this thread draws, then swap once both are done.
+    //Built with -DDX11FRAMEWORK_SANITIZER=thread any overlap on one snapshot is reported as a race
+    JobSystem jobSystem;
+    jobSystem.Initialise(2);
+
+    SnapshotBuffer buffer;
+    PrimeFirstFrame(buffer);
+
+    int bad = 0;
+    for (uint64_t frame = 2; frame < 2000; frame++)
+    {
+        JobCounter updateDone;
+        RenderSnapshot* written = nullptr;
+        jobSystem.Run([&buffer, &written, frame]()
+        {
+            for (Step& step : MakeWriterSteps([&]() -> RenderSnapshot& { return buffer.BeginWrite(frame); }, [&]() { buffer.EndWrite(); }, frame, &written)) step();
+        }, &updateDone);
+
+        const RenderSnapshot* read = nullptr;
+        ReadResult result;
+        for (Step& step : MakeReaderSteps([&]() -> const RenderSnapshot& { return buffer.BeginRead(); }, [&]() { buffer.EndRead(); }, &read, &result)) step();
+
+        jobSystem.Wait(&updateDone);
+        if (!result.IsConsistent(frame - 1)) bad++;
+        buffer.Swap();
+    }
+
+    CHECK(bad == 0);
+}
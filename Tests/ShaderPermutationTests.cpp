@@ -0,0 +1,103 @@
+#include "TestFramework.h"
+#include <string>
+#include "RenderQueue.h"
+#include "ShaderPermutation.h"
+
+TEST(PermutationKeysAreTheFeatureBits)
+{
+    CHECK(MakePermutationKey(false, false, false) == 0);
+    CHECK(MakePermutationKey(true, false, false) == SHADER_TEXTURED);
+    CHECK(MakePermutationKey(false, true, false) == SHADER_SPECULAR);
+    CHECK(MakePermutationKey(false, false, true) == SHADER_NORMAL_MAP);
+    CHECK(MakePermutationKey(true, true, true) == (SHADER_TEXTURED | SHADER_SPECULAR | SHADER_NORMAL_MAP));
+
+    //Every combination is its own variant and indexes inside the compiled shader array
+    bool seen[SHADER_PERMUTATION_COUNT] = {};
+    for (int i = 0; i < 8; i++)
+    {
+        PermutationKey key = MakePermutationKey((i & 1) != 0, (i & 2) != 0, (i & 4) != 0);
+        CHECK(key < (PermutationKey)SHADER_PERMUTATION_COUNT);
+        CHECK(!seen[key]);
+        seen[key] = true;
+
+        CHECK(HasFeature(key, SHADER_TEXTURED) == ((i & 1) != 0));
+        CHECK(HasFeature(key, SHADER_SPECULAR) == ((i & 2) != 0));
+        CHECK(HasFeature(key, SHADER_NORMAL_MAP) == ((i & 4) != 0));
+        CHECK(!HasFeature(key, SHADER_TEXTURE_ARRAY));
+    }
+}
+
+TEST(DefinesAreInBitOrder)
+{
+    CHECK(SHADER_PERMUTATION_COUNT == 16);
+    for (int i = 0; i < SHADER_FEATURE_COUNT; i++)
+    {
+        CHECK(GetPermutationDefine(i) != nullptr);
+    }
+
+    CHECK(SHADER_TEXTURED == 1u << 0 && std::string(GetPermutationDefine(0)) == "HAS_TEXTURE");
+    CHECK(SHADER_SPECULAR == 1u << 1 && std::string(GetPermutationDefine(1)) == "HAS_SPECULAR");
+    CHECK(SHADER_NORMAL_MAP == 1u << 2 && std::string(GetPermutationDefine(2)) == "HAS_NORMAL_MAP");
+    CHECK(SHADER_TEXTURE_ARRAY == 1u << 3 && std::string(GetPermutationDefine(3)) == "HAS_TEXTURE_ARRAY");
+}
+
+TEST(SortKeyFieldsSitWhereTheLayoutSays)
+{
+    //[63..60 permutation][59..40 texture][39..20 mesh][19..0 depth]
+    CHECK(MakeSortKey(SHADER_TEXTURE_ARRAY, 0, 0, 0) == 1ull << 63);
+    CHECK(MakeSortKey(SHADER_TEXTURED, 0, 0, 0) == 1ull << 60);
+    CHECK(MakeSortKey(0, 1, 0, 0) == 1ull << 40);
+    CHECK(MakeSortKey(0, 0, 1, 0) == 1ull << 20);
+    CHECK(MakeSortKey(0, 0, 0, 1) == 1ull);
+
+    CHECK(MakeSortKey(0xF, 0, 0, 0) == 0xF000000000000000ull);
+    CHECK(MakeSortKey(0, 0xFFFFF, 0, 0) == 0x0FFFFF0000000000ull);
+    CHECK(MakeSortKey(0, 0, 0xFFFFF, 0) == 0x000000FFFFF00000ull);
+    CHECK(MakeSortKey(0, 0, 0, 0xFFFFF) == 0x00000000000FFFFFull);
+
+    //Every permutation, including the texture array bit, comes back out
+    for (PermutationKey key = 0; key < (PermutationKey)SHADER_PERMUTATION_COUNT; key++)
+    {
+        CHECK(GetSortKeyPermutation(MakeSortKey(key, 0xFFFFF, 0xFFFFF, 0xFFFFF)) == key);
+    }
+}
+
+TEST(SortKeyFieldsDontSpillIntoEachOther)
+{
+    CHECK(MakeSortKey(0, 0, 0, 0xFFFFFFFF) == 0xFFFFFull);
+    CHECK(MakeSortKey(0, 0, 0xFFFFFFFF, 0) == 0xFFFFFull << 20);
+    CHECK(MakeSortKey(0, 0xFFFFFFFF, 0, 0) == 0xFFFFFull << 40);
+    CHECK(MakeSortKey(0xFFFFFFFF, 0, 0, 0) == 0xFull << 60);
+    CHECK(GetSortKeyPermutation(MakeSortKey(0x13, 0, 0, 0)) == 0x3);
+}
+
+TEST(SortKeysOrderPermutationThenTextureThenMeshThenDepth)
+{
+    CHECK(MakeSortKey(0, 0xFFFFF, 0xFFFFF, 0xFFFFF) < MakeSortKey(1, 0, 0, 0));
+    CHECK(MakeSortKey(SHADER_NORMAL_MAP, 0xFFFFF, 0xFFFFF, 0xFFFFF) < MakeSortKey(SHADER_TEXTURE_ARRAY, 0, 0, 0));
+    CHECK(MakeSortKey(1, 0, 0xFFFFF, 0xFFFFF) < MakeSortKey(1, 1, 0, 0));
+    CHECK(MakeSortKey(1, 1, 0, 0xFFFFF) < MakeSortKey(1, 1, 1, 0));
+    CHECK(MakeSortKey(1, 1, 1, 0) < MakeSortKey(1, 1, 1, 1));
+}
+
+TEST(RenderQueueGroupsByPermutationAndKeepsSubmissionOrder)
+{
+    RenderQueue queue;
+    queue.Add(MakeSortKey(SHADER_TEXTURED, 2, 0, 0), 0);
+    queue.Add(MakeSortKey(0, 7, 0, 0), 1);
+    queue.Add(MakeSortKey(SHADER_TEXTURED, 1, 0, 0), 2);
+    queue.Add(MakeSortKey(0, 7, 0, 0), 3);
+    queue.Add(MakeSortKey(SHADER_TEXTURED | SHADER_TEXTURE_ARRAY, 0, 0, 0), 4);
+    queue.Add(MakeSortKey(SHADER_TEXTURED, 2, 0, 0), 5);
+    queue.Sort();
+
+    const uint32_t expected[] = { 1, 3, 2, 0, 5, 4 };
+    CHECK(queue.GetCount() == 6);
+    for (size_t i = 0; i < queue.GetCount(); i++)
+    {
+        CHECK(queue[i].ObjectIndex == expected[i]);
+    }
+
+    queue.Clear();
+    CHECK(queue.GetCount() == 0);
+}
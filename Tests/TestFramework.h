@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+
+//Tests register themselves before main runs, TestMain.cpp runs every one linked into the executable and
+//returns non-zero if any check failed, which is all ctest needs
+struct TestCase
+{
+	const char* Name;
+	void(*Function)();
+};
+
+std::vector<TestCase>& GetTests();
+void ReportFailure(const char* file, int line, const char* expression);
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* name, void(*function)()) { GetTests().push_back({ name, function }); }
+};
+
+#define TEST(name) \
+	static void name(); \
+	static TestRegistrar name##Registrar(#name, name); \
+	static void name()
+
+//Carries on after a failure so one run reports every broken check
+#define CHECK(expression) \
+	do { if (!(expression)) ReportFailure(__FILE__, __LINE__, #expression); } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+	do { if (!((a) - (b) <= (tolerance) && (b) - (a) <= (tolerance))) ReportFailure(__FILE__, __LINE__, #a " ~= " #b); } while (0)
@@ -0,0 +1,32 @@
+#include "TestFramework.h"
+
+static int s_failures = 0;
+
+std::vector<TestCase>& GetTests()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void ReportFailure(const char* file, int line, const char* expression)
+{
+    printf("%s(%d): CHECK(%s) failed\n", file, line, expression);
+    s_failures++;
+}
+
+int main()
+{
+    int failedTests = 0;
+    for (const TestCase& test : GetTests())
+    {
+        int failuresBefore = s_failures;
+        test.Function();
+
+        bool passed = s_failures == failuresBefore;
+        if (!passed) failedTests++;
+        printf("[%s] %s\n", passed ? "PASS" : "FAIL", test.Name);
+    }
+
+    printf("%d of %d tests passed\n", (int)GetTests().size() - failedTests, (int)GetTests().size());
+    return failedTests == 0 ? 0 : 1;
+}
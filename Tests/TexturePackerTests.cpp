@@ -0,0 +1,301 @@
+#include "TestFramework.h"
+#include "TexturePacker.h"
+
+static TexturePackInput MakeInput(DDSFormat format, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+    TexturePackInput input;
+    input.Desc.Dimension = DDS_DIMENSION_TEXTURE2D;
+    input.Desc.Format = format;
+    input.Desc.Width = width;
+    input.Desc.Height = height;
+    input.Desc.Depth = 1;
+    input.Desc.MipCount = mipCount;
+    input.Desc.ArraySize = 1;
+    return input;
+}
+
+//A whole file for the input's desc with every byte of its pixels set to fill, which Data and Size then point into
+static void Fill(TexturePackInput& input, uint8_t fill, std::vector<uint8_t>& file)
+{
+    file.clear();
+    input.Desc.DataOffset = DDSParser::WriteHeader(input.Desc, file);
+    input.Desc.DataSize = SIZE_MAX - input.Desc.DataOffset;
+    DDSLayout layout;
+    CHECK(DDSParser::GetLayout(input.Desc, 0, layout) == DDS_OK);
+    file.resize(file.size() + layout.Bytes, fill);
+
+    CHECK(DDSParser::Parse(file.data(), file.size(), input.Desc) == DDS_OK);
+    input.Data = file.data();
+    input.Size = file.size();
+}
+
+static bool Overlaps(const TexturePlacement& a, uint32_t widthA, uint32_t heightA, const TexturePlacement& b, uint32_t widthB, uint32_t heightB)
+{
+    return a.X < b.X + widthB && b.X < a.X + widthA && a.Y < b.Y + heightB && b.Y < a.Y + heightA;
+}
+
+TEST(ArraysGroupBySizeFormatAndMips)
+{
+    std::vector<TexturePackInput> inputs;
+    inputs.push_back(MakeInput(DDS_FORMAT_BC1_UNORM, 256, 256, 9));
+    inputs.push_back(MakeInput(DDS_FORMAT_BC1_UNORM, 128, 128, 8));
+    inputs.push_back(MakeInput(DDS_FORMAT_BC1_UNORM, 256, 256, 9));
+    inputs.push_back(MakeInput(DDS_FORMAT_BC3_UNORM, 256, 256, 9));
+    inputs.push_back(MakeInput(DDS_FORMAT_BC1_UNORM, 256, 256, 1));
+    inputs.push_back(MakeInput(DDS_FORMAT_BC1_UNORM, 256, 256, 9));
+
+    TexturePackSettings settings;
+    settings.AtlasMaxInputSize = 0;
+    TexturePackPlan plan;
+    TexturePacker::Plan(inputs, settings, plan);
+
+    CHECK(plan.Packs.size() == 1);
+    CHECK(plan.Placements.size() == inputs.size());
+    const TexturePack& pack = plan.Packs[0];
+    CHECK(pack.Kind == TEXTURE_PACK_ARRAY && pack.Format == DDS_FORMAT_BC1_UNORM);
+    CHECK(pack.Width == 256 && pack.Height == 256 && pack.MipCount == 9 && pack.Slices == 3);
+    CHECK(pack.Inputs == std::vector<uint32_t>({ 0, 2, 5 }));
+
+    //Slices go in input order, and nothing that differs in any way shares them
+    CHECK(plan.Placements[0].Pack == 0 && plan.Placements[0].Slice == 0);
+    CHECK(plan.Placements[2].Pack == 0 && plan.Placements[2].Slice == 1);
+    CHECK(plan.Placements[5].Pack == 0 && plan.Placements[5].Slice == 2);
+    CHECK(plan.Placements[1].Pack == -1 && plan.Placements[3].Pack == -1 && plan.Placements[4].Pack == -1);
+}
+
+TEST(OnlySingle2DTexturesArePacked)
+{
+    TexturePackInput cube = MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 64, 64, 1);
+    cube.Desc.IsCubeMap = true;
+    cube.Desc.ArraySize = 6;
+    TexturePackInput array = MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 64, 64, 1);
+    array.Desc.ArraySize = 2;
+    TexturePackInput volume = MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 64, 64, 1);
+    volume.Desc.Dimension = DDS_DIMENSION_TEXTURE3D;
+
+    CHECK(TexturePacker::CanArray(MakeInput(DDS_FORMAT_R16G16B16A16_FLOAT, 64, 64, 1).Desc));
+    CHECK(!TexturePacker::CanArray(cube.Desc) && !TexturePacker::CanArray(array.Desc) && !TexturePacker::CanArray(volume.Desc));
+
+    //Atlases also need a format that can be decoded and written again
+    CHECK(TexturePacker::CanAtlas(MakeInput(DDS_FORMAT_B8G8R8A8_UNORM_SRGB, 64, 64, 1).Desc));
+    CHECK(TexturePacker::CanAtlas(MakeInput(DDS_FORMAT_BC1_UNORM, 64, 64, 1).Desc));
+    CHECK(!TexturePacker::CanAtlas(MakeInput(DDS_FORMAT_R16G16B16A16_FLOAT, 64, 64, 1).Desc));
+}
+
+TEST(AtlasPlacementsArePaddedAlignedAndApart)
+{
+    std::vector<TexturePackInput> inputs;
+    const uint32_t sizes[][2] = { { 60, 40 }, { 128, 128 }, { 16, 16 }, { 100, 20 }, { 37, 91 }, { 64, 64 }, { 1, 1 }, { 128, 5 } };
+    for (const auto& size : sizes) inputs.push_back(MakeInput(DDS_FORMAT_BC1_UNORM, size[0], size[1], 1));
+
+    TexturePackSettings settings;
+    settings.AtlasMaxInputSize = 128;
+    settings.AtlasSize = 160;
+    settings.AtlasPadding = 3;
+    TexturePackPlan plan;
+    TexturePacker::Plan(inputs, settings, plan);
+
+    CHECK(plan.Packs.size() == 1);
+    const TexturePack& pack = plan.Packs[0];
+    CHECK(pack.Kind == TEXTURE_PACK_ATLAS && pack.Inputs.size() == inputs.size());
+
+    //Padding of 3 keeps 2 mips, so every corner sits on 2 texels, which BC1's 4x4 blocks round up to 4
+    CHECK(pack.Alignment == 4 && pack.Padding == 4 && pack.MipCount == 2);
+    CHECK(pack.Width <= 160 && pack.Height <= 160 && pack.Width % 4 == 0 && pack.Height % 4 == 0);
+    CHECK(pack.Slices >= 2);
+
+    size_t usedTexels = 0;
+    for (uint32_t i = 0; i < (uint32_t)inputs.size(); i++)
+    {
+        const TexturePlacement& placement = plan.Placements[i];
+        const DDSTextureDesc& desc = inputs[i].Desc;
+        uint32_t paddedWidth = (desc.Width + 8 + 3) / 4 * 4;
+        uint32_t paddedHeight = (desc.Height + 8 + 3) / 4 * 4;
+        usedTexels += (size_t)paddedWidth * paddedHeight;
+
+        CHECK(placement.Pack == 0 && placement.Slice < pack.Slices);
+        CHECK(placement.X >= 4 && placement.Y >= 4 && (placement.X - 4) % 4 == 0 && (placement.Y - 4) % 4 == 0);
+        CHECK(placement.X - 4 + paddedWidth <= pack.Width && placement.Y - 4 + paddedHeight <= pack.Height);
+
+        CHECK_NEAR(placement.UVTransform.x, (float)desc.Width / pack.Width, 1e-6f);
+        CHECK_NEAR(placement.UVTransform.y, (float)desc.Height / pack.Height, 1e-6f);
+        CHECK_NEAR(placement.UVTransform.z, (float)placement.X / pack.Width, 1e-6f);
+        CHECK_NEAR(placement.UVTransform.w, (float)placement.Y / pack.Height, 1e-6f);
+
+        for (uint32_t j = 0; j < i; j++)
+        {
+            const TexturePlacement& other = plan.Placements[j];
+            if (other.Slice != placement.Slice) continue;
+
+            //Padding included, as the padded rectangles are what the mips read
+            TexturePlacement a = placement, b = other;
+            a.X -= 4, a.Y -= 4, b.X -= 4, b.Y -= 4;
+            CHECK(!Overlaps(a, paddedWidth, paddedHeight, b, (inputs[j].Desc.Width + 11) / 4 * 4, (inputs[j].Desc.Height + 11) / 4 * 4));
+        }
+    }
+    CHECK(pack.UsedTexels == usedTexels);
+}
+
+TEST(TooFewSmallTexturesFallBackToArrays)
+{
+    std::vector<TexturePackInput> inputs;
+    inputs.push_back(MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 64, 64, 7));
+    inputs.push_back(MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 64, 64, 7));
+    inputs.push_back(MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 32, 32, 6));
+
+    TexturePackSettings settings;
+    settings.MinSlices = 4;
+    TexturePackPlan plan;
+    TexturePacker::Plan(inputs, settings, plan);
+    CHECK(plan.Packs.empty());
+
+    settings.MinSlices = 2;
+    settings.AtlasSize = 64;
+    settings.AtlasPadding = 0;
+    TexturePacker::Plan(inputs, settings, plan);
+
+    //Each 64x64 fills an atlas page by itself, so all three go on pages rather than the two 64s sharing an array
+    CHECK(plan.Packs.size() == 1 && plan.Packs[0].Kind == TEXTURE_PACK_ATLAS && plan.Packs[0].Slices == 3);
+
+    settings.AtlasSize = 32;
+    TexturePacker::Plan(inputs, settings, plan);
+    CHECK(plan.Packs.size() == 1 && plan.Packs[0].Kind == TEXTURE_PACK_ARRAY && plan.Packs[0].Slices == 2);
+    CHECK(plan.Placements[2].Pack == -1);
+}
+
+TEST(AtlasPagesNeverExceedTheArrayLimit)
+{
+    //One texture to a page, so every input is a slice
+    TexturePackSettings settings;
+    settings.AtlasMaxInputSize = 8;
+    settings.AtlasSize = 8;
+    settings.AtlasPadding = 0;
+
+    std::vector<TexturePackInput> inputs(2048 * 2 + 3, MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 8, 8, 1));
+    TexturePackPlan plan;
+    TexturePacker::Plan(inputs, settings, plan);
+
+    CHECK(plan.Packs.size() == 3);
+    CHECK(plan.Packs[0].Slices == 2048 && plan.Packs[1].Slices == 2048 && plan.Packs[2].Slices == 3);
+    bool placed = true;
+    for (uint32_t i = 0; i < (uint32_t)inputs.size(); i++)
+    {
+        placed &= plan.Placements[i].Pack == (int)(i / 2048) && plan.Placements[i].Slice == i % 2048;
+    }
+    CHECK(placed);
+
+    //A last page on its own is too few to be worth a pack, and arrays can't take it either
+    inputs.resize(2048 + 1);
+    TexturePacker::Plan(inputs, settings, plan);
+    CHECK(plan.Packs.size() == 1 && plan.Packs[0].Slices == 2048);
+    CHECK(plan.Placements[2048].Pack == -1);
+}
+
+TEST(ArraysCopyEverySubresourceInOrder)
+{
+    std::vector<TexturePackInput> inputs(3, MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 16, 8, 3));
+    std::vector<std::vector<uint8_t>> files(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) Fill(inputs[i], (uint8_t)(10 + i), files[i]);
+
+    TexturePackSettings settings;
+    settings.AtlasMaxInputSize = 0;
+    TexturePackPlan plan;
+    TexturePacker::Plan(inputs, settings, plan);
+    CHECK(plan.Packs.size() == 1);
+
+    std::vector<uint8_t> output;
+    CHECK(TexturePacker::BuildArray(plan.Packs[0], inputs, output));
+
+    DDSTextureDesc desc;
+    DDSLayout layout;
+    CHECK(DDSParser::Parse(output.data(), output.size(), desc) == DDS_OK);
+    CHECK(desc.Width == 16 && desc.Height == 8 && desc.MipCount == 3 && desc.ArraySize == 3);
+    CHECK(DDSParser::GetLayout(desc, 0, layout) == DDS_OK && layout.Subresources.size() == 9);
+    CHECK(desc.DataOffset + layout.Bytes == output.size());
+
+    for (size_t i = 0; i < layout.Subresources.size(); i++)
+    {
+        const DDSSubresource& subresource = layout.Subresources[i];
+        uint8_t expected = (uint8_t)(10 + i / 3);
+        bool matches = true;
+        for (size_t b = 0; b < subresource.Size; b++) matches &= output[subresource.Offset + b] == expected;
+        CHECK(matches);
+    }
+
+    //Whatever doesn't match the plan any more is refused rather than written out wrong
+    inputs[1].Desc.MipCount = 2;
+    CHECK(!TexturePacker::BuildArray(plan.Packs[0], inputs, output));
+}
+
+TEST(AtlasPaddingRepeatsEachTexturesEdges)
+{
+    std::vector<TexturePackInput> inputs;
+    inputs.push_back(MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 12, 12, 1));
+    inputs.push_back(MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 8, 4, 1));
+    inputs.push_back(MakeInput(DDS_FORMAT_R8G8B8A8_UNORM, 5, 7, 1));
+    std::vector<std::vector<uint8_t>> files(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) Fill(inputs[i], (uint8_t)(50 * (i + 1)), files[i]);
+
+    TexturePackSettings settings;
+    settings.AtlasPadding = 2;
+    TexturePackPlan plan;
+    TexturePacker::Plan(inputs, settings, plan);
+    CHECK(plan.Packs.size() == 1 && plan.Packs[0].Kind == TEXTURE_PACK_ATLAS && plan.Packs[0].Slices == 1);
+    const TexturePack& pack = plan.Packs[0];
+
+    std::vector<uint8_t> output;
+    CHECK(TexturePacker::BuildAtlas(pack, plan, inputs, BC_QUALITY_FAST, nullptr, output));
+
+    DDSTextureDesc desc;
+    DDSLayout layout;
+    CHECK(DDSParser::Parse(output.data(), output.size(), desc) == DDS_OK);
+    CHECK(desc.Width == pack.Width && desc.Height == pack.Height && desc.MipCount == pack.MipCount && desc.ArraySize == pack.Slices);
+    CHECK(DDSParser::GetLayout(desc, 0, layout) == DDS_OK && desc.DataOffset + layout.Bytes == output.size());
+
+    //Solid textures, so everything inside each padded rectangle has to be its colour. Mip 1 stays solid too, as the
+    //alignment keeps neighbours out of each other's 2x2 boxes
+    for (uint32_t level = 0; level < pack.MipCount; level++)
+    {
+        const DDSSubresource& mip = layout.Subresources[level];
+        for (uint32_t i = 0; i < (uint32_t)inputs.size(); i++)
+        {
+            const TexturePlacement& placement = plan.Placements[i];
+            const DDSTextureDesc& inputDesc = inputs[i].Desc;
+            uint32_t left = (placement.X - pack.Padding) >> level;
+            uint32_t top = (placement.Y - pack.Padding) >> level;
+            uint32_t right = ((placement.X + inputDesc.Width + pack.Padding + pack.Alignment - 1) / pack.Alignment * pack.Alignment) >> level;
+            uint32_t bottom = ((placement.Y + inputDesc.Height + pack.Padding + pack.Alignment - 1) / pack.Alignment * pack.Alignment) >> level;
+
+            bool solid = true;
+            for (uint32_t y = top; y < bottom; y++)
+            {
+                for (uint32_t x = left; x < right; x++)
+                {
+                    const uint8_t* texel = output.data() + mip.Offset + y * mip.RowPitch + x * 4;
+                    solid &= texel[0] == 50 * (i + 1) && texel[3] == 50 * (i + 1);
+                }
+            }
+            CHECK(solid);
+        }
+    }
+}
+
+TEST(CompressedAtlasesAreEncodedBack)
+{
+    std::vector<TexturePackInput> inputs(4, MakeInput(DDS_FORMAT_BC1_UNORM, 32, 16, 1));
+    std::vector<std::vector<uint8_t>> files(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) Fill(inputs[i], 0, files[i]);
+
+    TexturePackSettings settings;
+    TexturePackPlan plan;
+    TexturePacker::Plan(inputs, settings, plan);
+    CHECK(plan.Packs.size() == 1 && plan.Packs[0].Kind == TEXTURE_PACK_ATLAS);
+
+    std::vector<uint8_t> output;
+    CHECK(TexturePacker::BuildAtlas(plan.Packs[0], plan, inputs, BC_QUALITY_FAST, nullptr, output));
+
+    DDSTextureDesc desc;
+    DDSLayout layout;
+    CHECK(DDSParser::Parse(output.data(), output.size(), desc) == DDS_OK && desc.Format == DDS_FORMAT_BC1_UNORM);
+    CHECK(DDSParser::GetLayout(desc, 0, layout) == DDS_OK && desc.DataOffset + layout.Bytes == output.size());
+}
@@ -0,0 +1,306 @@
+#include "TestFramework.h"
+#include <float.h>
+#include <math.h>
+#include <utility>
+#include <vector>
+#include "TextureStreaming.h"
+
+//BC7 sizes, a byte a texel down to one 4x4 block
+static std::vector<size_t> GetMipBytes(uint32_t size)
+{
+    std::vector<size_t> mipBytes;
+    for (uint32_t mip = 0; (size >> mip) > 0; mip++)
+    {
+        size_t blocks = std::max((size >> mip) / 4, 1u);
+        mipBytes.push_back(blocks * blocks * 16);
+    }
+    return mipBytes;
+}
+
+static size_t GetChainBytes(const std::vector<size_t>& mipBytes, uint32_t mip)
+{
+    size_t bytes = 0;
+    for (size_t m = mip; m < mipBytes.size(); m++) bytes += mipBytes[m];
+    return bytes;
+}
+
+//The size on screen that wants exactly mip of a size texel texture
+static float GetPixelsForMip(uint32_t size, float mip)
+{
+    return size / powf(2.0f, mip);
+}
+
+//The same shape as the streaming benchmark: a row of objects either side of the path the camera flies along, and
+//every stream finishes Latency frames after it was asked for, in the order they started
+struct SimulatedStreaming
+{
+    TextureStreamingPolicy Policy;
+    std::vector<uint32_t> Textures;
+    std::vector<XMFLOAT4> Bounds;
+    std::vector<uint32_t> ObjectTextures;
+    std::vector<std::pair<int, uint32_t>> InFlight;
+    std::vector<TextureStreamRequest> Requests;
+    int Latency = 3;
+    int Frame = 0;
+    size_t PeakResident = 0;
+
+    SimulatedStreaming(const TextureStreamingSettings& settings, int textureCount, int objectCount)
+    {
+        Policy.Initialise(settings);
+        for (int t = 0; t < textureCount; t++)
+        {
+            uint32_t size = 256u << (t % 3);
+            std::vector<size_t> mipBytes = GetMipBytes(size);
+            Textures.push_back(Policy.Add(size, size, mipBytes, (uint32_t)mipBytes.size()));
+        }
+        for (int i = 0; i < objectCount; i++)
+        {
+            Bounds.push_back(XMFLOAT4(i % 2 ? 3.0f : -3.0f, 0.0f, (i / 2) * 4.0f, 1.0f));
+            ObjectTextures.push_back(Textures[i % textureCount]);
+        }
+    }
+
+    size_t GetFullBytes() const
+    {
+        size_t bytes = 0;
+        for (uint32_t texture : Textures) bytes += TextureStreamingPolicy::GetBytes(Policy.Get(texture), 0);
+        return bytes;
+    }
+
+    //Camera t of the way along the row, looking down it from a little above. 720 lines at 90 degrees
+    void Step(float t)
+    {
+        XMFLOAT3 eye(0.0f, 2.0f, -10.0f + t * (Bounds.size() / 2 * 4.0f + 10.0f));
+        XMFLOAT3 forward(0.0f, 0.0f, 1.0f);
+
+        Policy.ReleaseRetired((uint64_t)std::max(Frame - 1, 0));
+        size_t done = 0;
+        while (done < InFlight.size() && InFlight[done].first <= Frame) Policy.Complete(InFlight[done++].second, true, Frame);
+        InFlight.erase(InFlight.begin(), InFlight.begin() + done);
+
+        Policy.BeginFrame();
+        for (size_t i = 0; i < Bounds.size(); i++)
+        {
+            float pixels = TextureStreamingPolicy::GetProjectedPixels(Bounds[i], eye, forward, 360.0f);
+            if (pixels > 0.0f) Policy.AddUse(ObjectTextures[i], pixels);
+        }
+        Policy.ChooseTargets();
+        Policy.GetRequests(Requests);
+        for (const TextureStreamRequest& request : Requests) InFlight.push_back(std::make_pair(Frame + Latency, request.Texture));
+
+        PeakResident = std::max(PeakResident, Policy.GetResidentBytes());
+        Frame++;
+    }
+
+    bool IsSettled() const
+    {
+        bool settled = InFlight.empty() && Requests.empty();
+        for (uint32_t texture : Textures) settled = settled && Policy.Get(texture).ResidentMip == Policy.Get(texture).TargetMip;
+        return settled;
+    }
+};
+
+//One texture on its own, with whatever stream it asks for finishing as soon as it is asked for
+static void StepOne(TextureStreamingPolicy& policy, uint32_t texture, float projectedPixels, uint64_t frame, std::vector<TextureStreamRequest>& requests)
+{
+    policy.ReleaseRetired(frame);
+    policy.BeginFrame();
+    if (projectedPixels > 0.0f) policy.AddUse(texture, projectedPixels);
+    policy.ChooseTargets();
+    policy.GetRequests(requests);
+    for (const TextureStreamRequest& request : requests) policy.Complete(request.Texture, true, frame);
+}
+
+TEST(ResidentMemoryNeverGoesOverBudget)
+{
+    TextureStreamingSettings settings;
+    SimulatedStreaming full(settings, 12, 48);
+    for (int frame = 0; frame < 200; frame++) full.Step(frame / 199.0f);
+
+    //Half of what the path wants at most, so the budget always has to leave detail out somewhere
+    settings.BudgetBytes = full.PeakResident / 2;
+    SimulatedStreaming limited(settings, 12, 48);
+    CHECK(limited.Policy.GetResidentBytes() <= settings.BudgetBytes);
+
+    bool underBudget = true;
+    for (int frame = 0; frame < 200; frame++)
+    {
+        limited.Step(frame / 199.0f);
+        underBudget &= limited.Policy.GetResidentBytes() <= settings.BudgetBytes;
+    }
+    CHECK(underBudget);
+    CHECK(limited.PeakResident > settings.BudgetBytes / 2);
+    CHECK(limited.Policy.GetStreamsStarted() > 0);
+}
+
+TEST(StreamsSettleOnceTheCameraStops)
+{
+    //Once with all it wants, then with half of that so the budget decides where it settles
+    size_t wanted = 0;
+    for (int budget = 0; budget < 2; budget++)
+    {
+        TextureStreamingSettings settings;
+        settings.MaxStreamsInFlight = 2;
+        if (budget == 1) settings.BudgetBytes = wanted / 2;
+        SimulatedStreaming streaming(settings, 12, 48);
+
+        for (int frame = 0; frame < 100; frame++) streaming.Step(frame / 199.0f);
+
+        //Halfway along it stops, and everything left to stream finishes
+        int frames = 0;
+        while (!streaming.IsSettled() && frames < 1000)
+        {
+            streaming.Step(99 / 199.0f);
+            frames++;
+        }
+        CHECK(streaming.IsSettled());
+        CHECK(streaming.Policy.GetResidentBytes() <= settings.BudgetBytes);
+        if (budget == 0) wanted = streaming.Policy.GetResidentBytes();
+
+        //Then nothing more is asked for while it stays still
+        size_t started = streaming.Policy.GetStreamsStarted();
+        for (int frame = 0; frame < 100; frame++) streaming.Step(99 / 199.0f);
+        CHECK(streaming.Policy.GetStreamsStarted() == started);
+    }
+}
+
+TEST(HysteresisHoldsAMipAtItsBoundary)
+{
+    for (int hysteresis = 0; hysteresis < 2; hysteresis++)
+    {
+        TextureStreamingSettings settings;
+        settings.Hysteresis = hysteresis ? 0.25f : 0.0f;
+        TextureStreamingPolicy policy;
+        policy.Initialise(settings);
+        uint32_t texture = policy.Add(1024, 1024, GetMipBytes(1024), 10);
+
+        std::vector<TextureStreamRequest> requests;
+        StepOne(policy, texture, GetPixelsForMip(1024, 0.9f), 0, requests);
+        CHECK(policy.Get(texture).ResidentMip == 0);
+
+        //Just either side of mip 1 every frame, as a camera standing at the distance where it changes would be
+        size_t started = policy.GetStreamsStarted();
+        for (uint64_t frame = 1; frame < 20; frame++)
+        {
+            StepOne(policy, texture, GetPixelsForMip(1024, frame % 2 ? 1.1f : 0.9f), frame, requests);
+        }
+
+        if (hysteresis) CHECK(policy.GetStreamsStarted() == started && policy.Get(texture).ResidentMip == 0);
+        else CHECK(policy.GetStreamsStarted() == started + 19);
+
+        //Going well past the boundary still drops it
+        StepOne(policy, texture, GetPixelsForMip(1024, 2.5f), 20, requests);
+        CHECK(policy.Get(texture).ResidentMip == 2);
+    }
+}
+
+TEST(DetailIsDroppedBeforeItIsAdded)
+{
+    //Room for one texture whole and another at its tail, plus the copy adding detail needs while it streams
+    std::vector<size_t> mipBytes = GetMipBytes(512);
+    TextureStreamingSettings settings;
+    settings.BudgetBytes = GetChainBytes(mipBytes, 0) * 2 + GetChainBytes(mipBytes, 3);
+    settings.MaxStreamsInFlight = 1;
+
+    TextureStreamingPolicy policy;
+    policy.Initialise(settings);
+    uint32_t shown = policy.Add(512, 512, mipBytes, 0);
+    uint32_t hidden = policy.Add(512, 512, mipBytes, 10);
+    CHECK(policy.Get(hidden).ResidentMip == 3);
+
+    //The resident one goes out of view as the other comes into it, and with one stream at a time the drop goes first
+    std::vector<TextureStreamRequest> requests;
+    policy.BeginFrame();
+    policy.AddUse(hidden, 512.0f);
+    policy.ChooseTargets();
+    policy.GetRequests(requests);
+    CHECK(requests.size() == 1 && requests[0].Texture == shown && requests[0].Mip == 3);
+
+    //With more at once, the other only gets what fits alongside both copies of the one being dropped
+    settings.MaxStreamsInFlight = 4;
+    policy.Initialise(settings);
+    policy.GetRequests(requests);
+    CHECK(requests.size() == 1 && requests[0].Texture == hidden && requests[0].Mip == 1);
+    CHECK(policy.GetCommittedBytes() <= settings.BudgetBytes);
+
+    //Once the dropped copy is let go of the rest comes in, never over budget
+    bool underBudget = true;
+    for (uint64_t frame = 0; frame < 20; frame++)
+    {
+        policy.ReleaseRetired(frame);
+        for (uint32_t texture : { shown, hidden })
+        {
+            if (policy.Get(texture).PendingMip != STREAM_NO_MIP) policy.Complete(texture, true, frame);
+        }
+
+        policy.BeginFrame();
+        policy.AddUse(hidden, 512.0f);
+        policy.ChooseTargets();
+        policy.GetRequests(requests);
+        underBudget &= policy.GetResidentBytes() <= settings.BudgetBytes && policy.GetCommittedBytes() <= settings.BudgetBytes;
+    }
+    CHECK(underBudget);
+    CHECK(policy.Get(hidden).ResidentMip == 0 && policy.Get(shown).ResidentMip == 3);
+}
+
+TEST(RemovingAStreamingTextureFreesItsIdOnceItsStreamIsDone)
+{
+    TextureStreamingSettings settings;
+    TextureStreamingPolicy policy;
+    policy.Initialise(settings);
+    uint32_t removed = policy.Add(1024, 1024, GetMipBytes(1024), 10);
+
+    std::vector<TextureStreamRequest> requests;
+    policy.BeginFrame();
+    policy.AddUse(removed, 1024.0f);
+    policy.ChooseTargets();
+    policy.GetRequests(requests);
+    CHECK(requests.size() == 1 && policy.GetInFlightCount() == 1);
+
+    //Its id can't be handed out while the stream still writes to it, and it no longer counts as resident
+    policy.Remove(removed);
+    CHECK(policy.GetResidentBytes() == 0);
+    uint32_t added = policy.Add(256, 256, GetMipBytes(256), 8);
+    CHECK(added != removed);
+
+    policy.Complete(removed, true, 0);
+    CHECK(policy.GetInFlightCount() == 0);
+    CHECK(policy.Add(256, 256, GetMipBytes(256), 8) == removed);
+    CHECK(policy.GetTextureCount() == 2);
+
+    //Removed with nothing in flight, it is free straight away
+    policy.Remove(added);
+    CHECK(policy.Add(256, 256, GetMipBytes(256), 8) == added);
+}
+
+TEST(AFailedStreamIsNotRetried)
+{
+    TextureStreamingSettings settings;
+    TextureStreamingPolicy policy;
+    policy.Initialise(settings);
+    uint32_t texture = policy.Add(1024, 1024, GetMipBytes(1024), 10);
+    uint32_t tailMip = policy.Get(texture).ResidentMip;
+
+    std::vector<TextureStreamRequest> requests;
+    policy.BeginFrame();
+    policy.AddUse(texture, 1024.0f);
+    policy.ChooseTargets();
+    policy.GetRequests(requests);
+    CHECK(requests.size() == 1);
+
+    policy.Complete(texture, false, 0);
+    CHECK(policy.Get(texture).Failed && policy.Get(texture).ResidentMip == tailMip);
+
+    //Still wanted every frame, but it stays as it was and takes nothing from the budget it doesn't have
+    size_t started = policy.GetStreamsStarted();
+    for (uint64_t frame = 1; frame < 20; frame++)
+    {
+        policy.BeginFrame();
+        policy.AddUse(texture, 1024.0f);
+        policy.ChooseTargets();
+        policy.GetRequests(requests);
+        CHECK(requests.empty());
+    }
+    CHECK(policy.GetStreamsStarted() == started);
+    CHECK(policy.Get(texture).TargetMip == tailMip);
+}